@@ -53,8 +53,13 @@ final class SessionCoordinator {
 
     func handleKey(_ keyEvent: LexKeyEvent, client: IMKTextInput) -> Bool {
         lastClient = client
-        candidateManager.invalidate()
         let resp = session.handleKey(event: keyEvent)
+        // The session omits the candidate event when the list is unchanged.
+        // Such a response must not cancel a panel show still pending from an
+        // earlier key, so only responses that touch the panel invalidate.
+        if resp.events.contains(where: Self.touchesPanel) {
+            candidateManager.invalidate()
+        }
         applyEvents(resp, client: client)
         return resp.consumed
     }
@@ -69,10 +74,14 @@ final class SessionCoordinator {
 
     func resetDisplay() {
         currentDisplay = nil
+        session.candidatePanelHidden()
     }
 
     func deactivate() {
         candidateManager.deactivate()
+        // The panel was hidden without a session response; make the session
+        // send its next candidate list in full.
+        session.candidatePanelHidden()
         currentDisplay = nil
         lastClient = nil
     }
@@ -105,6 +114,15 @@ final class SessionCoordinator {
         }
     }
 
+    private static func touchesPanel(_ event: LexEvent) -> Bool {
+        switch event {
+        case .commit, .showCandidates, .hideCandidates:
+            return true
+        case .setMarkedText, .switchToAbc:
+            return false
+        }
+    }
+
     /// Update inline marked text with the given display string.
     /// Uses markedClauseSegment to prevent the client's text system from
     /// applying its own transformations (e.g. Shift-triggered katakana conversion).
@@ -20,66 +20,47 @@ final class EngineContainer {
 
     static func load(resourcePath: String, userDictPath: String, historyPath: String) -> EngineContainer {
         let dictPath = (resourcePath as NSString).appendingPathComponent("lexime.dict")
-        var dict: LexDictionary?
-        do {
-            let d = try LexDictionary.open(path: dictPath)
-            NSLog("Lexime: Dictionary loaded from %@", dictPath)
-            let entries = d.lookup(reading: "かんじ")
-            NSLog("Lexime: Sample lookup 'かんじ' → %ld candidates", entries.count)
-            dict = d
-        } catch {
-            NSLog("Lexime: Failed to load dictionary at %@: %@", dictPath, "\(error)")
-            dict = nil
-        }
-
         let connPath = (resourcePath as NSString).appendingPathComponent("lexime.conn")
-        let conn: LexConnection?
-        do {
-            let c = try LexConnection.open(path: connPath)
-            NSLog("Lexime: Connection matrix loaded from %@", connPath)
-            conn = c
-        } catch {
-            NSLog("Lexime: Connection matrix not found at %@ (using unigram fallback)", connPath)
-            conn = nil
-        }
 
-        let userDict: LexUserDictionary?
+        // Opens the independent resources concurrently on the Rust side.
+        // Only a dictionary failure throws; the others come back nil.
+        let resources: LexResources
         do {
-            let ud = try LexUserDictionary.open(path: userDictPath)
-            NSLog("Lexime: User dictionary loaded from %@", userDictPath)
-            userDict = ud
+            resources = try LexResources.load(paths: LexResourcePaths(
+                dictPath: dictPath,
+                connPath: connPath,
+                userDictPath: userDictPath,
+                historyPath: historyPath))
         } catch {
-            NSLog("Lexime: Failed to open user dictionary at %@: %@", userDictPath, "\(error)")
-            userDict = nil
+            NSLog("Lexime: Failed to load dictionary at %@: %@", dictPath, "\(error)")
+            return EngineContainer(engine: nil, dictionary: nil, history: nil, userDict: nil)
         }
 
-        if userDict != nil, dict != nil {
-            do {
-                let composite = try LexDictionary.openWithUserDict(
-                    path: dictPath, userDict: userDict)
-                NSLog("Lexime: Composite dictionary created (system + user)")
-                dict = composite
-            } catch {
-                NSLog("Lexime: Failed to create composite dictionary: %@", "\(error)")
+        for timing in resources.timings() {
+            if let error = timing.error {
+                NSLog("Lexime: %@ failed to load (%.1f ms): %@", timing.resource, timing.millis, error)
+            } else {
+                NSLog("Lexime: %@ loaded in %.1f ms", timing.resource, timing.millis)
             }
         }
 
-        let history: LexUserHistory?
-        do {
-            let h = try LexUserHistory.open(path: historyPath)
-            NSLog("Lexime: User history loaded from %@", historyPath)
-            history = h
-        } catch {
-            NSLog("Lexime: Failed to open user history at %@: %@", historyPath, "\(error)")
-            history = nil
+        // Checksums are verified on a Rust background thread after load.
+        DispatchQueue.global(qos: .background).async {
+            for issue in resources.waitForIntegrity() {
+                NSLog(
+                    "Lexime: %@ failed integrity check (%@)",
+                    issue.resource, issue.sections.joined(separator: ", "))
+            }
         }
 
-        let engine: LexEngine?
-        if let dict {
-            engine = LexEngine(dict: dict, conn: conn, history: history, userDict: userDict)
-        } else {
-            engine = nil
-        }
+        let dict = resources.dictionary()
+        let entries = dict.lookup(reading: "かんじ")
+        NSLog("Lexime: Sample lookup 'かんじ' → %ld candidates", entries.count)
+
+        let conn = resources.connection()
+        let userDict = resources.userDictionary()
+        let history = resources.history()
+        let engine = LexEngine(dict: dict, conn: conn, history: history, userDict: userDict)
 
         return EngineContainer(
             engine: engine, dictionary: dict, history: history, userDict: userDict)
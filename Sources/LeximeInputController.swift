@@ -34,6 +34,8 @@ class LeximeInputController: IMKInputController {
             factory: { listener in
                 let session = engine.createSession(listener: listener)
                 session.setDeferCandidates(enabled: true)
+                // Idle text fields drop their caches and worker thread.
+                session.setAutoHibernate(seconds: 60)
                 session.setSnippetStore(store: AppContext.shared.snippetStore)
                 if convMode == 1 {
                     session.setConversionMode(mode: .predictive)
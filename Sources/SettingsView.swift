@@ -75,7 +75,7 @@ struct DeveloperSettingsView: View {
                         .border(Color(nsColor: .separatorColor))
                         .accessibilityLabel("設定エディタ")
                     tomlButtons(
-                        onSave: { saveFile(name: "settings.toml", content: settingsText) },
+                        onSave: { saveSettings() },
                         onReload: { loadSettings() },
                         onReset: { settingsText = settingsDefaultConfig() }
                     )
@@ -198,7 +198,8 @@ struct DeveloperSettingsView: View {
             ?? "# settings.toml が見つかりません\n# mise run settings-export で生成できます"
     }
 
-    private func saveFile(name: String, content: String) {
+    @discardableResult
+    private func saveFile(name: String, content: String) -> Bool {
         let path = (supportDir as NSString).appendingPathComponent(name)
         do {
             try FileManager.default.createDirectory(
@@ -206,8 +207,22 @@ struct DeveloperSettingsView: View {
             try content.write(toFile: path, atomically: true, encoding: .utf8)
             needsRestart = true
             NSLog("Lexime: Saved %@", path)
+            return true
         } catch {
             NSLog("Lexime: Failed to save %@: %@", path, "\(error)")
+            return false
+        }
+    }
+
+    /// Save settings.toml and apply it to new conversions right away.
+    /// Snippet variables are still bound at startup, so the restart hint stays.
+    private func saveSettings() {
+        guard saveFile(name: "settings.toml", content: settingsText) else { return }
+        do {
+            try settingsApplyConfig(toml: settingsText)
+            NSLog("Lexime: Applied settings.toml")
+        } catch {
+            NSLog("Lexime: settings.toml not applied: %@", "\(error)")
         }
     }
 }
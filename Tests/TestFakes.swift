@@ -122,6 +122,10 @@ final class FakeLexSession: LexSessionProtocol, @unchecked Sendable {
     var setAbcPassthroughCalls: [Bool] = []
     var setConversionModeCalls: [LexConversionMode] = []
     var setDeferCandidatesCalls: [Bool] = []
+    var setAutoHibernateCalls: [UInt32] = []
+    var hibernateCalls: Int = 0
+    var candidatePanelHiddenCalls: Int = 0
+    var nextPhraseSuggestionsValue: [String] = []
 
     func handleKey(event: LexKeyEvent) -> LexKeyResponse {
         handleKeyCalls.append(event)
@@ -144,5 +148,9 @@ final class FakeLexSession: LexSessionProtocol, @unchecked Sendable {
     func setConversionMode(mode: LexConversionMode) { setConversionModeCalls.append(mode) }
     func setDeferCandidates(enabled: Bool) { setDeferCandidatesCalls.append(enabled) }
     func setSnippetStore(store: LexSnippetStore?) { setSnippetStoreCalls += 1 }
+    func setAutoHibernate(seconds: UInt32) { setAutoHibernateCalls.append(seconds) }
+    func hibernate() { hibernateCalls += 1 }
+    func candidatePanelHidden() { candidatePanelHiddenCalls += 1 }
+    func nextPhraseSuggestions(maxResults: UInt32) -> [String] { nextPhraseSuggestionsValue }
     func shutdown() { shutdownCalls += 1 }
 }
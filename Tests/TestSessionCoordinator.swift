@@ -34,14 +34,40 @@ func testSessionCoordinator() {
         assertEqual(session.handleKeyCalls[0], LexKeyEvent.space, "forwarded event matches")
     }
 
-    // handleKey: bumps candidate generation (invalidates stale async work)
+    // handleKey: a response that touches the panel bumps candidate generation
+    // (invalidates a stale deferred show)
     do {
         let session = FakeLexSession()
+        session.handleKeyResponses = [
+            LexKeyResponse(consumed: true, events: [.hideCandidates])
+        ]
         let (coordinator, manager) = makeCoordinator(session: session)
         let before = manager.generation
-        _ = coordinator.handleKey(.space, client: FakeIMKClient())
+        _ = coordinator.handleKey(.escape, client: FakeIMKClient())
         assertTrue(manager.generation == before &+ 1,
-                   "handleKey invalidates candidate generation")
+                   "handleKey invalidates candidate generation on a panel event")
+    }
+
+    // handleKey: an unchanged candidate list (no candidate event) leaves a
+    // pending deferred show alone
+    do {
+        let session = FakeLexSession()
+        session.handleKeyResponses = [
+            LexKeyResponse(consumed: true, events: [
+                .setMarkedText(text: "きょう"),
+                .showCandidates(surfaces: ["今日", "京"], selected: 0),
+            ]),
+            LexKeyResponse(consumed: true, events: [.setMarkedText(text: "きょうk")]),
+        ]
+        let panel = FakePanel()
+        panel.visible = false
+        let (coordinator, manager) = makeCoordinator(session: session, panel: panel)
+        let client = FakeIMKClient()
+        _ = coordinator.handleKey(.text(text: "u", shift: false), client: client)
+        let pending = manager.generation
+        _ = coordinator.handleKey(.text(text: "k", shift: false), client: client)
+        assertTrue(manager.generation == pending,
+                   "marked-text-only response keeps the pending show")
     }
 
     // .commit event → client.insertText + currentDisplay cleared
@@ -189,6 +215,8 @@ func testSessionCoordinator() {
         assertTrue(manager.generation == genBefore &+ 1,
                    "deactivate invalidates generation")
         assertTrue(panel.hideCount >= 1, "deactivate hides panel")
+        assertEqual(session.candidatePanelHiddenCalls, 1,
+                    "deactivate tells the session the panel is hidden")
         assertTrue(coordinator.currentDisplay == nil, "deactivate clears display")
     }
 }
@@ -59,11 +59,21 @@ enum Command {
         /// Mozc id.def for function-word range extraction
         #[arg(long)]
         id_def: Option<String>,
+        /// Store 8-bit codes with per-left-ID offset and scale (V4)
+        #[arg(long)]
+        quantize: bool,
     },
     /// Show dictionary or connection matrix info (auto-detected by magic bytes)
     Info {
         /// Dictionary (.dict) or connection matrix (.conn) file
         file: String,
+        /// Also report layout statistics (trie shape, string pool, entry
+        /// and cost distributions)
+        #[arg(long)]
+        deep: bool,
+        /// Output as JSON instead of text
+        #[arg(long)]
+        json: bool,
     },
     /// Merge two dictionaries
     Merge {
@@ -237,6 +247,19 @@ enum UserDictAction {
     },
     /// List all registered words
     List,
+    /// Bulk-import a TSV glossary into the compiled base layer
+    ///
+    /// Rows are `reading<TAB>surface[<TAB>cost[<TAB>pos_id]]`; `#` starts a comment.
+    Import {
+        /// TSV file to import
+        tsv: String,
+        /// Cost for rows without a cost column (default: -1)
+        #[arg(long)]
+        cost: Option<i16>,
+        /// POS ID for rows without a pos_id column (default: 1852, 名詞,一般)
+        #[arg(long)]
+        pos_id: Option<u16>,
+    },
 }
 
 #[derive(Subcommand)]
@@ -302,8 +325,9 @@ fn main() {
             input_txt,
             output_file,
             id_def,
-        } => dict_ops::compile_conn(&input_txt, &output_file, id_def.as_deref()),
-        Command::Info { file } => dict_ops::info(&file),
+            quantize,
+        } => dict_ops::compile_conn(&input_txt, &output_file, id_def.as_deref(), quantize),
+        Command::Info { file, deep, json } => dict_ops::info(&file, deep, json),
         Command::Merge {
             max_cost,
             max_reading_len,
@@ -393,6 +417,9 @@ fn main() {
                     user_dict_ops::user_dict_remove(path, &reading, &surface)
                 }
                 UserDictAction::List => user_dict_ops::user_dict_list(path),
+                UserDictAction::Import { tsv, cost, pos_id } => {
+                    user_dict_ops::user_dict_import(path, Path::new(&tsv), cost, pos_id)
+                }
             }
         }
         #[cfg(feature = "neural")]
@@ -1,6 +1,7 @@
 use std::collections::{BTreeMap, HashMap, HashSet};
 use std::fs;
 use std::io::{BufRead, BufReader, BufWriter, Write};
+use std::ops::Range;
 use std::path::Path;
 use std::process;
 
@@ -8,11 +9,26 @@ use clap::{Parser, Subcommand};
 use serde::{Deserialize, Serialize};
 
 use lex_core::converter::tune;
-use lex_core::converter::{convert_nbest, convert_nbest_with_history};
+use lex_core::converter::{convert_nbest, convert_nbest_with_history, ConvertedSegment};
 use lex_core::dict::connection::ConnectionMatrix;
 use lex_core::dict::TrieDictionary;
 use lex_core::user_history::UserHistory;
 
+fn parse_span(raw: &str) -> Result<Range<usize>, String> {
+    let (start, end) = raw
+        .split_once("..")
+        .ok_or_else(|| format!("expected START..END, got '{raw}'"))?;
+    let parse = |s: &str| {
+        s.parse::<usize>()
+            .map_err(|e| format!("invalid position '{s}': {e}"))
+    };
+    let (start, end) = (parse(start)?, parse(end)?);
+    if start >= end {
+        return Err(format!("span must be non-empty, got '{raw}'"));
+    }
+    Ok(start..end)
+}
+
 #[derive(Parser)]
 #[command(name = "lextool", about = "Lexime conversion diagnostics")]
 struct Cli {
@@ -43,9 +59,15 @@ enum Command {
         /// Output as JSON instead of text
         #[arg(long)]
         json: bool,
-        /// Omit lattice_nodes from JSON output
+        /// Omit lattice_nodes from the output
         #[arg(long)]
         no_lattice: bool,
+        /// Only show lattice nodes overlapping this character span (START..END)
+        #[arg(long, value_parser = parse_span)]
+        node_span: Option<Range<usize>>,
+        /// Only show lattice nodes whose surface contains this string
+        #[arg(long)]
+        node_surface: Option<String>,
     },
 
     /// Run readings from a file and record top-N results to JSONL
@@ -89,6 +111,10 @@ enum Command {
         /// Path to user history file (optional)
         #[arg(long)]
         history: Option<String>,
+        /// Also run with this connection matrix and report cases that change
+        /// (e.g. a `dictool compile-conn --quantize` build of the same matrix)
+        #[arg(long)]
+        compare_conn: Option<String>,
     },
 
     /// Grid-search FeatureWeights to optimise conversion accuracy
@@ -197,7 +223,7 @@ struct AccuracyResult {
     pr: Option<String>,
 }
 
-#[derive(Debug, Serialize)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
 #[serde(rename_all = "lowercase")]
 enum AccuracyStatus {
     Pass,
@@ -218,6 +244,30 @@ struct AccuracySummary {
 struct AccuracyReport {
     results: Vec<AccuracyResult>,
     summary: AccuracySummary,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    delta: Option<AccuracyDelta>,
+}
+
+/// Cases whose top-1 changed under `--compare-conn`.
+#[derive(Debug, Serialize)]
+struct AccuracyDelta {
+    conn_file: String,
+    summary: AccuracySummary,
+    /// Passing cases that fail with the compared matrix.
+    regressed: usize,
+    /// Failing cases that pass with the compared matrix.
+    fixed: usize,
+    changes: Vec<AccuracyChange>,
+}
+
+#[derive(Debug, Serialize)]
+struct AccuracyChange {
+    reading: String,
+    expected: String,
+    actual: String,
+    compared: String,
+    status: AccuracyStatus,
+    compared_status: AccuracyStatus,
 }
 
 fn open_resources(
@@ -290,6 +340,118 @@ fn run_snapshot(
     }
 }
 
+/// Run one accuracy case against `conn`.
+fn run_accuracy_case(
+    dict: &TrieDictionary,
+    conn: &ConnectionMatrix,
+    hist: Option<&UserHistory>,
+    case: &AccuracyCase,
+) -> AccuracyResult {
+    let top1 = |paths: Vec<Vec<ConvertedSegment>>| -> String {
+        paths
+            .first()
+            .map(|segs| segs.iter().map(|s| s.surface.as_str()).collect())
+            .unwrap_or_default()
+    };
+    let result =
+        |actual: String, status: AccuracyStatus, baseline_actual: Option<String>| AccuracyResult {
+            reading: case.reading.clone(),
+            expected: case.expected.clone(),
+            actual,
+            status,
+            category: case.category.clone(),
+            baseline: case.baseline.clone(),
+            baseline_actual,
+            note: case.note.clone(),
+            issue: case.issue.clone(),
+            pr: case.pr.clone(),
+        };
+
+    if case.skip {
+        return result(String::new(), AccuracyStatus::Skip, None);
+    }
+
+    // If baseline is specified, first verify no-history conversion
+    let baseline_actual = case
+        .baseline
+        .as_ref()
+        .map(|_| top1(convert_nbest(dict, Some(conn), &case.reading, 1)));
+    if baseline_actual.is_some() && baseline_actual != case.baseline {
+        return result(String::new(), AccuracyStatus::Fail, baseline_actual);
+    }
+
+    let actual = top1(match hist {
+        Some(h) => convert_nbest_with_history(dict, Some(conn), h, &case.reading, 1),
+        None => convert_nbest(dict, Some(conn), &case.reading, 1),
+    });
+    let status = if actual == case.expected {
+        AccuracyStatus::Pass
+    } else {
+        AccuracyStatus::Fail
+    };
+    result(actual, status, baseline_actual)
+}
+
+/// Summary counts, plus the number of non-skipped cases.
+fn summarize_accuracy(results: &[AccuracyResult]) -> (AccuracySummary, usize) {
+    let count = |status| results.iter().filter(|r| r.status == status).count();
+    let total = results.len();
+    let (pass, fail, skip) = (
+        count(AccuracyStatus::Pass),
+        count(AccuracyStatus::Fail),
+        count(AccuracyStatus::Skip),
+    );
+    let tested = total - skip;
+    let rate = if tested > 0 {
+        pass as f64 / tested as f64 * 100.0
+    } else {
+        0.0
+    };
+    let summary = AccuracySummary {
+        total,
+        pass,
+        fail,
+        skip,
+        pass_rate: format!("{:.1}%", rate),
+    };
+    (summary, tested)
+}
+
+/// Compare per-case results from two connection matrices.
+fn accuracy_delta(
+    conn_file: String,
+    results: &[AccuracyResult],
+    compared: Vec<AccuracyResult>,
+) -> AccuracyDelta {
+    let (summary, _) = summarize_accuracy(&compared);
+    let changes: Vec<AccuracyChange> = results
+        .iter()
+        .zip(compared)
+        .filter(|(a, b)| a.actual != b.actual || a.status != b.status)
+        .map(|(a, b)| AccuracyChange {
+            reading: a.reading.clone(),
+            expected: a.expected.clone(),
+            actual: a.actual.clone(),
+            compared: b.actual,
+            status: a.status,
+            compared_status: b.status,
+        })
+        .collect();
+    let moved = |from, to| {
+        changes
+            .iter()
+            .filter(|c| c.status == from && c.compared_status == to)
+            .count()
+    };
+    AccuracyDelta {
+        conn_file,
+        summary,
+        regressed: moved(AccuracyStatus::Pass, AccuracyStatus::Fail),
+        fixed: moved(AccuracyStatus::Fail, AccuracyStatus::Pass),
+        changes,
+    }
+}
+
 fn main() {
     let cli = Cli::parse();
 
@@ -303,31 +465,44 @@ fn main() {
             n,
             json,
             no_lattice,
+            node_span,
+            node_surface,
         } => {
-            use lex_core::converter::explain;
+            use lex_core::converter::explain::{Explanation, NodeFilter};
 
             let (dict, conn, hist) = open_resources(&dict_file, conn.as_deref(), &history);
             // Over-fetch when filtering by surface
             let fetch_n = if surface.is_some() { n.max(20) } else { n };
-            let mut result =
-                explain::explain(&dict, conn.as_ref(), hist.as_ref(), &reading, fetch_n);
+            let mut explanation =
+                Explanation::new(&dict, conn.as_ref(), hist.as_ref(), &reading, fetch_n);
 
             if let Some(ref filter) = surface {
-                result.paths.retain(|p| p.surface().contains(filter));
-                result.paths.truncate(n);
+                explanation.retain_paths(|s| s.contains(filter.as_str()));
+                explanation.truncate_paths(n);
             }
 
-            if no_lattice {
-                result.lattice_nodes.clear();
-            }
+            explanation.set_node_filter(if no_lattice {
+                NodeFilter::None
+            } else if node_span.is_some() || node_surface.is_some() {
+                NodeFilter::Matching {
+                    span: node_span,
+                    surface: node_surface,
+                }
+            } else {
+                NodeFilter::All
+            });
 
-            if json {
-                println!(
-                    "{}",
-                    serde_json::to_string_pretty(&result).expect("JSON serialization failed")
-                );
+            let mut out = BufWriter::new(std::io::stdout().lock());
+            let written = if json {
+                serde_json::to_writer_pretty(&mut out, &explanation)
+                    .map_err(std::io::Error::from)
+                    .and_then(|()| writeln!(out))
             } else {
-                print!("{}", explain::format_text(&result));
+                explanation.write_text(&mut out)
+            };
+            if let Err(e) = written.and_then(|()| out.flush()) {
+                eprintln!("Failed to write explain output: {}", e);
+                process::exit(1);
             }
         }
 
@@ -340,6 +515,7 @@ fn main() {
             verbose,
             json,
             history,
+            compare_conn,
         } => {
             let (dict, conn, file_hist) = open_resources(&dict_file, Some(&conn_file), &history);
             let conn = conn.expect("connection matrix is required for accuracy");
@@ -398,114 +574,31 @@ fn main() {
                 process::exit(1);
             }
 
-            // Run each case
-            let mut results: Vec<AccuracyResult> = Vec::new();
-            for case in &cases {
-                if case.skip {
-                    results.push(AccuracyResult {
-                        reading: case.reading.clone(),
-                        expected: case.expected.clone(),
-                        actual: String::new(),
-                        status: AccuracyStatus::Skip,
-                        category: case.category.clone(),
-                        baseline: case.baseline.clone(),
-                        baseline_actual: None,
-                        note: case.note.clone(),
-                        issue: case.issue.clone(),
-                        pr: case.pr.clone(),
-                    });
-                    continue;
-                }
-
-                // If baseline is specified, first verify no-history conversion
-                let (baseline_actual, baseline_changed) =
-                    if let Some(ref expected_baseline) = case.baseline {
-                        let paths_no_hist = convert_nbest(&dict, Some(&conn), &case.reading, 1);
-                        let ba: String = paths_no_hist
-                            .first()
-                            .map(|segs| segs.iter().map(|s| s.surface.as_str()).collect())
-                            .unwrap_or_default();
-                        let changed = ba != *expected_baseline;
-                        (Some(ba), changed)
-                    } else {
-                        (None, false)
-                    };
-
-                if baseline_changed {
-                    results.push(AccuracyResult {
-                        reading: case.reading.clone(),
-                        expected: case.expected.clone(),
-                        actual: String::new(),
-                        status: AccuracyStatus::Fail,
-                        category: case.category.clone(),
-                        baseline: case.baseline.clone(),
-                        baseline_actual: baseline_actual.clone(),
-                        note: case.note.clone(),
-                        issue: case.issue.clone(),
-                        pr: case.pr.clone(),
-                    });
-                    continue;
-                }
-
-                let paths = match hist.as_ref() {
-                    Some(h) => convert_nbest_with_history(&dict, Some(&conn), h, &case.reading, 1),
-                    None => convert_nbest(&dict, Some(&conn), &case.reading, 1),
-                };
-                let actual: String = paths
-                    .first()
-                    .map(|segs| segs.iter().map(|s| s.surface.as_str()).collect())
-                    .unwrap_or_default();
-
-                let status = if actual == case.expected {
-                    AccuracyStatus::Pass
-                } else {
-                    AccuracyStatus::Fail
-                };
+            let results: Vec<AccuracyResult> = cases
+                .iter()
+                .map(|case| run_accuracy_case(&dict, &conn, hist.as_ref(), case))
+                .collect();
+            let (summary, tested) = summarize_accuracy(&results);
+            let fail = summary.fail;
 
-                results.push(AccuracyResult {
-                    reading: case.reading.clone(),
-                    expected: case.expected.clone(),
-                    actual,
-                    status,
-                    category: case.category.clone(),
-                    baseline: case.baseline.clone(),
-                    baseline_actual,
-                    note: case.note.clone(),
-                    issue: case.issue.clone(),
-                    pr: case.pr.clone(),
+            let delta = compare_conn.map(|cf| {
+                let other = ConnectionMatrix::open(Path::new(&cf)).unwrap_or_else(|e| {
+                    eprintln!("Failed to open connection matrix at {}: {}", cf, e);
+                    process::exit(1);
                 });
-            }
-
-            // Compute summary
-            let total = results.len();
-            let pass = results
-                .iter()
-                .filter(|r| matches!(r.status, AccuracyStatus::Pass))
-                .count();
-            let fail = results
-                .iter()
-                .filter(|r| matches!(r.status, AccuracyStatus::Fail))
-                .count();
-            let skip = results
-                .iter()
-                .filter(|r| matches!(r.status, AccuracyStatus::Skip))
-                .count();
-            let tested = total - skip;
-            let rate = if tested > 0 {
-                pass as f64 / tested as f64 * 100.0
-            } else {
-                0.0
-            };
-            let summary = AccuracySummary {
-                total,
-                pass,
-                fail,
-                skip,
-                pass_rate: format!("{:.1}%", rate),
-            };
+                let compared: Vec<AccuracyResult> = cases
+                    .iter()
+                    .map(|case| run_accuracy_case(&dict, &other, hist.as_ref(), case))
+                    .collect();
+                accuracy_delta(cf, &results, compared)
+            });
 
             if json {
-                let report = AccuracyReport { results, summary };
+                let report = AccuracyReport {
+                    results,
+                    summary,
+                    delta,
+                };
                 println!(
                     "{}",
                     serde_json::to_string_pretty(&report).expect("JSON serialization failed")
@@ -577,6 +670,34 @@ fn main() {
                     "  Pass rate: {} ({}/{})",
                     summary.pass_rate, summary.pass, tested
                 );
+
+                if let Some(d) = &delta {
+                    println!();
+                    println!("=== Delta vs {} ===", d.conn_file);
+                    for c in &d.changes {
+                        let mark = match (c.status, c.compared_status) {
+                            (AccuracyStatus::Pass, AccuracyStatus::Fail) => "-",
+                            (AccuracyStatus::Fail, AccuracyStatus::Pass) => "+",
+                            _ => "~",
+                        };
+                        println!(
+                            "  {} {}: {} \u{2192} {} (expected: {})",
+                            mark, c.reading, c.actual, c.compared, c.expected
+                        );
+                    }
+                    println!(
+                        "  Changed:   {} ({} regressed, {} fixed)",
+                        d.changes.len(),
+                        d.regressed,
+                        d.fixed
+                    );
+                    println!(
+                        "  Pass rate: {} \u{2192} {} ({:+})",
+                        summary.pass_rate,
+                        d.summary.pass_rate,
+                        d.summary.pass as i64 - summary.pass as i64
+                    );
+                }
             }
 
             if fail > 0 {
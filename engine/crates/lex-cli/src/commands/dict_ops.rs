@@ -3,9 +3,10 @@ use std::fs;
 use std::path::{Path, PathBuf};
 use std::process;
 
+use super::dict_stats;
 use crate::dict_source::{self, pos_map};
 use lex_core::dict::connection::ConnectionMatrix;
-use lex_core::dict::{DictEntry, Dictionary, TrieDictionary};
+use lex_core::dict::{DictEntry, Dictionary, Integrity, TrieDictionary};
 
 macro_rules! die {
     ($result:expr, $($arg:tt)*) => {
@@ -179,12 +180,7 @@ pub fn compile(
     );
 }
 
-pub fn compile_conn(input_txt: &str, output_file: &str, id_def: Option<&str>) {
-    let text = die!(
-        fs::read_to_string(input_txt),
-        "Error reading {input_txt}: {}"
-    );
-
+pub fn compile_conn(input_txt: &str, output_file: &str, id_def: Option<&str>, quantize: bool) {
     let (fw_min, fw_max, roles) = if let Some(id_def_path) = id_def {
         let (min, max) = die!(
             pos_map::function_word_id_range(Path::new(id_def_path)),
@@ -208,12 +204,24 @@ pub fn compile_conn(input_txt: &str, output_file: &str, id_def: Option<&str>) {
 
     eprintln!("Parsing connection matrix from {input_txt}...");
     let matrix = die!(
-        ConnectionMatrix::from_text_with_roles(&text, fw_min, fw_max, roles),
+        ConnectionMatrix::from_text_file(Path::new(input_txt), fw_min, fw_max, roles),
         "Error parsing connection matrix: {}"
     );
 
     eprintln!("  Matrix size: {}x{}", matrix.num_ids(), matrix.num_ids());
 
+    let matrix = if quantize {
+        let quantized = matrix.quantize();
+        let (max_err, mean_err) = quantization_error(&matrix, &quantized);
+        eprintln!(
+            "  Quantized to 8 bits: max error {max_err} (bound {}), mean {mean_err:.2}",
+            quantized.max_quantization_error()
+        );
+        quantized
+    } else {
+        matrix
+    };
+
     die!(
         matrix.save(Path::new(output_file)),
         "Error writing {output_file}: {}"
@@ -226,14 +234,33 @@ pub fn compile_conn(input_txt: &str, output_file: &str, id_def: Option<&str>) {
     );
 }
 
-pub fn info(file: &str) {
+/// Largest and mean absolute difference between `full` and `quantized`.
+fn quantization_error(full: &ConnectionMatrix, quantized: &ConnectionMatrix) -> (i32, f64) {
+    let n = full.num_ids();
+    let (mut max, mut sum) = (0, 0u64);
+    for left in 0..n {
+        for right in 0..n {
+            let err =
+                (i32::from(full.cost(left, right)) - i32::from(quantized.cost(left, right))).abs();
+            max = max.max(err);
+            sum += err as u64;
+        }
+    }
+    let cells = (n as u64 * n as u64).max(1);
+    (max, sum as f64 / cells as f64)
+}
+
+/// Number of rows in the `--deep` top-N tables.
+const DEEP_TOP_N: usize = 10;
+
+pub fn info(file: &str, deep: bool, json: bool) {
     let magic = fs::read(file)
         .ok()
         .and_then(|b| b.get(..4).map(|s| s.to_vec()));
 
     match magic.as_deref() {
-        Some(b"LXCX") => info_conn(file),
-        Some(b"LXDX") => info_dict(file),
+        Some(b"LXCX") => info_conn(file, deep, json),
+        Some(b"LXDX") => info_dict(file, deep, json),
         Some(other) => {
             eprintln!(
                 "Unknown file format (magic: {:?})",
@@ -248,7 +275,23 @@ pub fn info(file: &str) {
     }
 }
 
-fn info_dict(dict_file: &str) {
+/// Short label for a checksum verification result.
+fn checksums_label(integrity: &Integrity) -> String {
+    match integrity {
+        Integrity::Intact => "ok".to_string(),
+        Integrity::Unchecked => "none".to_string(),
+        Integrity::Corrupt(sections) => format!("CORRUPT ({})", sections.join(", ")),
+    }
+}
+
+fn print_json(value: &serde_json::Value) {
+    println!(
+        "{}",
+        serde_json::to_string_pretty(value).expect("JSON serialization failed")
+    );
+}
+
+fn info_dict(dict_file: &str, deep: bool, json: bool) {
     let dict = die!(
         TrieDictionary::open(Path::new(dict_file)),
         "Error opening dictionary: {}"
@@ -256,11 +299,32 @@ fn info_dict(dict_file: &str) {
 
     let file_size = fs::metadata(dict_file).map(|m| m.len()).unwrap_or(0);
     let (reading_count, entry_count) = dict.stats();
+    let checksums = checksums_label(&dict.verify());
+    let stats = deep.then(|| dict_stats::dict_stats(&dict, DEEP_TOP_N));
+
+    if json {
+        print_json(&serde_json::json!({
+            "kind": "dictionary",
+            "file": dict_file,
+            "file_bytes": file_size,
+            "readings": reading_count,
+            "entries": entry_count,
+            "checksums": checksums,
+            "deep": stats,
+        }));
+        return;
+    }
 
     println!("Dictionary: {dict_file}");
     println!("File size:  {:.1} MB", file_size as f64 / 1_048_576.0);
     println!("Readings:   {reading_count}");
     println!("Entries:    {entry_count}");
+    println!("Checksums:  {checksums}");
+
+    if let Some(stats) = &stats {
+        dict_stats::print_dict_stats(stats);
+        return;
+    }
 
     let sample_keys = ["かんじ", "にほん", "とうきょう", "たべる"];
     println!();
@@ -276,7 +340,7 @@ fn info_dict(dict_file: &str) {
     }
 }
 
-fn info_conn(conn_file: &str) {
+fn info_conn(conn_file: &str, deep: bool, json: bool) {
     let conn = die!(
         ConnectionMatrix::open(Path::new(conn_file)),
         "Error opening connection matrix: {}"
@@ -284,6 +348,39 @@ fn info_conn(conn_file: &str) {
 
     let file_size = fs::metadata(conn_file).map(|m| m.len()).unwrap_or(0);
     let num_ids = conn.num_ids();
+    let fw_min = conn.fw_min();
+    let fw_max = conn.fw_max();
+
+    let mut role_counts = [0u32; 4];
+    for id in 0..num_ids {
+        let r = conn.role(id) as usize;
+        if r < role_counts.len() {
+            role_counts[r] += 1;
+        }
+    }
+    let checksums = checksums_label(&conn.verify());
+    let stats = deep.then(|| dict_stats::conn_stats(&conn));
+
+    if json {
+        print_json(&serde_json::json!({
+            "kind": "connection_matrix",
+            "file": conn_file,
+            "file_bytes": file_size,
+            "num_ids": num_ids,
+            "fw_range": (fw_min != 0).then_some([fw_min, fw_max]),
+            "roles": {
+                "content_word": role_counts[0],
+                "function_word": role_counts[1],
+                "suffix": role_counts[2],
+                "prefix": role_counts[3],
+            },
+            "checksums": checksums,
+            "quantized": conn.is_quantized(),
+            "max_quantization_error": conn.max_quantization_error(),
+            "deep": stats,
+        }));
+        return;
+    }
 
     println!("Connection matrix: {conn_file}");
     println!("File size:  {:.1} MB", file_size as f64 / 1_048_576.0);
@@ -292,9 +389,15 @@ fn info_conn(conn_file: &str) {
         "Matrix:     {num_ids}x{num_ids} = {} entries",
         num_ids as u64 * num_ids as u64
     );
+    if conn.is_quantized() {
+        println!(
+            "Encoding:   8-bit (max error {})",
+            conn.max_quantization_error()
+        );
+    } else {
+        println!("Encoding:   i16");
+    }
 
-    let fw_min = conn.fw_min();
-    let fw_max = conn.fw_max();
     if fw_min != 0 {
         let fw_count = fw_max - fw_min + 1;
         println!("FW range:   {fw_min}..={fw_max} ({fw_count} IDs)");
@@ -302,17 +405,15 @@ fn info_conn(conn_file: &str) {
         println!("FW range:   (none)");
     }
 
-    let mut role_counts = [0u32; 4];
-    for id in 0..num_ids {
-        let r = conn.role(id) as usize;
-        if r < role_counts.len() {
-            role_counts[r] += 1;
-        }
-    }
     println!(
         "Roles:      CW={}, FW={}, Suffix={}, Prefix={}",
         role_counts[0], role_counts[1], role_counts[2], role_counts[3]
     );
+    println!("Checksums:  {checksums}");
+
+    if let Some(stats) = &stats {
+        dict_stats::print_conn_stats(stats);
+    }
 }
 
 pub struct MergeOptions {
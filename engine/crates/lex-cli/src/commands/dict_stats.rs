@@ -0,0 +1,545 @@
+//! Deep layout statistics for `dictool info --deep`.
+//!
+//! Everything here is computed from the public dictionary / matrix API plus
+//! `TrieDictionary::layout`, so the numbers describe the file as the engine
+//! sees it. Trie shape is measured on the logical byte trie (one node per
+//! distinct key prefix); the double-array slot layout itself is opaque.
+
+use std::collections::HashMap;
+
+use serde::Serialize;
+
+use lex_core::dict::connection::ConnectionMatrix;
+use lex_core::dict::{DictLayout, TrieDictionary};
+
+#[derive(Debug, Serialize)]
+pub struct DictStats {
+    pub sections: SectionBytes,
+    pub trie: TrieShape,
+    pub pool: PoolStats,
+    pub entries_per_reading: Vec<Bucket>,
+    /// Readings with the most entries (costliest exact lookups).
+    pub top_readings: Vec<Ranked>,
+    /// Left POS IDs carried by the most entries.
+    pub top_pos_ids: Vec<Ranked>,
+    /// Longest chains of readings where each is a prefix of the next; a
+    /// common-prefix search through the last one visits every link.
+    pub prefix_chains: Vec<Vec<String>>,
+}
+
+#[derive(Debug, Serialize)]
+pub struct SectionBytes {
+    pub trie: usize,
+    pub string_pool: usize,
+    pub entries: usize,
+    pub reading_index: usize,
+}
+
+#[derive(Debug, Serialize)]
+pub struct TrieShape {
+    pub nodes: usize,
+    pub leaves: usize,
+    pub branching: usize,
+    pub max_depth: usize,
+    /// Mean child count over non-leaf nodes.
+    pub mean_fanout: f64,
+    /// Trie section bytes per logical node.
+    pub bytes_per_node: f64,
+}
+
+#[derive(Debug, Serialize)]
+pub struct PoolStats {
+    pub bytes: usize,
+    /// Bytes the pool would need without deduplication.
+    pub referenced_bytes: usize,
+    pub references: usize,
+    pub distinct_strings: usize,
+    /// Fraction of references that reuse an existing pool string.
+    pub duplication_ratio: f64,
+}
+
+#[derive(Debug, Serialize, PartialEq)]
+pub struct Bucket {
+    pub label: String,
+    pub count: usize,
+}
+
+#[derive(Debug, Serialize, PartialEq)]
+pub struct Ranked {
+    pub key: String,
+    pub count: usize,
+}
+
+#[derive(Debug, Serialize)]
+pub struct ConnStats {
+    pub cells: u64,
+    pub distinct_values: usize,
+    pub min: i16,
+    pub max: i16,
+    pub mean: f64,
+    pub zero_cells: u64,
+    /// Left IDs whose whole row is zero.
+    pub all_zero_rows: usize,
+    pub histogram: Vec<Bucket>,
+}
+
+/// Upper bounds (inclusive) of the entries-per-reading histogram buckets.
+const ENTRY_BUCKETS: [usize; 7] = [1, 2, 4, 8, 16, 32, 64];
+
+/// Bucket edges for connection costs: `[lo, hi)` between neighbours, with
+/// zero in a bucket of its own.
+const COST_EDGES: [i32; 12] = [
+    i16::MIN as i32,
+    -10000,
+    -5000,
+    -2000,
+    -1000,
+    0,
+    1,
+    1000,
+    2000,
+    5000,
+    10000,
+    i16::MAX as i32 + 1,
+];
+
+pub fn dict_stats(dict: &TrieDictionary, top: usize) -> DictStats {
+    let layout = dict.layout();
+    let mut readings: Vec<(String, usize)> = Vec::new();
+    let mut pos_counts: HashMap<u16, usize> = HashMap::new();
+    for (reading, entries) in dict.iter() {
+        for e in &entries {
+            *pos_counts.entry(e.left_id).or_default() += 1;
+        }
+        readings.push((reading, entries.len()));
+    }
+    readings.sort_by(|a, b| a.0.as_bytes().cmp(b.0.as_bytes()));
+
+    let mut top_readings: Vec<Ranked> = readings
+        .iter()
+        .map(|(r, n)| Ranked {
+            key: r.clone(),
+            count: *n,
+        })
+        .collect();
+    rank(&mut top_readings, top);
+    let mut top_pos_ids: Vec<Ranked> = pos_counts
+        .into_iter()
+        .map(|(id, n)| Ranked {
+            key: id.to_string(),
+            count: n,
+        })
+        .collect();
+    rank(&mut top_pos_ids, top);
+
+    let keys: Vec<&str> = readings.iter().map(|(r, _)| r.as_str()).collect();
+    DictStats {
+        sections: SectionBytes {
+            trie: layout.trie_bytes,
+            string_pool: layout.pool_bytes,
+            entries: layout.entries_bytes,
+            reading_index: layout.index_bytes,
+        },
+        trie: trie_shape(&keys, layout.trie_bytes),
+        pool: pool_stats(&layout, dict.stats().1),
+        entries_per_reading: entry_histogram(readings.iter().map(|(_, n)| *n)),
+        top_readings,
+        top_pos_ids,
+        prefix_chains: prefix_chains(&keys, top),
+    }
+}
+
+/// Sort by count descending (ties by key) and keep the first `top`.
+fn rank(items: &mut Vec<Ranked>, top: usize) {
+    items.sort_by(|a, b| b.count.cmp(&a.count).then_with(|| a.key.cmp(&b.key)));
+    items.truncate(top);
+}
+
+/// Shape of the byte trie over `keys`, which must be sorted and unique.
+///
+/// Walks the keys once with a stack of per-depth child counts: a key whose
+/// longest common prefix with its predecessor is `l` adds one child at depth
+/// `l` and opens fresh nodes below it; nodes deeper than `l` are complete.
+fn trie_shape(keys: &[&str], trie_bytes: usize) -> TrieShape {
+    let mut shape = TrieShape {
+        nodes: 0,
+        leaves: 0,
+        branching: 0,
+        max_depth: 0,
+        mean_fanout: 0.0,
+        bytes_per_node: 0.0,
+    };
+    let mut children_total = 0usize;
+    let mut finish = |children: usize| {
+        shape.nodes += 1;
+        children_total += children;
+        match children {
+            0 => shape.leaves += 1,
+            1 => {}
+            _ => shape.branching += 1,
+        }
+    };
+
+    let mut stack: Vec<usize> = vec![0]; // root
+    let mut prev: &[u8] = &[];
+    let mut max_depth = 0;
+    for key in keys.iter().map(|k| k.as_bytes()) {
+        let l = prev.iter().zip(key).take_while(|(a, b)| a == b).count();
+        while stack.len() > l + 1 {
+            finish(stack.pop().unwrap());
+        }
+        if key.len() > l {
+            *stack.last_mut().unwrap() += 1;
+            stack.extend(std::iter::repeat_n(1, key.len() - l - 1));
+            stack.push(0);
+        }
+        max_depth = max_depth.max(key.len());
+        prev = key;
+    }
+    while let Some(children) = stack.pop() {
+        finish(children);
+    }
+
+    let internal = shape.nodes - shape.leaves;
+    shape.max_depth = max_depth;
+    shape.mean_fanout = ratio(children_total, internal);
+    shape.bytes_per_node = ratio(trie_bytes, shape.nodes);
+    shape
+}
+
+fn pool_stats(layout: &DictLayout, references: usize) -> PoolStats {
+    PoolStats {
+        bytes: layout.pool_bytes,
+        referenced_bytes: layout.surface_bytes,
+        references,
+        distinct_strings: layout.distinct_surfaces,
+        duplication_ratio: ratio(
+            references.saturating_sub(layout.distinct_surfaces),
+            references,
+        ),
+    }
+}
+
+fn entry_histogram(counts: impl Iterator<Item = usize>) -> Vec<Bucket> {
+    let mut hist = [0usize; ENTRY_BUCKETS.len() + 1];
+    for n in counts {
+        let i = ENTRY_BUCKETS.partition_point(|&hi| hi < n);
+        hist[i] += 1;
+    }
+    let mut lo = 1;
+    let mut buckets = Vec::with_capacity(hist.len());
+    for (i, count) in hist.into_iter().enumerate() {
+        let label = match ENTRY_BUCKETS.get(i) {
+            Some(&hi) if hi == lo => format!("{hi}"),
+            Some(&hi) => format!("{lo}-{hi}"),
+            None => format!("{lo}+"),
+        };
+        if let Some(&hi) = ENTRY_BUCKETS.get(i) {
+            lo = hi + 1;
+        }
+        buckets.push(Bucket { label, count });
+    }
+    buckets
+}
+
+/// The `top` longest maximal prefix chains over sorted `keys`.
+///
+/// In sorted order every prefix of a key precedes it, so a stack holding the
+/// current chain only ever needs popping until its top is a prefix again. A
+/// chain is reported only at a key that does not prefix the next one, so the
+/// sub-chains of a longer chain are not counted separately.
+fn prefix_chains(keys: &[&str], top: usize) -> Vec<Vec<String>> {
+    let mut stack: Vec<usize> = Vec::new();
+    let mut parent: Vec<Option<usize>> = Vec::with_capacity(keys.len());
+    // (chain length, index of the chain's last key)
+    let mut ends: Vec<(usize, usize)> = Vec::new();
+    for (i, key) in keys.iter().enumerate() {
+        while stack.last().is_some_and(|&p| !key.starts_with(keys[p])) {
+            stack.pop();
+        }
+        parent.push(stack.last().copied());
+        stack.push(i);
+        let extended = keys.get(i + 1).is_some_and(|next| next.starts_with(key));
+        if stack.len() > 1 && !extended {
+            ends.push((stack.len(), i));
+        }
+    }
+    ends.sort_by(|a, b| b.0.cmp(&a.0).then(a.1.cmp(&b.1)));
+    ends.truncate(top);
+    ends.into_iter()
+        .map(|(_, mut i)| {
+            let mut chain = vec![keys[i].to_string()];
+            while let Some(p) = parent[i] {
+                chain.push(keys[p].to_string());
+                i = p;
+            }
+            chain.reverse();
+            chain
+        })
+        .collect()
+}
+
+pub fn conn_stats(conn: &ConnectionMatrix) -> ConnStats {
+    let n = conn.num_ids();
+    let mut seen = vec![false; 1 << 16];
+    let mut hist = [0u64; COST_EDGES.len() - 1];
+    let mut stats = ConnStats {
+        cells: u64::from(n) * u64::from(n),
+        distinct_values: 0,
+        min: if n == 0 { 0 } else { i16::MAX },
+        max: if n == 0 { 0 } else { i16::MIN },
+        mean: 0.0,
+        zero_cells: 0,
+        all_zero_rows: 0,
+        histogram: Vec::new(),
+    };
+    let mut sum = 0i64;
+    for left in 0..n {
+        let mut row_zero = true;
+        for right in 0..n {
+            let c = conn.cost(left, right);
+            sum += i64::from(c);
+            stats.min = stats.min.min(c);
+            stats.max = stats.max.max(c);
+            seen[c as u16 as usize] = true;
+            if c == 0 {
+                stats.zero_cells += 1;
+            } else {
+                row_zero = false;
+            }
+            let i = COST_EDGES.partition_point(|&edge| edge <= i32::from(c)) - 1;
+            hist[i] += 1;
+        }
+        if row_zero {
+            stats.all_zero_rows += 1;
+        }
+    }
+    stats.distinct_values = seen.iter().filter(|&&s| s).count();
+    stats.mean = if stats.cells == 0 {
+        0.0
+    } else {
+        sum as f64 / stats.cells as f64
+    };
+    stats.histogram = COST_EDGES
+        .windows(2)
+        .zip(hist)
+        .map(|(edge, count)| Bucket {
+            label: match (edge[0], edge[1]) {
+                (0, 1) => "0".to_string(),
+                (lo, hi) => format!("[{lo}, {hi})"),
+            },
+            count: count as usize,
+        })
+        .collect();
+    stats
+}
+
+fn ratio(num: usize, den: usize) -> f64 {
+    if den == 0 {
+        0.0
+    } else {
+        num as f64 / den as f64
+    }
+}
+
+pub fn print_dict_stats(stats: &DictStats) {
+    let s = &stats.sections;
+    println!();
+    println!("Sections:");
+    println!("  trie          {:>12} B", s.trie);
+    println!("  string pool   {:>12} B", s.string_pool);
+    println!("  entries       {:>12} B", s.entries);
+    println!("  reading index {:>12} B", s.reading_index);
+
+    let t = &stats.trie;
+    println!();
+    println!("Trie (logical byte trie):");
+    println!(
+        "  nodes {} (leaves {}, branching {}), max depth {} B",
+        t.nodes, t.leaves, t.branching, t.max_depth
+    );
+    println!(
+        "  mean fan-out {:.2}, {:.2} B/node",
+        t.mean_fanout, t.bytes_per_node
+    );
+
+    let p = &stats.pool;
+    println!();
+    println!("String pool:");
+    println!(
+        "  {} B stored, {} B referenced by {} entries",
+        p.bytes, p.referenced_bytes, p.references
+    );
+    println!(
+        "  {} distinct strings, duplication ratio {:.1}%",
+        p.distinct_strings,
+        p.duplication_ratio * 100.0
+    );
+
+    println!();
+    println!("Entries per reading:");
+    print_buckets(&stats.entries_per_reading);
+
+    println!();
+    println!("Top readings by entry count:");
+    for r in &stats.top_readings {
+        println!("  {:>6}  {}", r.count, r.key);
+    }
+
+    println!();
+    println!("Top left POS IDs by entry count:");
+    for r in &stats.top_pos_ids {
+        println!("  {:>8}  {}", r.count, r.key);
+    }
+
+    println!();
+    println!("Longest prefix chains:");
+    for chain in &stats.prefix_chains {
+        println!("  {:>2}  {}", chain.len(), chain.join(" ⊂ "));
+    }
+}
+
+pub fn print_conn_stats(stats: &ConnStats) {
+    println!();
+    println!("Values:");
+    println!(
+        "  min {}, max {}, mean {:.1}, {} distinct",
+        stats.min, stats.max, stats.mean, stats.distinct_values
+    );
+    println!(
+        "  zero cells {} of {} ({:.1}%), all-zero rows {}",
+        stats.zero_cells,
+        stats.cells,
+        if stats.cells == 0 {
+            0.0
+        } else {
+            stats.zero_cells as f64 / stats.cells as f64 * 100.0
+        },
+        stats.all_zero_rows
+    );
+    println!();
+    println!("Value distribution:");
+    print_buckets(&stats.histogram);
+}
+
+fn print_buckets(buckets: &[Bucket]) {
+    let total: usize = buckets.iter().map(|b| b.count).sum();
+    for b in buckets {
+        let pct = ratio(b.count, total) * 100.0;
+        println!("  {:>16}  {:>10}  {:5.1}%", b.label, b.count, pct);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use lex_core::dict::DictEntry;
+
+    fn entry(surface: &str, left_id: u16) -> DictEntry {
+        DictEntry {
+            surface: surface.to_string(),
+            cost: 3000,
+            left_id,
+            right_id: left_id,
+        }
+    }
+
+    fn fixture() -> TrieDictionary {
+        TrieDictionary::from_entries(vec![
+            ("か".to_string(), vec![entry("蚊", 1), entry("可", 2)]),
+            ("かん".to_string(), vec![entry("缶", 1)]),
+            (
+                "かんじ".to_string(),
+                vec![entry("漢字", 1), entry("感じ", 3), entry("幹事", 1)],
+            ),
+            ("かんじる".to_string(), vec![entry("感じる", 3)]),
+            ("き".to_string(), vec![entry("木", 1), entry("感じ", 3)]),
+        ])
+    }
+
+    #[test]
+    fn trie_shape_counts_prefix_nodes() {
+        // "ab", "abc", "b": root → a → b → c, root → b.
+        let shape = trie_shape(&["ab", "abc", "b"], 50);
+        assert_eq!(shape.nodes, 5);
+        assert_eq!(shape.leaves, 2);
+        assert_eq!(shape.branching, 1);
+        assert_eq!(shape.max_depth, 3);
+        assert!((shape.mean_fanout - 4.0 / 3.0).abs() < 1e-9);
+        assert!((shape.bytes_per_node - 10.0).abs() < 1e-9);
+    }
+
+    #[test]
+    fn dict_stats_on_fixture() {
+        let stats = dict_stats(&fixture(), 3);
+        assert_eq!(stats.pool.references, 9);
+        assert_eq!(stats.pool.distinct_strings, 8);
+        assert!((stats.pool.duplication_ratio - 1.0 / 9.0).abs() < 1e-9);
+
+        let hist: Vec<(&str, usize)> = stats
+            .entries_per_reading
+            .iter()
+            .map(|b| (b.label.as_str(), b.count))
+            .collect();
+        assert_eq!(&hist[..3], &[("1", 2), ("2", 2), ("3-4", 1)]);
+        assert_eq!(hist.last(), Some(&("65+", 0)));
+
+        assert_eq!(
+            stats.top_readings[0],
+            Ranked {
+                key: "かんじ".to_string(),
+                count: 3
+            }
+        );
+        assert_eq!(
+            stats.top_pos_ids[0],
+            Ranked {
+                key: "1".to_string(),
+                count: 5
+            }
+        );
+        assert_eq!(
+            stats.prefix_chains[0],
+            vec!["か", "かん", "かんじ", "かんじる"]
+        );
+        assert!(stats.trie.nodes > stats.trie.leaves);
+    }
+
+    #[test]
+    fn prefix_chains_reports_maximal_chains_only() {
+        let keys = ["か", "かん", "かんじ", "かんじる", "かんと", "き", "きょう"];
+        assert_eq!(
+            prefix_chains(&keys, 10),
+            vec![
+                vec!["か", "かん", "かんじ", "かんじる"],
+                vec!["か", "かん", "かんと"],
+                vec!["き", "きょう"],
+            ]
+        );
+        assert_eq!(prefix_chains(&keys, 1).len(), 1);
+    }
+
+    #[test]
+    fn conn_stats_counts_zero_rows_and_buckets() {
+        let conn = ConnectionMatrix::from_text("3\n0\n0\n0\n5\n-1500\n0\n0\n20000\n5\n").unwrap();
+        let stats = conn_stats(&conn);
+        assert_eq!(stats.cells, 9);
+        assert_eq!(stats.zero_cells, 5);
+        assert_eq!(stats.all_zero_rows, 1);
+        assert_eq!((stats.min, stats.max), (-1500, 20000));
+        assert_eq!(stats.distinct_values, 4);
+        let count = |label: &str| {
+            stats
+                .histogram
+                .iter()
+                .find(|b| b.label == label)
+                .unwrap()
+                .count
+        };
+        assert_eq!(count("0"), 5);
+        assert_eq!(count("[1, 1000)"), 2);
+        assert_eq!(count("[-2000, -1000)"), 1);
+        assert_eq!(count("[10000, 32768)"), 1);
+        assert_eq!(stats.histogram.iter().map(|b| b.count).sum::<usize>(), 9);
+    }
+}
@@ -2,6 +2,7 @@ pub mod candidates_ops;
 pub mod config_ops;
 pub mod convert_ops;
 pub mod dict_ops;
+pub mod dict_stats;
 #[cfg(feature = "neural")]
 pub mod neural_ops;
 pub mod user_dict_ops;
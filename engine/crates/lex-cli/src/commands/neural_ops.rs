@@ -5,7 +5,7 @@ use std::time::Instant;
 use lex_core::converter::{convert, convert_nbest, convert_nbest_with_history};
 use lex_core::dict::connection::ConnectionMatrix;
 use lex_core::dict::TrieDictionary;
-use lex_core::neural::NeuralScorer;
+use lex_core::neural::{NeuralScorer, PruneConfig};
 use lex_core::user_history::UserHistory;
 
 macro_rules! die {
@@ -206,15 +206,21 @@ pub fn speculative_decode_cmd(
 
         let nbest = convert_nbest(&dict, Some(&conn), kana, 10);
         let neural_start = Instant::now();
+        let prune = PruneConfig {
+            top_k: Some(1),
+            ..PruneConfig::default()
+        };
         let scores = die!(
-            scorer.score_paths(context, kana, &nbest),
+            scorer.score_paths_pruned(context, kana, &nbest, &prune),
             "Error scoring paths: {}"
         );
         let neural_elapsed = neural_start.elapsed();
 
-        if let Some(&(best_idx, _)) = scores.first() {
-            let rerank_surface: String =
-                nbest[best_idx].iter().map(|s| s.surface.as_str()).collect();
+        if let Some(best) = scores.scores.first() {
+            let rerank_surface: String = nbest[best.index]
+                .iter()
+                .map(|s| s.surface.as_str())
+                .collect();
             println!(
                 "N-best rerank:   {rerank_surface}  ({:.0}ms neural)",
                 neural_elapsed.as_millis()
@@ -1,7 +1,7 @@
 use std::path::Path;
 use std::process;
 
-use lex_core::user_dict::UserDictionary;
+use lex_core::user_dict::{base_path, ImportDefaults, UserDictionary};
 
 macro_rules! die {
     ($result:expr, $($arg:tt)*) => {
@@ -43,6 +43,33 @@ pub fn user_dict_remove(path: &Path, reading: &str, surface: &str) {
     }
 }
 
+pub fn user_dict_import(path: &Path, tsv: &Path, cost: Option<i16>, pos_id: Option<u16>) {
+    let text = die!(
+        std::fs::read_to_string(tsv),
+        "Error reading {}: {}",
+        tsv.display()
+    );
+    let dict = die!(
+        UserDictionary::open(path),
+        "Error opening user dictionary: {}"
+    );
+    let base = ImportDefaults::default();
+    let defaults = ImportDefaults {
+        cost: cost.unwrap_or(base.cost),
+        pos_id: pos_id.unwrap_or(base.pos_id),
+    };
+    let imported = die!(
+        dict.import_tsv(&text, defaults),
+        "Error importing {}: {}",
+        tsv.display()
+    );
+    die!(dict.save(path), "Error saving user dictionary: {}");
+    println!(
+        "Imported {imported} new words into {}",
+        base_path(path).display()
+    );
+}
+
 pub fn user_dict_list(path: &Path) {
     let dict = die!(
         UserDictionary::open(path),
@@ -0,0 +1,168 @@
+use std::collections::BTreeMap;
+use std::fmt::Write;
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use lex_core::converter::{build_lattice, ConversionContext};
+use lex_core::dict::connection::ConnectionMatrix;
+use lex_core::dict::{DictEntry, TrieDictionary};
+use lex_core::settings::{self, DEFAULT_SETTINGS_TOML};
+
+mod common;
+use common::next;
+
+const NUM_IDS: u16 = 400;
+
+/// Kana of the adversarial readings; every string of up to
+/// `WORD_CHARS` of them is a word.
+const KANA: &[char] = &['あ', 'い', 'か'];
+const WORD_CHARS: usize = 8;
+
+/// Surfaces per word: homophones enough that every position holds more
+/// nodes than the default cap.
+const SURFACES: usize = 80;
+
+/// Candidates requested per conversion, as the candidate window does.
+const NBEST: usize = 20;
+
+fn bench_conn() -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let mut state = 0x9e37_79b9_7f4a_7c15u64;
+    let mut text = format!("{n} {n}\n");
+    for _ in 0..n * n {
+        let r = next(&mut state);
+        let cost = if r % 64 == 0 { 30000 } else { (r >> 32) % 6000 };
+        writeln!(text, "{cost}").unwrap();
+    }
+    ConnectionMatrix::from_text(&text).unwrap()
+}
+
+/// Every string of one to `WORD_CHARS` of `KANA` as a word, so every
+/// prefix at every position of a reading over `KANA` matches.
+fn bench_dict() -> TrieDictionary {
+    let mut state = 0x2545_f491_4f6c_dd1du64;
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    let mut layer = vec![String::new()];
+    for len in 1..=WORD_CHARS {
+        layer = layer
+            .iter()
+            .flat_map(|s| KANA.iter().map(move |&c| format!("{s}{c}")))
+            .collect();
+        for reading in &layer {
+            let list = (0..SURFACES)
+                .map(|i| {
+                    let id = (next(&mut state) % NUM_IDS as u64) as u16;
+                    DictEntry {
+                        surface: format!("{reading}{i}"),
+                        cost: 3000 + (len as i16) * 100 + (next(&mut state) % 2000) as i16,
+                        left_id: id,
+                        right_id: id,
+                    }
+                })
+                .collect();
+            entries.insert(reading.clone(), list);
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+/// Adversarial readings: long runs of one kana, short repeating patterns
+/// and random strings over `KANA`, from 8 to 120 characters.
+fn adversarial_readings() -> Vec<String> {
+    let mut state = 0x5851_f42d_4c95_7f2du64;
+    let mut readings = Vec::new();
+    for len in (8..=120).step_by(8) {
+        let ch = KANA[(next(&mut state) % KANA.len() as u64) as usize];
+        readings.push(std::iter::repeat_n(ch, len).collect());
+        let pattern: Vec<char> = (0..2 + next(&mut state) % 3)
+            .map(|_| KANA[(next(&mut state) % KANA.len() as u64) as usize])
+            .collect();
+        readings.push(pattern.iter().cycle().take(len).collect());
+        readings.push(
+            (0..len)
+                .map(|_| KANA[(next(&mut state) % KANA.len() as u64) as usize])
+                .collect(),
+        );
+    }
+    readings
+}
+
+/// Settings with the latency guards effectively off.
+fn unguarded_toml() -> String {
+    DEFAULT_SETTINGS_TOML
+        .replace(
+            "max_nodes_per_position = 512",
+            "max_nodes_per_position = 1000000000",
+        )
+        .replace(
+            "viterbi_work_budget = 256000000",
+            "viterbi_work_budget = 1000000000000",
+        )
+}
+
+fn convert(ctx: &ConversionContext<'_>, reading: &str) -> usize {
+    let lattice = build_lattice(ctx.dict, reading);
+    ctx.convert_nbest_from_lattice(&lattice, NBEST).len()
+}
+
+/// Latency of every reading, sorted.
+fn latencies(ctx: &ConversionContext<'_>, readings: &[String]) -> Vec<Duration> {
+    let mut times: Vec<Duration> = readings
+        .iter()
+        .map(|reading| {
+            let start = Instant::now();
+            let candidates = convert(ctx, reading);
+            let elapsed = start.elapsed();
+            assert!(candidates > 0, "no conversion for {reading}");
+            elapsed
+        })
+        .collect();
+    times.sort();
+    times
+}
+
+fn bench_adversarial(c: &mut Criterion) {
+    let dict = bench_dict();
+    let conn = bench_conn();
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: Some(&conn),
+        history: None,
+    };
+    let readings = adversarial_readings();
+
+    // Tail latency is what the guards are for; criterion reports means, so
+    // print p99 and max from a few rounds over every reading first.
+    for (label, toml) in [
+        ("unguarded", unguarded_toml()),
+        ("guarded", DEFAULT_SETTINGS_TOML.to_string()),
+    ] {
+        settings::reload(&toml).unwrap();
+        let mut times: Vec<Duration> = (0..5).flat_map(|_| latencies(&ctx, &readings)).collect();
+        times.sort();
+        let p99 = times[(times.len() * 99).div_ceil(100) - 1];
+        let max = times[times.len() - 1];
+        println!("adversarial/{label}: p99 {p99:?}, max {max:?}");
+    }
+
+    let mut group = c.benchmark_group("adversarial");
+    group.sample_size(10);
+    for (label, toml) in [
+        ("unguarded", unguarded_toml()),
+        ("guarded", DEFAULT_SETTINGS_TOML.to_string()),
+    ] {
+        settings::reload(&toml).unwrap();
+        group.bench_function(label, |b| {
+            b.iter(|| {
+                for reading in &readings {
+                    black_box(convert(&ctx, reading));
+                }
+            })
+        });
+    }
+    group.finish();
+    settings::reload(DEFAULT_SETTINGS_TOML).unwrap();
+}
+
+criterion_group!(benches, bench_adversarial);
+criterion_main!(benches);
@@ -0,0 +1,10 @@
+//! Helpers shared by the benchmarks that build synthetic inputs.
+
+/// xorshift64, for reproducible dictionaries, matrices and inputs without
+/// pulling in a rand dependency.
+pub fn next(state: &mut u64) -> u64 {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    *state
+}
@@ -0,0 +1,99 @@
+use std::collections::BTreeMap;
+use std::fmt::Write;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use lex_core::converter::convert_nbest;
+use lex_core::dict::connection::ConnectionMatrix;
+use lex_core::dict::{DictEntry, TrieDictionary};
+
+mod common;
+use common::next;
+
+/// About the size of the Mozc ID space, so the full grid (12 MB) is well
+/// past L2 and the quantized one half that.
+const NUM_IDS: u16 = 2500;
+
+const PHRASE: &str = "わたしはきょうがっこうでにほんごをべんきょうしました";
+
+/// Mozc-like costs: mostly a few thousand, with a sprinkling of very large
+/// "forbidden" transitions that widen each row's range.
+fn bench_conn() -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let mut state = 0x9e37_79b9_7f4a_7c15u64;
+    let mut text = format!("{n} {n}\n");
+    for _ in 0..n * n {
+        let r = next(&mut state);
+        let cost = if r % 64 == 0 { 30000 } else { (r >> 32) % 6000 };
+        writeln!(text, "{cost}").unwrap();
+    }
+    ConnectionMatrix::from_text(&text).unwrap()
+}
+
+/// Three surfaces for every one- to four-character substring of `PHRASE`,
+/// each on a pseudo-random POS ID so transitions hit scattered rows.
+fn bench_dict() -> TrieDictionary {
+    let chars: Vec<char> = PHRASE.chars().collect();
+    let mut state = 0x2545_f491_4f6c_dd1du64;
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for start in 0..chars.len() {
+        for len in 1..=4.min(chars.len() - start) {
+            let reading: String = chars[start..start + len].iter().collect();
+            let list = entries.entry(reading.clone()).or_default();
+            if !list.is_empty() {
+                continue;
+            }
+            for i in 0..3u16 {
+                let id = (next(&mut state) % NUM_IDS as u64) as u16;
+                list.push(DictEntry {
+                    surface: format!("{reading}{i}"),
+                    cost: 3000 + (len as i16) * 200 + (i as i16) * 150,
+                    left_id: id,
+                    right_id: id,
+                });
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+fn bench_connection(c: &mut Criterion) {
+    let full = bench_conn();
+    let quantized = full.quantize();
+    let dict = bench_dict();
+    let reading: String = PHRASE.chars().cycle().take(40).collect();
+
+    let mut group = c.benchmark_group("conn_viterbi_40");
+    for (name, conn) in [("full", &full), ("quantized", &quantized)] {
+        group.bench_function(name, |b| {
+            b.iter(|| convert_nbest(&dict, Some(conn), black_box(&reading), 10));
+        });
+    }
+    group.finish();
+
+    // Raw lookups over scattered cells: isolates the cache effect.
+    let mut state = 0x1234_5678_9abc_def1u64;
+    let pairs: Vec<(u16, u16)> = (0..4096)
+        .map(|_| {
+            let r = next(&mut state);
+            (
+                (r % NUM_IDS as u64) as u16,
+                ((r >> 32) % NUM_IDS as u64) as u16,
+            )
+        })
+        .collect();
+    let mut group = c.benchmark_group("conn_lookup_4096");
+    for (name, conn) in [("full", &full), ("quantized", &quantized)] {
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                pairs
+                    .iter()
+                    .map(|&(l, r)| i64::from(conn.cost(l, r)))
+                    .sum::<i64>()
+            });
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_connection);
+criterion_main!(benches);
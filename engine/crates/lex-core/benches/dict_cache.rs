@@ -0,0 +1,151 @@
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::collections::BTreeMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use lex_core::converter::build_lattice;
+use lex_core::dict::{CompositeDictionary, DictEntry, Dictionary, EntryCache, TrieDictionary};
+
+mod common;
+use common::next;
+
+/// Counts heap allocations so the replay can report them next to timings.
+struct CountingAlloc;
+
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        System.alloc(layout)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+const SENTENCES: &[&str] = &[
+    "わたしはきょうがっこうでにほんごをべんきょうしました",
+    "あしたはあめがふるかもしれないのでかさをもっていきます",
+    "このほんはとてもおもしろいのでともだちにもすすめたい",
+    "えきのまえにあたらしいきっさてんができたそうです",
+    "しゅうまつはかぞくといっしょにやまへいくよていです",
+    "かいぎのしりょうはきのうのうちにおくっておきました",
+];
+
+const KANA: &[char] = &[
+    'あ', 'い', 'う', 'か', 'き', 'く', 'さ', 'し', 'す', 'た', 'ち', 'つ', 'な', 'に', 'の', 'は',
+    'ま', 'も', 'よ', 'ら', 'り', 'る', 'を', 'ん',
+];
+
+/// Four surfaces for every one- to six-character substring of the
+/// sentences, plus a few longer readings under each so prediction has
+/// something to scan.
+fn bench_dict() -> TrieDictionary {
+    let mut state = 0x9e37_79b9_7f4a_7c15u64;
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    let mut add = |reading: String, state: &mut u64| {
+        let list = entries.entry(reading.clone()).or_default();
+        if !list.is_empty() {
+            return;
+        }
+        for i in 0..4u16 {
+            let id = (next(state) % 2500) as u16;
+            list.push(DictEntry {
+                surface: format!("{reading}{i}"),
+                cost: 3000 + (next(state) % 4000) as i16,
+                left_id: id,
+                right_id: id,
+            });
+        }
+    };
+    for sentence in SENTENCES {
+        let chars: Vec<char> = sentence.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=6.min(chars.len() - start) {
+                let reading: String = chars[start..start + len].iter().collect();
+                for _ in 0..3 {
+                    let tail: String = (0..1 + next(&mut state) % 3)
+                        .map(|_| KANA[(next(&mut state) % KANA.len() as u64) as usize])
+                        .collect();
+                    add(format!("{reading}{tail}"), &mut state);
+                }
+                add(reading, &mut state);
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+/// Every prefix of every sentence, as a session sees them while typing.
+fn keystrokes() -> Vec<String> {
+    SENTENCES
+        .iter()
+        .flat_map(|s| {
+            let chars: Vec<char> = s.chars().collect();
+            (1..=chars.len()).map(move |n| chars[..n].iter().collect())
+        })
+        .collect()
+}
+
+/// Per keystroke: rebuild the lattice and fetch predictions.
+fn replay(dict: &dyn Dictionary, stream: &[String]) {
+    for reading in stream {
+        black_box(build_lattice(dict, reading));
+        black_box(dict.predict_ranked(reading, 20, 1000));
+    }
+}
+
+fn bench_dict_cache(c: &mut Criterion) {
+    let stream = keystrokes();
+    let plain = Arc::new(bench_dict());
+    let cache = Arc::new(EntryCache::new(4 << 20));
+    let cached = Arc::new(bench_dict().with_entry_cache(Arc::clone(&cache)));
+    // The app's layering once a user dictionary is loaded.
+    let user: Arc<dyn Dictionary> = Arc::new(TrieDictionary::from_entries(Vec::new()));
+    let layered = |trie: &Arc<TrieDictionary>| {
+        CompositeDictionary::new(vec![Arc::clone(trie) as _, Arc::clone(&user)])
+    };
+    let (plain_layered, cached_layered) = (layered(&plain), layered(&cached));
+    let cases: [(&str, &dyn Dictionary); 4] = [
+        ("uncached", plain.as_ref()),
+        ("cached", cached.as_ref()),
+        ("layered_uncached", &plain_layered),
+        ("layered_cached", &cached_layered),
+    ];
+
+    // Warm once, then report allocations and hit rate of one more replay.
+    replay(cached.as_ref(), &stream);
+    cache.reset_counters();
+    for (name, dict) in cases {
+        let before = ALLOCATIONS.load(Ordering::Relaxed);
+        replay(dict, &stream);
+        let allocs = ALLOCATIONS.load(Ordering::Relaxed) - before;
+        eprintln!(
+            "{name}: {allocs} allocations over {} keystrokes",
+            stream.len()
+        );
+    }
+    let stats = cache.stats();
+    eprintln!(
+        "cache: {:.1}% hits, {} values, {} KiB",
+        stats.hit_rate() * 100.0,
+        stats.values,
+        stats.bytes / 1024
+    );
+
+    let mut group = c.benchmark_group("keystroke_replay");
+    group.sample_size(20);
+    for (name, dict) in cases {
+        group.bench_function(name, |b| b.iter(|| replay(dict, &stream)));
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_dict_cache);
+criterion_main!(benches);
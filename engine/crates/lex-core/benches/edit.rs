@@ -0,0 +1,179 @@
+use std::collections::BTreeMap;
+use std::fmt::Write;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+use lex_core::converter::{build_lattice, ConversionContext, Lattice, ViterbiMemo};
+use lex_core::dict::connection::ConnectionMatrix;
+use lex_core::dict::{DictEntry, TrieDictionary};
+
+mod common;
+use common::next;
+
+const NUM_IDS: u16 = 400;
+
+const SENTENCES: &[&str] = &[
+    "わたしはきょうがっこうでにほんごをべんきょうしました",
+    "あしたはあめがふるかもしれないのでかさをもっていきます",
+    "このほんはとてもおもしろいのでともだちにもすすめたい",
+    "えきのまえにあたらしいきっさてんができたそうです",
+    "しゅうまつはかぞくといっしょにやまへいくよていです",
+];
+
+/// Characters of the composition being edited.
+const COMPOSITION_CHARS: usize = 100;
+
+/// Edits replayed per iteration.
+const EDITS: usize = 32;
+
+/// Mozc-like costs: mostly a few thousand, with a sprinkling of very large
+/// "forbidden" transitions.
+fn bench_conn() -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let mut state = 0x9e37_79b9_7f4a_7c15u64;
+    let mut text = format!("{n} {n}\n");
+    for _ in 0..n * n {
+        let r = next(&mut state);
+        let cost = if r % 64 == 0 { 30000 } else { (r >> 32) % 6000 };
+        writeln!(text, "{cost}").unwrap();
+    }
+    ConnectionMatrix::from_text(&text).unwrap()
+}
+
+/// Three surfaces for every one- to five-character substring of the
+/// sentences, each on a pseudo-random POS ID.
+fn bench_dict() -> TrieDictionary {
+    let mut state = 0x2545_f491_4f6c_dd1du64;
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for sentence in SENTENCES {
+        let chars: Vec<char> = sentence.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=5.min(chars.len() - start) {
+                let reading: String = chars[start..start + len].iter().collect();
+                let list = entries.entry(reading.clone()).or_default();
+                if !list.is_empty() {
+                    continue;
+                }
+                for i in 0..3u16 {
+                    let id = (next(&mut state) % NUM_IDS as u64) as u16;
+                    list.push(DictEntry {
+                        surface: format!("{reading}{i}"),
+                        cost: 3000 + (len as i16) * 200 + (i as i16) * 150,
+                        left_id: id,
+                        right_id: id,
+                    });
+                }
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+/// A 100-character composition and the readings it goes through while the
+/// user moves the cursor around inserting, deleting and replacing a
+/// character at a time.
+fn edit_script() -> (String, Vec<String>) {
+    let mut chars: Vec<char> = SENTENCES
+        .iter()
+        .flat_map(|s| s.chars())
+        .take(COMPOSITION_CHARS)
+        .collect();
+    let initial = chars.iter().collect();
+    let mut state = 0x5851_f42d_4c95_7f2du64;
+    let mut readings = Vec::with_capacity(EDITS);
+    for _ in 0..EDITS {
+        let at = 10 + (next(&mut state) % 80) as usize;
+        let ch = chars[(next(&mut state) % chars.len() as u64) as usize];
+        match next(&mut state) % 3 {
+            0 => chars.insert(at, ch),
+            1 => {
+                chars.remove(at);
+            }
+            _ => chars[at] = ch,
+        }
+        readings.push(chars.iter().collect());
+    }
+    (initial, readings)
+}
+
+fn bench_edit(c: &mut Criterion) {
+    let dict = bench_dict();
+    let conn = bench_conn();
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: Some(&conn),
+        history: None,
+    };
+    let (initial, readings) = edit_script();
+
+    let mut group = c.benchmark_group("mid_composition_edit");
+    group.throughput(Throughput::Elements(EDITS as u64));
+    group.bench_function("rebuild", |b| {
+        b.iter(|| {
+            for reading in &readings {
+                let lattice = build_lattice(&dict, reading);
+                black_box(ctx.convert_from_lattice(&lattice));
+            }
+        })
+    });
+    group.bench_function("splice_memo", |b| {
+        b.iter_batched(
+            || {
+                let lattice = build_lattice(&dict, &initial);
+                let mut memo = ViterbiMemo::new();
+                ctx.convert_from_lattice_with_memo(&lattice, &mut memo);
+                (lattice, memo)
+            },
+            |(mut lattice, mut memo): (Lattice, ViterbiMemo)| {
+                for reading in &readings {
+                    let (next, edit) = lattice.splice(&dict, reading);
+                    lattice = next;
+                    memo.apply_edit(&lattice, &edit);
+                    black_box(ctx.convert_from_lattice_with_memo(&lattice, &mut memo));
+                }
+            },
+            criterion::BatchSize::SmallInput,
+        )
+    });
+    group.finish();
+}
+
+/// Typing the composition one character at a time, lattice only: the
+/// in-place `extend` against a `splice` that copies every node per key.
+fn bench_append(c: &mut Criterion) {
+    let dict = bench_dict();
+    let readings: Vec<String> = {
+        let chars: Vec<char> = SENTENCES
+            .iter()
+            .flat_map(|s| s.chars())
+            .take(COMPOSITION_CHARS)
+            .collect();
+        (1..=chars.len())
+            .map(|n| chars[..n].iter().collect())
+            .collect()
+    };
+
+    let mut group = c.benchmark_group("append_keystroke");
+    group.throughput(Throughput::Elements(readings.len() as u64));
+    group.bench_function("splice", |b| {
+        b.iter(|| {
+            let mut lattice = build_lattice(&dict, "");
+            for reading in &readings {
+                lattice = lattice.splice(&dict, reading).0;
+            }
+            black_box(lattice)
+        })
+    });
+    group.bench_function("extend", |b| {
+        b.iter(|| {
+            let mut lattice = build_lattice(&dict, "");
+            for reading in &readings {
+                black_box(lattice.extend(&dict, reading));
+            }
+            black_box(lattice)
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_edit, bench_append);
+criterion_main!(benches);
@@ -0,0 +1,83 @@
+use std::collections::BTreeMap;
+use std::io;
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use lex_core::converter::explain::{explain, Explanation, NodeFilter};
+use lex_core::dict::{DictEntry, TrieDictionary};
+
+const PHRASE: &str = "わたしはきょうがっこうでにほんごをべんきょうしました";
+
+/// A 200-character reading built by repeating `PHRASE`.
+fn long_reading() -> String {
+    PHRASE.chars().cycle().take(200).collect()
+}
+
+/// Three surfaces for every one- to four-character substring of `PHRASE`,
+/// so the long reading builds a dense lattice.
+fn dense_dict() -> TrieDictionary {
+    let chars: Vec<char> = PHRASE.chars().collect();
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for start in 0..chars.len() {
+        for len in 1..=4.min(chars.len() - start) {
+            let reading: String = chars[start..start + len].iter().collect();
+            let list = entries.entry(reading.clone()).or_default();
+            if !list.is_empty() {
+                continue;
+            }
+            for i in 0..3u16 {
+                list.push(DictEntry {
+                    surface: format!("{reading}{i}"),
+                    cost: 3000 + (len as i16) * 200 + (i as i16) * 150,
+                    left_id: 100 + i,
+                    right_id: 100 + i,
+                });
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+fn bench_explain(c: &mut Criterion) {
+    let dict = dense_dict();
+    let reading = long_reading();
+    let mut group = c.benchmark_group("explain_200");
+    group.sample_size(20);
+
+    // Old lextool path: materialize the whole result, then serialize it.
+    group.bench_function("materialized_json", |b| {
+        b.iter(|| {
+            let result = explain(&dict, None, None, black_box(&reading), 10);
+            serde_json::to_writer_pretty(io::sink(), &result).unwrap();
+        });
+    });
+
+    group.bench_function("streamed_json", |b| {
+        b.iter(|| {
+            let explanation = Explanation::new(&dict, None, None, black_box(&reading), 10);
+            serde_json::to_writer_pretty(io::sink(), &explanation).unwrap();
+        });
+    });
+
+    group.bench_function("streamed_text", |b| {
+        b.iter(|| {
+            let explanation = Explanation::new(&dict, None, None, black_box(&reading), 10);
+            explanation.write_text(&mut io::sink()).unwrap();
+        });
+    });
+
+    // Nodes outside a 10-character window are skipped without being read.
+    group.bench_function("streamed_json_span", |b| {
+        b.iter(|| {
+            let mut explanation = Explanation::new(&dict, None, None, black_box(&reading), 10);
+            explanation.set_node_filter(NodeFilter::Matching {
+                span: Some(100..110),
+                surface: None,
+            });
+            serde_json::to_writer_pretty(io::sink(), &explanation).unwrap();
+        });
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_explain);
+criterion_main!(benches);
@@ -0,0 +1,52 @@
+use criterion::{criterion_group, criterion_main, Criterion};
+use lex_core::candidates::predictive::next_phrase_suggestions;
+use lex_core::settings::{default_toml, init_custom};
+use lex_core::user_history::{now_epoch, UserHistory};
+
+const PREV_COUNT: usize = 100;
+const SUCCESSORS_PER_PREV: usize = 1000;
+
+/// History holding `PREV_COUNT * SUCCESSORS_PER_PREV` (100k) bigrams.
+fn bench_history() -> UserHistory {
+    // The default caps would evict down to 10k entries.
+    let toml = default_toml()
+        .replace("max_unigrams = 10000", "max_unigrams = 1000000")
+        .replace("max_bigrams = 10000", "max_bigrams = 1000000");
+    init_custom(toml).expect("settings must not be initialized yet");
+
+    let mut h = UserHistory::new();
+    let base = now_epoch() - 30 * 24 * 3600;
+    for p in 0..PREV_COUNT {
+        for n in 0..SUCCESSORS_PER_PREV {
+            let segments = [
+                (format!("p{p}"), format!("P{p}")),
+                (format!("n{n}"), format!("N{n}")),
+            ];
+            h.record_at(&segments, base + (p * SUCCESSORS_PER_PREV + n) as u64);
+        }
+    }
+    h
+}
+
+fn bench_successors(c: &mut Criterion) {
+    let h = bench_history();
+    let now = now_epoch();
+    let mut group = c.benchmark_group("history/successors_100k");
+
+    // Previous behaviour: collect and sort every successor per call.
+    group.bench_function("full_sort", |b| {
+        b.iter(|| h.bigram_successors("P42"));
+    });
+
+    group.bench_function("top_k_index", |b| {
+        b.iter(|| h.top_successors("P42", now));
+    });
+
+    group.bench_function("next_phrase_suggestions", |b| {
+        b.iter(|| next_phrase_suggestions(&h, "P42", 5));
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_successors);
+criterion_main!(benches);
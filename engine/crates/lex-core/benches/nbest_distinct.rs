@@ -0,0 +1,106 @@
+use std::collections::BTreeMap;
+use std::fmt::Write;
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+use lex_core::converter::{build_lattice, nbest_surfaces};
+use lex_core::dict::connection::ConnectionMatrix;
+use lex_core::dict::{DictEntry, TrieDictionary};
+
+mod common;
+use common::next;
+
+const NUM_IDS: u16 = 400;
+
+const SENTENCES: &[&str] = &[
+    "わたしはきょうがっこうでにほんごをべんきょうしました",
+    "あしたはあめがふるかもしれないのでかさをもっていきます",
+    "このほんはとてもおもしろいのでともだちにもすすめたい",
+    "えきのまえにあたらしいきっさてんができたそうです",
+    "しゅうまつはかぞくといっしょにやまへいくよていです",
+];
+
+fn bench_conn() -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let mut state = 0x9e37_79b9_7f4a_7c15u64;
+    let mut text = format!("{n} {n}\n");
+    for _ in 0..n * n {
+        let r = next(&mut state);
+        let cost = if r % 64 == 0 { 30000 } else { (r >> 32) % 6000 };
+        writeln!(text, "{cost}").unwrap();
+    }
+    ConnectionMatrix::from_text(&text).unwrap()
+}
+
+/// For every one- to four-character substring of the sentences, the kana
+/// itself and two other surfaces. As in a real dictionary, kana entries
+/// make many segmentations of a stretch spell the same string.
+fn bench_dict() -> TrieDictionary {
+    let mut state = 0x2545_f491_4f6c_dd1du64;
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for sentence in SENTENCES {
+        let chars: Vec<char> = sentence.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=4.min(chars.len() - start) {
+                let reading: String = chars[start..start + len].iter().collect();
+                let list = entries.entry(reading.clone()).or_default();
+                if !list.is_empty() {
+                    continue;
+                }
+                for i in 0..3u16 {
+                    let id = (next(&mut state) % NUM_IDS as u64) as u16;
+                    let surface = match i {
+                        0 => reading.clone(),
+                        _ => format!("{reading}{i}"),
+                    };
+                    list.push(DictEntry {
+                        surface,
+                        cost: 3000 + (len as i16) * 200 + (next(&mut state) % 1500) as i16,
+                        left_id: id,
+                        right_id: id,
+                    });
+                }
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+/// The candidate pool of an `n`-best conversion (`3n` paths) per sentence:
+/// the plain search the converter runs at that width, whose deduplicated
+/// list can come up short, against the surface-distinct search at the same
+/// width. The distinct search pays for its per-node surface hashing here,
+/// which is why conversion stays on the plain search.
+fn bench_nbest_distinct(c: &mut Criterion) {
+    let dict = bench_dict();
+    let conn = bench_conn();
+    let lattices: Vec<_> = SENTENCES.iter().map(|s| build_lattice(&dict, s)).collect();
+
+    let mut group = c.benchmark_group("nbest_distinct");
+    for n in [5, 10, 20] {
+        let pool = n * 3;
+        for lattice in &lattices {
+            let plain = nbest_surfaces(lattice, Some(&conn), pool, Some(pool));
+            let distinct = nbest_surfaces(lattice, Some(&conn), pool, None);
+            assert_eq!(plain.first(), distinct.first());
+            assert!(plain.len() <= distinct.len());
+        }
+        group.bench_with_input(BenchmarkId::new("plain", n), &pool, |b, &pool| {
+            b.iter(|| {
+                for lattice in &lattices {
+                    black_box(nbest_surfaces(lattice, Some(&conn), pool, Some(pool)));
+                }
+            })
+        });
+        group.bench_with_input(BenchmarkId::new("distinct", n), &pool, |b, &pool| {
+            b.iter(|| {
+                for lattice in &lattices {
+                    black_box(nbest_surfaces(lattice, Some(&conn), pool, None));
+                }
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_nbest_distinct);
+criterion_main!(benches);
@@ -0,0 +1,54 @@
+//! KV cache precision: resident size and per-token latency vs. context length.
+//!
+//! Run with `cargo bench -p lex-core --features neural --bench neural_kv`.
+
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+use candle_core::Device;
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use lex_core::neural::{KvCacheMode, QuantizedGpt2};
+
+const CONTEXT_LENGTHS: &[usize] = &[64, 256, 1024];
+const MODES: &[(&str, KvCacheMode)] = &[("f32", KvCacheMode::F32), ("int8", KvCacheMode::Int8)];
+
+fn bench_kv_cache(c: &mut Criterion) {
+    let device = Device::Cpu;
+    let mut model = QuantizedGpt2::random(256, 8, 4, 1024, 1024, &device).unwrap();
+    let mut group = c.benchmark_group("neural/kv_cache_step");
+    group.sample_size(20);
+
+    for &(label, mode) in MODES {
+        model.set_kv_cache_mode(mode);
+        for &ctx in CONTEXT_LENGTHS {
+            // Fill the cache up to `ctx - 1` tokens; each sample then forwards
+            // the token at position `ctx - 1` from a restored snapshot.
+            model.reset_kv_cache();
+            for pos in 0..ctx - 1 {
+                model.forward(&[(pos % 1024) as u32], pos).unwrap();
+            }
+            eprintln!(
+                "kv_cache {label} ctx={ctx}: {} KiB",
+                model.kv_cache_bytes() / 1024
+            );
+            let snapshot = model.save_kv_cache();
+
+            group.bench_with_input(BenchmarkId::new(label, ctx), &ctx, |b, &ctx| {
+                b.iter_custom(|iters| {
+                    let mut total = Duration::ZERO;
+                    for _ in 0..iters {
+                        model.restore_kv_cache(&snapshot);
+                        let start = Instant::now();
+                        black_box(model.forward(&[1], ctx - 1).unwrap());
+                        total += start.elapsed();
+                    }
+                    total
+                });
+            });
+        }
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_kv_cache);
+criterion_main!(benches);
@@ -0,0 +1,43 @@
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use lex_core::numeric::{number_prefixes, parse_japanese_number};
+
+/// Readings the numeric rewriter sees: numbers, number + counter, and
+/// ordinary words that start like a number.
+const READINGS: &[&str] = &[
+    "にじゅうさん",
+    "さんびゃくよんじゅうご",
+    "いちまんにせんさんびゃくよんじゅうご",
+    "きゅうせんきゅうひゃくきゅうじゅうきゅうおくきゅうせんきゅうひゃくまん",
+    "さんぜんえん",
+    "ろっぴゃくにん",
+    "にじゅうよっか",
+    "ちょうさ",
+    "しごと",
+    "いちばん",
+    "こんにちは",
+];
+
+fn bench_parse(c: &mut Criterion) {
+    let mut group = c.benchmark_group("numeric");
+
+    group.bench_function("parse_japanese_number", |b| {
+        b.iter(|| {
+            for reading in READINGS {
+                black_box(parse_japanese_number(black_box(reading)));
+            }
+        });
+    });
+
+    // Counter splitting: every numeric prefix from one scan.
+    group.bench_function("number_prefixes", |b| {
+        b.iter(|| {
+            for reading in READINGS {
+                black_box(number_prefixes(black_box(reading)));
+            }
+        });
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_parse);
+criterion_main!(benches);
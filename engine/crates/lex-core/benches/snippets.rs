@@ -0,0 +1,90 @@
+use std::collections::HashMap;
+
+use criterion::{criterion_group, criterion_main, Criterion};
+use lex_core::snippets::{SnippetStore, SnippetVariable, VariableResolver};
+
+const SNIPPET_COUNT: usize = 5000;
+const PAGE_SIZE: usize = 9;
+
+fn bench_entries() -> HashMap<String, String> {
+    let bodies = [
+        "https://example.com/path/to/page",
+        "Best regards,\n$name",
+        "Today is $date ($wareki)",
+        "Meeting at $time, room ${room}",
+        "Price: $$100 / ${unknown}",
+    ];
+    let keys = "abcdefghijklmnopqrstuvwxyz".as_bytes();
+    (0..SNIPPET_COUNT)
+        .map(|i| {
+            // Spread keys so each one-character prefix matches ~1/26 of the set,
+            // except `a`, which every fifth entry shares.
+            let head = if i % 5 == 0 {
+                'a'
+            } else {
+                keys[i % keys.len()] as char
+            };
+            (
+                format!("{head}{i:05}"),
+                bodies[i % bodies.len()].to_string(),
+            )
+        })
+        .collect()
+}
+
+fn bench_resolver() -> VariableResolver {
+    let mut vars = HashMap::new();
+    vars.insert(
+        "name".to_string(),
+        SnippetVariable::Static {
+            value: "Taro".to_string(),
+        },
+    );
+    vars.insert(
+        "room".to_string(),
+        SnippetVariable::Static {
+            value: "A-1".to_string(),
+        },
+    );
+    VariableResolver::new(vars)
+}
+
+fn bench_prefix_search(c: &mut Criterion) {
+    let entries = bench_entries();
+    let store = SnippetStore::new(entries.clone(), bench_resolver());
+    let resolver = bench_resolver();
+    let mut group = c.benchmark_group("snippets/prefix_a");
+
+    // Previous behaviour: filter the map, re-parse and expand every match.
+    group.bench_function("reparse_all", |b| {
+        b.iter(|| {
+            let mut results: Vec<(String, String)> = entries
+                .iter()
+                .filter(|(key, _)| key.starts_with('a'))
+                .map(|(key, body)| (key.clone(), resolver.expand(body)))
+                .collect();
+            results.sort_by(|a, b| a.0.cmp(&b.0));
+            results
+        });
+    });
+
+    group.bench_function("compiled_all", |b| {
+        b.iter(|| store.prefix_search("a"));
+    });
+
+    // What the session does: expand the visible page only.
+    group.bench_function("compiled_page", |b| {
+        b.iter(|| {
+            let range = store.prefix_range("a");
+            let ctx = store.context();
+            range
+                .take(PAGE_SIZE)
+                .map(|i| store.expand(i, &ctx))
+                .collect::<Vec<_>>()
+        });
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_prefix_search);
+criterion_main!(benches);
@@ -61,11 +61,12 @@ fn generate_punctuation_candidates(
     // Learned predictions first
     if let Some(h) = history {
         let now = crate::user_history::now_epoch();
+        let settings = crate::settings::settings();
         let fetch_limit = max_results.max(200);
         let mut ranked = dict.predict_ranked(reading, fetch_limit, 1000);
         ranked.sort_by(|(r_a, e_a), (r_b, e_b)| {
-            let boost_a = h.unigram_boost(r_a, &e_a.surface, now);
-            let boost_b = h.unigram_boost(r_b, &e_b.surface, now);
+            let boost_a = h.unigram_boost_with(&settings.history, r_a, &e_a.surface, now);
+            let boost_b = h.unigram_boost_with(&settings.history, r_b, &e_b.surface, now);
             boost_b.cmp(&boost_a).then(e_a.cost.cmp(&e_b.cost))
         });
         ranked.truncate(max_results);
@@ -5,7 +5,7 @@ use tracing::{debug, debug_span};
 use crate::converter::Lattice;
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
-use crate::user_history::UserHistory;
+use crate::user_history::{now_epoch, UserHistory};
 
 use super::{generate_punctuation_candidates, punctuation_alternatives, CandidateResponse};
 
@@ -22,9 +22,10 @@ fn chain_bigram_phrase(
     let mut visited = HashSet::new();
     visited.insert(current_surface.clone());
     let mut extended = false;
+    let now = now_epoch();
 
     for _ in 0..max_chain {
-        let successors = history.bigram_successors(&current_surface);
+        let successors = history.top_successors(&current_surface, now);
         if let Some((_, next_surface, _)) = successors.first() {
             if !visited.insert(next_surface.clone()) {
                 break; // cycle detected
@@ -44,6 +45,27 @@ fn chain_bigram_phrase(
     }
 }
 
+/// Zero-query suggestions: phrases likely to follow `prev_surface`, for
+/// showing right after a commit before any new key is typed.
+///
+/// Each of the best direct successors is extended by bigram chaining, so
+/// suggestions range from a single word to a short phrase.
+pub fn next_phrase_suggestions(
+    history: &UserHistory,
+    prev_surface: &str,
+    max_results: usize,
+) -> Vec<String> {
+    let max_chain = 4;
+    let mut seen = HashSet::new();
+    history
+        .top_successors(prev_surface, now_epoch())
+        .into_iter()
+        .map(|(_, surface, _)| chain_bigram_phrase(history, &surface, max_chain).unwrap_or(surface))
+        .filter(|phrase| seen.insert(phrase.clone()))
+        .take(max_results)
+        .collect()
+}
+
 /// Generate prediction candidates with bigram chaining (Copilot-like completions).
 /// Uses Viterbi N-best as the base, then chains bigram successors from history
 /// to produce progressively longer multi-word phrases.
@@ -187,6 +209,23 @@ mod tests {
         assert_eq!(result.as_deref(), Some("AB"));
     }
 
+    #[test]
+    fn test_next_phrase_suggestions() {
+        let mut h = UserHistory::new();
+        h.record(&[
+            ("きょう".into(), "今日".into()),
+            ("は".into(), "は".into()),
+            ("いい".into(), "良い".into()),
+        ]);
+        h.record(&[("きょう".into(), "今日".into()), ("も".into(), "も".into())]);
+        h.record(&[("きょう".into(), "今日".into()), ("も".into(), "も".into())]);
+
+        let suggestions = next_phrase_suggestions(&h, "今日", 5);
+        assert_eq!(suggestions, vec!["も".to_string(), "は良い".to_string()]);
+        assert_eq!(next_phrase_suggestions(&h, "今日", 1).len(), 1);
+        assert!(next_phrase_suggestions(&h, "良い", 5).is_empty());
+    }
+
     #[test]
     fn test_chain_bigram_phrase_self_loop() {
         let mut h = UserHistory::new();
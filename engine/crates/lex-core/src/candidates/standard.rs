@@ -5,7 +5,6 @@ use tracing::{debug, debug_span};
 use crate::converter::Lattice;
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
-use crate::settings::settings;
 use crate::user_history::UserHistory;
 
 use super::{generate_punctuation_candidates, punctuation_alternatives, CandidateResponse};
@@ -26,7 +25,9 @@ pub(super) fn generate_normal_candidates(
     //    history_rerank is applied post-Viterbi on N-best paths (not during
     //    lattice search), so it cannot cause fragmentation. Time-decayed
     //    boosts (half-life 168h) prevent stale history from dominating.
-    let nbest = settings().candidates.nbest;
+    // The snapshot the lattice was built with, as the conversion uses.
+    let settings = lattice.settings();
+    let nbest = settings.candidates.nbest;
     let ctx = crate::converter::ConversionContext {
         dict,
         conn,
@@ -59,9 +60,13 @@ pub(super) fn generate_normal_candidates(
     //    learned. When the #1 has its own whole-path history boost, kana
     //    goes to position 1 instead so explicit kanji selection is respected.
     let now = crate::user_history::now_epoch();
-    let kana_boost = history.map_or(0, |h| h.unigram_boost(reading, reading, now));
+    let kana_boost = history.map_or(0, |h| {
+        h.unigram_boost_with(&settings.history, reading, reading, now)
+    });
     let top_has_boost = if !surfaces.is_empty() && surfaces[0] != reading {
-        history.is_some_and(|h| h.unigram_boost(reading, &surfaces[0], now) > 0)
+        history.is_some_and(|h| {
+            h.unigram_boost_with(&settings.history, reading, &surfaces[0], now) > 0
+        })
     } else {
         false
     };
@@ -99,8 +104,8 @@ pub(super) fn generate_normal_candidates(
     let mut ranked = dict.predict_ranked(reading, fetch_limit, 1000);
     if let Some(h) = history {
         ranked.sort_by(|(r_a, e_a), (r_b, e_b)| {
-            let boost_a = h.unigram_boost(r_a, &e_a.surface, now);
-            let boost_b = h.unigram_boost(r_b, &e_b.surface, now);
+            let boost_a = h.unigram_boost_with(&settings.history, r_a, &e_a.surface, now);
+            let boost_b = h.unigram_boost_with(&settings.history, r_b, &e_b.surface, now);
             boost_b.cmp(&boost_a).then(e_a.cost.cmp(&e_b.cost))
         });
         ranked.truncate(max_results);
@@ -13,7 +13,7 @@ use super::viterbi::ConvertedSegment;
 /// Confirmed prefix constraint for constrained Viterbi.
 ///
 /// Segments within the prefix are matched by (char_range, reading, surface).
-/// Nodes that contradict the fixed prefix receive a prohibitive cost.
+/// Nodes that contradict the fixed prefix are excluded from the search.
 pub(crate) struct PrefixConstraint {
     /// Fixed segments: (char_range, reading, surface)
     segments: Vec<(Range<usize>, String, String)>,
@@ -38,78 +38,108 @@ impl PrefixConstraint {
         }
     }
 
-    /// Check if a lattice node is within the prefix region.
-    fn is_in_prefix(&self, lattice: &Lattice, idx: usize) -> bool {
-        lattice.start(idx) < self.prefix_char_end
+    /// Resolve the constraint against `lattice`: one bit per node, set when
+    /// the node may appear on a path.
+    ///
+    /// Nodes starting inside the prefix are allowed only if they match the
+    /// fixed segment at that position exactly (range, reading, surface);
+    /// that also rules out nodes spanning the prefix boundary. Nodes after
+    /// the prefix are unconstrained.
+    pub fn compile(&self, lattice: &Lattice) -> NodeMask {
+        let mut mask = NodeMask::all(lattice.node_count());
+        // Segments tile the prefix, so at most one can start at each position.
+        let mut fixed_at: Vec<Option<&(Range<usize>, String, String)>> =
+            vec![None; self.prefix_char_end];
+        for seg in &self.segments {
+            if seg.0.start < fixed_at.len() {
+                fixed_at[seg.0.start] = Some(seg);
+            }
+        }
+        for (start, nodes) in lattice
+            .nodes_by_start
+            .iter()
+            .enumerate()
+            .take(self.prefix_char_end)
+        {
+            for &idx in nodes {
+                let allowed = fixed_at[start].is_some_and(|(range, reading, surface)| {
+                    lattice.end(idx) == range.end
+                        && lattice.reading(idx) == *reading
+                        && lattice.surface(idx) == *surface
+                });
+                if !allowed {
+                    mask.forbid(idx);
+                }
+            }
+        }
+        mask
+    }
+}
+
+/// Per-node allow bits of a [`PrefixConstraint`] compiled for one lattice.
+pub(crate) struct NodeMask {
+    bits: Vec<u64>,
+}
+
+impl NodeMask {
+    fn all(node_count: usize) -> Self {
+        Self {
+            bits: vec![u64::MAX; node_count.div_ceil(64)],
+        }
     }
 
-    /// Check if a lattice node spans the prefix boundary.
-    fn spans_boundary(&self, lattice: &Lattice, idx: usize) -> bool {
-        lattice.start(idx) < self.prefix_char_end && lattice.end(idx) > self.prefix_char_end
+    fn forbid(&mut self, idx: usize) {
+        self.bits[idx / 64] &= !(1 << (idx % 64));
     }
 
-    /// Check if a lattice node matches a fixed segment exactly.
-    fn matches_fixed_segment(&self, lattice: &Lattice, idx: usize) -> bool {
-        self.segments.iter().any(|(pos, reading, surface)| {
-            lattice.start(idx) == pos.start
-                && lattice.end(idx) == pos.end
-                && lattice.reading(idx) == *reading
-                && lattice.surface(idx) == *surface
-        })
+    #[inline]
+    pub fn allows(&self, idx: usize) -> bool {
+        self.bits[idx / 64] & (1 << (idx % 64)) != 0
     }
 }
 
-/// Cost that prohibits nodes contradicting a prefix constraint.
-const CONSTRAINT_VIOLATION_COST: i64 = i64::MAX / 4;
-
 /// Cost function wrapper that enforces prefix constraints.
 ///
-/// - Nodes within the prefix that match a fixed segment: normal cost
-/// - Nodes within the prefix that don't match: CONSTRAINT_VIOLATION_COST
-/// - Nodes that span the prefix boundary: CONSTRAINT_VIOLATION_COST
-/// - Nodes after the prefix: normal cost
+/// The constraint is compiled into a [`NodeMask`] for the lattice up
+/// front; Viterbi skips the nodes it forbids, and every other node costs
+/// what `DefaultCostFunction` says.
 pub(crate) struct PrefixConstrainedCost<'a> {
     inner: DefaultCostFunction<'a>,
-    constraint: &'a PrefixConstraint,
+    mask: NodeMask,
 }
 
 impl<'a> PrefixConstrainedCost<'a> {
     pub fn new(
         conn: Option<&'a crate::dict::connection::ConnectionMatrix>,
-        constraint: &'a PrefixConstraint,
+        cost: &crate::settings::CostSettings,
+        constraint: &PrefixConstraint,
+        lattice: &Lattice,
     ) -> Self {
         Self {
-            inner: DefaultCostFunction::new(conn),
-            constraint,
+            inner: DefaultCostFunction::new(conn, cost),
+            mask: constraint.compile(lattice),
         }
     }
 }
 
 impl CostFunction for PrefixConstrainedCost<'_> {
-    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i64 {
-        if self.constraint.spans_boundary(lattice, idx) {
-            return CONSTRAINT_VIOLATION_COST;
-        }
-        if self.constraint.is_in_prefix(lattice, idx) {
-            if self.constraint.matches_fixed_segment(lattice, idx) {
-                self.inner.word_cost(lattice, idx)
-            } else {
-                CONSTRAINT_VIOLATION_COST
-            }
-        } else {
-            self.inner.word_cost(lattice, idx)
-        }
+    fn allows(&self, _lattice: &Lattice, idx: usize) -> bool {
+        self.mask.allows(idx)
+    }
+
+    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i32 {
+        self.inner.word_cost(lattice, idx)
     }
 
-    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i64 {
+    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i32 {
         self.inner.transition_cost(prev_right_id, next_left_id)
     }
 
-    fn bos_cost(&self, left_id: u16) -> i64 {
+    fn bos_cost(&self, left_id: u16) -> i32 {
         self.inner.bos_cost(left_id)
     }
 
-    fn eos_cost(&self, right_id: u16) -> i64 {
+    fn eos_cost(&self, right_id: u16) -> i32 {
         self.inner.eos_cost(right_id)
     }
 }
@@ -117,9 +147,10 @@ impl CostFunction for PrefixConstrainedCost<'_> {
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::converter::testutil::test_dict;
+    use crate::converter::testutil::{test_dict, Rng};
     use crate::converter::viterbi::{viterbi_nbest, ScoredPath};
     use crate::converter::{build_lattice, convert_nbest};
+    use crate::settings::settings;
 
     fn to_segments(path: &ScoredPath) -> Vec<ConvertedSegment> {
         path.segments
@@ -141,8 +172,8 @@ mod tests {
 
         // Empty constraint (no confirmed segments)
         let constraint = PrefixConstraint::from_confirmed(&[]);
-        let cost_fn = PrefixConstrainedCost::new(None, &constraint);
         let lattice = build_lattice(&dict, kana);
+        let cost_fn = PrefixConstrainedCost::new(None, &settings().cost, &constraint, &lattice);
         let constrained = viterbi_nbest(&lattice, &cost_fn, 15);
 
         // First result should match
@@ -165,7 +196,7 @@ mod tests {
         let kana = "きょうは";
 
         // Get raw 1-best (no grouping)
-        let cost_fn = crate::converter::cost::DefaultCostFunction::new(None);
+        let cost_fn = crate::converter::cost::DefaultCostFunction::new(None, &settings().cost);
         let lattice = build_lattice(&dict, kana);
         let raw_paths = viterbi_nbest(&lattice, &cost_fn, 1);
         assert!(!raw_paths.is_empty());
@@ -173,8 +204,9 @@ mod tests {
 
         // Constrain all segments
         let constraint = PrefixConstraint::from_confirmed(&first_raw);
-        let constrained_cost = PrefixConstrainedCost::new(None, &constraint);
         let lattice2 = build_lattice(&dict, kana);
+        let constrained_cost =
+            PrefixConstrainedCost::new(None, &settings().cost, &constraint, &lattice2);
         let constrained = viterbi_nbest(&lattice2, &constrained_cost, 5);
 
         // First result should have the same segments as the constrained prefix
@@ -194,7 +226,7 @@ mod tests {
         let kana = "きょうはいいてんき";
 
         // Get raw 1-best (no grouping) to use as constraint source
-        let cost_fn = crate::converter::cost::DefaultCostFunction::new(None);
+        let cost_fn = crate::converter::cost::DefaultCostFunction::new(None, &settings().cost);
         let lattice = build_lattice(&dict, kana);
         let raw_paths = viterbi_nbest(&lattice, &cost_fn, 5);
         assert!(!raw_paths.is_empty());
@@ -211,24 +243,20 @@ mod tests {
             })
             .collect();
         let constraint = PrefixConstraint::from_confirmed(&confirmed);
-        let cost_fn = PrefixConstrainedCost::new(None, &constraint);
         let lattice2 = build_lattice(&dict, kana);
+        let cost_fn = PrefixConstrainedCost::new(None, &settings().cost, &constraint, &lattice2);
         let constrained = viterbi_nbest(&lattice2, &cost_fn, 10);
 
         // Valid results (non-violated paths) should have the prefix matching
         let prefix_char_len: usize = confirmed.iter().map(|s| s.reading.chars().count()).sum();
 
-        // Only check paths with reasonable cost (not constraint-violated)
-        let valid_paths: Vec<_> = constrained
-            .iter()
-            .filter(|p| p.viterbi_cost < CONSTRAINT_VIOLATION_COST / 2)
-            .collect();
+        // Forbidden nodes are skipped, so every path honours the prefix.
         assert!(
-            !valid_paths.is_empty(),
+            !constrained.is_empty(),
             "should have at least one valid path"
         );
 
-        for path in &valid_paths {
+        for path in &constrained {
             let segs = to_segments(path);
             let mut chars = 0;
             let mut prefix_surfaces = Vec::new();
@@ -259,8 +287,8 @@ mod tests {
         // Build a mini lattice with one boundary-spanning node
         let lattice = Lattice::from_test_nodes("きょう", &[(1, 3, "ょう", "陽", 1000, 0, 0)]);
 
-        let cost_fn = PrefixConstrainedCost::new(None, &constraint);
-        assert_eq!(cost_fn.word_cost(&lattice, 0), CONSTRAINT_VIOLATION_COST);
+        let cost_fn = PrefixConstrainedCost::new(None, &settings().cost, &constraint, &lattice);
+        assert!(!cost_fn.allows(&lattice, 0));
     }
 
     #[test]
@@ -288,4 +316,126 @@ mod tests {
             (3..4, "は".to_string(), "は".to_string())
         );
     }
+
+    /// The pre-bitset wrapper: nodes contradicting the prefix cost 2^28
+    /// instead of being skipped.
+    struct ViolationCost<'a> {
+        inner: DefaultCostFunction<'a>,
+        constraint: &'a PrefixConstraint,
+    }
+
+    const VIOLATION: i32 = 1 << 28;
+
+    impl CostFunction for ViolationCost<'_> {
+        fn word_cost(&self, lattice: &Lattice, idx: usize) -> i32 {
+            let (start, end) = (lattice.start(idx), lattice.end(idx));
+            let prefix_end = self.constraint.prefix_char_end;
+            let matches = self
+                .constraint
+                .segments
+                .iter()
+                .any(|(pos, reading, surface)| {
+                    start == pos.start
+                        && end == pos.end
+                        && lattice.reading(idx) == *reading
+                        && lattice.surface(idx) == *surface
+                });
+            if start < prefix_end && (end > prefix_end || !matches) {
+                return VIOLATION;
+            }
+            self.inner.word_cost(lattice, idx)
+        }
+
+        fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i32 {
+            self.inner.transition_cost(prev_right_id, next_left_id)
+        }
+
+        fn bos_cost(&self, left_id: u16) -> i32 {
+            self.inner.bos_cost(left_id)
+        }
+
+        fn eos_cost(&self, right_id: u16) -> i32 {
+            self.inner.eos_cost(right_id)
+        }
+    }
+
+    type PathKey = (i64, Vec<(String, String)>);
+
+    fn path_keys(paths: &[ScoredPath]) -> Vec<PathKey> {
+        paths
+            .iter()
+            .map(|p| {
+                let segs = p
+                    .segments
+                    .iter()
+                    .map(|s| (s.reading.clone(), s.surface.clone()))
+                    .collect();
+                (p.viterbi_cost, segs)
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_bitset_matches_violation_cost_on_random_prefixes() {
+        use crate::dict::{DictEntry, TrieDictionary};
+        use std::collections::BTreeMap;
+
+        const KANA: [&str; 5] = ["か", "き", "し", "た", "ん"];
+        let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+        let mut below = |n: usize| rng.below(n);
+
+        for _ in 0..30 {
+            let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+            for _ in 0..40 {
+                let reading: String = (0..1 + below(3)).map(|_| KANA[below(KANA.len())]).collect();
+                let n = entries.get(&reading).map_or(0, Vec::len);
+                let entry = DictEntry {
+                    surface: format!("{reading}{n}"),
+                    cost: below(8000) as i16,
+                    left_id: below(4) as u16,
+                    right_id: below(4) as u16,
+                };
+                entries.entry(reading).or_default().push(entry);
+            }
+            let dict = TrieDictionary::from_entries(entries);
+            let default_cost = DefaultCostFunction::new(None, &settings().cost);
+
+            for _ in 0..10 {
+                let kana: String = (0..2 + below(10))
+                    .map(|_| KANA[below(KANA.len())])
+                    .collect();
+                let lattice = build_lattice(&dict, &kana);
+                let unconstrained = viterbi_nbest(&lattice, &default_cost, 10);
+                if unconstrained.is_empty() {
+                    continue;
+                }
+
+                // Prefix of a real path, sometimes with a wrong final surface.
+                let path = &unconstrained[below(unconstrained.len())];
+                let mut confirmed = to_segments(path);
+                confirmed.truncate(below(confirmed.len() + 1));
+                if below(3) == 0 {
+                    if let Some(last) = confirmed.last_mut() {
+                        last.surface = format!("{}{}", last.reading, below(3));
+                    }
+                }
+                let constraint = PrefixConstraint::from_confirmed(&confirmed);
+
+                let bitset =
+                    PrefixConstrainedCost::new(None, &settings().cost, &constraint, &lattice);
+                let reference = ViolationCost {
+                    inner: DefaultCostFunction::new(None, &settings().cost),
+                    constraint: &constraint,
+                };
+                for n in [1, 5, 20] {
+                    let expected: Vec<PathKey> = path_keys(&viterbi_nbest(&lattice, &reference, n))
+                        .into_iter()
+                        .filter(|(cost, _)| *cost < i64::from(VIOLATION / 2))
+                        .collect();
+                    let actual = path_keys(&viterbi_nbest(&lattice, &bitset, n));
+                    assert_eq!(actual, expected, "{kana} {confirmed:?} n={n}");
+                }
+            }
+        }
+    }
 }
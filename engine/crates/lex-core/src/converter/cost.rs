@@ -1,5 +1,5 @@
 use crate::dict::connection::ConnectionMatrix;
-use crate::settings::settings;
+use crate::settings::CostSettings;
 use crate::unicode::{is_hiragana, is_kanji, is_katakana, is_latin};
 
 use super::lattice::Lattice;
@@ -10,14 +10,13 @@ use super::lattice::Lattice;
 /// - Contains Latin/ASCII (e.g. death, tie, thai): heavy penalty
 /// - All-katakana (e.g. タラ, オッ): penalty (positive)
 /// - Otherwise (pure hiragana, etc.): no adjustment
-pub fn script_cost(surface: &str, reading_chars: usize) -> i64 {
-    let s = settings();
+pub fn script_cost(surface: &str, reading_chars: usize, cost: &CostSettings) -> i64 {
     let mut has_kanji = false;
     let mut has_kana = false;
     let mut all_katakana = !surface.is_empty();
     for c in surface.chars() {
         if is_latin(c) {
-            return s.cost.latin_penalty;
+            return cost.latin_penalty;
         }
         if is_kanji(c) {
             has_kanji = true;
@@ -31,11 +30,11 @@ pub fn script_cost(surface: &str, reading_chars: usize) -> i64 {
     }
     let scale = reading_chars.min(2) as i64;
     if has_kanji && has_kana {
-        -s.cost.mixed_script_bonus * scale / 3
+        -cost.mixed_script_bonus * scale / 3
     } else if has_kanji {
-        -s.cost.pure_kanji_bonus * scale / 3
+        -cost.pure_kanji_bonus * scale / 3
     } else if all_katakana {
-        s.cost.katakana_penalty
+        cost.katakana_penalty
     } else {
         0
     }
@@ -43,17 +42,36 @@ pub fn script_cost(surface: &str, reading_chars: usize) -> i64 {
 
 /// Trait for scoring lattice paths during Viterbi search.
 ///
-/// Hybrid design: `word_cost` receives `(&Lattice, usize)` because
-/// `PrefixConstrainedCost` needs full node inspection (start, end,
-/// reading, surface).  The other three methods take raw IDs — both
-/// implementations only ever read `left_id` / `right_id`, so passing
-/// the Lattice would be wasteful (especially for `transition_cost`,
-/// the most frequent call at O(P*Q) per position).
+/// Costs are `i32`. A node adds at most `|word cost| + segment penalty +
+/// |transition|`, each bounded by `i16::MAX` (the penalty is clamped to it),
+/// so one node contributes under 2^17 and a path is exact up to 2^14 nodes
+/// — far beyond any composition. Accumulation saturates instead of wrapping
+/// past that bound.
+///
+/// Hybrid design: `word_cost` and `allows` receive `(&Lattice, usize)`
+/// because node costs and constraints need node inspection (surface,
+/// span). The other three methods take raw IDs — both implementations
+/// only ever read `left_id` / `right_id`, so passing the Lattice would be
+/// wasteful (especially for `transition_cost`, the most frequent call at
+/// O(P*Q) per position).
 pub(crate) trait CostFunction: Send + Sync {
-    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i64;
-    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i64;
-    fn bos_cost(&self, left_id: u16) -> i64;
-    fn eos_cost(&self, right_id: u16) -> i64;
+    /// Whether node `idx` may be on a path at all. Viterbi skips nodes
+    /// this rejects, so it must be cheap: `PrefixConstrainedCost` answers
+    /// from a precompiled bitset.
+    fn allows(&self, _lattice: &Lattice, _idx: usize) -> bool {
+        true
+    }
+    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i32;
+    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i32;
+    fn bos_cost(&self, left_id: u16) -> i32;
+    fn eos_cost(&self, right_id: u16) -> i32;
+
+    /// Identifies the costs this function assigns, for `ViterbiMemo`: two
+    /// calls returning the same key must score every node and transition
+    /// of a lattice alike. `None` (the default) disables memoization.
+    fn memo_key(&self) -> Option<(usize, i32)> {
+        None
+    }
 }
 
 /// Look up connection cost between two IDs, returning 0 if no matrix is provided.
@@ -64,34 +82,51 @@ pub fn conn_cost(conn: Option<&ConnectionMatrix>, left: u16, right: u16) -> i64
 /// Default cost function using word costs and optional connection matrix.
 pub(crate) struct DefaultCostFunction<'a> {
     conn: Option<&'a ConnectionMatrix>,
+    segment_penalty: i32,
 }
 
 impl<'a> DefaultCostFunction<'a> {
-    pub fn new(conn: Option<&'a ConnectionMatrix>) -> Self {
-        Self { conn }
+    pub fn new(conn: Option<&'a ConnectionMatrix>, cost: &CostSettings) -> Self {
+        Self {
+            conn,
+            // Clamped so a node's cost stays within the bound documented on
+            // `CostFunction`; real settings are a few thousand.
+            segment_penalty: cost.segment_penalty.clamp(i16::MIN.into(), i16::MAX.into()) as i32,
+        }
+    }
+
+    fn conn_cost(&self, left: u16, right: u16) -> i32 {
+        self.conn.map_or(0, |c| i32::from(c.cost(left, right)))
     }
 }
 
 impl CostFunction for DefaultCostFunction<'_> {
-    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i64 {
-        let seg_penalty = settings().cost.segment_penalty;
+    fn word_cost(&self, lattice: &Lattice, idx: usize) -> i32 {
+        let seg_penalty = self.segment_penalty;
         let is_fw = self
             .conn
             .map(|c| c.is_function_word(lattice.left_id(idx)))
             .unwrap_or(false);
         let penalty = if is_fw { seg_penalty / 2 } else { seg_penalty };
-        lattice.cost(idx) as i64 + penalty
+        i32::from(lattice.cost(idx)) + penalty
     }
 
-    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i64 {
-        conn_cost(self.conn, prev_right_id, next_left_id)
+    fn transition_cost(&self, prev_right_id: u16, next_left_id: u16) -> i32 {
+        self.conn_cost(prev_right_id, next_left_id)
     }
 
-    fn bos_cost(&self, left_id: u16) -> i64 {
-        conn_cost(self.conn, 0, left_id)
+    fn bos_cost(&self, left_id: u16) -> i32 {
+        self.conn_cost(0, left_id)
     }
 
-    fn eos_cost(&self, right_id: u16) -> i64 {
-        conn_cost(self.conn, right_id, 0)
+    fn eos_cost(&self, right_id: u16) -> i32 {
+        self.conn_cost(right_id, 0)
+    }
+
+    fn memo_key(&self) -> Option<(usize, i32)> {
+        let conn = self
+            .conn
+            .map_or(0, |c| c as *const ConnectionMatrix as usize);
+        Some((conn, self.segment_penalty))
     }
 }
@@ -1,19 +1,22 @@
-use std::collections::HashMap;
+use std::io::{self, Write};
+use std::ops::Range;
+use std::sync::Arc;
 
+use serde::ser::{SerializeStruct, Serializer};
 use serde::Serialize;
 
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
 use crate::user_history::UserHistory;
 
-use crate::settings::settings;
+use crate::settings::{settings, HistorySettings, Settings};
 
 use super::cost::{conn_cost, script_cost, DefaultCostFunction};
 use super::features::{is_single_char_kanji_penalised, is_te_form_kanji_penalised};
-use super::lattice::{build_lattice, Lattice};
+use super::lattice::{build_lattice_with, Lattice};
 use super::postprocess::{postprocess_observed, PostprocessContext, PostprocessObserver};
 use super::reranker::compute_history_boost;
-use super::viterbi::{viterbi_nbest, ScoredPath};
+use super::viterbi::{budgeted_n, viterbi_nbest, ScoredPath};
 
 // Re-export so downstream crates (e.g. lex-cli) can name the type behind
 // `ExplainPath::history_breakdown` — the definition lives in the crate-private
@@ -42,18 +45,56 @@ pub struct ExplainNode {
 }
 
 impl ExplainNode {
-    /// Build from a lattice + node index.
-    fn from_lattice(lattice: &Lattice, idx: usize) -> Self {
+    fn view(&self) -> NodeView<'_> {
+        NodeView {
+            start: self.start,
+            end: self.end,
+            reading: &self.reading,
+            surface: &self.surface,
+            cost: self.cost,
+            left_id: self.left_id,
+            right_id: self.right_id,
+        }
+    }
+}
+
+/// Borrowed counterpart of [`ExplainNode`] that serializes identically.
+/// Streams node data out of the lattice's string pool without copying it.
+#[derive(Serialize)]
+struct NodeView<'a> {
+    start: usize,
+    end: usize,
+    reading: &'a str,
+    surface: &'a str,
+    cost: i16,
+    left_id: u16,
+    right_id: u16,
+}
+
+impl<'a> NodeView<'a> {
+    fn from_lattice(lattice: &'a Lattice, idx: usize) -> Self {
         Self {
             start: lattice.start(idx),
             end: lattice.end(idx),
-            reading: lattice.reading(idx).to_string(),
-            surface: lattice.surface(idx).to_string(),
+            reading: lattice.reading(idx),
+            surface: lattice.surface(idx),
             cost: lattice.cost(idx),
             left_id: lattice.left_id(idx),
             right_id: lattice.right_id(idx),
         }
     }
+
+    fn into_node(self) -> ExplainNode {
+        ExplainNode {
+            start: self.start,
+            end: self.end,
+            reading: self.reading.to_string(),
+            surface: self.surface.to_string(),
+            cost: self.cost,
+            left_id: self.left_id,
+            right_id: self.right_id,
+        }
+    }
 }
 
 /// A complete path with full cost breakdown.
@@ -99,6 +140,38 @@ pub struct ExplainSegment {
     pub right_id: u16,
 }
 
+/// Which lattice nodes an [`Explanation`] reports.
+#[derive(Debug, Clone, Default)]
+pub enum NodeFilter {
+    /// Every node.
+    #[default]
+    All,
+    /// No nodes; only the paths are reported.
+    None,
+    /// Nodes that overlap `span` (character positions, end-exclusive) and
+    /// whose surface contains `surface`. A `None` criterion matches any node.
+    Matching {
+        span: Option<Range<usize>>,
+        surface: Option<String>,
+    },
+}
+
+impl NodeFilter {
+    fn keeps(&self, lattice: &Lattice, idx: usize) -> bool {
+        match self {
+            NodeFilter::All => true,
+            NodeFilter::None => false,
+            NodeFilter::Matching { span, surface } => {
+                span.as_ref()
+                    .is_none_or(|s| lattice.start(idx) < s.end && lattice.end(idx) > s.start)
+                    && surface
+                        .as_deref()
+                        .is_none_or(|s| lattice.surface(idx).contains(s))
+            }
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Observer that captures cost snapshots for explain diagnostics
 // ---------------------------------------------------------------------------
@@ -125,66 +198,158 @@ struct PreHistorySnapshot {
     segment_count: usize,
 }
 
+/// Maps a later path back to its index in a slice the observer recorded.
+///
+/// Paths are matched by concatenated surface, which survives
+/// `group_segments`. All surfaces share one buffer and are found by hash, so
+/// building the index does not allocate per path; a hash hit is confirmed
+/// against the stored surface. When a slice holds the same surface twice the
+/// later path wins.
+#[derive(Default)]
+struct PathIndex {
+    surfaces: String,
+    /// `(surface hash, path index, surface byte range)`, sorted by hash then
+    /// index.
+    entries: Vec<(u64, u32, u32, u32)>,
+}
+
+impl PathIndex {
+    fn build(paths: &[ScoredPath]) -> Self {
+        let mut surfaces = String::new();
+        let mut entries = Vec::with_capacity(paths.len());
+        for (i, p) in paths.iter().enumerate() {
+            let start = surfaces.len();
+            for seg in &p.segments {
+                surfaces.push_str(&seg.surface);
+            }
+            entries.push((
+                surface_hash(p),
+                i as u32,
+                start as u32,
+                surfaces.len() as u32,
+            ));
+        }
+        entries.sort_unstable();
+        Self { surfaces, entries }
+    }
+
+    fn find(&self, path: &ScoredPath) -> Option<usize> {
+        let hash = surface_hash(path);
+        let lo = self.entries.partition_point(|e| e.0 < hash);
+        let hi = self.entries.partition_point(|e| e.0 <= hash);
+        self.entries[lo..hi]
+            .iter()
+            .rev()
+            .find(|e| path.surface_key_eq(&self.surfaces[e.2 as usize..e.3 as usize]))
+            .map(|e| e.1 as usize)
+    }
+}
+
+/// FNV-1a over the concatenated surface, independent of segmentation.
+fn surface_hash(path: &ScoredPath) -> u64 {
+    let mut hash = 0xcbf2_9ce4_8422_2325_u64;
+    for seg in &path.segments {
+        for &b in seg.surface.as_bytes() {
+            hash = (hash ^ u64::from(b)).wrapping_mul(0x0100_0000_01b3);
+        }
+    }
+    hash
+}
+
 /// Diagnostic observer.
 ///
-/// Keys are `ScoredPath::surface_key()` — i.e. the concatenated surface — so
-/// that lookups survive `group_segments` (which merges adjacent segments but
-/// preserves the overall surface). Paths that only appear after history_rerank
-/// (rewriter-added candidates: numeric, katakana, kanji variants) are absent
-/// from these maps and fall back to zero in the caller.
+/// Snapshots are stored by the path's index in the slice each hook saw, and
+/// [`PathIndex`] maps a final path back to that index. Paths that only appear
+/// after history_rerank (rewriter-added candidates: numeric, katakana, kanji
+/// variants) have no index and fall back to zero in [`Self::resolve`].
 struct ExplainObserver<'a> {
     history: Option<&'a UserHistory>,
     /// Needed so the displayed breakdown matches `history_rerank`'s
     /// function-word exclusion for per-segment unigram boosts.
     conn: Option<&'a ConnectionMatrix>,
+    history_settings: &'a HistorySettings,
     now: u64,
     /// viterbi_cost before resegment/rerank — the raw Viterbi output.
-    original_costs: HashMap<String, i64>,
+    original_costs: Vec<i64>,
+    viterbi_index: PathIndex,
     /// State at the post-rerank / pre-history-rerank boundary.
-    pre_history: HashMap<String, PreHistorySnapshot>,
+    pre_history: Vec<PreHistorySnapshot>,
+    rerank_index: PathIndex,
 }
 
 impl<'a> ExplainObserver<'a> {
-    fn new(history: Option<&'a UserHistory>, conn: Option<&'a ConnectionMatrix>, now: u64) -> Self {
+    fn new(
+        history: Option<&'a UserHistory>,
+        conn: Option<&'a ConnectionMatrix>,
+        history_settings: &'a HistorySettings,
+        now: u64,
+    ) -> Self {
         Self {
             history,
             conn,
+            history_settings,
             now,
-            original_costs: HashMap::new(),
-            pre_history: HashMap::new(),
+            original_costs: Vec::new(),
+            viterbi_index: PathIndex::default(),
+            pre_history: Vec::new(),
+            rerank_index: PathIndex::default(),
+        }
+    }
+
+    /// Attach the recorded snapshots to a final path.
+    fn resolve(&self, scored: ScoredPath) -> ExplainedPath {
+        // Rewriter-added candidates (numeric / katakana / kanji variants) are
+        // synthesised after history_rerank and have no snapshot, so they fall
+        // back to zero history boost and use the final cost for `viterbi_cost`.
+        let viterbi_cost = self
+            .viterbi_index
+            .find(&scored)
+            .map_or(scored.viterbi_cost, |i| self.original_costs[i]);
+        let snapshot = match self.rerank_index.find(&scored) {
+            Some(i) => self.pre_history[i],
+            None => PreHistorySnapshot {
+                cost: viterbi_cost,
+                breakdown: HistoryBoostBreakdown::default(),
+                applied_boost: 0,
+                segment_count: scored.segments.len(),
+            },
+        };
+        ExplainedPath {
+            scored,
+            viterbi_cost,
+            snapshot,
         }
     }
 }
 
 impl PostprocessObserver for ExplainObserver<'_> {
     fn after_viterbi(&mut self, paths: &[ScoredPath]) {
-        self.original_costs = paths
-            .iter()
-            .map(|p| (p.surface_key(), p.viterbi_cost))
-            .collect();
+        self.original_costs = paths.iter().map(|p| p.viterbi_cost).collect();
+        self.viterbi_index = PathIndex::build(paths);
     }
 
     fn after_rerank(&mut self, paths: &[ScoredPath]) {
-        self.pre_history.clear();
-        for p in paths {
-            let (breakdown, applied) = match self.history {
-                Some(h) => {
-                    let b = compute_history_boost(p, h, self.conn, self.now);
-                    let a = b.applied(p.segments.len());
-                    (b, a)
-                }
-                None => (HistoryBoostBreakdown::default(), 0),
-            };
-            self.pre_history.insert(
-                p.surface_key(),
+        self.pre_history = paths
+            .iter()
+            .map(|p| {
+                let (breakdown, applied) = match self.history {
+                    Some(h) => {
+                        let b =
+                            compute_history_boost(p, h, self.history_settings, self.conn, self.now);
+                        let a = b.applied(p.segments.len());
+                        (b, a)
+                    }
+                    None => (HistoryBoostBreakdown::default(), 0),
+                };
                 PreHistorySnapshot {
                     cost: p.viterbi_cost,
                     breakdown,
                     applied_boost: applied,
                     segment_count: p.segments.len(),
-                },
-            );
-        }
+                }
+            })
+            .collect();
+        self.rerank_index = PathIndex::build(paths);
     }
 }
 
@@ -197,6 +362,7 @@ fn explain_segments(
     scored: &ScoredPath,
     conn: Option<&ConnectionMatrix>,
     dict: &dyn Dictionary,
+    settings: &Settings,
 ) -> Vec<ExplainSegment> {
     scored
         .segments
@@ -216,7 +382,7 @@ fn explain_segments(
             };
             let te_penalty = if let Some(c) = conn {
                 if is_te_form_kanji_penalised(seg, prev_seg, c) {
-                    settings().reranker.te_form_kanji_penalty
+                    settings.reranker.te_form_kanji_penalty
                 } else {
                     0
                 }
@@ -225,7 +391,7 @@ fn explain_segments(
             };
             let sc_penalty = if let Some(c) = conn {
                 if is_single_char_kanji_penalised(seg, i, &scored.segments, c, Some(dict)) {
-                    settings().reranker.single_char_kanji_penalty
+                    settings.reranker.single_char_kanji_penalty
                 } else {
                     0
                 }
@@ -236,8 +402,8 @@ fn explain_segments(
                 reading: seg.reading.clone(),
                 surface: seg.surface.clone(),
                 word_cost: seg.word_cost as i64,
-                segment_penalty: settings().cost.segment_penalty,
-                script_cost: script_cost(&seg.surface, seg.reading.chars().count()),
+                segment_penalty: settings.cost.segment_penalty,
+                script_cost: script_cost(&seg.surface, seg.reading.chars().count(), &settings.cost),
                 connection_cost: connection,
                 te_form_kanji_penalty: te_penalty,
                 single_char_kanji_penalty: sc_penalty,
@@ -252,207 +418,354 @@ fn explain_segments(
 // Public API
 // ---------------------------------------------------------------------------
 
-/// Run the full conversion pipeline and capture detailed cost breakdown.
+/// A final path together with the snapshots the observer recorded for it.
+struct ExplainedPath {
+    scored: ScoredPath,
+    viterbi_cost: i64,
+    snapshot: PreHistorySnapshot,
+}
+
+/// Pipeline output for one reading, kept in the form it was computed in.
 ///
-/// Uses `postprocess_observed` to follow the exact same pipeline as
-/// production conversion, with an observer that records cost snapshots
-/// at each stage for diagnostic output.
-pub fn explain(
-    dict: &dyn Dictionary,
-    conn: Option<&ConnectionMatrix>,
-    history: Option<&UserHistory>,
-    kana: &str,
-    n: usize,
-) -> ExplainResult {
-    if kana.is_empty() || n == 0 {
-        return ExplainResult {
+/// Lattice nodes are read from the lattice and each path's segment breakdown
+/// is built only as it is written, so [`Self::write_text`] and the
+/// `Serialize` impl stream a report without materializing an
+/// [`ExplainResult`]. Serializing produces the same document as serializing
+/// [`Self::to_result`].
+pub struct Explanation<'a> {
+    dict: &'a dyn Dictionary,
+    conn: Option<&'a ConnectionMatrix>,
+    settings: Arc<Settings>,
+    reading: String,
+    lattice: Lattice,
+    paths: Vec<ExplainedPath>,
+    node_filter: NodeFilter,
+}
+
+impl<'a> Explanation<'a> {
+    /// Run the full conversion pipeline and capture detailed cost breakdown.
+    ///
+    /// Uses `postprocess_observed` to follow the exact same pipeline as
+    /// production conversion, with an observer that records cost snapshots
+    /// at each stage for diagnostic output.
+    pub fn new(
+        dict: &'a dyn Dictionary,
+        conn: Option<&'a ConnectionMatrix>,
+        history: Option<&UserHistory>,
+        kana: &str,
+        n: usize,
+    ) -> Self {
+        let settings = settings();
+        let (lattice, paths) = if kana.is_empty() || n == 0 {
+            (Lattice::empty(), Vec::new())
+        } else {
+            let lattice = build_lattice_with(dict, kana, Arc::clone(&settings));
+            let cost_fn = DefaultCostFunction::new(conn, &settings.cost);
+            let oversample = budgeted_n(
+                &lattice,
+                (n * 3).max(50),
+                settings.limits.viterbi_work_budget,
+            );
+            let mut raw_paths = viterbi_nbest(&lattice, &cost_fn, oversample);
+
+            let now = crate::user_history::now_epoch();
+            let mut observer = ExplainObserver::new(history, conn, &settings.history, now);
+            let ctx = PostprocessContext {
+                lattice: &lattice,
+                conn,
+                dict: Some(dict),
+                history,
+                kana,
+                n,
+                now,
+                settings: &settings,
+            };
+            let final_paths = postprocess_observed(&mut raw_paths, &ctx, &mut observer);
+            let paths = final_paths
+                .into_iter()
+                .map(|scored| observer.resolve(scored))
+                .collect();
+            (lattice, paths)
+        };
+        Self {
+            dict,
+            conn,
+            settings,
             reading: kana.to_string(),
-            lattice_char_count: 0,
-            lattice_nodes: Vec::new(),
-            paths: Vec::new(),
+            lattice,
+            paths,
+            node_filter: NodeFilter::All,
+        }
+    }
+
+    /// Restrict the lattice nodes that are reported.
+    pub fn set_node_filter(&mut self, filter: NodeFilter) {
+        self.node_filter = filter;
+    }
+
+    /// Keep only the paths whose concatenated surface satisfies `keep`.
+    pub fn retain_paths(&mut self, mut keep: impl FnMut(&str) -> bool) {
+        self.paths.retain(|p| keep(&p.scored.surface_key()));
+    }
+
+    /// Keep at most the first `n` paths.
+    pub fn truncate_paths(&mut self, n: usize) {
+        self.paths.truncate(n);
+    }
+
+    /// Number of lattice nodes the node filter keeps.
+    pub fn node_count(&self) -> usize {
+        self.nodes().count()
+    }
+
+    fn nodes(&self) -> impl Iterator<Item = NodeView<'_>> + '_ {
+        let count = match self.node_filter {
+            NodeFilter::None => 0,
+            _ => self.lattice.node_count(),
         };
+        (0..count)
+            .filter(|&idx| self.node_filter.keeps(&self.lattice, idx))
+            .map(|idx| NodeView::from_lattice(&self.lattice, idx))
     }
 
-    let lattice = build_lattice(dict, kana);
-    let lattice_nodes: Vec<ExplainNode> = (0..lattice.node_count())
-        .map(|idx| ExplainNode::from_lattice(&lattice, idx))
-        .collect();
-
-    let cost_fn = DefaultCostFunction::new(conn);
-    let oversample = (n * 3).max(50);
-    let mut raw_paths = viterbi_nbest(&lattice, &cost_fn, oversample);
-
-    let now = crate::user_history::now_epoch();
-    let mut observer = ExplainObserver::new(history, conn, now);
-    let ctx = PostprocessContext {
-        lattice: &lattice,
-        conn,
-        dict: Some(dict),
-        history,
-        kana,
-        n,
-        now,
-    };
-    let final_paths = postprocess_observed(&mut raw_paths, &ctx, &mut observer);
+    fn explain_path(&self, path: &ExplainedPath) -> ExplainPath {
+        let snapshot = &path.snapshot;
+        ExplainPath {
+            segments: explain_segments(&path.scored, self.conn, self.dict, &self.settings),
+            viterbi_cost: path.viterbi_cost,
+            rerank_delta: snapshot.cost - path.viterbi_cost,
+            history_breakdown: snapshot.breakdown,
+            history_boost: snapshot.applied_boost,
+            history_segment_count: snapshot.segment_count,
+            final_cost: path.scored.viterbi_cost,
+        }
+    }
 
-    let paths: Vec<ExplainPath> = final_paths
-        .iter()
-        .map(|scored| {
-            let key = scored.surface_key();
-            // Look up snapshots by surface_key — preserved through group_segments.
-            // Rewriter-added candidates (numeric / katakana / kanji variants) are
-            // synthesised after history_rerank and have no snapshot, so they fall
-            // back to zero history boost and use the final cost for `viterbi_cost`.
-            let original = observer
-                .original_costs
-                .get(&key)
-                .copied()
-                .unwrap_or(scored.viterbi_cost);
-            let snapshot = observer
-                .pre_history
-                .get(&key)
-                .copied()
-                .unwrap_or(PreHistorySnapshot {
-                    cost: original,
-                    breakdown: HistoryBoostBreakdown::default(),
-                    applied_boost: 0,
-                    segment_count: scored.segments.len(),
-                });
-            ExplainPath {
-                segments: explain_segments(scored, conn, dict),
-                viterbi_cost: original,
-                rerank_delta: snapshot.cost - original,
-                history_breakdown: snapshot.breakdown,
-                history_boost: snapshot.applied_boost,
-                history_segment_count: snapshot.segment_count,
-                final_cost: scored.viterbi_cost,
+    /// Materialize the report.
+    pub fn to_result(&self) -> ExplainResult {
+        ExplainResult {
+            reading: self.reading.clone(),
+            lattice_char_count: self.lattice.char_count,
+            lattice_nodes: self.nodes().map(NodeView::into_node).collect(),
+            paths: self.paths.iter().map(|p| self.explain_path(p)).collect(),
+        }
+    }
+
+    /// Write the report in the format of [`format_text`].
+    pub fn write_text<W: Write>(&self, out: &mut W) -> io::Result<()> {
+        write_lattice_header(
+            out,
+            &self.reading,
+            self.lattice.char_count,
+            self.node_count(),
+        )?;
+        if !matches!(self.node_filter, NodeFilter::None) {
+            for (pos, indices) in self.lattice.nodes_by_start.iter().enumerate() {
+                let mut kept = indices
+                    .iter()
+                    .filter(|&&idx| self.node_filter.keeps(&self.lattice, idx))
+                    .peekable();
+                if kept.peek().is_none() {
+                    continue;
+                }
+                writeln!(out, "  Position {}:", pos)?;
+                for &idx in kept {
+                    write_node(out, &NodeView::from_lattice(&self.lattice, idx))?;
+                }
             }
-        })
-        .collect();
+        }
 
-    ExplainResult {
-        reading: kana.to_string(),
-        lattice_char_count: lattice.char_count,
-        lattice_nodes,
-        paths,
+        write_paths_header(out, self.paths.len())?;
+        for (i, path) in self.paths.iter().enumerate() {
+            write_path(out, i + 1, &self.explain_path(path))?;
+        }
+        Ok(())
     }
 }
 
+impl Serialize for Explanation<'_> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        struct Nodes<'e, 'a>(&'e Explanation<'a>);
+        impl Serialize for Nodes<'_, '_> {
+            fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+                serializer.collect_seq(self.0.nodes())
+            }
+        }
+
+        struct Paths<'e, 'a>(&'e Explanation<'a>);
+        impl Serialize for Paths<'_, '_> {
+            fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+                serializer.collect_seq(self.0.paths.iter().map(|p| self.0.explain_path(p)))
+            }
+        }
+
+        let mut s = serializer.serialize_struct("ExplainResult", 4)?;
+        s.serialize_field("reading", &self.reading)?;
+        s.serialize_field("lattice_char_count", &self.lattice.char_count)?;
+        s.serialize_field("lattice_nodes", &Nodes(self))?;
+        s.serialize_field("paths", &Paths(self))?;
+        s.end()
+    }
+}
+
+/// Run the full conversion pipeline and capture detailed cost breakdown.
+///
+/// Materializes the whole [`Explanation`]; prefer streaming it for long
+/// readings.
+pub fn explain(
+    dict: &dyn Dictionary,
+    conn: Option<&ConnectionMatrix>,
+    history: Option<&UserHistory>,
+    kana: &str,
+    n: usize,
+) -> ExplainResult {
+    Explanation::new(dict, conn, history, kana, n).to_result()
+}
+
+// ---------------------------------------------------------------------------
+// Text formatting
+// ---------------------------------------------------------------------------
+
 /// Format an ExplainResult as human-readable text.
 pub fn format_text(result: &ExplainResult) -> String {
-    use unicode_width::UnicodeWidthStr;
-    let mut out = String::new();
+    let mut out = Vec::new();
+    write_result_text(&mut out, result).expect("writing to a Vec cannot fail");
+    String::from_utf8(out).expect("report is built from UTF-8 strings")
+}
 
-    out.push_str(&format!(
-        "=== Lattice for \"{}\" ({} chars, {} nodes) ===\n",
-        result.reading,
+fn write_result_text<W: Write>(out: &mut W, result: &ExplainResult) -> io::Result<()> {
+    write_lattice_header(
+        out,
+        &result.reading,
         result.lattice_char_count,
         result.lattice_nodes.len(),
-    ));
+    )?;
 
-    // Group nodes by start position
-    let max_pos = result
-        .lattice_nodes
-        .iter()
-        .map(|n| n.start)
-        .max()
-        .unwrap_or(0);
-    for pos in 0..=max_pos {
-        let nodes_at_pos: Vec<&ExplainNode> = result
-            .lattice_nodes
-            .iter()
-            .filter(|n| n.start == pos)
-            .collect();
-        if nodes_at_pos.is_empty() {
-            continue;
-        }
-        out.push_str(&format!("  Position {}:\n", pos));
-        for n in &nodes_at_pos {
-            let surface_display = if n.surface != n.reading {
-                format!(" -> {}", n.surface)
-            } else {
-                String::new()
-            };
-            out.push_str(&format!(
-                "    [{},{}] {}  cost={:<6} L={:<4} R={:<4}{}\n",
-                n.start, n.end, n.reading, n.cost, n.left_id, n.right_id, surface_display,
-            ));
+    // Group nodes by start position (stable, so lattice order is kept within
+    // a position).
+    let mut nodes: Vec<&ExplainNode> = result.lattice_nodes.iter().collect();
+    nodes.sort_by_key(|n| n.start);
+    for (i, n) in nodes.iter().enumerate() {
+        if i == 0 || nodes[i - 1].start != n.start {
+            writeln!(out, "  Position {}:", n.start)?;
         }
+        write_node(out, &n.view())?;
     }
 
-    if result.paths.is_empty() {
-        out.push_str("\nNo paths found.\n");
-        return out;
+    write_paths_header(out, result.paths.len())?;
+    for (i, path) in result.paths.iter().enumerate() {
+        write_path(out, i + 1, path)?;
     }
+    Ok(())
+}
 
-    out.push_str(&format!("\n=== Paths ({}) ===\n", result.paths.len()));
-    for (i, path) in result.paths.iter().enumerate() {
-        let surface = path.surface();
-        out.push_str(&format!(
-            "\n  #{:<2} {}  (final_cost={})\n",
-            i + 1,
-            surface,
-            path.final_cost,
-        ));
-
-        for (j, seg) in path.segments.iter().enumerate() {
-            let seg_label = if seg.surface != seg.reading {
-                format!("{}({})", seg.surface, seg.reading)
-            } else {
-                seg.surface.clone()
-            };
-            let pad_width = 16;
-            let display_width = UnicodeWidthStr::width(seg_label.as_str());
-            let padded = if display_width < pad_width {
-                format!("{}{}", seg_label, " ".repeat(pad_width - display_width))
-            } else {
-                seg_label
-            };
-            let conn_label = if j == 0 { "BOS->" } else { "conn=" };
-            let te_str = if seg.te_form_kanji_penalty > 0 {
-                format!(" teK={:<+6}", seg.te_form_kanji_penalty)
-            } else {
-                String::new()
-            };
-            let single_char_str = if seg.single_char_kanji_penalty > 0 {
-                format!(" 1charK={:<+6}", seg.single_char_kanji_penalty)
-            } else {
-                String::new()
-            };
-            out.push_str(&format!(
-                "    seg[{}]: {} word={:<6} penalty={:<5} script={:<6} {}{}{}{}\n",
-                j,
-                padded,
-                seg.word_cost,
-                seg.segment_penalty,
-                seg.script_cost,
-                conn_label,
-                seg.connection_cost,
-                te_str,
-                single_char_str,
-            ));
-        }
+fn write_lattice_header<W: Write>(
+    out: &mut W,
+    reading: &str,
+    char_count: usize,
+    node_count: usize,
+) -> io::Result<()> {
+    writeln!(
+        out,
+        "=== Lattice for \"{}\" ({} chars, {} nodes) ===",
+        reading, char_count, node_count,
+    )
+}
 
-        out.push_str(&format!(
-            "    viterbi={:<8} rerank={:<+8} history={:<+8} -> final={}\n",
-            path.viterbi_cost, path.rerank_delta, -path.history_boost, path.final_cost,
-        ));
-        let hb = &path.history_breakdown;
-        if hb.unigram_sum != 0 || hb.bigram_sum != 0 || hb.whole_path_boost != 0 {
-            out.push_str(&format!(
-                "      history: uni_sum={:<+7} bi_sum={:<+7} whole×5={:<+7} (/{} segs)\n",
-                -hb.unigram_sum, -hb.bigram_sum, -hb.whole_path_boost, path.history_segment_count,
-            ));
-        }
+fn write_node<W: Write>(out: &mut W, n: &NodeView<'_>) -> io::Result<()> {
+    let surface_display = if n.surface != n.reading {
+        format!(" -> {}", n.surface)
+    } else {
+        String::new()
+    };
+    writeln!(
+        out,
+        "    [{},{}] {}  cost={:<6} L={:<4} R={:<4}{}",
+        n.start, n.end, n.reading, n.cost, n.left_id, n.right_id, surface_display,
+    )
+}
+
+fn write_paths_header<W: Write>(out: &mut W, path_count: usize) -> io::Result<()> {
+    if path_count == 0 {
+        writeln!(out, "\nNo paths found.")
+    } else {
+        writeln!(out, "\n=== Paths ({}) ===", path_count)
+    }
+}
+
+fn write_path<W: Write>(out: &mut W, rank: usize, path: &ExplainPath) -> io::Result<()> {
+    use unicode_width::UnicodeWidthStr;
+
+    writeln!(
+        out,
+        "\n  #{:<2} {}  (final_cost={})",
+        rank,
+        path.surface(),
+        path.final_cost,
+    )?;
+
+    for (j, seg) in path.segments.iter().enumerate() {
+        let seg_label = if seg.surface != seg.reading {
+            format!("{}({})", seg.surface, seg.reading)
+        } else {
+            seg.surface.clone()
+        };
+        let pad_width = 16;
+        let display_width = UnicodeWidthStr::width(seg_label.as_str());
+        let padded = if display_width < pad_width {
+            format!("{}{}", seg_label, " ".repeat(pad_width - display_width))
+        } else {
+            seg_label
+        };
+        let conn_label = if j == 0 { "BOS->" } else { "conn=" };
+        let te_str = if seg.te_form_kanji_penalty > 0 {
+            format!(" teK={:<+6}", seg.te_form_kanji_penalty)
+        } else {
+            String::new()
+        };
+        let single_char_str = if seg.single_char_kanji_penalty > 0 {
+            format!(" 1charK={:<+6}", seg.single_char_kanji_penalty)
+        } else {
+            String::new()
+        };
+        writeln!(
+            out,
+            "    seg[{}]: {} word={:<6} penalty={:<5} script={:<6} {}{}{}{}",
+            j,
+            padded,
+            seg.word_cost,
+            seg.segment_penalty,
+            seg.script_cost,
+            conn_label,
+            seg.connection_cost,
+            te_str,
+            single_char_str,
+        )?;
     }
 
-    out
+    writeln!(
+        out,
+        "    viterbi={:<8} rerank={:<+8} history={:<+8} -> final={}",
+        path.viterbi_cost, path.rerank_delta, -path.history_boost, path.final_cost,
+    )?;
+    let hb = &path.history_breakdown;
+    if hb.unigram_sum != 0 || hb.bigram_sum != 0 || hb.whole_path_boost != 0 {
+        writeln!(
+            out,
+            "      history: uni_sum={:<+7} bi_sum={:<+7} whole×5={:<+7} (/{} segs)",
+            -hb.unigram_sum, -hb.bigram_sum, -hb.whole_path_boost, path.history_segment_count,
+        )?;
+    }
+    Ok(())
 }
 
 #[cfg(test)]
 mod tests {
+    use std::collections::HashMap;
+
     use super::*;
-    use crate::converter::testutil::test_dict;
+    use crate::converter::build_lattice;
+    use crate::converter::testutil::{test_dict, zero_conn_with_fw};
     use crate::user_history::UserHistory;
 
     #[test]
@@ -606,4 +919,260 @@ mod tests {
             }
         }
     }
+
+    /// Observer as it was before snapshots were indexed: maps keyed by
+    /// surface string.
+    struct SurfaceKeyedObserver<'a> {
+        history: Option<&'a UserHistory>,
+        conn: Option<&'a ConnectionMatrix>,
+        history_settings: &'a HistorySettings,
+        now: u64,
+        original_costs: HashMap<String, i64>,
+        pre_history: HashMap<String, PreHistorySnapshot>,
+    }
+
+    impl PostprocessObserver for SurfaceKeyedObserver<'_> {
+        fn after_viterbi(&mut self, paths: &[ScoredPath]) {
+            self.original_costs = paths
+                .iter()
+                .map(|p| (p.surface_key(), p.viterbi_cost))
+                .collect();
+        }
+
+        fn after_rerank(&mut self, paths: &[ScoredPath]) {
+            self.pre_history.clear();
+            for p in paths {
+                let (breakdown, applied) = match self.history {
+                    Some(h) => {
+                        let b =
+                            compute_history_boost(p, h, self.history_settings, self.conn, self.now);
+                        let a = b.applied(p.segments.len());
+                        (b, a)
+                    }
+                    None => (HistoryBoostBreakdown::default(), 0),
+                };
+                self.pre_history.insert(
+                    p.surface_key(),
+                    PreHistorySnapshot {
+                        cost: p.viterbi_cost,
+                        breakdown,
+                        applied_boost: applied,
+                        segment_count: p.segments.len(),
+                    },
+                );
+            }
+        }
+    }
+
+    /// The materializing `explain` the streaming report replaced.
+    fn reference_explain(
+        dict: &dyn Dictionary,
+        conn: Option<&ConnectionMatrix>,
+        history: Option<&UserHistory>,
+        kana: &str,
+        n: usize,
+    ) -> ExplainResult {
+        let lattice = build_lattice(dict, kana);
+        let lattice_nodes = (0..lattice.node_count())
+            .map(|idx| NodeView::from_lattice(&lattice, idx).into_node())
+            .collect();
+
+        let settings = settings();
+        let cost_fn = DefaultCostFunction::new(conn, &settings.cost);
+        let mut raw_paths = viterbi_nbest(&lattice, &cost_fn, (n * 3).max(50));
+        let now = crate::user_history::now_epoch();
+        let mut observer = SurfaceKeyedObserver {
+            history,
+            conn,
+            history_settings: &settings.history,
+            now,
+            original_costs: HashMap::new(),
+            pre_history: HashMap::new(),
+        };
+        let ctx = PostprocessContext {
+            lattice: &lattice,
+            conn,
+            dict: Some(dict),
+            history,
+            kana,
+            n,
+            now,
+            settings: &settings,
+        };
+        let final_paths = postprocess_observed(&mut raw_paths, &ctx, &mut observer);
+
+        let paths = final_paths
+            .iter()
+            .map(|scored| {
+                let key = scored.surface_key();
+                let original = observer
+                    .original_costs
+                    .get(&key)
+                    .copied()
+                    .unwrap_or(scored.viterbi_cost);
+                let snapshot =
+                    observer
+                        .pre_history
+                        .get(&key)
+                        .copied()
+                        .unwrap_or(PreHistorySnapshot {
+                            cost: original,
+                            breakdown: HistoryBoostBreakdown::default(),
+                            applied_boost: 0,
+                            segment_count: scored.segments.len(),
+                        });
+                ExplainPath {
+                    segments: explain_segments(scored, conn, dict, &settings),
+                    viterbi_cost: original,
+                    rerank_delta: snapshot.cost - original,
+                    history_breakdown: snapshot.breakdown,
+                    history_boost: snapshot.applied_boost,
+                    history_segment_count: snapshot.segment_count,
+                    final_cost: scored.viterbi_cost,
+                }
+            })
+            .collect();
+
+        ExplainResult {
+            reading: kana.to_string(),
+            lattice_char_count: lattice.char_count,
+            lattice_nodes,
+            paths,
+        }
+    }
+
+    const FIXTURE_READINGS: &[&str] = &[
+        "きょう",
+        "きょうは",
+        "きょうはいいてんき",
+        "きょうはいいてんきですね",
+        "わたしはがくせいです",
+        "てんきてんき",
+        "ぬ",
+    ];
+
+    fn stream_json(explanation: &Explanation<'_>) -> String {
+        String::from_utf8(serde_json::to_vec_pretty(explanation).unwrap()).unwrap()
+    }
+
+    fn stream_text(explanation: &Explanation<'_>) -> String {
+        let mut out = Vec::new();
+        explanation.write_text(&mut out).unwrap();
+        String::from_utf8(out).unwrap()
+    }
+
+    #[test]
+    fn test_streamed_output_matches_materialized_on_fixtures() {
+        let dict = test_dict();
+        // は (id 200) is a function word, so grouping merges segments and the
+        // snapshot lookup has to survive it.
+        let conn = zero_conn_with_fw(500, 200, 200);
+        let mut h = UserHistory::new();
+        h.record(&[("きょう".into(), "京".into())]);
+        h.record(&[("てんき".into(), "天気".into()), ("き".into(), "木".into())]);
+
+        for &reading in FIXTURE_READINGS {
+            for conn in [None, Some(&conn)] {
+                for history in [None, Some(&h)] {
+                    for n in [1, 5, 20] {
+                        let expected = reference_explain(&dict, conn, history, reading, n);
+                        let streamed = Explanation::new(&dict, conn, history, reading, n);
+                        assert_eq!(
+                            stream_json(&streamed),
+                            serde_json::to_string_pretty(&expected).unwrap(),
+                            "JSON for {reading}, n = {n}"
+                        );
+                        assert_eq!(
+                            stream_text(&streamed),
+                            format_text(&expected),
+                            "text for {reading}, n = {n}"
+                        );
+                        assert_eq!(
+                            serde_json::to_string_pretty(&streamed.to_result()).unwrap(),
+                            stream_json(&streamed),
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_streamed_empty_reading_matches_materialized() {
+        let dict = test_dict();
+        for (reading, n) in [("", 5), ("きょう", 0)] {
+            let streamed = Explanation::new(&dict, None, None, reading, n);
+            let expected = explain(&dict, None, None, reading, n);
+            assert_eq!(
+                stream_json(&streamed),
+                serde_json::to_string_pretty(&expected).unwrap()
+            );
+            assert_eq!(stream_text(&streamed), format_text(&expected));
+        }
+    }
+
+    #[test]
+    fn test_node_filter() {
+        let dict = test_dict();
+        let reading = "きょうはいいてんき";
+        let full = reference_explain(&dict, None, None, reading, 5);
+
+        type Keep = fn(&ExplainNode) -> bool;
+        let cases: Vec<(NodeFilter, Keep)> = vec![
+            (NodeFilter::All, |_| true),
+            (NodeFilter::None, |_| false),
+            (
+                NodeFilter::Matching {
+                    span: Some(3..5),
+                    surface: None,
+                },
+                |n| n.start < 5 && n.end > 3,
+            ),
+            (
+                NodeFilter::Matching {
+                    span: None,
+                    surface: Some("天".into()),
+                },
+                |n| n.surface.contains('天'),
+            ),
+            (
+                NodeFilter::Matching {
+                    span: Some(6..9),
+                    surface: Some("き".into()),
+                },
+                |n| n.start < 9 && n.end > 6 && n.surface.contains('き'),
+            ),
+        ];
+        for (filter, keep) in cases {
+            let mut streamed = Explanation::new(&dict, None, None, reading, 5);
+            streamed.set_node_filter(filter.clone());
+            let mut expected = reference_explain(&dict, None, None, reading, 5);
+            expected.lattice_nodes.retain(keep);
+            assert!(expected.lattice_nodes.len() <= full.lattice_nodes.len());
+            assert_eq!(streamed.node_count(), expected.lattice_nodes.len());
+            assert_eq!(
+                stream_json(&streamed),
+                serde_json::to_string_pretty(&expected).unwrap(),
+                "{filter:?}"
+            );
+            assert_eq!(stream_text(&streamed), format_text(&expected), "{filter:?}");
+        }
+    }
+
+    #[test]
+    fn test_retain_and_truncate_paths() {
+        let dict = test_dict();
+        let mut streamed = Explanation::new(&dict, None, None, "きょうはいいてんき", 20);
+        streamed.retain_paths(|s| s.contains("天気"));
+        streamed.truncate_paths(2);
+
+        let mut expected = reference_explain(&dict, None, None, "きょうはいいてんき", 20);
+        expected.paths.retain(|p| p.surface().contains("天気"));
+        expected.paths.truncate(2);
+        assert!(!expected.paths.is_empty());
+        assert_eq!(
+            stream_json(&streamed),
+            serde_json::to_string_pretty(&expected).unwrap()
+        );
+    }
 }
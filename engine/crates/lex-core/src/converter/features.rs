@@ -5,6 +5,7 @@
 
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
+use crate::settings::{CostSettings, RerankerSettings};
 use crate::unicode::is_kanji;
 
 use super::cost::{conn_cost, script_cost};
@@ -95,13 +96,17 @@ impl FeatureWeights {
     /// `structure` and `script` are compile-time constants (not in settings)
     /// because grid search showed no benefit from varying them.
     pub fn from_settings() -> Self {
-        let s = crate::settings::settings();
+        Self::from_reranker(&crate::settings::settings().reranker)
+    }
+
+    /// Build weights from an already-captured reranker settings snapshot.
+    pub fn from_reranker(r: &RerankerSettings) -> Self {
         Self {
             structure: STRUCTURE_WEIGHT,
-            length_variance: s.reranker.length_variance_weight,
+            length_variance: r.length_variance_weight,
             script: SCRIPT_WEIGHT,
-            te_kanji: s.reranker.te_form_kanji_penalty,
-            single_kanji: s.reranker.single_char_kanji_penalty,
+            te_kanji: r.te_form_kanji_penalty,
+            single_kanji: r.single_char_kanji_penalty,
         }
     }
 }
@@ -184,6 +189,8 @@ pub fn compute_structure_cost(
 pub struct FeatureConfig<'a> {
     pub conn: Option<&'a ConnectionMatrix>,
     pub dict: Option<&'a dyn Dictionary>,
+    /// Script-cost table from the conversion's settings snapshot.
+    pub cost: &'a CostSettings,
     pub structure_cap: i64,
     pub prefix_floor: i64,
 }
@@ -246,7 +253,7 @@ pub fn extract_features(
     f.script_cost = path
         .segments
         .iter()
-        .map(|s| script_cost(&s.surface, s.reading.chars().count()))
+        .map(|s| script_cost(&s.surface, s.reading.chars().count(), cfg.cost))
         .sum();
 
     // Per-segment features
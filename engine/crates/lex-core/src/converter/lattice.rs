@@ -1,7 +1,10 @@
+use std::collections::HashMap;
+use std::sync::Arc;
+
 use tracing::{debug, debug_span};
 
-use crate::dict::Dictionary;
-use crate::settings::settings;
+use crate::dict::{Dictionary, SharedSearchResult};
+use crate::settings::{settings, Settings};
 
 use super::viterbi::RichSegment;
 
@@ -49,9 +52,52 @@ pub struct Lattice {
     pub nodes_by_start: Vec<Vec<usize>>,
     /// Number of characters in input
     pub char_count: usize,
-    /// Longest reading (in chars) seen during lattice construction.
-    /// Used by `extend` to bound the lookback window.
-    max_reading_chars: usize,
+    /// Settings snapshot the lattice was built with. Splices and extensions
+    /// keep it, and conversions of the lattice score against it, so one
+    /// conversion never mixes two configurations.
+    settings: Arc<Settings>,
+    /// Dictionary nodes kept per start position, cheapest first; `splice`
+    /// builds with the same cap.
+    max_nodes_per_position: usize,
+    /// Dictionary entries left out by that cap, per start position.
+    dropped_by_start: Vec<u32>,
+}
+
+/// What [`Lattice::splice`] kept from the previous lattice.
+///
+/// Nodes ending at or before `start` see the same input from BOS as before,
+/// and nodes starting at or after `new_end` the same input up to EOS, so
+/// per-node state computed from either side can be carried over through
+/// [`Self::new_index`]. `ViterbiMemo` uses this.
+#[derive(Clone, Debug)]
+pub struct LatticeEdit {
+    /// Input the edit was applied to.
+    pub(crate) old_input: String,
+    /// Old node index → new node index, [`DROPPED`] for rebuilt nodes.
+    remap: Vec<u32>,
+    /// First changed character position, or an earlier one when the node
+    /// cap makes nodes before the change depend on it.
+    pub start: usize,
+    /// End of the replacement text in the new input.
+    pub new_end: usize,
+}
+
+/// `LatticeEdit::remap` entry of a node that was rebuilt.
+const DROPPED: u32 = u32::MAX;
+
+impl LatticeEdit {
+    /// Index in the new lattice of old node `idx`, if it was kept.
+    pub fn new_index(&self, idx: usize) -> Option<usize> {
+        match self.remap[idx] {
+            DROPPED => None,
+            i => Some(i as usize),
+        }
+    }
+
+    /// Node count of the lattice before the edit.
+    pub fn old_node_count(&self) -> usize {
+        self.remap.len()
+    }
 }
 
 impl Lattice {
@@ -73,7 +119,9 @@ impl Lattice {
             nodes_by_end: vec![Vec::new()],
             nodes_by_start: Vec::new(),
             char_count: 0,
-            max_reading_chars: 0,
+            settings: settings(),
+            max_nodes_per_position: usize::MAX,
+            dropped_by_start: Vec::new(),
         }
     }
 
@@ -81,7 +129,12 @@ impl Lattice {
     ///
     /// Estimates ~3 nodes per character (typical dictionary density) and
     /// ~10 bytes of string pool per node.
-    fn new(input: &str, char_count: usize) -> Self {
+    fn new(
+        input: &str,
+        char_count: usize,
+        settings: Arc<Settings>,
+        max_nodes_per_position: usize,
+    ) -> Self {
         let est_nodes = char_count * 3;
         let est_pool = est_nodes * 10;
         Self {
@@ -97,7 +150,9 @@ impl Lattice {
             nodes_by_end: vec![Vec::new(); char_count + 1],
             nodes_by_start: vec![Vec::new(); char_count],
             char_count,
-            max_reading_chars: 0,
+            settings,
+            max_nodes_per_position,
+            dropped_by_start: vec![0; char_count],
         }
     }
 
@@ -161,7 +216,7 @@ impl Lattice {
         nodes: &[(usize, usize, &str, &str, i16, u16, u16)],
     ) -> Self {
         let char_count = input.chars().count();
-        let mut lattice = Self::new(input, char_count);
+        let mut lattice = Self::new(input, char_count, settings(), usize::MAX);
         for &(start, end, reading, surface, cost, left_id, right_id) in nodes {
             lattice.push_node(
                 start..end,
@@ -182,6 +237,42 @@ impl Lattice {
         self.costs.len()
     }
 
+    /// Settings snapshot the lattice was built with.
+    pub fn settings(&self) -> &Arc<Settings> {
+        &self.settings
+    }
+
+    /// Dictionary entries left out because their start position already
+    /// had `max_nodes_per_position` cheaper nodes. Zero for any ordinary
+    /// reading; see [`crate::settings::LimitSettings`].
+    pub fn dropped_nodes(&self) -> usize {
+        self.dropped_by_start.iter().map(|&n| n as usize).sum()
+    }
+
+    /// Heap bytes reserved by this lattice (capacity, not length).
+    pub fn heap_bytes(&self) -> usize {
+        use std::mem::size_of;
+        let index_bytes = |table: &Vec<Vec<usize>>| {
+            table.capacity() * size_of::<Vec<usize>>()
+                + table
+                    .iter()
+                    .map(|v| v.capacity() * size_of::<usize>())
+                    .sum::<usize>()
+        };
+        self.input.capacity()
+            + self.starts.capacity() * size_of::<usize>()
+            + self.ends.capacity() * size_of::<usize>()
+            + self.costs.capacity() * size_of::<i16>()
+            + self.left_ids.capacity() * size_of::<u16>()
+            + self.right_ids.capacity() * size_of::<u16>()
+            + self.string_pool.capacity()
+            + self.reading_spans.capacity() * size_of::<StringSpan>()
+            + self.surface_spans.capacity() * size_of::<StringSpan>()
+            + index_bytes(&self.nodes_by_end)
+            + index_bytes(&self.nodes_by_start)
+            + self.dropped_by_start.capacity() * size_of::<u32>()
+    }
+
     /// Start position (char index, inclusive) of node `idx`.
     pub fn start(&self, idx: usize) -> usize {
         self.starts[idx]
@@ -231,66 +322,215 @@ impl Lattice {
     /// Extend the lattice with additional kana characters.
     ///
     /// `new_kana` must be an extension of `self.input` (i.e., start with the
-    /// same characters). Only new nodes are added:
-    /// - Existing positions near the boundary get new longer matches
-    /// - New positions get full dictionary search + fallback nodes
+    /// same characters). The appended positions are searched and nodes that
+    /// run from the last [`Dictionary::max_reading_len`] old positions into
+    /// the new text are added, all in place: existing nodes keep their
+    /// indices, so typing at the end costs O(max_word) per keystroke rather
+    /// than a copy of the whole lattice. The node set matches
+    /// `build_lattice(dict, new_kana)`; new nodes come after the old ones.
+    ///
+    /// Falls back to [`Self::splice`] when `new_kana` is not an append, or
+    /// when the node cap drops entries at a re-searched position, since the
+    /// appended text can then change which old nodes are kept.
     ///
-    /// This avoids rebuilding the entire lattice on each keystroke.
-    pub fn extend(&mut self, dict: &dyn Dictionary, new_kana: &str) {
+    /// Returns the edit for [`super::ViterbiMemo::apply_edit`].
+    pub fn extend(&mut self, dict: &dyn Dictionary, new_kana: &str) -> LatticeEdit {
         debug_assert!(
             new_kana.starts_with(&self.input),
             "extend: new_kana must start with current input"
         );
-        if !new_kana.starts_with(&self.input) {
-            // Precondition violated — rebuild from scratch instead of panicking.
-            *self = build_lattice(dict, new_kana);
-            return;
+        let old_n = self.char_count;
+        if new_kana == self.input {
+            return self.unchanged_edit(old_n);
         }
-        let old_char_count = self.char_count;
-        let new_char_count = new_kana.chars().count();
-        if new_char_count <= old_char_count {
-            return;
+        let lo = old_n.saturating_sub(dict.max_reading_len());
+        let byte_offsets: Vec<usize> = new_kana.char_indices().map(|(i, _)| i).collect();
+        let new_n = byte_offsets.len();
+
+        let lookback: Option<Vec<Vec<SharedSearchResult>>> = new_kana
+            .starts_with(&self.input)
+            .then(|| {
+                (lo..old_n)
+                    .map(|pos| dict.common_prefix_search_shared(&new_kana[byte_offsets[pos]..]))
+                    .collect()
+            })
+            .filter(|searches: &Vec<Vec<SharedSearchResult>>| {
+                (lo..old_n).zip(searches).all(|(pos, matches)| {
+                    let entries: usize = matches.iter().map(|m| m.entries.len()).sum();
+                    self.dropped_by_start[pos] == 0 && entries <= self.max_nodes_per_position
+                })
+            });
+        let Some(lookback) = lookback else {
+            let (next, edit) = self.splice(dict, new_kana);
+            *self = next;
+            return edit;
+        };
+
+        let _span = debug_span!("lattice_extend", old_n, new_n, lo).entered();
+        let edit = self.unchanged_edit(new_n);
+        self.input = new_kana.to_string();
+        self.char_count = new_n;
+        self.nodes_by_start.resize_with(new_n, Vec::new);
+        self.nodes_by_end.resize_with(new_n + 1, Vec::new);
+        self.dropped_by_start.resize(new_n, 0);
+
+        // Old positions already have their shorter matches and fallbacks;
+        // only matches reaching past the old end are new. They are at least
+        // two characters long, so the fallbacks stay as they are.
+        for (start, matches) in (lo..old_n).zip(&lookback) {
+            for result in matches {
+                let end = start + result.reading.chars().count();
+                if end <= old_n {
+                    continue;
+                }
+                let reading = self.pool(&result.reading);
+                for entry in result.entries.iter() {
+                    let surface = if entry.surface == result.reading {
+                        reading
+                    } else {
+                        PooledStr::New(&entry.surface)
+                    };
+                    self.push_node(
+                        start..end,
+                        reading,
+                        surface,
+                        entry.cost,
+                        entry.left_id,
+                        entry.right_id,
+                    );
+                }
+            }
         }
+        add_nodes_for_range(self, dict, new_kana, &byte_offsets, old_n, new_n);
 
-        let _span = debug_span!("lattice_extend", old_char_count, new_char_count).entered();
+        debug!(node_count = self.node_count());
+        edit
+    }
 
-        let byte_offsets: Vec<usize> = new_kana.char_indices().map(|(i, _)| i).collect();
+    /// An edit that keeps every node of this lattice at its index, with the
+    /// change starting at the current end.
+    fn unchanged_edit(&self, new_end: usize) -> LatticeEdit {
+        LatticeEdit {
+            old_input: self.input.clone(),
+            remap: (0..self.node_count() as u32).collect(),
+            start: self.char_count,
+            new_end,
+        }
+    }
 
-        // Update lattice metadata
-        self.input = new_kana.to_string();
-        self.char_count = new_char_count;
-        self.nodes_by_start.resize_with(new_char_count, Vec::new);
-        self.nodes_by_end.resize_with(new_char_count + 1, Vec::new);
-
-        // New positions first: full search + fallback nodes.
-        add_nodes_for_range(
-            self,
-            dict,
-            new_kana,
-            &byte_offsets,
-            old_char_count,
-            new_char_count,
-            None,
-        );
+    /// The lattice of `new_kana`, reusing the nodes of this one that cannot
+    /// differ.
+    ///
+    /// The edit is the span between the longest common character prefix and
+    /// suffix of the two inputs, so insertions, deletions and replacements
+    /// anywhere in the reading are handled alike. Nodes starting before the
+    /// edit by more than [`Dictionary::max_reading_len`] are kept as they are,
+    /// nodes starting after it are kept shifted to their new position, and
+    /// every start position in between is searched again. The result is
+    /// node-for-node identical to `build_lattice(dict, new_kana)`, in the
+    /// same order.
+    pub fn splice(&self, dict: &dyn Dictionary, new_kana: &str) -> (Lattice, LatticeEdit) {
+        let old_chars: Vec<char> = self.input.chars().collect();
+        let new_chars: Vec<char> = new_kana.chars().collect();
+        let (old_n, new_n) = (old_chars.len(), new_chars.len());
+        let prefix = old_chars
+            .iter()
+            .zip(&new_chars)
+            .take_while(|(a, b)| a == b)
+            .count();
+        let suffix = old_chars[prefix..]
+            .iter()
+            .rev()
+            .zip(new_chars[prefix..].iter().rev())
+            .take_while(|(a, b)| a == b)
+            .count();
+        let (old_end, new_end) = (old_n - suffix, new_n - suffix);
+        let lo = prefix.saturating_sub(dict.max_reading_len());
+
+        let _span = debug_span!("lattice_splice", old_n, new_n, lo, old_end, new_end).entered();
 
-        // Existing positions near the boundary: find new longer matches
-        // that extend into the appended suffix. Lookback is bounded by
-        // the longest reading observed so far (tracked in add_nodes_for_range)
-        // combined with the dictionary's declared max, keeping extend
-        // O(max_word) per keystroke rather than O(input_length).
-        let lookback = self.max_reading_chars.min(dict.max_reading_len());
-        let lookback_start = old_char_count.saturating_sub(lookback);
-        add_nodes_for_range(
-            self,
-            dict,
+        let byte_offsets: Vec<usize> = new_kana.char_indices().map(|(i, _)| i).collect();
+        let mut next = Lattice::new(
             new_kana,
-            &byte_offsets,
-            lookback_start,
-            old_char_count,
-            Some(old_char_count),
+            new_n,
+            Arc::clone(&self.settings),
+            self.max_nodes_per_position,
         );
+        let mut remap = vec![DROPPED; self.node_count()];
+        // Old pool span → new pool span, so shared strings stay shared.
+        let mut spans: HashMap<(u32, u16), StringSpan> = HashMap::new();
 
-        debug!(node_count = self.node_count());
+        for pos in 0..lo {
+            for &idx in &self.nodes_by_start[pos] {
+                remap[idx] = self.copy_node(&mut next, idx, (0, 0), &mut spans) as u32;
+            }
+            next.dropped_by_start[pos] = self.dropped_by_start[pos];
+        }
+
+        add_nodes_for_range(&mut next, dict, new_kana, &byte_offsets, lo, new_end);
+
+        // Starts in lo..prefix were searched again; the nodes that end
+        // within the common prefix come out the same and in the same order,
+        // unless the node cap picked them against longer matches that
+        // changed. Then the edit is reported as starting at `lo`.
+        let capped = (lo..prefix)
+            .any(|pos| self.dropped_by_start[pos] != 0 || next.dropped_by_start[pos] != 0);
+        let start = if capped { lo } else { prefix };
+        for pos in lo..start {
+            let kept = |l: &Lattice| -> Vec<usize> {
+                l.nodes_by_start[pos]
+                    .iter()
+                    .copied()
+                    .filter(|&i| l.ends[i] <= prefix)
+                    .collect()
+            };
+            let (old, new) = (kept(self), kept(&next));
+            debug_assert_eq!(old.len(), new.len(), "splice: prefix nodes at {pos}");
+            for (o, n) in old.into_iter().zip(new) {
+                remap[o] = n as u32;
+            }
+        }
+
+        for pos in old_end..old_n {
+            for &idx in &self.nodes_by_start[pos] {
+                remap[idx] = self.copy_node(&mut next, idx, (old_end, new_end), &mut spans) as u32;
+            }
+            next.dropped_by_start[pos - old_end + new_end] = self.dropped_by_start[pos];
+        }
+
+        debug!(node_count = next.node_count());
+        let edit = LatticeEdit {
+            old_input: self.input.clone(),
+            remap,
+            start,
+            new_end,
+        };
+        (next, edit)
+    }
+
+    /// Append a copy of node `idx` to `dst`, moved by `to - from` positions.
+    fn copy_node(
+        &self,
+        dst: &mut Lattice,
+        idx: usize,
+        (from, to): (usize, usize),
+        spans: &mut HashMap<(u32, u16), StringSpan>,
+    ) -> usize {
+        let mut repool = |span: StringSpan| {
+            *spans
+                .entry((span.offset, span.len))
+                .or_insert_with(|| dst.pool_string(self.span_str(&span)))
+        };
+        let reading = repool(self.reading_spans[idx]);
+        let surface = repool(self.surface_spans[idx]);
+        dst.push_node(
+            self.starts[idx] - from + to..self.ends[idx] - from + to,
+            PooledStr::Reuse(reading),
+            PooledStr::Reuse(surface),
+            self.costs[idx],
+            self.left_ids[idx],
+            self.right_ids[idx],
+        )
     }
 
     /// Resolve a `StringSpan` to a `&str`.
@@ -304,9 +544,12 @@ impl Lattice {
 
 /// Add nodes for dictionary matches at a range of character positions.
 ///
-/// For each position in `start_pos..end_pos`, runs `common_prefix_search`
-/// and adds matching nodes. If `min_end` is set, only nodes with
-/// `end > min_end` are added (used by `extend` to skip already-known matches).
+/// For each position in `start_pos..end_pos`, runs
+/// `common_prefix_search_shared` and adds matching nodes.
+///
+/// A position with more entries than `lattice.max_nodes_per_position` keeps
+/// the cheapest that many. The unknown-word fallback is added whenever no
+/// single-character node was kept, so the lattice stays connected.
 fn add_nodes_for_range(
     lattice: &mut Lattice,
     dict: &dyn Dictionary,
@@ -314,31 +557,24 @@ fn add_nodes_for_range(
     byte_offsets: &[usize],
     start_pos: usize,
     end_pos: usize,
-    min_end: Option<usize>,
 ) {
+    let unknown_word_cost = lattice.settings.cost.unknown_word_cost;
     for start in start_pos..end_pos {
-        let mut has_single_char_match = min_end.is_some(); // existing positions already have fallbacks
-
-        let suffix = &kana[byte_offsets[start]..];
-        let matches = dict.common_prefix_search(suffix);
+        let mut has_single_char_match = false;
+        let matches = dict.common_prefix_search_shared(&kana[byte_offsets[start]..]);
+        let mut admit = NodeCap::new(&matches, lattice.max_nodes_per_position);
 
         for result in &matches {
             let reading_char_count = result.reading.chars().count();
             let end = start + reading_char_count;
 
-            if let Some(min) = min_end {
-                if end <= min {
-                    // Already exists from previous build
-                    if reading_char_count == 1 {
-                        has_single_char_match = true;
-                    }
+            let mut reading = None;
+            for entry in result.entries.iter() {
+                if !admit.admits(entry.cost) {
+                    lattice.dropped_by_start[start] += 1;
                     continue;
                 }
-            }
-
-            lattice.max_reading_chars = lattice.max_reading_chars.max(reading_char_count);
-            let reading = lattice.pool(&result.reading);
-            for entry in &result.entries {
+                let reading = *reading.get_or_insert_with(|| lattice.pool(&result.reading));
                 let surface = if entry.surface == result.reading {
                     reading
                 } else {
@@ -352,9 +588,7 @@ fn add_nodes_for_range(
                     entry.left_id,
                     entry.right_id,
                 );
-            }
-            if reading_char_count == 1 {
-                has_single_char_match = true;
+                has_single_char_match |= reading_char_count == 1;
             }
         }
 
@@ -363,14 +597,48 @@ fn add_nodes_for_range(
             let ch = &kana[byte_offsets[start]..next_offset];
             // reading == surface for fallback — pool once, reuse for both
             let span = lattice.pool(ch);
-            lattice.push_node(
-                start..start + 1,
-                span,
-                span,
-                settings().cost.unknown_word_cost,
-                0,
-                0,
-            );
+            lattice.push_node(start..start + 1, span, span, unknown_word_cost, 0, 0);
+        }
+    }
+}
+
+/// Which entries of one start position fit under the node cap: every entry
+/// below the `cap`-th lowest cost, and entries at that cost in search order
+/// until the cap is reached. Positions within the cap admit everything.
+struct NodeCap {
+    threshold: i16,
+    ties: usize,
+}
+
+impl NodeCap {
+    fn new(matches: &[SharedSearchResult], cap: usize) -> Self {
+        let total: usize = matches.iter().map(|m| m.entries.len()).sum();
+        if total <= cap {
+            return Self {
+                threshold: i16::MAX,
+                ties: usize::MAX,
+            };
+        }
+        let mut costs: Vec<i16> = matches
+            .iter()
+            .flat_map(|m| m.entries.iter().map(|e| e.cost))
+            .collect();
+        let (_, &mut threshold, _) = costs.select_nth_unstable(cap - 1);
+        let below = costs.iter().filter(|&&c| c < threshold).count();
+        Self {
+            threshold,
+            ties: cap - below,
+        }
+    }
+
+    fn admits(&mut self, cost: i16) -> bool {
+        if cost < self.threshold {
+            true
+        } else if cost == self.threshold && self.ties > 0 {
+            self.ties -= 1;
+            true
+        } else {
+            false
         }
     }
 }
@@ -381,16 +649,45 @@ fn add_nodes_for_range(
 /// per starting position finds all matching prefixes, instead of O(n) individual
 /// lookups per position.
 /// Adds an unknown-word fallback node (1-char, high cost) to guarantee connectivity.
+/// Start positions keep at most `limits.max_nodes_per_position` dictionary
+/// nodes of the current settings.
 pub fn build_lattice(dict: &dyn Dictionary, kana: &str) -> Lattice {
+    build_lattice_with(dict, kana, settings())
+}
+
+/// [`build_lattice`] against a settings snapshot the caller already holds.
+pub fn build_lattice_with(dict: &dyn Dictionary, kana: &str, settings: Arc<Settings>) -> Lattice {
+    let cap = settings.limits.max_nodes_per_position;
+    build_lattice_impl(dict, kana, settings, cap)
+}
+
+/// [`build_lattice`] with an explicit node cap.
+#[cfg(test)]
+pub(crate) fn build_lattice_capped(
+    dict: &dyn Dictionary,
+    kana: &str,
+    max_nodes_per_position: usize,
+) -> Lattice {
+    build_lattice_impl(dict, kana, settings(), max_nodes_per_position)
+}
+
+fn build_lattice_impl(
+    dict: &dyn Dictionary,
+    kana: &str,
+    settings: Arc<Settings>,
+    max_nodes_per_position: usize,
+) -> Lattice {
     let char_count = kana.chars().count();
     let _span = debug_span!("build_lattice", char_count).entered();
     let byte_offsets: Vec<usize> = kana.char_indices().map(|(i, _)| i).collect();
-    let mut lattice = Lattice::new(kana, char_count);
-    lattice.max_reading_chars = dict.max_reading_len();
+    let mut lattice = Lattice::new(kana, char_count, settings, max_nodes_per_position);
 
-    add_nodes_for_range(&mut lattice, dict, kana, &byte_offsets, 0, char_count, None);
+    add_nodes_for_range(&mut lattice, dict, kana, &byte_offsets, 0, char_count);
 
-    debug!(node_count = lattice.node_count());
+    debug!(
+        node_count = lattice.node_count(),
+        dropped_nodes = lattice.dropped_nodes()
+    );
     lattice
 }
 
@@ -681,4 +978,59 @@ mod tests {
         assert_eq!(span0.offset, span1.offset);
         assert_eq!(span0.len, span1.len);
     }
+
+    // ── node cap ──────────────────────────────────────────────────
+
+    #[test]
+    fn test_node_cap_keeps_cheapest() {
+        let dict = test_dict();
+        // Position 0 of きょう matches 木 (4500), 今日 (3000) and 京 (5000).
+        let surfaces = |lattice: &Lattice| -> Vec<String> {
+            lattice.nodes_by_start[0]
+                .iter()
+                .map(|&i| lattice.surface(i).to_string())
+                .collect()
+        };
+        let uncapped = build_lattice_capped(&dict, "きょう", usize::MAX);
+        assert_eq!(surfaces(&uncapped), ["木", "今日", "京"]);
+        assert_eq!(uncapped.dropped_nodes(), 0);
+
+        let two = build_lattice_capped(&dict, "きょう", 2);
+        assert_eq!(surfaces(&two), ["木", "今日"]);
+        assert_eq!(two.dropped_by_start[0], 1);
+
+        // Without 木, the unknown-word fallback keeps position 1 reachable.
+        let one = build_lattice_capped(&dict, "きょう", 1);
+        assert_eq!(surfaces(&one), ["今日", "き"]);
+        assert_eq!(one.dropped_by_start[0], 2);
+    }
+
+    #[test]
+    fn test_node_cap_keeps_lattice_connected() {
+        // Every prefix of a run of あ is a word, the longer the cheaper, so
+        // a cap of one keeps only the longest and drops the 1-char word.
+        let entries: Vec<(String, Vec<crate::dict::DictEntry>)> = (1..=4)
+            .map(|len| {
+                let reading = "あ".repeat(len);
+                let entry = crate::dict::DictEntry {
+                    surface: format!("亜{len}"),
+                    cost: 5000 - len as i16 * 1000,
+                    left_id: 1,
+                    right_id: 1,
+                };
+                (reading, vec![entry])
+            })
+            .collect();
+        let dict = crate::dict::TrieDictionary::from_entries(entries);
+        let lattice = build_lattice_capped(&dict, "あああああ", 1);
+        for pos in 0..lattice.char_count {
+            assert!(
+                lattice.nodes_by_start[pos]
+                    .iter()
+                    .any(|&i| lattice.end(i) == pos + 1),
+                "no 1-char node at {pos}"
+            );
+        }
+        assert!(lattice.dropped_nodes() > 0);
+    }
 }
@@ -10,6 +10,8 @@
 //!
 //! Separating these steps allows callers to reuse a lattice across multiple
 //! conversions (e.g. sync 1-best + async N-best in deferred candidate mode).
+//! A caller editing the reading can also keep the lattice and the Viterbi
+//! tables across edits (`Lattice::splice` / `ViterbiMemo`).
 
 #[cfg(feature = "neural")]
 pub(crate) mod constrained;
@@ -33,12 +35,17 @@ use crate::dict::Dictionary;
 use crate::user_history::UserHistory;
 
 use cost::DefaultCostFunction;
-use postprocess::postprocess;
+use postprocess::{postprocess, PostprocessContext};
 
-pub use lattice::{build_lattice, Lattice};
-pub use viterbi::ConvertedSegment;
-#[allow(unused_imports)]
-pub(crate) use viterbi::{viterbi_nbest, RichSegment, ScoredPath};
+#[cfg(test)]
+pub(crate) use lattice::build_lattice_capped;
+pub use lattice::{build_lattice, build_lattice_with, Lattice, LatticeEdit};
+#[cfg(all(test, feature = "neural"))]
+pub(crate) use viterbi::RichSegment;
+pub(crate) use viterbi::{
+    budgeted_n, viterbi_nbest, viterbi_nbest_distinct, viterbi_nbest_memo, ScoredPath,
+};
+pub use viterbi::{ConvertedSegment, ViterbiMemo};
 
 /// Shared conversion resources: dictionary, connection matrix, and user history.
 ///
@@ -61,7 +68,25 @@ impl ConversionContext<'_> {
         // 1-best uses a larger oversample floor than the N-best formula to give
         // the reranker/history boost enough candidates to work with.
         let oversample = if self.history.is_some() { 30 } else { 10 };
-        self.convert_lattice_impl(lattice, 1, oversample)
+        self.convert_lattice_impl(lattice, 1, oversample, Search::Plain)
+            .into_iter()
+            .next()
+            .unwrap_or_default()
+    }
+
+    /// [`Self::convert_from_lattice`] reusing the Viterbi tables in `memo`.
+    ///
+    /// For a lattice kept up to date with [`Lattice::splice`] whose edits are
+    /// passed to [`ViterbiMemo::apply_edit`]; only the part of the forward
+    /// and backward passes the edit reaches is recomputed. The result is the
+    /// same as without the memo.
+    pub fn convert_from_lattice_with_memo(
+        &self,
+        lattice: &Lattice,
+        memo: &mut ViterbiMemo,
+    ) -> Vec<ConvertedSegment> {
+        let oversample = if self.history.is_some() { 30 } else { 10 };
+        self.convert_lattice_impl(lattice, 1, oversample, Search::Memo(memo))
             .into_iter()
             .next()
             .unwrap_or_default()
@@ -78,33 +103,52 @@ impl ConversionContext<'_> {
         } else {
             n * 3
         };
-        self.convert_lattice_impl(lattice, n, oversample)
+        self.convert_lattice_impl(lattice, n, oversample, Search::Plain)
     }
 
     /// Shared Viterbi + postprocess pipeline used by the 1-best and N-best wrappers.
+    ///
+    /// Every stage scores against the settings snapshot `lattice` was built
+    /// with, so a reload mid-conversion cannot mix two configurations.
     fn convert_lattice_impl(
         &self,
         lattice: &Lattice,
         n: usize,
         oversample: usize,
+        search: Search<'_>,
     ) -> Vec<Vec<ConvertedSegment>> {
         if lattice.input.is_empty() || n == 0 {
             return Vec::new();
         }
-        let cost_fn = DefaultCostFunction::new(self.conn);
-        let mut paths = viterbi_nbest(lattice, &cost_fn, oversample);
-        postprocess(
-            &mut paths,
+        let settings = lattice.settings();
+        let cost_fn = DefaultCostFunction::new(self.conn, &settings.cost);
+        let oversample = budgeted_n(lattice, oversample, settings.limits.viterbi_work_budget);
+        let mut paths = match search {
+            Search::Plain => viterbi_nbest(lattice, &cost_fn, oversample),
+            Search::Memo(memo) => viterbi_nbest_memo(lattice, &cost_fn, oversample, memo),
+        };
+        let ctx = PostprocessContext {
             lattice,
-            self.conn,
-            Some(self.dict),
-            self.history,
-            &lattice.input,
+            conn: self.conn,
+            dict: Some(self.dict),
+            history: self.history,
+            kana: &lattice.input,
             n,
-        )
+            now: crate::user_history::now_epoch(),
+            settings,
+        };
+        postprocess(&mut paths, &ctx)
     }
 }
 
+/// Which Viterbi search `convert_lattice_impl` runs.
+enum Search<'m> {
+    /// [`viterbi_nbest`].
+    Plain,
+    /// [`viterbi_nbest_memo`] with the caller's tables.
+    Memo(&'m mut ViterbiMemo),
+}
+
 // ---------------------------------------------------------------------------
 // Convenience wrappers — build lattice internally
 // ---------------------------------------------------------------------------
@@ -185,6 +229,27 @@ pub fn convert_nbest_with_history(
     ctx.convert_nbest_from_lattice(&lattice, n)
 }
 
+/// Surfaces of the `n` cheapest surface-distinct Viterbi paths through
+/// `lattice`: from the surface-distinct search, or with `oversample`, from
+/// that many plain N-best paths deduplicated. Lets benchmarks compare the
+/// two searches without the rest of the pipeline; conversion itself stays
+/// on the plain search, which is faster at the pool widths it uses.
+#[doc(hidden)]
+pub fn nbest_surfaces(
+    lattice: &Lattice,
+    conn: Option<&ConnectionMatrix>,
+    n: usize,
+    oversample: Option<usize>,
+) -> Vec<String> {
+    let cost_fn = DefaultCostFunction::new(conn, &lattice.settings().cost);
+    let mut paths = match oversample {
+        Some(k) => viterbi_nbest(lattice, &cost_fn, k),
+        None => viterbi_nbest_distinct(lattice, &cost_fn, n),
+    };
+    paths.truncate(n);
+    paths.iter().map(ScoredPath::surface_key).collect()
+}
+
 // ---------------------------------------------------------------------------
 // Internal — constrained decoding (neural feature)
 // ---------------------------------------------------------------------------
@@ -200,11 +265,13 @@ pub(crate) fn convert_nbest_constrained(
     if kana.is_empty() || n == 0 {
         return Vec::new();
     }
-    let cost_fn = constrained::PrefixConstrainedCost::new(ctx.conn, constraint);
     let lattice = build_lattice(ctx.dict, kana);
+    let settings = lattice.settings();
+    let cost_fn =
+        constrained::PrefixConstrainedCost::new(ctx.conn, &settings.cost, constraint, &lattice);
     let oversample = n * 3;
     let mut paths = viterbi_nbest(&lattice, &cost_fn, oversample);
-    reranker::rerank(&mut paths, ctx.conn, Some(ctx.dict));
+    reranker::rerank(&mut paths, ctx.conn, Some(ctx.dict), settings);
     paths.truncate(n);
     paths
 }
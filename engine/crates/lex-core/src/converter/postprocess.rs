@@ -2,6 +2,7 @@ use tracing::debug_span;
 
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
+use crate::settings::Settings;
 use crate::user_history::UserHistory;
 
 use super::lattice::Lattice;
@@ -46,6 +47,10 @@ pub(crate) struct PostprocessContext<'a> {
     /// observers compute breakdowns against the exact value the pipeline will
     /// use, avoiding sub-second drift across the second boundary.
     pub now: u64,
+    /// Settings snapshot captured when the conversion started. Every stage
+    /// reads weights from here, so a concurrent `settings::reload` cannot
+    /// change them halfway through the pipeline.
+    pub settings: &'a Settings,
 }
 
 // ---------------------------------------------------------------------------
@@ -55,23 +60,9 @@ pub(crate) struct PostprocessContext<'a> {
 /// Shared post-processing pipeline: resegment → rerank → hiragana_rewrite → history_rerank → take(n) → rewrite → group.
 pub(super) fn postprocess(
     paths: &mut Vec<ScoredPath>,
-    lattice: &Lattice,
-    conn: Option<&ConnectionMatrix>,
-    dict: Option<&dyn Dictionary>,
-    history: Option<&UserHistory>,
-    kana: &str,
-    n: usize,
+    ctx: &PostprocessContext<'_>,
 ) -> Vec<Vec<ConvertedSegment>> {
-    let ctx = PostprocessContext {
-        lattice,
-        conn,
-        dict,
-        history,
-        kana,
-        n,
-        now: crate::user_history::now_epoch(),
-    };
-    postprocess_observed(paths, &ctx, &mut NoopObserver)
+    postprocess_observed(paths, ctx, &mut NoopObserver)
         .into_iter()
         .map(|p| p.into_segments())
         .collect()
@@ -92,10 +83,10 @@ pub(crate) fn postprocess_observed<O: PostprocessObserver>(
 
     // Generate alternative segmentations from the lattice before reranking,
     // so the reranker can compare them on equal footing with Viterbi paths.
-    let reseg_paths = resegment::resegment(paths, ctx.lattice, ctx.conn);
+    let reseg_paths = resegment::resegment(paths, ctx.lattice, ctx.conn, &ctx.settings.cost);
     paths.extend(reseg_paths);
 
-    reranker::rerank(paths, ctx.conn, ctx.dict);
+    reranker::rerank(paths, ctx.conn, ctx.dict, ctx.settings);
 
     // Hiragana variant must run BEFORE history_rerank so that whole-path
     // unigram boosts (×5) can promote a previously-selected hiragana variant.
@@ -117,7 +108,7 @@ pub(crate) fn postprocess_observed<O: PostprocessObserver>(
     };
 
     if let Some(h) = ctx.history {
-        reranker::history_rerank_at(paths, h, ctx.conn, ctx.now);
+        reranker::history_rerank_at(paths, h, &ctx.settings.history, ctx.conn, ctx.now);
     }
     let mut top: Vec<ScoredPath> = paths.drain(..ctx.n.min(paths.len())).collect();
 
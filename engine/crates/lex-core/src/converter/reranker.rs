@@ -2,7 +2,7 @@ use tracing::{debug, debug_span};
 
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
-use crate::settings::settings;
+use crate::settings::{HistorySettings, Settings};
 use crate::user_history::UserHistory;
 
 use super::features::{compute_structure_cost, FeatureConfig, FeatureWeights};
@@ -20,10 +20,14 @@ use super::viterbi::ScoredPath;
 ///   segmentations are preferred when Viterbi costs are close
 /// - **Script cost**: penalises katakana / Latin surfaces and rewards mixed-script
 ///   (kanji+kana) surfaces — a ranking preference that doesn't affect search quality
+///
+/// `settings` is the snapshot the conversion captured on entry, so every
+/// feature of one conversion is scored with the same weights.
 pub fn rerank(
     paths: &mut Vec<ScoredPath>,
     conn: Option<&ConnectionMatrix>,
     dict: Option<&dyn Dictionary>,
+    settings: &Settings,
 ) {
     let _span = debug_span!("rerank", paths_in = paths.len()).entered();
     if paths.len() <= 1 {
@@ -36,8 +40,8 @@ pub fn rerank(
     // filter threshold. Without this, a prefix→content-word transition
     // (e.g. 今[prefix]→デスネ with conn=256) can drag min_sc so low that
     // the hard filter drops correct multi-segment paths like 今|です|ね.
-    let cap = settings().reranker.structure_cost_transition_cap;
-    let prefix_floor = (settings().reranker.structure_cost_filter / 2).min(cap);
+    let cap = settings.reranker.structure_cost_transition_cap;
+    let prefix_floor = (settings.reranker.structure_cost_filter / 2).min(cap);
     let structure_costs: Vec<i64> = paths
         .iter()
         .map(|p| compute_structure_cost(p, conn, cap, prefix_floor))
@@ -49,7 +53,7 @@ pub fn rerank(
     // imputed with prefix_floor so they don't set an artificially low baseline.
     // Combined with the prefix-transition floor in step 1, this ensures the
     // threshold is high enough to keep correct multi-segment paths.
-    let filter = settings().reranker.structure_cost_filter;
+    let filter = settings.reranker.structure_cost_filter;
     let min_sc = structure_costs
         .iter()
         .zip(paths.iter())
@@ -80,12 +84,13 @@ pub fn rerank(
     // Pass pre-computed structure_cost to avoid recomputing transition costs.
     // Only the single-kanji compound exemption requires dictionary lookups;
     // te-form scoring does not.
-    let weights = FeatureWeights::from_settings();
+    let weights = FeatureWeights::from_reranker(&settings.reranker);
     let need_dict = weights.single_kanji != 0;
     let dict_for_features = if need_dict { dict } else { None };
     let fcfg = FeatureConfig {
         conn,
         dict: dict_for_features,
+        cost: &settings.cost,
         structure_cap: cap,
         prefix_floor,
     };
@@ -128,6 +133,7 @@ impl HistoryBoostBreakdown {
 pub fn compute_history_boost(
     path: &ScoredPath,
     history: &UserHistory,
+    hs: &HistorySettings,
     conn: Option<&ConnectionMatrix>,
     now: u64,
 ) -> HistoryBoostBreakdown {
@@ -144,15 +150,20 @@ pub fn compute_history_boost(
         if conn.is_some_and(|c| c.is_function_word(seg.left_id)) {
             continue;
         }
-        unigram_sum += history.unigram_boost(&seg.reading, &seg.surface, now);
+        unigram_sum += history.unigram_boost_with(hs, &seg.reading, &seg.surface, now);
     }
     let mut bigram_sum: i64 = 0;
     for pair in path.segments.windows(2) {
-        bigram_sum +=
-            history.bigram_boost(&pair[0].surface, &pair[1].reading, &pair[1].surface, now);
+        bigram_sum += history.bigram_boost_with(
+            hs,
+            &pair[0].surface,
+            &pair[1].reading,
+            &pair[1].surface,
+            now,
+        );
     }
     let whole_path_boost =
-        history.unigram_boost(&path.full_reading(), &path.surface_key(), now) * 5;
+        history.unigram_boost_with(hs, &path.full_reading(), &path.surface_key(), now) * 5;
     HistoryBoostBreakdown {
         unigram_sum,
         bigram_sum,
@@ -163,7 +174,7 @@ pub fn compute_history_boost(
 /// Apply user-history boosts to N-best paths using the given `now`, then re-sort.
 ///
 /// Callers that also want to inspect the breakdown (e.g. `explain`) should pass
-/// the same `now` they used with [`compute_history_boost`]; otherwise the
+/// the same `hs` and `now` they used with [`compute_history_boost`]; otherwise the
 /// stored breakdown can drift from the boost actually subtracted here when
 /// execution crosses a second boundary.
 ///
@@ -182,6 +193,7 @@ pub fn compute_history_boost(
 pub fn history_rerank_at(
     paths: &mut [ScoredPath],
     history: &UserHistory,
+    hs: &HistorySettings,
     conn: Option<&ConnectionMatrix>,
     now: u64,
 ) {
@@ -190,7 +202,7 @@ pub fn history_rerank_at(
         return;
     }
     for path in paths.iter_mut() {
-        let breakdown = compute_history_boost(path, history, conn, now);
+        let breakdown = compute_history_boost(path, history, hs, conn, now);
         let applied = breakdown.applied(path.segments.len());
         path.viterbi_cost -= applied;
         // Remember the boost so candidate generators running after this step
@@ -209,6 +221,7 @@ mod tests {
     use crate::converter::viterbi::RichSegment;
     use crate::dict::connection::ConnectionMatrix;
     use crate::dict::{DictEntry, Dictionary, SearchResult};
+    use crate::settings::settings;
 
     /// Build a minimal ConnectionMatrix with the given roles vector.
     fn conn_with_roles(roles: Vec<u8>) -> ConnectionMatrix {
@@ -262,8 +275,8 @@ mod tests {
             path(vec![seg("で", "で", 2), seg("みる", "見る", 1)], 99999), // dummy
         ];
 
-        rerank(&mut with_kanji, Some(&conn), None);
-        rerank(&mut without_kanji, Some(&conn), None);
+        rerank(&mut with_kanji, Some(&conn), None, &settings());
+        rerank(&mut without_kanji, Some(&conn), None, &settings());
 
         let kanji_cost = with_kanji
             .iter()
@@ -277,7 +290,7 @@ mod tests {
             path(vec![seg("は", "は", 2), seg("みる", "見る", 1)], 100),
             path(vec![seg("は", "は", 2), seg("みる", "みる", 1)], 99999),
         ];
-        rerank(&mut baseline_kanji, Some(&conn), None);
+        rerank(&mut baseline_kanji, Some(&conn), None, &settings());
         let baseline_kanji_cost = baseline_kanji
             .iter()
             .find(|p| p.segments[1].surface == "見る")
@@ -324,7 +337,7 @@ mod tests {
             ),
         ];
 
-        rerank(&mut paths, Some(&conn), None);
+        rerank(&mut paths, Some(&conn), None, &settings());
 
         // The FW path should rank first (lower cost) because its 2-char
         // particle is excluded from the variance calculation.
@@ -367,7 +380,7 @@ mod tests {
             ),
         ];
 
-        rerank(&mut paths, Some(&conn), None);
+        rerank(&mut paths, Some(&conn), None, &settings());
 
         // Path A should rank better: its 1-char segments are all excluded,
         // leaving no variance. Path B has [4, 2] with nonzero variance.
@@ -433,7 +446,7 @@ mod tests {
             path(vec![seg("かくにんね", "確認ね", 1)], 100),
         ];
 
-        rerank(&mut paths, Some(&conn), None);
+        rerank(&mut paths, Some(&conn), None, &settings());
 
         // The path with 根 should have penalty applied
         let root_path = paths
@@ -468,7 +481,7 @@ mod tests {
                 path(vec![seg("きょう", "京", 1), seg("と", "都", 1)], 100),
                 dummy.clone(),
             ];
-            rerank(&mut p, Some(&conn), Some(&dict));
+            rerank(&mut p, Some(&conn), Some(&dict), &settings());
             p.iter()
                 .find(|pp| pp.segments.len() == 2)
                 .unwrap()
@@ -481,7 +494,7 @@ mod tests {
                 path(vec![seg("きょう", "京", 1), seg("と", "都", 1)], 100),
                 dummy.clone(),
             ];
-            rerank(&mut p, Some(&conn), None);
+            rerank(&mut p, Some(&conn), None, &settings());
             p.iter()
                 .find(|pp| pp.segments.len() == 2)
                 .unwrap()
@@ -513,7 +526,7 @@ mod tests {
                 path(vec![seg("ます", "ます", 1), seg("ね", "根", 1)], 100),
                 dummy.clone(),
             ];
-            rerank(&mut p, Some(&conn), Some(&dict));
+            rerank(&mut p, Some(&conn), Some(&dict), &settings());
             p.iter()
                 .find(|pp| pp.segments.len() == 2)
                 .unwrap()
@@ -525,7 +538,7 @@ mod tests {
                 path(vec![seg("ます", "ます", 1), seg("ね", "根", 1)], 100),
                 dummy.clone(),
             ];
-            rerank(&mut p, Some(&conn), None);
+            rerank(&mut p, Some(&conn), None, &settings());
             p.iter()
                 .find(|pp| pp.segments.len() == 2)
                 .unwrap()
@@ -544,14 +557,16 @@ mod tests {
         // regardless of the configured penalty weight.
         // ID 2 has role=1 (FW) so extract_features skips it (role != 0).
         let conn = conn_with_roles_and_fw(vec![0u8, 0, 1], 2, 2);
-        let cap = settings().reranker.structure_cost_transition_cap;
-        let prefix_floor = (settings().reranker.structure_cost_filter / 2).min(cap);
+        let s = settings();
+        let cap = s.reranker.structure_cost_transition_cap;
+        let prefix_floor = (s.reranker.structure_cost_filter / 2).min(cap);
 
         // CW single-char kanji — should count
         let cw_path = path(vec![seg("ね", "根", 1)], 100);
         let fcfg = FeatureConfig {
             conn: Some(&conn),
             dict: None,
+            cost: &s.cost,
             structure_cap: cap,
             prefix_floor,
         };
@@ -582,7 +597,7 @@ mod tests {
             path(vec![seg("ね", "根", 1)], 100),   // 1-char reading
         ];
 
-        rerank(&mut paths, Some(&conn), None);
+        rerank(&mut paths, Some(&conn), None, &settings());
 
         let multi = paths
             .iter()
@@ -605,14 +620,16 @@ mod tests {
     fn te_form_kanji_feature_not_counted_for_non_te_function_word() {
         // Verify that te_kanji_count is 0 when the preceding FW is not て/で.
         let conn = conn_with_roles_and_fw(vec![0u8, 0, 0], 2, 2);
-        let cap = settings().reranker.structure_cost_transition_cap;
-        let prefix_floor = (settings().reranker.structure_cost_filter / 2).min(cap);
+        let s = settings();
+        let cap = s.reranker.structure_cost_transition_cap;
+        let prefix_floor = (s.reranker.structure_cost_filter / 2).min(cap);
 
         // "は" (FW, not て/で) + "見る" (kanji) — should NOT trigger te-form
         let ha_path = path(vec![seg("は", "は", 2), seg("みる", "見る", 1)], 100);
         let fcfg = FeatureConfig {
             conn: Some(&conn),
             dict: None,
+            cost: &s.cost,
             structure_cap: cap,
             prefix_floor,
         };
@@ -9,7 +9,7 @@
 use std::collections::HashSet;
 
 use crate::dict::connection::ConnectionMatrix;
-use crate::settings::settings;
+use crate::settings::CostSettings;
 
 use super::cost::conn_cost;
 use super::lattice::Lattice;
@@ -27,6 +27,7 @@ pub(super) fn resegment(
     paths: &[ScoredPath],
     lattice: &Lattice,
     conn: Option<&ConnectionMatrix>,
+    cost_settings: &CostSettings,
 ) -> Vec<ScoredPath> {
     let best = match paths.first() {
         Some(p) if !p.segments.is_empty() => p,
@@ -102,7 +103,7 @@ pub(super) fn resegment(
                     new_segs.push(lattice.to_rich_segment(right_idx));
                     new_segs.extend_from_slice(&best.segments[(seg_idx + 1)..]);
 
-                    let cost = score_path(&new_segs, conn);
+                    let cost = score_path(&new_segs, conn, cost_settings.segment_penalty);
 
                     let candidate = ScoredPath {
                         segments: new_segs,
@@ -131,12 +132,11 @@ pub(super) fn resegment(
 /// Score a path using the same formula as `DefaultCostFunction`.
 ///
 /// Reproduces: word_cost(node) + BOS + transitions + EOS.
-fn score_path(segments: &[RichSegment], conn: Option<&ConnectionMatrix>) -> i64 {
+fn score_path(segments: &[RichSegment], conn: Option<&ConnectionMatrix>, seg_penalty: i64) -> i64 {
     if segments.is_empty() {
         return 0;
     }
 
-    let seg_penalty = settings().cost.segment_penalty;
     let mut cost: i64 = 0;
 
     for (i, seg) in segments.iter().enumerate() {
@@ -173,6 +173,7 @@ mod tests {
     use crate::converter::testutil::{test_dict, zero_conn_with_fw};
     use crate::converter::viterbi::viterbi_nbest;
     use crate::dict::{DictEntry, TrieDictionary};
+    use crate::settings::settings;
 
     /// Helper: build lattice + viterbi paths for a kana string.
     fn build_paths(
@@ -182,7 +183,7 @@ mod tests {
         n: usize,
     ) -> (Lattice, Vec<ScoredPath>) {
         let lattice = build_lattice(dict, kana);
-        let cost_fn = DefaultCostFunction::new(conn);
+        let cost_fn = DefaultCostFunction::new(conn, &settings().cost);
         let paths = viterbi_nbest(&lattice, &cost_fn, n);
         (lattice, paths)
     }
@@ -254,7 +255,7 @@ mod tests {
             "Viterbi best should contain 教派 compound for this test to be meaningful"
         );
 
-        let new_paths = resegment(&paths, &lattice, Some(&conn));
+        let new_paths = resegment(&paths, &lattice, Some(&conn), &settings().cost);
 
         assert!(
             !new_paths.is_empty(),
@@ -287,7 +288,7 @@ mod tests {
         let dict = dict_with_compound();
         let (lattice, paths) = build_paths(&dict, "きょうはいいてんき", Some(&conn), 5);
 
-        let new_paths = resegment(&paths, &lattice, Some(&conn));
+        let new_paths = resegment(&paths, &lattice, Some(&conn), &settings().cost);
         assert!(
             new_paths.is_empty(),
             "no splits should be generated without FW: got {} paths",
@@ -301,7 +302,7 @@ mod tests {
         let dict = dict_with_compound();
         let (lattice, paths) = build_paths(&dict, "きょうはいいてんき", Some(&conn), 20);
 
-        let new_paths = resegment(&paths, &lattice, Some(&conn));
+        let new_paths = resegment(&paths, &lattice, Some(&conn), &settings().cost);
 
         let existing_keys: HashSet<String> = paths.iter().map(|p| p.surface_key()).collect();
         for p in &new_paths {
@@ -320,7 +321,7 @@ mod tests {
         let lattice = build_lattice(&dict, "きょう");
         let paths: Vec<ScoredPath> = Vec::new();
 
-        let new_paths = resegment(&paths, &lattice, Some(&conn));
+        let new_paths = resegment(&paths, &lattice, Some(&conn), &settings().cost);
         assert!(new_paths.is_empty());
     }
 
@@ -331,7 +332,7 @@ mod tests {
         let (_, paths) = build_paths(&dict, "きょうはいいてんき", Some(&conn), 5);
 
         if let Some(best) = paths.first() {
-            let rescored = score_path(&best.segments, Some(&conn));
+            let rescored = score_path(&best.segments, Some(&conn), settings().cost.segment_penalty);
             assert_eq!(
                 rescored, best.viterbi_cost,
                 "score_path ({}) should match viterbi_cost ({})",
@@ -364,8 +364,11 @@ pub(crate) struct NumericRewriter<'a> {
 impl Rewriter for NumericRewriter<'_> {
     fn generate(&self, paths: &[ScoredPath], reading: &str) -> Vec<ScoredPath> {
         let mut candidates = Vec::new();
+        // One scan yields both the whole-reading value and every numeric
+        // prefix a counter can follow.
+        let prefixes = numeric::number_prefixes(reading);
 
-        if let Some(n) = numeric::parse_japanese_number(reading) {
+        if let Some(&(_, n)) = prefixes.last().filter(|&&(end, _)| end == reading.len()) {
             let best_cost = paths
                 .iter()
                 .map(|p| p.pre_history_cost())
@@ -397,7 +400,14 @@ impl Rewriter for NumericRewriter<'_> {
         }
 
         if let (Some(lattice), Some(conn)) = (self.lattice, self.connection) {
-            self.append_counter_candidates(lattice, conn, paths, reading, &mut candidates);
+            self.append_counter_candidates(
+                lattice,
+                conn,
+                paths,
+                reading,
+                &prefixes,
+                &mut candidates,
+            );
         }
 
         candidates
@@ -406,8 +416,9 @@ impl Rewriter for NumericRewriter<'_> {
 
 impl NumericRewriter<'_> {
     /// Scan the lattice for counter (助数詞) nodes ending at the reading's tail.
-    /// For each unique counter surface, try to parse the kana prefix as a number,
-    /// and emit kanji / half-width / full-width counter compounds.
+    /// For each unique counter surface whose kana prefix is a number (looked
+    /// up in `prefixes`, from `numeric::number_prefixes`), emit kanji /
+    /// half-width / full-width counter compounds.
     ///
     /// Counter ambiguity is resolved by the counter node's own word cost: the
     /// cheapest counter at the position anchors at `best_cost - 500` (so the
@@ -421,8 +432,12 @@ impl NumericRewriter<'_> {
         conn: &ConnectionMatrix,
         paths: &[ScoredPath],
         reading: &str,
+        prefixes: &[(usize, u64)],
         out: &mut Vec<ScoredPath>,
     ) {
+        if prefixes.is_empty() {
+            return;
+        }
         let char_count = reading.chars().count();
         if char_count < 2 {
             return;
@@ -497,10 +512,11 @@ impl NumericRewriter<'_> {
         let kanji_anchor = best_cost.saturating_sub(500);
 
         for cand in &cands {
-            let prefix = &reading[..byte_offsets[cand.start]];
-            let Some(n) = numeric::parse_japanese_number(prefix) else {
+            let end = byte_offsets[cand.start];
+            let Ok(i) = prefixes.binary_search_by_key(&end, |&(e, _)| e) else {
                 continue;
             };
+            let n = prefixes[i].1;
             // Widen to i64 before subtraction: i16 - i16 can overflow if the
             // dictionary contains extreme positive/negative costs.
             let cost_offset = cand.cost as i64 - cheapest as i64;
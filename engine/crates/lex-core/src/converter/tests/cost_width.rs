@@ -0,0 +1,219 @@
+//! Differential test: the `i32` Viterbi must rank exactly like the `i64`
+//! formulation it replaced.
+
+use std::collections::BTreeMap;
+
+use super::*;
+use crate::converter::cost::{CostFunction, DefaultCostFunction};
+use crate::converter::testutil::Rng;
+use crate::dict::{DictEntry, TrieDictionary};
+
+/// The pre-narrowing N-best Viterbi: same traversal and tie-breaking, with
+/// every cost widened to `i64` and accumulated without saturation.
+fn reference_nbest_i64<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    n: usize,
+) -> Vec<(i64, Vec<(String, String)>)> {
+    #[derive(Clone, Copy)]
+    struct Entry {
+        cost: i64,
+        prev: Option<(usize, usize)>,
+    }
+    fn insert(list: &mut Vec<Entry>, k: usize, entry: Entry) {
+        let pos = list.partition_point(|e| e.cost <= entry.cost);
+        if pos < k {
+            list.insert(pos, entry);
+            list.truncate(k);
+        }
+    }
+
+    let char_count = lattice.char_count;
+    if char_count == 0 || n == 0 {
+        return Vec::new();
+    }
+    let mut top_k: Vec<Vec<Entry>> = vec![Vec::new(); lattice.node_count()];
+    for &idx in &lattice.nodes_by_start[0] {
+        let cost = i64::from(cost_fn.word_cost(lattice, idx))
+            + i64::from(cost_fn.bos_cost(lattice.left_id(idx)));
+        top_k[idx].push(Entry { cost, prev: None });
+    }
+    for pos in 1..char_count {
+        for &next in &lattice.nodes_by_start[pos] {
+            let word = i64::from(cost_fn.word_cost(lattice, next));
+            for &prev in &lattice.nodes_by_end[pos] {
+                let transition = i64::from(
+                    cost_fn.transition_cost(lattice.right_id(prev), lattice.left_id(next)),
+                );
+                for rank in 0..top_k[prev].len() {
+                    let cost = top_k[prev][rank].cost + transition + word;
+                    let entry = Entry {
+                        cost,
+                        prev: Some((prev, rank)),
+                    };
+                    insert(&mut top_k[next], n, entry);
+                }
+            }
+        }
+    }
+
+    let mut eos = Vec::new();
+    for &idx in &lattice.nodes_by_end[char_count] {
+        let eos_cost = i64::from(cost_fn.eos_cost(lattice.right_id(idx)));
+        for (rank, entry) in top_k[idx].iter().enumerate() {
+            eos.push((entry.cost + eos_cost, idx, rank));
+        }
+    }
+    eos.sort_by_key(|&(cost, _, _)| cost);
+
+    let mut seen = std::collections::HashSet::new();
+    let mut results = Vec::new();
+    for (cost, mut idx, mut rank) in eos {
+        if results.len() >= n {
+            break;
+        }
+        let mut segments = Vec::new();
+        loop {
+            segments.push((
+                lattice.reading(idx).to_string(),
+                lattice.surface(idx).to_string(),
+            ));
+            match top_k[idx][rank].prev {
+                Some((p, r)) => (idx, rank) = (p, r),
+                None => break,
+            }
+        }
+        segments.reverse();
+        let key: String = segments.iter().map(|(_, s)| s.as_str()).collect();
+        if seen.insert(key) {
+            results.push((cost, segments));
+        }
+    }
+    results
+}
+
+fn narrowed_nbest<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    n: usize,
+) -> Vec<(i64, Vec<(String, String)>)> {
+    viterbi_nbest(lattice, cost_fn, n)
+        .into_iter()
+        .map(|p| {
+            let segments = p
+                .segments
+                .into_iter()
+                .map(|s| (s.reading, s.surface))
+                .collect();
+            (p.viterbi_cost, segments)
+        })
+        .collect()
+}
+
+/// Any `i16`, with the extremes over-represented.
+fn random_cost(rng: &mut Rng) -> i16 {
+    match rng.below(8) {
+        0 => i16::MAX,
+        1 => i16::MIN,
+        _ => rng.next() as i16,
+    }
+}
+
+const NUM_IDS: u16 = 8;
+
+fn random_conn(rng: &mut Rng) -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let costs = (0..n * n).map(|_| random_cost(rng)).collect();
+    ConnectionMatrix::new_owned(NUM_IDS, 1, 2, Vec::new(), costs)
+}
+
+fn random_entry(rng: &mut Rng, surface: String) -> DictEntry {
+    DictEntry {
+        surface,
+        cost: random_cost(rng),
+        left_id: rng.below(NUM_IDS as usize) as u16,
+        right_id: rng.below(NUM_IDS as usize) as u16,
+    }
+}
+
+fn assert_same_nbest(dict: &TrieDictionary, conn: &ConnectionMatrix, reading: &str) {
+    let lattice = build_lattice(dict, reading);
+    let cost_fn = DefaultCostFunction::new(Some(conn), &settings().cost);
+    for n in [1, 5, 30] {
+        assert_eq!(
+            narrowed_nbest(&lattice, &cost_fn, n),
+            reference_nbest_i64(&lattice, &cost_fn, n),
+            "reading {reading}, n = {n}"
+        );
+    }
+}
+
+#[test]
+fn test_i32_matches_i64_on_random_lattices() {
+    const KANA: [&str; 6] = ["あ", "い", "か", "き", "し", "ん"];
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+
+    for _ in 0..40 {
+        let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+        for _ in 0..60 {
+            let len = 1 + rng.below(3);
+            let reading: String = (0..len).map(|_| KANA[rng.below(KANA.len())]).collect();
+            let count = 1 + rng.below(3);
+            let list: Vec<DictEntry> = (0..count)
+                .map(|i| random_entry(&mut rng, format!("{reading}{i}")))
+                .collect();
+            entries.entry(reading).or_default().extend(list);
+        }
+        let dict = TrieDictionary::from_entries(entries);
+        let conn = random_conn(&mut rng);
+
+        for _ in 0..10 {
+            let len = 1 + rng.below(16);
+            let reading: String = (0..len).map(|_| KANA[rng.below(KANA.len())]).collect();
+            assert_same_nbest(&dict, &conn, &reading);
+        }
+    }
+}
+
+#[test]
+fn test_i32_matches_i64_on_accuracy_corpus() {
+    #[derive(serde::Deserialize)]
+    struct Corpus {
+        cases: Vec<Case>,
+    }
+    #[derive(serde::Deserialize)]
+    struct Case {
+        reading: String,
+        expected: String,
+    }
+    let corpus: Corpus = toml::from_str(include_str!(
+        "../../../../../testcorpus/accuracy-corpus.toml"
+    ))
+    .unwrap();
+
+    // Each expected surface plus a random-cost entry for every one- to
+    // three-character substring, so the corpus readings build dense lattices.
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for case in &corpus.cases {
+        let expected = random_entry(&mut rng, case.expected.clone());
+        entries
+            .entry(case.reading.clone())
+            .or_default()
+            .push(expected);
+        let chars: Vec<char> = case.reading.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=3.min(chars.len() - start) {
+                let reading: String = chars[start..start + len].iter().collect();
+                let entry = random_entry(&mut rng, format!("{reading}*"));
+                entries.entry(reading).or_default().push(entry);
+            }
+        }
+    }
+    let dict = TrieDictionary::from_entries(entries);
+    let conn = random_conn(&mut rng);
+
+    for case in &corpus.cases {
+        assert_same_nbest(&dict, &conn, &case.reading);
+    }
+}
@@ -0,0 +1,135 @@
+//! Surface-distinct N-best: `viterbi_nbest_distinct(n)` must return the
+//! same top-n surfaces as oversampling `viterbi_nbest` and deduplicating.
+
+use std::collections::BTreeMap;
+
+use super::*;
+use crate::converter::cost::DefaultCostFunction;
+use crate::converter::testutil::{corpus_readings, Rng};
+use crate::dict::{DictEntry, TrieDictionary};
+
+const NUM_IDS: u16 = 8;
+
+fn random_conn(rng: &mut Rng) -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let costs = (0..n * n).map(|_| rng.below(3000) as i16 - 500).collect();
+    ConnectionMatrix::new_owned(NUM_IDS, 1, 2, Vec::new(), costs)
+}
+
+fn random_entry(rng: &mut Rng, surface: String) -> DictEntry {
+    let id = rng.below(NUM_IDS as usize) as u16;
+    DictEntry {
+        surface,
+        cost: rng.below(6000) as i16 - 1000,
+        left_id: id,
+        right_id: id,
+    }
+}
+
+/// A kana surface and a marked one for every one- to three-character
+/// substring of `readings`. The kana surfaces make every all-kana
+/// segmentation of a stretch spell the same string, which is what crowds
+/// the lists of the plain search.
+fn dense_dict<'a>(rng: &mut Rng, readings: impl Iterator<Item = &'a str>) -> TrieDictionary {
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for reading in readings {
+        let chars: Vec<char> = reading.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=3.min(chars.len() - start) {
+                let sub: String = chars[start..start + len].iter().collect();
+                if entries.contains_key(&sub) {
+                    continue;
+                }
+                let list = vec![
+                    random_entry(rng, sub.clone()),
+                    random_entry(rng, format!("{sub}*")),
+                ];
+                entries.insert(sub, list);
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+type Surfaces = Vec<(i64, String)>;
+
+/// Costs and surfaces, ordered by cost and then surface so that equal-cost
+/// paths compare the same whichever order the search found them in.
+fn surfaces(paths: Vec<ScoredPath>) -> Surfaces {
+    let mut rows: Surfaces = paths
+        .into_iter()
+        .map(|p| (p.viterbi_cost, p.surface_key()))
+        .collect();
+    rows.sort();
+    rows
+}
+
+fn oversampled(lattice: &Lattice, cost_fn: &DefaultCostFunction, n: usize, k: usize) -> Surfaces {
+    let mut paths = viterbi_nbest(lattice, cost_fn, k);
+    paths.truncate(n);
+    surfaces(paths)
+}
+
+#[test]
+fn test_distinct_matches_oversample_on_accuracy_corpus() {
+    let readings = corpus_readings();
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    let dict = dense_dict(&mut rng, readings.iter().map(String::as_str));
+    let conn = random_conn(&mut rng);
+    let cost_fn = DefaultCostFunction::new(Some(&conn), &settings().cost);
+
+    for reading in &readings {
+        let lattice = build_lattice(&dict, reading);
+        for n in [1, 5, 10] {
+            assert_eq!(
+                surfaces(viterbi_nbest_distinct(&lattice, &cost_fn, n)),
+                oversampled(&lattice, &cost_fn, n, (n * 3).max(50)),
+                "reading {reading}, n = {n}"
+            );
+        }
+    }
+}
+
+#[test]
+fn test_distinct_is_exact_where_oversampling_falls_short() {
+    const KANA: [char; 4] = ['あ', 'い', 'か', 'し'];
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+    let readings: Vec<String> = (0..20)
+        .map(|_| {
+            let len = 4 + rng.below(7);
+            (0..len).map(|_| KANA[rng.below(KANA.len())]).collect()
+        })
+        .collect();
+    let dict = dense_dict(&mut rng, readings.iter().map(String::as_str));
+    let conn = random_conn(&mut rng);
+    let cost_fn = DefaultCostFunction::new(Some(&conn), &settings().cost);
+
+    let mut short = 0;
+    for reading in &readings {
+        let lattice = build_lattice(&dict, reading);
+        for n in [1, 3, 10] {
+            // Wide enough to hold every path of these short readings.
+            let exact = oversampled(&lattice, &cost_fn, n, 2000);
+            if oversampled(&lattice, &cost_fn, n, n) != exact {
+                short += 1;
+            }
+            assert_eq!(
+                surfaces(viterbi_nbest_distinct(&lattice, &cost_fn, n)),
+                exact,
+                "reading {reading}, n = {n}"
+            );
+        }
+    }
+    // Without oversampling, segmentation variants do crowd out surfaces.
+    assert!(short > 0);
+}
+
+#[test]
+fn test_distinct_empty_input_and_zero_n() {
+    let dict = crate::converter::testutil::test_dict();
+    let cost_fn = DefaultCostFunction::new(None, &settings().cost);
+    let lattice = build_lattice(&dict, "");
+    assert!(viterbi_nbest_distinct(&lattice, &cost_fn, 5).is_empty());
+    let lattice = build_lattice(&dict, "きょう");
+    assert!(viterbi_nbest_distinct(&lattice, &cost_fn, 0).is_empty());
+}
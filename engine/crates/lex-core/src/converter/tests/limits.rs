@@ -0,0 +1,209 @@
+//! Latency guards: pathological readings under tight node caps and work
+//! budgets still convert to a path covering the whole reading, and the
+//! default limits leave ordinary readings alone.
+
+use std::collections::BTreeMap;
+use std::sync::Arc;
+
+use super::*;
+use crate::converter::cost::DefaultCostFunction;
+use crate::converter::testutil::{corpus_readings, Rng};
+use crate::dict::{DictEntry, TrieDictionary};
+use crate::settings::{parse_settings_toml, DEFAULT_SETTINGS_TOML};
+
+const KANA: [char; 2] = ['あ', 'い'];
+const NUM_IDS: u16 = 8;
+
+/// Every string of up to five of `KANA` is a word with three surfaces, so
+/// every prefix at every position matches.
+fn every_prefix_dict(rng: &mut Rng) -> TrieDictionary {
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    let mut layer = vec![String::new()];
+    for _ in 0..5 {
+        layer = layer
+            .iter()
+            .flat_map(|s| KANA.iter().map(move |&c| format!("{s}{c}")))
+            .collect();
+        for reading in &layer {
+            let list = (0..3)
+                .map(|i| {
+                    let id = rng.below(NUM_IDS as usize) as u16;
+                    DictEntry {
+                        surface: format!("{reading}{i}"),
+                        cost: rng.below(6000) as i16,
+                        left_id: id,
+                        right_id: id,
+                    }
+                })
+                .collect();
+            entries.insert(reading.clone(), list);
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+fn adversarial_readings(rng: &mut Rng) -> Vec<String> {
+    let mut readings = vec!["あ".repeat(80), "あい".repeat(40), "あ".to_string()];
+    for _ in 0..5 {
+        let len = 40 + rng.below(40);
+        readings.push((0..len).map(|_| KANA[rng.below(KANA.len())]).collect());
+    }
+    readings
+}
+
+fn tight_limits() -> Settings {
+    let toml = DEFAULT_SETTINGS_TOML
+        .replace("max_nodes_per_position = 512", "max_nodes_per_position = 3")
+        .replace(
+            "viterbi_work_budget = 256000000",
+            "viterbi_work_budget = 500",
+        );
+    parse_settings_toml(&toml).unwrap()
+}
+
+fn assert_covers(paths: &[Vec<ConvertedSegment>], reading: &str, context: &str) {
+    assert!(!paths.is_empty(), "{context}: no conversion for {reading}");
+    for path in paths {
+        let covered: String = path.iter().map(|s| s.reading.as_str()).collect();
+        assert_eq!(covered, reading, "{context}");
+    }
+}
+
+#[test]
+fn test_tight_limits_still_convert() {
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+    let dict = every_prefix_dict(&mut rng);
+    let costs = (0..NUM_IDS as usize * NUM_IDS as usize)
+        .map(|_| rng.below(3000) as i16)
+        .collect();
+    let conn = ConnectionMatrix::new_owned(NUM_IDS, 1, 2, Vec::new(), costs);
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: Some(&conn),
+        history: None,
+    };
+    let settings = Arc::new(tight_limits());
+    let cap = settings.limits.max_nodes_per_position;
+    let cost_fn = DefaultCostFunction::new(Some(&conn), &settings.cost);
+
+    for reading in adversarial_readings(&mut rng) {
+        let lattice = build_lattice_with(&dict, &reading, Arc::clone(&settings));
+        assert!(lattice
+            .nodes_by_start
+            .iter()
+            .all(|row| row.len() <= cap + 1));
+        for (n, pool) in [(1, 10), (20, 60)] {
+            let plain = ctx.convert_lattice_impl(&lattice, n, pool, Search::Plain);
+            assert_covers(&plain, &reading, "plain");
+            let k = budgeted_n(&lattice, pool, settings.limits.viterbi_work_budget);
+            let distinct = viterbi_nbest_distinct(&lattice, &cost_fn, k);
+            assert!(!distinct.is_empty(), "distinct: no path for {reading}");
+            for path in &distinct {
+                let covered: String = path.segments.iter().map(|s| s.reading.as_str()).collect();
+                assert_eq!(covered, reading, "distinct");
+            }
+        }
+        let mut memo = ViterbiMemo::new();
+        let memoized = ctx.convert_lattice_impl(&lattice, 1, 10, Search::Memo(&mut memo));
+        assert_covers(&memoized, &reading, "memo");
+    }
+}
+
+#[test]
+fn test_tight_limits_survive_edits() {
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    let dict = every_prefix_dict(&mut rng);
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: None,
+        history: None,
+    };
+    let mut chars: Vec<char> = "あ".repeat(40).chars().collect();
+    let mut lattice = build_lattice_with(
+        &dict,
+        &chars.iter().collect::<String>(),
+        Arc::new(tight_limits()),
+    );
+    let mut memo = ViterbiMemo::new();
+    for _ in 0..20 {
+        let at = rng.below(chars.len());
+        chars[at] = KANA[rng.below(KANA.len())];
+        let reading: String = chars.iter().collect();
+        let (next, edit) = lattice.splice(&dict, &reading);
+        lattice = next;
+        memo.apply_edit(&lattice, &edit);
+        let paths = ctx.convert_lattice_impl(&lattice, 1, 10, Search::Memo(&mut memo));
+        assert_covers(&paths, &reading, "edit");
+    }
+}
+
+#[test]
+fn test_budget_only_binds_on_large_lattices() {
+    let mut rng = Rng(0x5851_f42d_4c95_7f2d);
+    let dict = every_prefix_dict(&mut rng);
+    let short = build_lattice_capped(&dict, "あいあい", usize::MAX);
+    assert_eq!(budgeted_n(&short, 50, 4_000_000), 50);
+
+    let long = build_lattice_capped(&dict, &"あ".repeat(80), usize::MAX);
+    let k = budgeted_n(&long, 50, 20_000);
+    assert!((1..50).contains(&k), "k = {k}");
+    assert_eq!(budgeted_n(&long, 50, 1), 1);
+    assert_eq!(budgeted_n(&long, 0, 1), 0);
+}
+
+/// Homophones per reading length, about those of the densest short
+/// readings of the Mozc dictionary (か, こう, しょう, ...).
+const DENSE_HOMOPHONES: [usize; 6] = [150, 120, 40, 12, 4, 4];
+
+/// Every one- to six-character substring of `readings` is a word with
+/// `DENSE_HOMOPHONES` surfaces: far denser than the shipped dictionary,
+/// where most substrings are no word at all.
+fn homophone_dense_dict<'a>(
+    rng: &mut Rng,
+    readings: impl Iterator<Item = &'a str>,
+) -> TrieDictionary {
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for reading in readings {
+        let chars: Vec<char> = reading.chars().collect();
+        for start in 0..chars.len() {
+            for len in 1..=DENSE_HOMOPHONES.len().min(chars.len() - start) {
+                let sub: String = chars[start..start + len].iter().collect();
+                entries.entry(sub.clone()).or_insert_with(|| {
+                    (0..DENSE_HOMOPHONES[len - 1])
+                        .map(|i| {
+                            let id = rng.below(2500) as u16;
+                            DictEntry {
+                                surface: format!("{sub}{i}"),
+                                cost: 3000 + rng.below(6000) as i16,
+                                left_id: id,
+                                right_id: id,
+                            }
+                        })
+                        .collect()
+                });
+            }
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+#[test]
+fn test_default_limits_leave_ordinary_readings_alone() {
+    // The corpus readings, and each with the next one as a longer phrase
+    // typed in one go.
+    let corpus = corpus_readings();
+    let mut readings = corpus.clone();
+    readings.extend(corpus.windows(2).map(|w| format!("{}{}", w[0], w[1])));
+    let mut rng = Rng(0x5851_f42d_4c95_7f2d);
+    let dict = homophone_dense_dict(&mut rng, readings.iter().map(String::as_str));
+    let settings = Arc::new(parse_settings_toml(DEFAULT_SETTINGS_TOML).unwrap());
+    let budget = settings.limits.viterbi_work_budget;
+    // The widest pool a conversion asks for: N-best with history.
+    let pool = (settings.candidates.nbest * 3).max(50);
+
+    for reading in &readings {
+        let lattice = build_lattice_with(&dict, reading, Arc::clone(&settings));
+        assert_eq!(lattice.dropped_nodes(), 0, "{reading}");
+        assert_eq!(budgeted_n(&lattice, pool, budget), pool, "{reading}");
+    }
+}
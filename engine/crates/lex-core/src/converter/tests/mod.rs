@@ -1,9 +1,15 @@
 use super::*;
+use crate::settings::{settings, Settings};
 
 mod basic;
 mod bench;
+mod cost_width;
+mod distinct;
 mod grouping;
 mod history;
+mod limits;
 mod nbest;
 mod reranker;
 mod rewriter;
+mod settings_snapshot;
+mod splice;
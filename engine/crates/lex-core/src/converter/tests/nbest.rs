@@ -91,7 +91,7 @@ fn test_nbest_includes_katakana_candidate() {
 fn test_nbest_sorted_by_cost() {
     // Verify N-best paths are returned in ascending cost order
     let dict = test_dict();
-    let cost_fn = DefaultCostFunction::new(None);
+    let cost_fn = DefaultCostFunction::new(None, &settings().cost);
     let lattice = build_lattice(&dict, "きょうは");
     let results = viterbi_nbest(&lattice, &cost_fn, 10);
 
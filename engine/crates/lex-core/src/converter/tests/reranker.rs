@@ -1,6 +1,7 @@
 use crate::converter::reranker::{history_rerank_at, rerank};
 use crate::converter::viterbi::{RichSegment, ScoredPath};
 use crate::dict::connection::ConnectionMatrix;
+use crate::settings::settings;
 use crate::user_history::{now_epoch, UserHistory};
 
 #[test]
@@ -57,7 +58,7 @@ fn test_rerank_penalizes_fragmented_path() {
         },
     ];
 
-    rerank(&mut paths, Some(&conn), None);
+    rerank(&mut paths, Some(&conn), None, &settings());
 
     // Fragmented: 1000 + 50 = 1050 > Single: 1040 + 0 = 1040
     assert_eq!(paths[0].segments[0].surface, "木の葉");
@@ -101,7 +102,7 @@ fn test_rerank_no_conn_no_structure_penalty() {
 
     // Without conn, structure cost is 0; "木の" (reading "きの" = 2 chars)
     // gets script_cost -3000 * 2/3 = -2000 (mixed kanji+kana bonus scaled).
-    rerank(&mut paths, None, None);
+    rerank(&mut paths, None, None, &settings());
     assert_eq!(paths[0].segments[0].surface, "木の");
     assert_eq!(paths[0].viterbi_cost, 2000 - 2000);
 }
@@ -120,7 +121,7 @@ fn test_rerank_single_path_noop() {
         history_boost: 0,
     }];
 
-    rerank(&mut paths, None, None);
+    rerank(&mut paths, None, None, &settings());
     assert_eq!(paths.len(), 1);
     assert_eq!(paths[0].segments[0].surface, "亜");
 }
@@ -128,7 +129,7 @@ fn test_rerank_single_path_noop() {
 #[test]
 fn test_rerank_empty_noop() {
     let mut paths: Vec<ScoredPath> = Vec::new();
-    rerank(&mut paths, None, None);
+    rerank(&mut paths, None, None, &settings());
     assert!(paths.is_empty());
 }
 
@@ -181,7 +182,7 @@ fn test_rerank_penalizes_uneven_segments() {
         },
     ];
 
-    rerank(&mut paths, None, None);
+    rerank(&mut paths, None, None, &settings());
 
     // script_cost (scaled by reading length, capped at 2):
     //   "来たり" (reading "きたり" = 3 chars, cap 2) → mixed bonus -3000 * 2/3 = -2000
@@ -225,7 +226,7 @@ fn test_rerank_applies_script_cost() {
         },
     ];
 
-    rerank(&mut paths, None, None);
+    rerank(&mut paths, None, None, &settings());
 
     // Katakana: 3000 + 5000 = 8000
     // Hiragana: 7000 + 0    = 7000
@@ -269,7 +270,7 @@ fn test_history_rerank_unigram_boost_reorders() {
         },
     ];
 
-    history_rerank_at(&mut paths, &h, None, now_epoch());
+    history_rerank_at(&mut paths, &h, &settings().history, None, now_epoch());
 
     // "京" should be boosted to first place
     assert_eq!(paths[0].segments[0].surface, "京");
@@ -325,7 +326,7 @@ fn test_history_rerank_bigram_boost() {
         },
     ];
 
-    history_rerank_at(&mut paths, &h, None, now_epoch());
+    history_rerank_at(&mut paths, &h, &settings().history, None, now_epoch());
 
     // "今日は" path should be boosted (both unigram + bigram) to first
     assert_eq!(paths[0].segments[0].surface, "今日");
@@ -360,7 +361,7 @@ fn test_history_rerank_empty_history_preserves_order() {
         },
     ];
 
-    history_rerank_at(&mut paths, &h, None, now_epoch());
+    history_rerank_at(&mut paths, &h, &settings().history, None, now_epoch());
 
     assert_eq!(paths[0].segments[0].surface, "亜");
     assert_eq!(paths[0].viterbi_cost, 1000);
@@ -372,7 +373,7 @@ fn test_history_rerank_empty_history_preserves_order() {
 fn test_history_rerank_empty_paths() {
     let h = UserHistory::new();
     let mut paths: Vec<ScoredPath> = Vec::new();
-    history_rerank_at(&mut paths, &h, None, now_epoch());
+    history_rerank_at(&mut paths, &h, &settings().history, None, now_epoch());
     assert!(paths.is_empty());
 }
 
@@ -400,12 +401,12 @@ fn test_history_rerank_at_matches_compute_history_boost() {
         viterbi_cost: 10_000,
         history_boost: 0,
     };
-    let expected_applied =
-        compute_history_boost(&path_before, &h, None, now).applied(path_before.segments.len());
+    let expected_applied = compute_history_boost(&path_before, &h, &settings().history, None, now)
+        .applied(path_before.segments.len());
 
     let initial_cost = path_before.viterbi_cost;
     let mut paths = vec![path_before];
-    history_rerank_at(&mut paths, &h, None, now);
+    history_rerank_at(&mut paths, &h, &settings().history, None, now);
     let actual_applied = initial_cost - paths[0].viterbi_cost;
 
     assert_eq!(actual_applied, expected_applied);
@@ -463,11 +464,11 @@ fn test_compute_history_boost_skips_function_word_unigram() {
     assert!(particle_boost > 0, "precondition: particle is boosted");
 
     // Without conn: both content word and particle contribute.
-    let without = compute_history_boost(&path, &h, None, now);
+    let without = compute_history_boost(&path, &h, &settings().history, None, now);
     assert_eq!(without.unigram_sum, content_boost + particle_boost);
 
     // With conn: the function-word particle is excluded from per-segment boost.
-    let with = compute_history_boost(&path, &h, Some(&conn), now);
+    let with = compute_history_boost(&path, &h, &settings().history, Some(&conn), now);
     assert_eq!(with.unigram_sum, content_boost);
 }
 
@@ -566,7 +567,7 @@ fn test_filter_drops_fragmented_paths() {
         },
     ];
 
-    rerank(&mut paths, Some(&conn), None);
+    rerank(&mut paths, Some(&conn), None, &settings());
 
     // Path C should have been filtered out (sc=20000 > threshold=9000);
     // paths A and B survive.
@@ -617,7 +618,7 @@ fn test_filter_keeps_all_when_all_exceed() {
         },
     ];
 
-    rerank(&mut paths, Some(&conn), None);
+    rerank(&mut paths, Some(&conn), None, &settings());
 
     // Both have identical structure_cost, so neither is filtered
     assert_eq!(paths.len(), 2);
@@ -679,7 +680,7 @@ fn test_filter_preserves_minimum_path() {
         },
     ];
 
-    rerank(&mut paths, Some(&conn), None);
+    rerank(&mut paths, Some(&conn), None, &settings());
 
     // Only the single-segment path (sc=0) should survive
     assert_eq!(paths.len(), 1);
@@ -779,7 +780,7 @@ fn test_prefix_floor_prevents_low_baseline() {
         },
     ];
 
-    rerank(&mut paths, Some(&conn), None);
+    rerank(&mut paths, Some(&conn), None, &settings());
 
     // Both paths survive thanks to the prefix floor raising the threshold.
     assert_eq!(paths.len(), 2);
@@ -0,0 +1,87 @@
+use std::sync::{Arc, Barrier};
+
+use super::*;
+use crate::converter::testutil::test_dict;
+use crate::settings::{parse_settings_toml, SettingsCell, DEFAULT_SETTINGS_TOML};
+use crate::user_history::UserHistory;
+
+fn no_boost_settings() -> Settings {
+    let toml = DEFAULT_SETTINGS_TOML.replace("boost_per_use = 3000", "boost_per_use = 0");
+    parse_settings_toml(&toml).unwrap()
+}
+
+#[test]
+fn test_conversion_uses_lattice_snapshot() {
+    let dict = test_dict();
+    let mut h = UserHistory::new();
+    h.record(&[("きょう".into(), "京".into())]);
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: None,
+        history: Some(&h),
+    };
+
+    let boosted = Arc::new(parse_settings_toml(DEFAULT_SETTINGS_TOML).unwrap());
+    let lattice = build_lattice_with(&dict, "きょう", boosted);
+    let paths = ctx.convert_lattice_impl(&lattice, 1, 30, Search::Plain);
+    assert_eq!(paths[0][0].surface, "京");
+
+    let lattice = build_lattice_with(&dict, "きょう", Arc::new(no_boost_settings()));
+    let paths = ctx.convert_lattice_impl(&lattice, 1, 30, Search::Plain);
+    assert_eq!(paths[0][0].surface, "今日");
+}
+
+#[test]
+fn test_lattice_and_scoring_share_one_snapshot() {
+    let dict = test_dict();
+    let toml = DEFAULT_SETTINGS_TOML.replace("unknown_word_cost = 10000", "unknown_word_cost = 7");
+    let lattice = build_lattice_with(&dict, "ぬ", Arc::new(parse_settings_toml(&toml).unwrap()));
+    assert_eq!(lattice.cost(0), 7);
+    assert_eq!(lattice.settings().cost.unknown_word_cost, 7);
+
+    // Splices and extensions keep the snapshot rather than re-reading it.
+    let (spliced, _) = lattice.splice(&dict, "ぬぬ");
+    assert!(Arc::ptr_eq(spliced.settings(), lattice.settings()));
+    assert!(spliced.nodes_by_start[1]
+        .iter()
+        .all(|&i| spliced.cost(i) == 7));
+    let mut extended = lattice.clone();
+    extended.extend(&dict, "ぬぬぬ");
+    assert!(extended.nodes_by_start[2]
+        .iter()
+        .all(|&i| extended.cost(i) == 7));
+}
+
+#[test]
+fn test_in_flight_conversion_keeps_snapshot_across_reload() {
+    let dict = test_dict();
+    let mut h = UserHistory::new();
+    h.record(&[("きょう".into(), "京".into())]);
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: None,
+        history: Some(&h),
+    };
+    let cell = SettingsCell::new(parse_settings_toml(DEFAULT_SETTINGS_TOML).unwrap());
+    let barrier = Barrier::new(2);
+
+    let (in_flight, after) = std::thread::scope(|scope| {
+        let worker = scope.spawn(|| {
+            // The lattice captures the snapshot; let the reload happen
+            // before any scoring runs.
+            let lattice = build_lattice_with(&dict, "きょう", cell.load());
+            barrier.wait();
+            barrier.wait();
+            ctx.convert_lattice_impl(&lattice, 1, 30, Search::Plain)
+        });
+        barrier.wait();
+        cell.replace(no_boost_settings());
+        barrier.wait();
+        let lattice = build_lattice_with(&dict, "きょう", cell.load());
+        let after = ctx.convert_lattice_impl(&lattice, 1, 30, Search::Plain);
+        (worker.join().unwrap(), after)
+    });
+
+    assert_eq!(in_flight[0][0].surface, "京", "in-flight keeps old weights");
+    assert_eq!(after[0][0].surface, "今日", "new conversion sees reload");
+}
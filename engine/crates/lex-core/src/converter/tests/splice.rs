@@ -0,0 +1,233 @@
+//! Differential test: editing a reading anywhere through `Lattice::splice`
+//! and `ViterbiMemo` must give exactly what rebuilding from scratch gives.
+
+use std::collections::BTreeMap;
+
+use super::*;
+use crate::converter::cost::DefaultCostFunction;
+use crate::converter::testutil::{test_dict, Rng};
+use crate::dict::{DictEntry, TrieDictionary};
+
+type NodeRow = (usize, usize, String, String, i16, u16, u16);
+
+fn nodes(lattice: &Lattice) -> Vec<NodeRow> {
+    (0..lattice.node_count())
+        .map(|i| {
+            (
+                lattice.start(i),
+                lattice.end(i),
+                lattice.reading(i).to_string(),
+                lattice.surface(i).to_string(),
+                lattice.cost(i),
+                lattice.left_id(i),
+                lattice.right_id(i),
+            )
+        })
+        .collect()
+}
+
+fn assert_same_lattice(spliced: &Lattice, dict: &dyn Dictionary, cap: usize, context: &str) {
+    let full = build_lattice_capped(dict, &spliced.input, cap);
+    assert_eq!(spliced.char_count, full.char_count, "{context}");
+    assert_eq!(nodes(spliced), nodes(&full), "{context}");
+    assert_eq!(spliced.nodes_by_start, full.nodes_by_start, "{context}");
+    assert_eq!(spliced.nodes_by_end, full.nodes_by_end, "{context}");
+    assert_eq!(spliced.dropped_nodes(), full.dropped_nodes(), "{context}");
+}
+
+type PathRow = (i64, Vec<(String, String)>);
+
+fn paths(paths: Vec<ScoredPath>) -> Vec<PathRow> {
+    paths
+        .into_iter()
+        .map(|p| {
+            let segments = p
+                .segments
+                .into_iter()
+                .map(|s| (s.reading, s.surface))
+                .collect();
+            (p.viterbi_cost, segments)
+        })
+        .collect()
+}
+
+fn random_kana(rng: &mut Rng, len: usize) -> String {
+    (0..len).map(|_| KANA[rng.below(KANA.len())]).collect()
+}
+
+const KANA: [char; 6] = ['あ', 'い', 'か', 'き', 'し', 'ん'];
+const NUM_IDS: u16 = 8;
+
+fn random_dict(rng: &mut Rng) -> TrieDictionary {
+    let mut entries: BTreeMap<String, Vec<DictEntry>> = BTreeMap::new();
+    for _ in 0..80 {
+        let len = 1 + rng.below(4);
+        let reading = random_kana(rng, len);
+        let count = 1 + rng.below(3);
+        let list = entries.entry(reading.clone()).or_default();
+        for i in 0..count {
+            let id = rng.below(NUM_IDS as usize) as u16;
+            list.push(DictEntry {
+                // Repeats across draws give the lattice repeated entries.
+                surface: format!("{reading}{}", i % 2),
+                cost: (rng.below(6000) as i16) - 1000,
+                left_id: id,
+                right_id: id,
+            });
+        }
+    }
+    TrieDictionary::from_entries(entries)
+}
+
+fn random_conn(rng: &mut Rng) -> ConnectionMatrix {
+    let n = NUM_IDS as usize;
+    let costs = (0..n * n).map(|_| rng.below(3000) as i16 - 500).collect();
+    ConnectionMatrix::new_owned(NUM_IDS, 1, 2, Vec::new(), costs)
+}
+
+/// Replace a random range of `chars` (possibly empty) with random kana
+/// (possibly none): an insertion, deletion or replacement anywhere,
+/// appends and pops included.
+fn random_edit(rng: &mut Rng, chars: &mut Vec<char>) {
+    let at = rng.below(chars.len() + 1);
+    let removed = match rng.below(3) {
+        0 => 0,
+        _ => rng.below((chars.len() - at).min(4) + 1),
+    };
+    let inserted = match rng.below(3) {
+        0 => 0,
+        _ => 1 + rng.below(4),
+    };
+    let text: Vec<char> = random_kana(rng, inserted).chars().collect();
+    chars.splice(at..at + removed, text);
+}
+
+#[test]
+fn test_splice_matches_build_on_random_edit_scripts() {
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+    for round in 0..30 {
+        let dict = random_dict(&mut rng);
+        let conns = [random_conn(&mut rng), random_conn(&mut rng)];
+        // Every third round caps positions tightly enough to drop nodes.
+        let cap = if round % 3 == 0 { 2 } else { usize::MAX };
+        let len = rng.below(30);
+        let mut chars: Vec<char> = random_kana(&mut rng, len).chars().collect();
+        let mut lattice = build_lattice_capped(&dict, &chars.iter().collect::<String>(), cap);
+        let mut memos = [ViterbiMemo::new(), ViterbiMemo::new()];
+
+        for step in 0..40 {
+            random_edit(&mut rng, &mut chars);
+            let reading: String = chars.iter().collect();
+            let (next, edit) = lattice.splice(&dict, &reading);
+            lattice = next;
+            let context = format!("round {round}, step {step}, {reading}");
+            assert_same_lattice(&lattice, &dict, cap, &context);
+
+            // Mostly the same costs, sometimes a different matrix, which
+            // must not reuse the other matrix's tables.
+            let conn = &conns[usize::from(rng.below(8) == 0)];
+            let cost_fn = DefaultCostFunction::new(Some(conn), &settings().cost);
+            for (memo, n) in memos.iter_mut().zip([1, 10]) {
+                memo.apply_edit(&lattice, &edit);
+                assert_eq!(
+                    paths(viterbi_nbest_memo(&lattice, &cost_fn, n, memo)),
+                    paths(viterbi_nbest(&lattice, &cost_fn, n)),
+                    "{context}, n = {n}"
+                );
+            }
+        }
+    }
+}
+
+#[test]
+fn test_extend_matches_build_on_random_appends() {
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    for round in 0..30 {
+        let dict = random_dict(&mut rng);
+        let conn = random_conn(&mut rng);
+        let cost_fn = DefaultCostFunction::new(Some(&conn), &settings().cost);
+        // Every third round caps positions, which forces some appends
+        // through `splice`.
+        let cap = if round % 3 == 0 { 2 } else { usize::MAX };
+        let len = rng.below(4);
+        let mut reading = random_kana(&mut rng, len);
+        let mut lattice = build_lattice_capped(&dict, &reading, cap);
+        let mut memo = ViterbiMemo::new();
+
+        for step in 0..20 {
+            let len = 1 + rng.below(3);
+            reading.push_str(&random_kana(&mut rng, len));
+            let edit = lattice.extend(&dict, &reading);
+            let context = format!("round {round}, step {step}, {reading}");
+            let full = build_lattice_capped(&dict, &reading, cap);
+            let sorted = |l: &Lattice| {
+                let mut rows = nodes(l);
+                rows.sort();
+                rows
+            };
+            assert_eq!(sorted(&lattice), sorted(&full), "{context}");
+            assert_eq!(lattice.dropped_nodes(), full.dropped_nodes(), "{context}");
+
+            memo.apply_edit(&lattice, &edit);
+            assert_eq!(
+                paths(viterbi_nbest_memo(&lattice, &cost_fn, 10, &mut memo)),
+                paths(viterbi_nbest(&lattice, &cost_fn, 10)),
+                "{context}"
+            );
+        }
+    }
+}
+
+#[test]
+fn test_splice_reports_edit_span() {
+    let dict = test_dict();
+    let lattice = build_lattice(&dict, "きょうはいいてんき");
+    let (next, edit) = lattice.splice(&dict, "きょうはてんき");
+    assert_eq!((edit.start, edit.new_end), (4, 4));
+    assert_eq!(edit.old_node_count(), lattice.node_count());
+
+    // Nodes right of the edit are kept, moved two positions left.
+    let tenki = (0..lattice.node_count())
+        .find(|&i| lattice.surface(i) == "天気")
+        .unwrap();
+    let moved = edit.new_index(tenki).unwrap();
+    assert_eq!((next.start(moved), next.surface(moved)), (4, "天気"));
+
+    // Nodes crossing into the edit are rebuilt.
+    let ii = (0..lattice.node_count())
+        .find(|&i| lattice.surface(i) == "良い")
+        .unwrap();
+    assert_eq!(edit.new_index(ii), None);
+}
+
+#[test]
+fn test_memo_conversion_matches_plain() {
+    let dict = test_dict();
+    let ctx = ConversionContext {
+        dict: &dict,
+        conn: None,
+        history: None,
+    };
+    let mut memo = ViterbiMemo::new();
+    let mut lattice = build_lattice(&dict, "きょうは");
+    for reading in [
+        "きょうはいいてんき",
+        "きょうはいいてんき",
+        "きょうはてんき",
+        "わたしはてんき",
+        "わたしはがくせいです",
+    ] {
+        let (next, edit) = lattice.splice(&dict, reading);
+        lattice = next;
+        memo.apply_edit(&lattice, &edit);
+        let surfaces = |segments: Vec<ConvertedSegment>| -> Vec<String> {
+            segments.into_iter().map(|s| s.surface).collect()
+        };
+        assert_eq!(
+            surfaces(ctx.convert_from_lattice_with_memo(&lattice, &mut memo)),
+            surfaces(ctx.convert_from_lattice(&lattice)),
+            "{reading}"
+        );
+    }
+    assert!(memo.heap_bytes() > 0);
+}
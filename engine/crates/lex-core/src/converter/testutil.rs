@@ -3,6 +3,24 @@
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::{DictEntry, TrieDictionary};
 
+/// xorshift64 for randomized tests: deterministic without pulling in a
+/// rand dependency.
+pub struct Rng(pub u64);
+
+impl Rng {
+    pub fn next(&mut self) -> u64 {
+        self.0 ^= self.0 << 13;
+        self.0 ^= self.0 >> 7;
+        self.0 ^= self.0 << 17;
+        self.0
+    }
+
+    /// Uniform enough in `0..n` for test inputs.
+    pub fn below(&mut self, n: usize) -> usize {
+        (self.next() % n as u64) as usize
+    }
+}
+
 /// Shared test dictionary for converter tests.
 ///
 /// Contains entries for a representative set of words used across
@@ -133,3 +151,18 @@ pub fn zero_conn_with_roles(num_ids: u16, roles: Vec<u8>) -> ConnectionMatrix {
     let text = format!("{num_ids} {num_ids}\n{}", "0\n".repeat(n * n));
     ConnectionMatrix::from_text_with_roles(&text, 0, 0, roles).unwrap()
 }
+
+/// Readings of the accuracy corpus (`testcorpus/accuracy-corpus.toml`).
+pub fn corpus_readings() -> Vec<String> {
+    #[derive(serde::Deserialize)]
+    struct Corpus {
+        cases: Vec<Case>,
+    }
+    #[derive(serde::Deserialize)]
+    struct Case {
+        reading: String,
+    }
+    let corpus: Corpus =
+        toml::from_str(include_str!("../../../../testcorpus/accuracy-corpus.toml")).unwrap();
+    corpus.cases.into_iter().map(|c| c.reading).collect()
+}
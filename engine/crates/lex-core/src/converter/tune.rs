@@ -117,11 +117,12 @@ pub fn precompute_cases(
     let cap = s.reranker.structure_cost_transition_cap;
     let prefix_floor = (s.reranker.structure_cost_filter / 2).min(cap);
     let filter = s.reranker.structure_cost_filter;
-    let cost_fn = DefaultCostFunction::new(Some(conn));
+    let cost_fn = DefaultCostFunction::new(Some(conn), &s.cost);
 
     let fcfg = FeatureConfig {
         conn: Some(conn),
         dict: Some(dict),
+        cost: &s.cost,
         structure_cap: cap,
         prefix_floor,
     };
@@ -133,7 +134,7 @@ pub fn precompute_cases(
             let mut paths = viterbi_nbest(&lattice, &cost_fn, 30);
 
             // Resegment
-            let reseg = resegment::resegment(&paths, &lattice, Some(conn));
+            let reseg = resegment::resegment(&paths, &lattice, Some(conn), &s.cost);
             paths.extend(reseg);
             let mut paired: Vec<(ScoredPath, PathFeatures)> = paths
                 .into_iter()
@@ -1,7 +1,7 @@
 use tracing::{debug, debug_span};
 
 use super::cost::CostFunction;
-use super::lattice::Lattice;
+use super::lattice::{Lattice, LatticeEdit};
 
 /// A segment in the conversion result.
 #[derive(Debug, Clone)]
@@ -103,11 +103,44 @@ impl ScoredPath {
 /// A single entry in the top-K list for a node: (accumulated cost, previous node index, rank at
 /// that node). `prev_rank` identifies which of the K paths at the previous node this entry
 /// continues from.
+///
+/// Packed into 12 bytes: `i32` cost (see the bound on `CostFunction`) and `u32` indices, with
+/// [`BOS`] standing in for "no previous node". Lattices never approach 2^32 nodes.
 #[derive(Clone, Copy)]
 struct KEntry {
-    cost: i64,
-    prev_idx: Option<usize>,
-    prev_rank: usize,
+    cost: i32,
+    prev_idx: u32,
+    prev_rank: u32,
+}
+
+/// `KEntry::prev_idx` of a path's first node.
+const BOS: u32 = u32::MAX;
+
+/// `ViterbiMemo::cutoff` of a node without a computed top-K list.
+const NO_ROW: i32 = i32::MIN;
+
+/// Headroom added to the previous conversion's cost spread when bounding the
+/// forward pass; a bound that turns out too tight costs one more pass.
+const BOUND_SLACK: i32 = 1000;
+
+/// Paths per node a search over `lattice` may keep to stay within `budget`
+/// relaxations (edges times paths per node): `n`, or fewer, down to one,
+/// on lattices with too many edges. One path per node is still an exact
+/// 1-best search, so the conversion degrades to fewer candidates rather
+/// than to no result.
+pub(crate) fn budgeted_n(lattice: &Lattice, n: usize, budget: usize) -> usize {
+    // BOS counts as the one predecessor of the nodes at position 0.
+    let edges: usize = (0..lattice.char_count)
+        .map(|pos| lattice.nodes_by_start[pos].len() * lattice.nodes_by_end[pos].len().max(1))
+        .sum();
+    let k = n.min((budget / edges.max(1)).max(1));
+    if k < n {
+        debug!(
+            n,
+            k, edges, budget, "viterbi work budget: fewer paths per node"
+        );
+    }
+    k
 }
 
 /// Run N-best Viterbi: keep top-K cost/backpointer pairs per node.
@@ -131,56 +164,452 @@ pub(crate) fn viterbi_nbest<C: CostFunction>(
     let num_nodes = lattice.node_count();
     // top_k[node_idx] = sorted Vec of KEntry (ascending cost), max `n` entries
     let mut top_k: Vec<Vec<KEntry>> = vec![Vec::new(); num_nodes];
+    let mut cutoff = vec![NO_ROW; num_nodes];
+    forward_pass(lattice, cost_fn, n, &mut top_k, &mut cutoff, &[], i32::MAX);
+    let (results, _) = collect_paths(lattice, cost_fn, &top_k, n, i32::MAX);
+
+    debug!(
+        result_count = results.len(),
+        best_cost = results.first().map(|p| p.viterbi_cost)
+    );
+    results
+}
+
+/// Viterbi tables kept between conversions of one composition.
+///
+/// Holds the top-K lists of the forward pass and, per node, the cheapest
+/// completion cost from the node's end to EOS (a 1-best backward pass).
+/// After [`Lattice::splice`], [`Self::apply_edit`] keeps the lists of nodes
+/// left of the edit and the completion costs of nodes right of it, so the
+/// next [`viterbi_nbest_memo`] only recomputes what the edit can reach.
+///
+/// The completion costs also bound the forward pass: an entry whose cost
+/// plus its node's completion cost exceeds a bound derived from the previous
+/// conversion cannot reach the N-best list within that bound and is not
+/// kept. If fewer than `n` paths come in under the bound, the pass is
+/// repeated without it, so results always equal [`viterbi_nbest`]'s.
+#[derive(Default)]
+pub struct ViterbiMemo {
+    /// `(n, CostFunction::memo_key)` the tables were computed with.
+    key: Option<(usize, (usize, i32))>,
+    /// Input and node count of the lattice the tables belong to.
+    input: String,
+    node_count: usize,
+    top_k: Vec<Vec<KEntry>>,
+    /// `top_k[i]` holds every entry of the unbounded list up to this cost
+    /// (`i32::MAX`: the whole list; [`NO_ROW`]: not computed).
+    cutoff: Vec<i32>,
+    /// Cheapest cost from the end of node `i` to EOS, `i32::MAX` when EOS is
+    /// unreachable; valid where `tail_known[i]`.
+    tail: Vec<i32>,
+    tail_known: Vec<bool>,
+    /// Cost of the `n`-th path above the best one in the last conversion;
+    /// `None` when it returned fewer than `n` paths.
+    spread: Option<i32>,
+}
+
+impl ViterbiMemo {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Forget all tables.
+    pub fn clear(&mut self) {
+        self.key = None;
+        self.input.clear();
+        self.node_count = 0;
+        self.top_k.clear();
+        self.cutoff.clear();
+        self.tail.clear();
+        self.tail_known.clear();
+        self.spread = None;
+    }
+
+    /// Heap bytes reserved by the tables.
+    pub fn heap_bytes(&self) -> usize {
+        use std::mem::size_of;
+        self.input.capacity()
+            + self.top_k.capacity() * size_of::<Vec<KEntry>>()
+            + self
+                .top_k
+                .iter()
+                .map(|row| row.capacity() * size_of::<KEntry>())
+                .sum::<usize>()
+            + self.cutoff.capacity() * size_of::<i32>()
+            + self.tail.capacity() * size_of::<i32>()
+            + self.tail_known.capacity()
+    }
+
+    /// Carry the tables over to `lattice`, the result of the `splice` that
+    /// produced `edit`. Tables that do not belong to the spliced lattice are
+    /// cleared.
+    pub fn apply_edit(&mut self, lattice: &Lattice, edit: &LatticeEdit) {
+        if self.key.is_none()
+            || self.input != edit.old_input
+            || self.node_count != edit.old_node_count()
+        {
+            self.clear();
+            return;
+        }
+        let num_nodes = lattice.node_count();
+        let mut top_k = vec![Vec::new(); num_nodes];
+        let mut cutoff = vec![NO_ROW; num_nodes];
+        let mut tail = vec![i32::MAX; num_nodes];
+        let mut tail_known = vec![false; num_nodes];
+        for old in 0..self.node_count {
+            let Some(new) = edit.new_index(old) else {
+                continue;
+            };
+            // Paths from BOS to a node left of the edit are unchanged, and
+            // so are their predecessors.
+            if self.cutoff[old] != NO_ROW && lattice.end(new) <= edit.start {
+                let mut row = std::mem::take(&mut self.top_k[old]);
+                for entry in &mut row {
+                    if entry.prev_idx != BOS {
+                        let prev = edit.new_index(entry.prev_idx as usize);
+                        debug_assert!(prev.is_some(), "predecessor of a kept node dropped");
+                        entry.prev_idx = prev.map_or(BOS, |p| p as u32);
+                    }
+                }
+                top_k[new] = row;
+                cutoff[new] = self.cutoff[old];
+            }
+            if self.tail_known[old] && lattice.start(new) >= edit.new_end {
+                tail[new] = self.tail[old];
+                tail_known[new] = true;
+            }
+        }
+        self.input.clone_from(&lattice.input);
+        self.node_count = num_nodes;
+        self.top_k = top_k;
+        self.cutoff = cutoff;
+        self.tail = tail;
+        self.tail_known = tail_known;
+    }
+
+    /// Make the tables belong to `lattice` under `key`, dropping them if
+    /// they belong to anything else.
+    fn prepare(&mut self, lattice: &Lattice, key: (usize, (usize, i32))) {
+        let num_nodes = lattice.node_count();
+        if self.key == Some(key) && self.input == lattice.input && self.node_count == num_nodes {
+            return;
+        }
+        self.clear();
+        self.key = Some(key);
+        self.input.push_str(&lattice.input);
+        self.node_count = num_nodes;
+        self.top_k.resize_with(num_nodes, Vec::new);
+        self.cutoff.resize(num_nodes, NO_ROW);
+        self.tail.resize(num_nodes, i32::MAX);
+        self.tail_known.resize(num_nodes, false);
+    }
+
+    /// Backward pass: fill in every completion cost not already known.
+    fn complete_tails<C: CostFunction>(&mut self, lattice: &Lattice, cost_fn: &C) {
+        let char_count = lattice.char_count;
+        // Cost from entering node `i` to EOS, for nodes starting at `pos`.
+        let mut head = vec![i32::MAX; lattice.node_count()];
+        for pos in (1..=char_count).rev() {
+            if lattice.nodes_by_end[pos]
+                .iter()
+                .all(|&u| self.tail_known[u])
+            {
+                continue;
+            }
+            if pos < char_count {
+                for &v in &lattice.nodes_by_start[pos] {
+                    if self.tail[v] != i32::MAX && cost_fn.allows(lattice, v) {
+                        head[v] = cost_fn.word_cost(lattice, v).saturating_add(self.tail[v]);
+                    }
+                }
+            }
+            for &u in &lattice.nodes_by_end[pos] {
+                if self.tail_known[u] {
+                    continue;
+                }
+                self.tail_known[u] = true;
+                self.tail[u] = if !cost_fn.allows(lattice, u) {
+                    i32::MAX
+                } else if pos == char_count {
+                    cost_fn.eos_cost(lattice.right_id(u))
+                } else {
+                    let right_id = lattice.right_id(u);
+                    lattice.nodes_by_start[pos]
+                        .iter()
+                        .filter(|&&v| head[v] != i32::MAX)
+                        .map(|&v| {
+                            cost_fn
+                                .transition_cost(right_id, lattice.left_id(v))
+                                .saturating_add(head[v])
+                        })
+                        .min()
+                        .unwrap_or(i32::MAX)
+                };
+            }
+        }
+    }
+}
+
+/// [`viterbi_nbest`] reusing and updating the tables in `memo`.
+///
+/// Returns exactly what `viterbi_nbest(lattice, cost_fn, n)` returns. Cost
+/// functions without a [`CostFunction::memo_key`] bypass the memo.
+pub(crate) fn viterbi_nbest_memo<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    n: usize,
+    memo: &mut ViterbiMemo,
+) -> Vec<ScoredPath> {
+    let char_count = lattice.char_count;
+    let Some(key) = cost_fn.memo_key() else {
+        return viterbi_nbest(lattice, cost_fn, n);
+    };
+    let _span = debug_span!("viterbi_nbest_memo", n, char_count).entered();
+    if char_count == 0 || n == 0 {
+        return Vec::new();
+    }
+    debug_assert!(
+        lattice.node_count() < BOS as usize,
+        "lattice too large for u32 backpointers"
+    );
+
+    memo.prepare(lattice, (n, key));
+    memo.complete_tails(lattice, cost_fn);
+    let best = lattice.nodes_by_start[0]
+        .iter()
+        .filter(|&&i| memo.tail[i] != i32::MAX && cost_fn.allows(lattice, i))
+        .map(|&i| {
+            cost_fn
+                .bos_cost(lattice.left_id(i))
+                .saturating_add(cost_fn.word_cost(lattice, i))
+                .saturating_add(memo.tail[i])
+        })
+        .min()
+        .unwrap_or(i32::MAX);
+    let mut bound = match memo.spread {
+        Some(spread) if best != i32::MAX => best
+            .saturating_add(spread.saturating_mul(2))
+            .saturating_add(BOUND_SLACK),
+        _ => i32::MAX,
+    };
+
+    let (results, stop_cost) = loop {
+        forward_pass(
+            lattice,
+            cost_fn,
+            n,
+            &mut memo.top_k,
+            &mut memo.cutoff,
+            &memo.tail,
+            bound,
+        );
+        let (results, stop_cost) = collect_paths(lattice, cost_fn, &memo.top_k, n, bound);
+        if results.len() == n || bound == i32::MAX {
+            break (results, stop_cost);
+        }
+        debug!(bound, "bound too tight, repeating unbounded");
+        bound = i32::MAX;
+    };
+    memo.spread = stop_cost.map(|cost| cost.saturating_sub(best));
+
+    debug!(
+        result_count = results.len(),
+        best_cost = results.first().map(|p| p.viterbi_cost),
+        bound
+    );
+    results
+}
+
+/// N-best Viterbi that keeps only the best path per surface string.
+///
+/// Each node's top-K list holds at most one entry per distinct surface of
+/// the path up to and including the node, identified by a hash of that
+/// prefix. A path that is the cheapest for its surface overall is also the
+/// cheapest for its prefix at every node it passes through, and its prefix
+/// can only drop out of a list behind `n` cheaper distinct prefixes, which
+/// would give `n` cheaper distinct surfaces. So this returns the `n`
+/// cheapest distinct surfaces, each with its best path, without the
+/// segmentation variants that crowd [`viterbi_nbest`]'s lists and have to
+/// be traced back and discarded at EOS.
+pub(crate) fn viterbi_nbest_distinct<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    n: usize,
+) -> Vec<ScoredPath> {
+    let char_count = lattice.char_count;
+    let _span = debug_span!("viterbi_nbest_distinct", n, char_count).entered();
+    if char_count == 0 || n == 0 {
+        return Vec::new();
+    }
+    debug_assert!(
+        lattice.node_count() < BOS as usize,
+        "lattice too large for u32 backpointers"
+    );
+
+    let num_nodes = lattice.node_count();
+    let mut top_k: Vec<Vec<KEntry>> = vec![Vec::new(); num_nodes];
+    // keys[i][r]: surface hash of the path prefix of top_k[i][r].
+    let mut keys: Vec<Vec<u64>> = vec![Vec::new(); num_nodes];
+
+    for pos in 0..char_count {
+        for &next_idx in &lattice.nodes_by_start[pos] {
+            if !cost_fn.allows(lattice, next_idx) {
+                continue;
+            }
+            let word = cost_fn.word_cost(lattice, next_idx);
+            let next_left_id = lattice.left_id(next_idx);
+            let surface = SurfaceHash::of(lattice.surface(next_idx));
+
+            if pos == 0 {
+                top_k[next_idx].push(KEntry {
+                    cost: word.saturating_add(cost_fn.bos_cost(next_left_id)),
+                    prev_idx: BOS,
+                    prev_rank: 0,
+                });
+                keys[next_idx].push(surface.append_to(0));
+                continue;
+            }
 
-    // Initialize nodes starting at position 0 (BOS transition)
-    for &idx in &lattice.nodes_by_start[0] {
-        let cost = cost_fn.word_cost(lattice, idx) + cost_fn.bos_cost(lattice.left_id(idx));
-        top_k[idx].push(KEntry {
-            cost,
-            prev_idx: None,
-            prev_rank: 0,
-        });
+            for &prev_idx in &lattice.nodes_by_end[pos] {
+                let step = cost_fn
+                    .transition_cost(lattice.right_id(prev_idx), next_left_id)
+                    .saturating_add(word);
+                for rank in 0..top_k[prev_idx].len() {
+                    let entry = KEntry {
+                        cost: top_k[prev_idx][rank].cost.saturating_add(step),
+                        prev_idx: prev_idx as u32,
+                        prev_rank: rank as u32,
+                    };
+                    if is_full_below(&top_k[next_idx], n, entry.cost) {
+                        break;
+                    }
+                    let key = surface.append_to(keys[prev_idx][rank]);
+                    insert_top_k_distinct(&mut top_k[next_idx], &mut keys[next_idx], n, entry, key);
+                }
+            }
+        }
     }
+    let (results, _) = collect_paths(lattice, cost_fn, &top_k, n, i32::MAX);
+
+    debug!(
+        result_count = results.len(),
+        best_cost = results.first().map(|p| p.viterbi_cost)
+    );
+    results
+}
+
+/// Forward pass: fill `top_k` from BOS to EOS.
+///
+/// With a finite `bound`, node `i` only keeps entries costing at most
+/// `bound - tail[i]`: anything above cannot finish within `bound`. Lists
+/// whose `cutoff` already covers that cost are kept as they are; every
+/// other list is recomputed and its `cutoff` updated. Each list therefore
+/// holds exactly the entries of the unbounded list up to its cutoff, at the
+/// same ranks. With `bound == i32::MAX`, `tail` is not read.
+fn forward_pass<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    n: usize,
+    top_k: &mut [Vec<KEntry>],
+    cutoff: &mut [i32],
+    tail: &[i32],
+    bound: i32,
+) {
+    debug_assert!(
+        lattice.node_count() < BOS as usize,
+        "lattice too large for u32 backpointers"
+    );
+    let needed = |idx: usize| {
+        if bound == i32::MAX {
+            i32::MAX
+        } else {
+            bound.saturating_sub(tail[idx])
+        }
+    };
 
     // Forward pass — next_idx loop is outermost so word_cost is computed
     // once per next_node (O(P)) instead of once per (prev, next) pair (O(P²)).
-    for pos in 1..char_count {
+    for pos in 0..lattice.char_count {
         for &next_idx in &lattice.nodes_by_start[pos] {
+            let limit = needed(next_idx);
+            if cutoff[next_idx] >= limit {
+                continue;
+            }
+            top_k[next_idx].clear();
+            cutoff[next_idx] = limit;
+            // Skipped nodes keep an empty top-K list, which also removes
+            // them as predecessors.
+            if !cost_fn.allows(lattice, next_idx) {
+                continue;
+            }
             let word = cost_fn.word_cost(lattice, next_idx);
             let next_left_id = lattice.left_id(next_idx);
 
+            if pos == 0 {
+                // BOS transition
+                let cost = word.saturating_add(cost_fn.bos_cost(next_left_id));
+                if cost <= limit {
+                    top_k[next_idx].push(KEntry {
+                        cost,
+                        prev_idx: BOS,
+                        prev_rank: 0,
+                    });
+                }
+                continue;
+            }
+
             for &prev_idx in &lattice.nodes_by_end[pos] {
                 if top_k[prev_idx].is_empty() {
                     continue;
                 }
                 let prev_right_id = lattice.right_id(prev_idx);
-                let transition = cost_fn.transition_cost(prev_right_id, next_left_id);
+                let step = cost_fn
+                    .transition_cost(prev_right_id, next_left_id)
+                    .saturating_add(word);
 
                 for rank in 0..top_k[prev_idx].len() {
                     let prev_cost = top_k[prev_idx][rank].cost;
-                    let total = prev_cost + transition + word;
+                    let total = prev_cost.saturating_add(step);
+                    // Lists are sorted, so the rest of this one is over too.
+                    if total > limit || is_full_below(&top_k[next_idx], n, total) {
+                        break;
+                    }
 
                     insert_top_k(
                         &mut top_k[next_idx],
                         n,
                         KEntry {
                             cost: total,
-                            prev_idx: Some(prev_idx),
-                            prev_rank: rank,
+                            prev_idx: prev_idx as u32,
+                            prev_rank: rank as u32,
                         },
                     );
                 }
             }
         }
     }
+}
+
+/// Collect up to `n` surface-distinct paths costing at most `bound`, best
+/// first. Also returns the cost of the `n`-th path, when there is one.
+fn collect_paths<C: CostFunction>(
+    lattice: &Lattice,
+    cost_fn: &C,
+    top_k: &[Vec<KEntry>],
+    n: usize,
+    bound: i32,
+) -> (Vec<ScoredPath>, Option<i32>) {
+    let char_count = lattice.char_count;
 
     // Collect top-K at EOS
-    let mut eos_entries: Vec<(i64, usize, usize)> = Vec::new(); // (total_cost, node_idx, rank)
+    let mut eos_entries: Vec<(i32, usize, usize)> = Vec::new(); // (total_cost, node_idx, rank)
     for &node_idx in &lattice.nodes_by_end[char_count] {
         let eos = cost_fn.eos_cost(lattice.right_id(node_idx));
         for (rank, entry) in top_k[node_idx].iter().enumerate() {
-            let total = entry.cost + eos;
-            eos_entries.push((total, node_idx, rank));
+            let total = entry.cost.saturating_add(eos);
+            if total <= bound {
+                eos_entries.push((total, node_idx, rank));
+            }
         }
     }
     eos_entries.sort_by_key(|&(cost, _, _)| cost);
@@ -190,30 +619,33 @@ pub(crate) fn viterbi_nbest<C: CostFunction>(
     let mut seen_surfaces: std::collections::HashSet<String> = std::collections::HashSet::new();
 
     for &(total_cost, end_idx, end_rank) in &eos_entries {
-        if results.len() >= n {
-            break;
-        }
-        let segments = backtrace_nbest(&top_k, end_idx, end_rank, lattice);
+        let segments = backtrace_nbest(top_k, end_idx, end_rank, lattice);
         let scored = ScoredPath {
             segments,
-            viterbi_cost: total_cost,
+            viterbi_cost: total_cost.into(),
             history_boost: 0,
         };
         if seen_surfaces.insert(scored.surface_key()) {
             results.push(scored);
+            if results.len() >= n {
+                return (results, Some(total_cost));
+            }
         }
     }
+    (results, None)
+}
 
-    debug!(
-        result_count = results.len(),
-        best_cost = results.first().map(|p| p.viterbi_cost)
-    );
-    results
+/// Whether a top-K list already holds `k` entries costing at most `cost`,
+/// so neither an entry at `cost` nor any costlier one can get in.
+/// (`insert_top_k_distinct` too: a listed entry with the same key would
+/// cost no more.)
+fn is_full_below(list: &[KEntry], k: usize, cost: i32) -> bool {
+    list.len() >= k && list[k - 1].cost <= cost
 }
 
 /// Insert a KEntry into a top-K list, maintaining ascending sort by cost and max size `k`.
 ///
-/// `Vec::insert` is O(k) due to memmove, but k is small (30-50) and KEntry is 32 bytes,
+/// `Vec::insert` is O(k) due to memmove, but k is small (30-50) and KEntry is 12 bytes,
 /// so the shift fits in L1 cache. A BinaryHeap would give O(log k) insert but breaks
 /// the stable-index invariant that `backtrace_nbest` relies on (`prev_rank` indexes
 /// into the finalized Vec of a predecessor node).
@@ -229,6 +661,85 @@ fn insert_top_k(list: &mut Vec<KEntry>, k: usize, entry: KEntry) {
     }
 }
 
+/// [`insert_top_k`] for a list holding one entry per surface prefix: an
+/// entry whose `key` is already listed replaces the listed entry if it is
+/// cheaper and is dropped otherwise. `keys` runs parallel to `list`.
+///
+/// The linear scan for `key` touches no more than the shift of
+/// `Vec::insert` does.
+fn insert_top_k_distinct(
+    list: &mut Vec<KEntry>,
+    keys: &mut Vec<u64>,
+    k: usize,
+    entry: KEntry,
+    key: u64,
+) {
+    if let Some(at) = keys.iter().position(|&listed| listed == key) {
+        if list[at].cost <= entry.cost {
+            return;
+        }
+        list.remove(at);
+        keys.remove(at);
+    }
+    let pos = list.partition_point(|e| e.cost <= entry.cost);
+    if pos >= k {
+        return;
+    }
+    list.insert(pos, entry);
+    keys.insert(pos, key);
+    if list.len() > k {
+        list.pop();
+        keys.pop();
+    }
+}
+
+/// Polynomial hash modulo the Mersenne prime 2^61 - 1 of a node's surface,
+/// in the form that extends the hash of a path prefix: hashing a prefix
+/// and then appending surfaces gives the hash of the concatenated string,
+/// however it was segmented.
+#[derive(Clone, Copy)]
+struct SurfaceHash {
+    /// Hash of the surface on its own.
+    hash: u64,
+    /// `HASH_BASE` to the power of the surface's length in bytes.
+    shift: u64,
+}
+
+const HASH_MOD: u64 = (1 << 61) - 1;
+const HASH_BASE: u64 = 0x0d6e_8fea_b2a9_d7c5;
+
+impl SurfaceHash {
+    fn of(surface: &str) -> Self {
+        let mut hash = 0;
+        let mut shift = 1;
+        for byte in surface.bytes() {
+            hash = mod_add(mod_mul(hash, HASH_BASE), u64::from(byte) + 1);
+            shift = mod_mul(shift, HASH_BASE);
+        }
+        Self { hash, shift }
+    }
+
+    /// Hash of `prefix` (a hash as returned here, `0` for the empty string)
+    /// followed by this surface.
+    fn append_to(self, prefix: u64) -> u64 {
+        mod_add(mod_mul(prefix, self.shift), self.hash)
+    }
+}
+
+fn mod_mul(a: u64, b: u64) -> u64 {
+    let product = u128::from(a) * u128::from(b);
+    mod_add(product as u64 & HASH_MOD, (product >> 61) as u64)
+}
+
+fn mod_add(a: u64, b: u64) -> u64 {
+    let sum = a + b;
+    if sum >= HASH_MOD {
+        sum - HASH_MOD
+    } else {
+        sum
+    }
+}
+
 /// Backtrace from a specific (node_idx, rank) to reconstruct a path.
 fn backtrace_nbest(
     top_k: &[Vec<KEntry>],
@@ -243,13 +754,11 @@ fn backtrace_nbest(
     loop {
         path_indices.push(cur_idx);
         let entry = &top_k[cur_idx][cur_rank];
-        match entry.prev_idx {
-            Some(prev) => {
-                cur_rank = entry.prev_rank;
-                cur_idx = prev;
-            }
-            None => break,
+        if entry.prev_idx == BOS {
+            break;
         }
+        cur_rank = entry.prev_rank as usize;
+        cur_idx = entry.prev_idx as usize;
     }
     path_indices.reverse();
 
@@ -0,0 +1,93 @@
+//! Per-section CRC32 table appended after the last LXDX / LXCX section.
+//!
+//! Trailer layout (native endian, like the section headers):
+//! `crc(4) × count` + `count(4)` + magic `LXCK`.
+//!
+//! `open` only checks that a trailer is well formed, which is O(1). Hashing
+//! the sections is [`verify`]'s job, and callers run it off the startup path.
+
+use std::ops::Range;
+
+pub(super) const MAGIC: &[u8; 4] = b"LXCK";
+
+/// Bytes hashed between yields, so a background check does not hog a core
+/// that conversion needs.
+const CHUNK_SIZE: usize = 1 << 20;
+
+/// Result of comparing a compiled file against its checksum table.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum Integrity {
+    /// Every section matches its recorded checksum.
+    Intact,
+    /// No table to compare against: the file predates checksum tables, or
+    /// the data was built in memory rather than opened from disk.
+    Unchecked,
+    /// Names of the sections whose contents no longer match (`"checksums"`
+    /// when the table itself is damaged).
+    Corrupt(Vec<&'static str>),
+}
+
+/// Trailer size for a table of `count` sections.
+pub(super) const fn trailer_len(count: usize) -> usize {
+    count * 4 + 4 + MAGIC.len()
+}
+
+/// Append the table for `sections` (byte ranges of `buf`) to `buf`.
+pub(super) fn append(buf: &mut Vec<u8>, sections: &[Range<usize>]) {
+    let crcs: Vec<u32> = sections
+        .iter()
+        .map(|r| crc32fast::hash(&buf[r.clone()]))
+        .collect();
+    for crc in crcs {
+        buf.extend_from_slice(&crc.to_ne_bytes());
+    }
+    buf.extend_from_slice(&(sections.len() as u32).to_ne_bytes());
+    buf.extend_from_slice(MAGIC);
+}
+
+/// The checksums stored in `trailer`, if it is exactly one well-formed table.
+pub(super) fn parse(trailer: &[u8]) -> Option<Vec<u32>> {
+    let rest = trailer.strip_suffix(MAGIC)?;
+    let (crcs, count) = rest.split_at(rest.len().checked_sub(4)?);
+    let count = u32::from_ne_bytes(count.try_into().ok()?) as usize;
+    if crcs.len() != count.checked_mul(4)? {
+        return None;
+    }
+    Some(
+        crcs.chunks_exact(4)
+            .map(|c| u32::from_ne_bytes(c.try_into().expect("4-byte checksum")))
+            .collect(),
+    )
+}
+
+/// Hash each named section of `data` and compare it with `table`.
+pub(super) fn verify(
+    data: &[u8],
+    sections: &[(&'static str, Range<usize>)],
+    table: &[u32],
+) -> Integrity {
+    if table.len() != sections.len() {
+        return Integrity::Corrupt(vec!["checksums"]);
+    }
+    let corrupt: Vec<&'static str> = sections
+        .iter()
+        .zip(table)
+        .filter(|((_, range), &expected)| paced_hash(&data[range.clone()]) != expected)
+        .map(|((name, _), _)| *name)
+        .collect();
+    if corrupt.is_empty() {
+        Integrity::Intact
+    } else {
+        Integrity::Corrupt(corrupt)
+    }
+}
+
+/// CRC32 of `bytes`, yielding the thread between chunks.
+fn paced_hash(bytes: &[u8]) -> u32 {
+    let mut hasher = crc32fast::Hasher::new();
+    for chunk in bytes.chunks(CHUNK_SIZE) {
+        hasher.update(chunk);
+        std::thread::yield_now();
+    }
+    hasher.finalize()
+}
@@ -1,7 +1,7 @@
 use std::collections::HashMap;
 use std::sync::Arc;
 
-use super::{DictEntry, Dictionary, SearchResult};
+use super::{DictEntry, Dictionary, SearchResult, SharedSearchResult};
 
 /// A dictionary that merges results from multiple layers.
 ///
@@ -73,6 +73,33 @@ fn merge_results(results: Vec<SearchResult>) -> Vec<SearchResult> {
     merged
 }
 
+/// `merge_results` over shared slices.
+///
+/// A reading found in one layer only keeps that layer's slice when it is
+/// already in cost order, so cached system-dictionary entries reach the
+/// lattice without a copy. Layers never repeat a surface within a reading,
+/// so such a slice is what `merge_entries` would return, up to the order
+/// of equal costs, which `merge_entries` leaves unspecified as well.
+/// Readings found in several layers are merged as in `merge_results`.
+fn merge_shared_results(results: Vec<SharedSearchResult>) -> Vec<SharedSearchResult> {
+    let mut by_reading: HashMap<String, Vec<Arc<[DictEntry]>>> = HashMap::new();
+    for sr in results {
+        by_reading.entry(sr.reading).or_default().push(sr.entries);
+    }
+    let mut merged: Vec<SharedSearchResult> = by_reading
+        .into_iter()
+        .map(|(reading, mut lists)| {
+            let entries = match lists.as_slice() {
+                [only] if only.windows(2).all(|w| w[0].cost <= w[1].cost) => lists.remove(0),
+                _ => merge_entries(lists.iter().flat_map(|l| l.iter().cloned()).collect()).into(),
+            };
+            SharedSearchResult { reading, entries }
+        })
+        .collect();
+    merged.sort_by(|a, b| a.reading.cmp(&b.reading));
+    merged
+}
+
 impl Dictionary for CompositeDictionary {
     fn lookup(&self, reading: &str) -> Vec<DictEntry> {
         let mut all = Vec::new();
@@ -99,6 +126,22 @@ impl Dictionary for CompositeDictionary {
         }
         merge_results(all)
     }
+
+    fn common_prefix_search_shared(&self, query: &str) -> Vec<SharedSearchResult> {
+        let mut all = Vec::new();
+        for layer in &self.layers {
+            all.extend(layer.common_prefix_search_shared(query));
+        }
+        merge_shared_results(all)
+    }
+
+    fn max_reading_len(&self) -> usize {
+        self.layers
+            .iter()
+            .map(|layer| layer.max_reading_len())
+            .max()
+            .unwrap_or(0)
+    }
 }
 
 #[cfg(test)]
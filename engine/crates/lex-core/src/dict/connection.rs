@@ -2,13 +2,68 @@ use memmap2::Mmap;
 
 pub(super) const MAGIC: &[u8; 4] = b"LXCX";
 pub(super) const VERSION: u8 = 3;
+/// Version of the 8-bit layout written by [`ConnectionMatrix::quantize`].
+pub(super) const VERSION_QUANTIZED: u8 = 4;
 /// Fixed header size before roles array: magic(4) + version(1) + num_ids(2) + fw_min(2) + fw_max(2).
 pub(super) const FIXED_HEADER_SIZE: usize = 4 + 1 + 2 + 2 + 2;
 
-/// Backing storage for cost data: either owned or memory-mapped.
+/// Serialized size of one [`RowScale`]: offset(2) + scale(2).
+pub(super) const ROW_SCALE_SIZE: usize = 4;
+
+/// Backing storage for cost data: either owned or memory-mapped, holding
+/// either full `i16` costs (V3) or 8-bit codes (V4).
 pub(super) enum CostStorage {
     Owned(Vec<i16>),
     Mapped(Mmap),
+    /// One code per cell, decoded through `ConnectionMatrix::rows`.
+    QuantizedOwned(Vec<u8>),
+    /// As `QuantizedOwned`; codes start at `header_size`.
+    QuantizedMapped(Mmap),
+}
+
+/// Affine decode parameters for one left ID of a quantized matrix:
+/// `cost = offset + code * scale`.
+///
+/// `offset` is the row minimum and `scale` the smallest step that spans the
+/// row's range in 255 steps, so each cell is off by at most `scale / 2`.
+/// Rows spanning 255 or less decode exactly.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(super) struct RowScale {
+    pub offset: i16,
+    pub scale: u16,
+}
+
+impl RowScale {
+    /// Fit the parameters to one row of costs.
+    pub(super) fn fit(row: &[i16]) -> Self {
+        let min = row.iter().copied().min().unwrap_or(0);
+        let max = row.iter().copied().max().unwrap_or(0);
+        let range = (i32::from(max) - i32::from(min)) as u32;
+        Self {
+            offset: min,
+            scale: range.div_ceil(255).max(1) as u16,
+        }
+    }
+
+    /// Nearest code for `cost`, which must lie within the fitted row.
+    pub(super) fn encode(self, cost: i16) -> u8 {
+        let scale = u32::from(self.scale);
+        let delta = (i32::from(cost) - i32::from(self.offset)) as u32;
+        ((delta + scale / 2) / scale).min(255) as u8
+    }
+
+    /// Cost represented by `code`. Rounding up can overshoot the row maximum
+    /// by less than one step; the result saturates at `i16::MAX`.
+    #[inline]
+    pub(super) fn decode(self, code: u8) -> i16 {
+        let cost = i32::from(self.offset) + i32::from(code) * i32::from(self.scale);
+        cost.min(i32::from(i16::MAX)) as i16
+    }
+
+    /// Largest difference between a cost in the fitted row and its decoding.
+    pub(super) fn max_error(self) -> u16 {
+        self.scale / 2
+    }
 }
 
 /// A connection cost matrix mapping (left_id, right_id) → cost.
@@ -18,6 +73,9 @@ pub struct ConnectionMatrix {
     pub(super) fw_min: u16,
     pub(super) fw_max: u16,
     pub(super) roles: Vec<u8>,
+    /// Per-left-ID decode parameters; empty unless the storage is quantized.
+    pub(super) rows: Vec<RowScale>,
+    /// Offset of the cost data (past roles and, in V4, the row table).
     pub(super) header_size: usize,
     pub(super) storage: CostStorage,
 }
@@ -39,17 +97,65 @@ impl ConnectionMatrix {
             fw_min,
             fw_max,
             roles,
+            rows: Vec::new(),
             header_size: FIXED_HEADER_SIZE + num_ids as usize,
             storage: CostStorage::Owned(costs),
         }
     }
 
+    /// Re-encode as an 8-bit matrix (V4) with per-left-ID offset and scale.
+    ///
+    /// Halves the cost grid. Each cost is off by at most
+    /// [`Self::max_quantization_error`]; rows whose costs span 255 or less
+    /// are exact. Metadata (function-word range, roles) is carried over.
+    pub fn quantize(&self) -> Self {
+        let n = self.num_ids as usize;
+        let mut rows = Vec::with_capacity(n);
+        let mut codes = Vec::with_capacity(n * n);
+        let mut row = Vec::with_capacity(n);
+        for left in 0..self.num_ids {
+            row.clear();
+            row.extend((0..self.num_ids).map(|right| self.cost(left, right)));
+            let scale = RowScale::fit(&row);
+            codes.extend(row.iter().map(|&cost| scale.encode(cost)));
+            rows.push(scale);
+        }
+        Self {
+            num_ids: self.num_ids,
+            fw_min: self.fw_min,
+            fw_max: self.fw_max,
+            roles: self.roles.clone(),
+            rows,
+            header_size: FIXED_HEADER_SIZE + n + n * ROW_SCALE_SIZE,
+            storage: CostStorage::QuantizedOwned(codes),
+        }
+    }
+
+    /// Whether costs are stored as 8-bit codes (see [`Self::quantize`]).
+    pub fn is_quantized(&self) -> bool {
+        matches!(
+            self.storage,
+            CostStorage::QuantizedOwned(_) | CostStorage::QuantizedMapped(_)
+        )
+    }
+
+    /// Upper bound on `|cost - original|` for any cell of a quantized
+    /// matrix, in cost units. Always 0 for a full-precision matrix.
+    pub fn max_quantization_error(&self) -> u16 {
+        self.rows.iter().map(|r| r.max_error()).max().unwrap_or(0)
+    }
+
     /// Look up the connection cost between two morphemes.
     /// Index: left_id * num_ids + right_id. Out-of-bounds returns 0.
+    /// Quantized matrices decode the cell's code with its row's scale.
     pub fn cost(&self, left_id: u16, right_id: u16) -> i16 {
-        let idx = (left_id as usize)
-            .saturating_mul(self.num_ids as usize)
-            .saturating_add(right_id as usize);
+        // Every layout runs on past its costs (into the next row, or into
+        // the checksum trailer when mapped), so bound the IDs rather than
+        // the storage.
+        if left_id >= self.num_ids || right_id >= self.num_ids {
+            return 0;
+        }
+        let idx = left_id as usize * self.num_ids as usize + right_id as usize;
         match &self.storage {
             CostStorage::Owned(costs) => costs.get(idx).copied().unwrap_or(0),
             CostStorage::Mapped(mmap) => {
@@ -58,6 +164,12 @@ impl ConnectionMatrix {
                     .map(|b| i16::from_ne_bytes([b[0], b[1]]))
                     .unwrap_or(0)
             }
+            CostStorage::QuantizedOwned(codes) => codes
+                .get(idx)
+                .map_or(0, |&code| self.rows[left_id as usize].decode(code)),
+            CostStorage::QuantizedMapped(mmap) => mmap
+                .get(self.header_size + idx)
+                .map_or(0, |&code| self.rows[left_id as usize].decode(code)),
         }
     }
 
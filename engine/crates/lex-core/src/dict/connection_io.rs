@@ -1,11 +1,34 @@
 use std::fs::{self, File};
+use std::ops::Range;
 use std::path::Path;
 
 use memmap2::Mmap;
 
-use super::connection::{ConnectionMatrix, CostStorage, FIXED_HEADER_SIZE, MAGIC, VERSION};
+use super::checksum::{self, Integrity};
+use super::connection::{
+    ConnectionMatrix, CostStorage, RowScale, FIXED_HEADER_SIZE, MAGIC, ROW_SCALE_SIZE, VERSION,
+    VERSION_QUANTIZED,
+};
+use super::connection_text;
 use super::DictError;
 
+/// Sections covered by the checksum table: header (with roles), costs.
+const SECTION_COUNT: usize = 2;
+
+/// Fields of a validated LXCX header.
+pub(super) struct Header {
+    pub num_ids: u16,
+    pub fw_min: u16,
+    pub fw_max: u16,
+    pub roles: Vec<u8>,
+    /// Row scale table; empty for V3.
+    pub rows: Vec<RowScale>,
+    /// V4: one `u8` code per cell instead of an `i16` cost.
+    pub quantized: bool,
+    /// Byte range of the cost data.
+    pub costs: Range<usize>,
+}
+
 impl ConnectionMatrix {
     /// Build from a text file.
     ///
@@ -13,37 +36,13 @@ impl ConnectionMatrix {
     /// - **Mozc**: Line 1 is `num_ids` (or `num_left num_right`), then one cost per line.
     /// - **MeCab**: Line 1 is `num_left num_right`, then `right_id left_id cost` per line.
     pub fn from_text(text: &str) -> Result<Self, DictError> {
-        let mut lines = text.lines().peekable();
+        // Physical 1-based line numbers, for error messages.
+        let mut lines = text.lines().zip(1..).peekable();
 
-        let header = lines
+        let (header, _) = lines
             .next()
             .ok_or_else(|| DictError::Parse("empty file".to_string()))?;
-        let parts: Vec<&str> = header.split_whitespace().collect();
-        let num_ids: u16 = match parts.len() {
-            1 => parts[0]
-                .parse()
-                .map_err(|e| DictError::Parse(format!("invalid num_ids: {e}")))?,
-            2 => {
-                let nl: u16 = parts[0]
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("invalid num_left: {e}")))?;
-                let nr: u16 = parts[1]
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("invalid num_right: {e}")))?;
-                if nl != nr {
-                    return Err(DictError::Parse(format!(
-                        "num_left ({nl}) != num_right ({nr})"
-                    )));
-                }
-                nl
-            }
-            _ => {
-                return Err(DictError::Parse(format!(
-                    "expected 1 or 2 values in header, got {}",
-                    parts.len()
-                )));
-            }
-        };
+        let num_ids = connection_text::parse_header(header)?;
 
         // `num_ids` is `u16`, so `num_ids² ≤ u32::MAX` and the product
         // always fits in `usize` on every supported target (32-bit
@@ -52,71 +51,40 @@ impl ConnectionMatrix {
         let expected = num_ids_usize * num_ids_usize;
 
         // Auto-detect format: skip empty lines then peek at first data line
-        while lines.peek().is_some_and(|line| line.trim().is_empty()) {
+        while lines.peek().is_some_and(|(line, _)| line.trim().is_empty()) {
             lines.next();
         }
         let is_triplet = lines
             .peek()
-            .is_some_and(|line| line.split_whitespace().count() == 3);
+            .is_some_and(|(line, _)| connection_text::is_triplet(line));
 
         let costs = if is_triplet {
             // MeCab format: "right_id left_id cost" per line
-            // Store as left_id * N + right_id to match cost() lookup
             let mut costs = vec![0i16; expected];
-            for line in lines {
+            for (line, line_no) in lines {
                 let line = line.trim();
                 if line.is_empty() {
                     continue;
                 }
-                let fields: Vec<&str> = line.split_whitespace().collect();
-                if fields.len() != 3 {
-                    return Err(DictError::Parse(format!(
-                        "expected 3 fields, got {}",
-                        fields.len()
-                    )));
-                }
-                let right_id: usize = fields[0]
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("right_id: {e}")))?;
-                let left_id: usize = fields[1]
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("left_id: {e}")))?;
-                let cost: i16 = fields[2]
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("cost: {e}")))?;
-                // Validate each ID against `num_ids` explicitly: a
-                // product-only check (`idx < expected`) would accept
-                // e.g. `num_ids=2, left_id=0, right_id=2` and write
-                // into cell (1, 0) instead of erroring. Once both
-                // fields are bounded, `left · num_ids + right` fits
-                // in `u32`, so plain arithmetic is safe.
-                if left_id >= num_ids_usize || right_id >= num_ids_usize {
-                    return Err(DictError::Parse(format!(
-                        "id out of range: left_id={left_id}, right_id={right_id} (num_ids={num_ids})"
-                    )));
-                }
-                let idx = left_id * num_ids_usize + right_id;
+                let (idx, cost) = connection_text::parse_triplet(line, num_ids)
+                    .map_err(|e| connection_text::line_error(line_no, e))?;
                 costs[idx] = cost;
             }
             costs
         } else {
             // Mozc format: one cost per line
             let mut costs = Vec::with_capacity(expected);
-            for line in lines {
+            for (line, line_no) in lines {
                 let line = line.trim();
                 if line.is_empty() {
                     continue;
                 }
-                let cost: i16 = line
-                    .parse()
-                    .map_err(|e| DictError::Parse(format!("invalid cost '{line}': {e}")))?;
+                let cost = connection_text::parse_cost(line)
+                    .map_err(|e| connection_text::line_error(line_no, e))?;
                 costs.push(cost);
             }
             if costs.len() != expected {
-                return Err(DictError::Parse(format!(
-                    "expected {expected} costs, got {}",
-                    costs.len()
-                )));
+                return Err(connection_text::count_mismatch(expected, costs.len()));
             }
             costs
         };
@@ -146,21 +114,29 @@ impl ConnectionMatrix {
         fw_max: u16,
         roles: Vec<u8>,
     ) -> Result<Self, DictError> {
-        let mut m = Self::from_text(text)?;
-        if roles.len() > m.num_ids as usize {
+        Self::from_text(text)?.with_roles(fw_min, fw_max, roles)
+    }
+
+    /// Attach function-word range and morpheme roles to a freshly parsed
+    /// matrix.
+    pub(super) fn with_roles(
+        mut self,
+        fw_min: u16,
+        fw_max: u16,
+        mut roles: Vec<u8>,
+    ) -> Result<Self, DictError> {
+        if roles.len() > self.num_ids as usize {
             return Err(DictError::InvalidHeader);
         }
-        m.fw_min = fw_min;
-        m.fw_max = fw_max;
-        m.roles = roles;
-        m.roles.resize(m.num_ids as usize, 0);
-        Ok(m)
+        roles.resize(self.num_ids as usize, 0);
+        self.fw_min = fw_min;
+        self.fw_max = fw_max;
+        self.roles = roles;
+        Ok(self)
     }
 
-    /// Validate a V3 binary header and return parsed fields.
-    pub(super) fn validate_header(
-        data: &[u8],
-    ) -> Result<(u16, u16, u16, Vec<u8>, usize), DictError> {
+    /// Validate a V3 or V4 binary header and return parsed fields.
+    pub(super) fn validate_header(data: &[u8]) -> Result<Header, DictError> {
         if data.len() < FIXED_HEADER_SIZE {
             return Err(DictError::InvalidHeader);
         }
@@ -168,9 +144,10 @@ impl ConnectionMatrix {
             return Err(DictError::InvalidMagic);
         }
         let version = data[4];
-        if version != VERSION {
+        if version != VERSION && version != VERSION_QUANTIZED {
             return Err(DictError::UnsupportedVersion(version));
         }
+        let quantized = version == VERSION_QUANTIZED;
         let num_ids = u16::from_ne_bytes([data[5], data[6]]);
         let fw_min = u16::from_ne_bytes([data[7], data[8]]);
         let fw_max = u16::from_ne_bytes([data[9], data[10]]);
@@ -181,94 +158,181 @@ impl ConnectionMatrix {
             return Err(DictError::InvalidHeader);
         }
         let roles = data[FIXED_HEADER_SIZE..roles_end].to_vec();
+        // V4 stores one `RowScale` per left ID between roles and codes.
+        let rows_end = if quantized {
+            roles_end
+                .checked_add(num_ids as usize * ROW_SCALE_SIZE)
+                .ok_or(DictError::InvalidHeader)?
+        } else {
+            roles_end
+        };
+        if data.len() < rows_end {
+            return Err(DictError::InvalidHeader);
+        }
+        let rows = data[roles_end..rows_end]
+            .chunks_exact(ROW_SCALE_SIZE)
+            .map(|b| RowScale {
+                offset: i16::from_ne_bytes([b[0], b[1]]),
+                scale: u16::from_ne_bytes([b[2], b[3]]),
+            })
+            .collect();
         // `u16² · 2` can exceed a 32-bit `usize`; fall back to
         // `InvalidHeader` instead of silently wrapping.
         let expected_bytes = (num_ids as usize)
             .checked_mul(num_ids as usize)
-            .and_then(|n| n.checked_mul(2))
+            .and_then(|n| n.checked_mul(if quantized { 1 } else { 2 }))
             .ok_or(DictError::InvalidHeader)?;
-        let actual_bytes = data.len() - roles_end;
-        if actual_bytes != expected_bytes {
+        // Cost data is followed by nothing (files written before checksum
+        // tables) or by exactly one checksum table.
+        let actual_bytes = data.len() - rows_end;
+        let well_formed = match actual_bytes.checked_sub(expected_bytes) {
+            Some(0) => true,
+            Some(_) => checksum::parse(&data[rows_end + expected_bytes..]).is_some(),
+            None => false,
+        };
+        if !well_formed {
             return Err(DictError::Parse(format!(
                 "expected {expected_bytes} bytes of cost data, got {actual_bytes}",
             )));
         }
-        Ok((num_ids, fw_min, fw_max, roles, roles_end))
+        Ok(Header {
+            num_ids,
+            fw_min,
+            fw_max,
+            roles,
+            rows,
+            quantized,
+            costs: rows_end..rows_end + expected_bytes,
+        })
     }
 
-    /// Load from compiled V3 binary format using memory-mapped I/O.
+    /// Load from compiled V3/V4 binary format using memory-mapped I/O.
     pub fn open(path: &Path) -> Result<Self, DictError> {
         let file = File::open(path)?;
         // SAFETY: The file is opened read-only and the mapping is immutable.
         // We hold the Mmap for the lifetime of this struct, so the data remains
         // valid. The file should not be modified while the IME is running.
         let mmap = unsafe { Mmap::map(&file)? };
-        let (num_ids, fw_min, fw_max, roles, hdr_size) = Self::validate_header(&mmap)?;
+        let header = Self::validate_header(&mmap)?;
+        let storage = if header.quantized {
+            CostStorage::QuantizedMapped(mmap)
+        } else {
+            CostStorage::Mapped(mmap)
+        };
         Ok(Self {
-            num_ids,
-            fw_min,
-            fw_max,
-            roles,
-            header_size: hdr_size,
-            storage: CostStorage::Mapped(mmap),
+            num_ids: header.num_ids,
+            fw_min: header.fw_min,
+            fw_max: header.fw_max,
+            roles: header.roles,
+            rows: header.rows,
+            header_size: header.costs.start,
+            storage,
         })
     }
 
-    /// Parse from compiled V3 binary format into an owned representation.
+    /// Parse from compiled V3/V4 binary format into an owned representation.
     pub fn from_bytes(data: &[u8]) -> Result<Self, DictError> {
-        let (num_ids, fw_min, fw_max, roles, hdr_size) = Self::validate_header(data)?;
-        let costs: Vec<i16> = data[hdr_size..]
-            .chunks_exact(2)
-            .map(|chunk| i16::from_ne_bytes([chunk[0], chunk[1]]))
-            .collect();
-        Ok(Self::new_owned(num_ids, fw_min, fw_max, roles, costs))
-    }
-
-    /// Serialize to compiled V3 binary format.
-    pub fn to_bytes(&self) -> Vec<u8> {
-        let costs = match &self.storage {
-            CostStorage::Owned(c) => c.as_slice(),
-            CostStorage::Mapped(_) => {
-                return self.to_bytes_from_mapped();
-            }
-        };
-        let mut buf = Vec::with_capacity(FIXED_HEADER_SIZE + self.roles.len() + costs.len() * 2);
-        buf.extend_from_slice(MAGIC);
-        buf.push(VERSION);
-        buf.extend_from_slice(&self.num_ids.to_ne_bytes());
-        buf.extend_from_slice(&self.fw_min.to_ne_bytes());
-        buf.extend_from_slice(&self.fw_max.to_ne_bytes());
-        buf.extend_from_slice(&self.roles);
-        for &cost in costs {
-            buf.extend_from_slice(&cost.to_ne_bytes());
+        let header = Self::validate_header(data)?;
+        let body = &data[header.costs.clone()];
+        if !header.quantized {
+            let costs: Vec<i16> = body
+                .chunks_exact(2)
+                .map(|chunk| i16::from_ne_bytes([chunk[0], chunk[1]]))
+                .collect();
+            return Ok(Self::new_owned(
+                header.num_ids,
+                header.fw_min,
+                header.fw_max,
+                header.roles,
+                costs,
+            ));
         }
-        buf
+        Ok(Self {
+            num_ids: header.num_ids,
+            fw_min: header.fw_min,
+            fw_max: header.fw_max,
+            roles: header.roles,
+            rows: header.rows,
+            header_size: header.costs.start,
+            storage: CostStorage::QuantizedOwned(body.to_vec()),
+        })
     }
 
-    /// Helper: re-serialize a Mapped matrix.
-    fn to_bytes_from_mapped(&self) -> Vec<u8> {
+    /// Serialize to compiled binary format: V4 if quantized, V3 otherwise.
+    pub fn to_bytes(&self) -> Vec<u8> {
         // Saturating arithmetic for the capacity hint — it's advisory
         // and over-allocating is preferable to panicking on a
         // worst-case value.
         let n = (self.num_ids as usize).saturating_mul(self.num_ids as usize);
-        let cap = FIXED_HEADER_SIZE
-            .saturating_add(self.roles.len())
-            .saturating_add(n.saturating_mul(2));
+        let cell_bytes = if self.is_quantized() { 1 } else { 2 };
+        let cap = self
+            .header_size
+            .saturating_add(n.saturating_mul(cell_bytes))
+            .saturating_add(checksum::trailer_len(SECTION_COUNT));
         let mut buf = Vec::with_capacity(cap);
         buf.extend_from_slice(MAGIC);
-        buf.push(VERSION);
+        buf.push(if self.is_quantized() {
+            VERSION_QUANTIZED
+        } else {
+            VERSION
+        });
         buf.extend_from_slice(&self.num_ids.to_ne_bytes());
         buf.extend_from_slice(&self.fw_min.to_ne_bytes());
         buf.extend_from_slice(&self.fw_max.to_ne_bytes());
         buf.extend_from_slice(&self.roles);
-        for i in 0..n {
-            let left = (i / self.num_ids as usize) as u16;
-            let right = (i % self.num_ids as usize) as u16;
-            buf.extend_from_slice(&self.cost(left, right).to_ne_bytes());
+        for row in &self.rows {
+            buf.extend_from_slice(&row.offset.to_ne_bytes());
+            buf.extend_from_slice(&row.scale.to_ne_bytes());
+        }
+        let header_end = buf.len();
+        match &self.storage {
+            CostStorage::Owned(costs) => {
+                for &cost in costs {
+                    buf.extend_from_slice(&cost.to_ne_bytes());
+                }
+            }
+            // Mapped bodies are already in this layout.
+            CostStorage::Mapped(mmap) => {
+                buf.extend_from_slice(&mmap[self.header_size..self.header_size + n * 2])
+            }
+            CostStorage::QuantizedOwned(codes) => buf.extend_from_slice(codes),
+            CostStorage::QuantizedMapped(mmap) => {
+                buf.extend_from_slice(&mmap[self.header_size..self.header_size + n])
+            }
         }
+        let end = buf.len();
+        checksum::append(&mut buf, &[0..header_end, header_end..end]);
         buf
     }
 
+    /// Compare the header and cost sections with the checksum table written
+    /// by `save`.
+    ///
+    /// Hashes the whole matrix, so run it off the startup path. Matrices
+    /// built in memory have nothing on disk to check and report `Unchecked`.
+    pub fn verify(&self) -> Integrity {
+        match &self.storage {
+            // `open` already validated the header, so this cannot fail.
+            CostStorage::Mapped(mmap) | CostStorage::QuantizedMapped(mmap) => {
+                Self::verify_bytes(mmap).unwrap_or_else(|_| Integrity::Corrupt(vec!["header"]))
+            }
+            CostStorage::Owned(_) | CostStorage::QuantizedOwned(_) => Integrity::Unchecked,
+        }
+    }
+
+    /// Compare each section of the LXCX image `data` with its checksum table.
+    ///
+    /// In V4 images the row scale table is part of the header section.
+    pub fn verify_bytes(data: &[u8]) -> Result<Integrity, DictError> {
+        let Header { costs, .. } = Self::validate_header(data)?;
+        // `validate_header` accepts trailing bytes only as a well-formed table.
+        let Some(table) = checksum::parse(&data[costs.end..]) else {
+            return Ok(Integrity::Unchecked);
+        };
+        let sections = [("header", 0..costs.start), ("costs", costs)];
+        Ok(checksum::verify(data, &sections, &table))
+    }
+
     /// Save compiled binary to file.
     pub fn save(&self, path: &Path) -> Result<(), DictError> {
         Ok(fs::write(path, self.to_bytes())?)
@@ -0,0 +1,346 @@
+//! Connection-matrix text sources (Mozc `connection_single.txt`, MeCab
+//! `matrix.def`).
+//!
+//! Line-level parsing is shared by the in-memory [`ConnectionMatrix::from_text`]
+//! and the streaming [`ConnectionMatrix::from_text_file`], which memory-maps
+//! the source, splits it at newline boundaries and parses the chunks on
+//! worker threads straight into the preallocated cost grid. Both report
+//! malformed lines as `line N: ...` with the same 1-based numbering.
+
+use std::fs::File;
+use std::ops::Range;
+use std::path::Path;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::thread;
+
+use memmap2::Mmap;
+
+use super::connection::ConnectionMatrix;
+use super::DictError;
+
+/// Target chunk size for [`ConnectionMatrix::from_text_file`].
+const CHUNK_SIZE: usize = 4 << 20;
+
+/// Parse the header line: `num_ids`, or `num_left num_right` (must match).
+pub(super) fn parse_header(line: &str) -> Result<u16, DictError> {
+    let parts: Vec<&str> = line.split_whitespace().collect();
+    match parts.len() {
+        1 => parts[0]
+            .parse()
+            .map_err(|e| DictError::Parse(format!("invalid num_ids: {e}"))),
+        2 => {
+            let nl: u16 = parts[0]
+                .parse()
+                .map_err(|e| DictError::Parse(format!("invalid num_left: {e}")))?;
+            let nr: u16 = parts[1]
+                .parse()
+                .map_err(|e| DictError::Parse(format!("invalid num_right: {e}")))?;
+            if nl != nr {
+                return Err(DictError::Parse(format!(
+                    "num_left ({nl}) != num_right ({nr})"
+                )));
+            }
+            Ok(nl)
+        }
+        _ => Err(DictError::Parse(format!(
+            "expected 1 or 2 values in header, got {}",
+            parts.len()
+        ))),
+    }
+}
+
+/// Whether the first data line is in MeCab `right_id left_id cost` form.
+pub(super) fn is_triplet(line: &str) -> bool {
+    line.split_whitespace().count() == 3
+}
+
+/// Parse one trimmed Mozc-format line (a single cost).
+pub(super) fn parse_cost(line: &str) -> Result<i16, String> {
+    line.parse()
+        .map_err(|e| format!("invalid cost '{line}': {e}"))
+}
+
+/// Parse one trimmed MeCab-format line into `(grid index, cost)`.
+///
+/// The grid is stored as `left_id * num_ids + right_id` to match
+/// `ConnectionMatrix::cost`.
+pub(super) fn parse_triplet(line: &str, num_ids: u16) -> Result<(usize, i16), String> {
+    let fields: Vec<&str> = line.split_whitespace().collect();
+    if fields.len() != 3 {
+        return Err(format!("expected 3 fields, got {}", fields.len()));
+    }
+    let right_id: usize = fields[0].parse().map_err(|e| format!("right_id: {e}"))?;
+    let left_id: usize = fields[1].parse().map_err(|e| format!("left_id: {e}"))?;
+    let cost: i16 = fields[2].parse().map_err(|e| format!("cost: {e}"))?;
+    // Validate each ID against `num_ids` explicitly: a product-only
+    // check (`idx < expected`) would accept e.g. `num_ids=2, left_id=0,
+    // right_id=2` and write into cell (1, 0) instead of erroring. Once
+    // both fields are bounded, `left · num_ids + right` fits in `u32`,
+    // so plain arithmetic is safe.
+    let n = num_ids as usize;
+    if left_id >= n || right_id >= n {
+        return Err(format!(
+            "id out of range: left_id={left_id}, right_id={right_id} (num_ids={num_ids})"
+        ));
+    }
+    Ok((left_id * n + right_id, cost))
+}
+
+pub(super) fn line_error(line_no: usize, msg: String) -> DictError {
+    DictError::Parse(format!("line {line_no}: {msg}"))
+}
+
+pub(super) fn count_mismatch(expected: usize, got: usize) -> DictError {
+    DictError::Parse(format!("expected {expected} costs, got {got}"))
+}
+
+/// First malformed line of a chunk: (line number within the chunk, message).
+type ChunkError = (usize, String);
+
+/// Non-empty trimmed lines of `chunk`, numbered from 0 within the chunk.
+fn data_lines(chunk: &str) -> impl Iterator<Item = (usize, &str)> {
+    chunk
+        .lines()
+        .enumerate()
+        .map(|(i, line)| (i, line.trim()))
+        .filter(|(_, line)| !line.is_empty())
+}
+
+/// A chunk as UTF-8, or the line holding its first invalid byte.
+fn chunk_str(chunk: &[u8]) -> Result<&str, ChunkError> {
+    std::str::from_utf8(chunk).map_err(|e| {
+        let line = chunk[..e.valid_up_to()]
+            .iter()
+            .filter(|&&b| b == b'\n')
+            .count();
+        (line, "invalid UTF-8".to_string())
+    })
+}
+
+/// Split `data[start..]` into ranges of roughly `chunk_size` bytes, each
+/// ending just after a newline (or at the end of the data).
+fn split_chunks(data: &[u8], start: usize, chunk_size: usize) -> Vec<Range<usize>> {
+    let mut chunks = Vec::new();
+    let mut begin = start;
+    while begin < data.len() {
+        let target = begin.saturating_add(chunk_size.max(1)).min(data.len());
+        let end = match data[target..].iter().position(|&b| b == b'\n') {
+            Some(i) => target + i + 1,
+            None => data.len(),
+        };
+        chunks.push(begin..end);
+        begin = end;
+    }
+    chunks
+}
+
+/// Run `work` for every item on up to `threads` scoped workers, returning
+/// the results in item order.
+fn par_map<T: Send, R: Send>(
+    items: Vec<T>,
+    threads: usize,
+    work: impl Fn(T) -> R + Sync,
+) -> Vec<R> {
+    let threads = threads.clamp(1, items.len().max(1));
+    if threads == 1 {
+        return items.into_iter().map(work).collect();
+    }
+    let mut buckets: Vec<Vec<(usize, T)>> = (0..threads).map(|_| Vec::new()).collect();
+    for (i, item) in items.into_iter().enumerate() {
+        buckets[i % threads].push((i, item));
+    }
+    let work = &work;
+    let mut out: Vec<(usize, R)> = thread::scope(|s| {
+        let handles: Vec<_> = buckets
+            .into_iter()
+            .map(|bucket| {
+                s.spawn(move || {
+                    bucket
+                        .into_iter()
+                        .map(|(i, item)| (i, work(item)))
+                        .collect::<Vec<_>>()
+                })
+            })
+            .collect();
+        handles
+            .into_iter()
+            .flat_map(|h| h.join().unwrap_or_else(|p| std::panic::resume_unwind(p)))
+            .collect()
+    });
+    out.sort_unstable_by_key(|&(i, _)| i);
+    out.into_iter().map(|(_, r)| r).collect()
+}
+
+/// Cost grid shared by triplet workers. Each cell is written by at most
+/// one worker: the one that first claims it in `claimed`.
+struct SharedGrid {
+    cells: *mut i16,
+    claimed: Vec<AtomicU64>,
+    duplicate: AtomicBool,
+}
+
+// SAFETY: writes go through `write`, which only touches a cell after
+// winning its claim bit, so no two threads ever write the same cell and
+// nobody reads the grid until the workers are joined.
+unsafe impl Sync for SharedGrid {}
+
+impl SharedGrid {
+    fn new(grid: &mut [i16]) -> Self {
+        Self {
+            cells: grid.as_mut_ptr(),
+            claimed: (0..grid.len().div_ceil(64))
+                .map(|_| AtomicU64::new(0))
+                .collect(),
+            duplicate: AtomicBool::new(false),
+        }
+    }
+
+    fn write(&self, idx: usize, cost: i16) {
+        let bit = 1u64 << (idx % 64);
+        if self.claimed[idx / 64].fetch_or(bit, Ordering::Relaxed) & bit != 0 {
+            // A second line for the same cell: file order decides, which
+            // only the serial pass can honour.
+            self.duplicate.store(true, Ordering::Relaxed);
+            return;
+        }
+        // SAFETY: `idx` is in bounds (`parse_triplet` checked both ids) and
+        // this thread owns the cell (claim bit above).
+        unsafe { *self.cells.add(idx) = cost };
+    }
+}
+
+impl ConnectionMatrix {
+    /// Build from a text source file with function-word range and morpheme
+    /// roles, like [`from_text_with_roles`](Self::from_text_with_roles), but
+    /// without reading the file into a `String`.
+    ///
+    /// The file is memory-mapped and parsed in newline-aligned chunks on
+    /// all available cores, writing costs directly into the cost grid, so
+    /// peak heap use is the grid itself. Output is identical to
+    /// `from_text_with_roles` on the same text, errors included.
+    pub fn from_text_file(
+        path: &Path,
+        fw_min: u16,
+        fw_max: u16,
+        roles: Vec<u8>,
+    ) -> Result<Self, DictError> {
+        let file = File::open(path)?;
+        // SAFETY: read-only mapping of a source file that is not modified
+        // while the compiler runs.
+        let mmap = unsafe { Mmap::map(&file)? };
+        let threads = thread::available_parallelism().map_or(1, |n| n.get());
+        Self::from_text_chunked(&mmap, CHUNK_SIZE, threads)?.with_roles(fw_min, fw_max, roles)
+    }
+
+    /// Parse `data` in chunks of about `chunk_size` bytes on `threads` workers.
+    pub(super) fn from_text_chunked(
+        data: &[u8],
+        chunk_size: usize,
+        threads: usize,
+    ) -> Result<Self, DictError> {
+        if data.is_empty() {
+            return Err(DictError::Parse("empty file".to_string()));
+        }
+        let header_end = data
+            .iter()
+            .position(|&b| b == b'\n')
+            .map_or(data.len(), |i| i + 1);
+        let header = std::str::from_utf8(&data[..header_end])
+            .map_err(|_| line_error(1, "invalid UTF-8".to_string()))?;
+        let num_ids = parse_header(header.trim_end_matches(['\n', '\r']))?;
+        let n = num_ids as usize;
+        let expected = n * n;
+
+        // Format is decided by the first non-empty data line, as in `from_text`.
+        let mut is_triplet_format = false;
+        for line in data[header_end..].split(|&b| b == b'\n') {
+            let line = String::from_utf8_lossy(line);
+            if !line.trim().is_empty() {
+                is_triplet_format = is_triplet(&line);
+                break;
+            }
+        }
+
+        let chunks = split_chunks(data, header_end, chunk_size);
+        let mut costs = vec![0i16; expected];
+        let failed = if is_triplet_format {
+            let grid = SharedGrid::new(&mut costs);
+            let results = par_map(chunks.clone(), threads, |range| {
+                for (line, text) in data_lines(chunk_str(&data[range])?) {
+                    let (idx, cost) = parse_triplet(text, num_ids).map_err(|e| (line, e))?;
+                    grid.write(idx, cost);
+                }
+                Ok(())
+            });
+            let duplicate = grid.duplicate.load(Ordering::Relaxed);
+            match first_error(&chunks, results) {
+                Some(i) => Some(i),
+                None if duplicate => {
+                    // Rare: let file order decide, exactly as `from_text`.
+                    for range in &chunks {
+                        for (_, text) in data_lines(chunk_str(&data[range.clone()]).unwrap_or("")) {
+                            if let Ok((idx, cost)) = parse_triplet(text, num_ids) {
+                                costs[idx] = cost;
+                            }
+                        }
+                    }
+                    None
+                }
+                None => None,
+            }
+        } else {
+            // Pass 1 counts each chunk's cost lines, which fixes where its
+            // costs land in the grid; pass 2 parses into those slices.
+            let counts = par_map(chunks.clone(), threads, |range| {
+                chunk_str(&data[range]).map(|text| data_lines(text).count())
+            });
+            let total: usize = counts.iter().map(|c| *c.as_ref().unwrap_or(&0)).sum();
+            let mut slices: Vec<Option<&mut [i16]>> = Vec::with_capacity(chunks.len());
+            let mut rest = costs.as_mut_slice();
+            for count in &counts {
+                let count = *count.as_ref().unwrap_or(&0);
+                if total == expected {
+                    let (head, tail) = std::mem::take(&mut rest).split_at_mut(count);
+                    slices.push(Some(head));
+                    rest = tail;
+                } else {
+                    // Wrong total: parse only to report a malformed line first.
+                    slices.push(None);
+                }
+            }
+            let work: Vec<_> = chunks.iter().cloned().zip(slices).collect();
+            let results = par_map(work, threads, |(range, mut out)| {
+                let lines = data_lines(chunk_str(&data[range])?);
+                for (i, (line, text)) in lines.enumerate() {
+                    let cost = parse_cost(text).map_err(|e| (line, e))?;
+                    if let Some(out) = out.as_deref_mut() {
+                        out[i] = cost;
+                    }
+                }
+                Ok(())
+            });
+            match first_error(&chunks, results) {
+                Some(i) => Some(i),
+                None if total != expected => return Err(count_mismatch(expected, total)),
+                None => None,
+            }
+        };
+
+        if let Some((chunk_start, (line, msg))) = failed {
+            let lines_before = data[..chunk_start].iter().filter(|&&b| b == b'\n').count();
+            return Err(line_error(lines_before + line + 1, msg));
+        }
+        Ok(Self::new_owned(num_ids, 0, 0, Vec::new(), costs))
+    }
+}
+
+/// The error of the earliest failing chunk, with that chunk's start offset.
+fn first_error(
+    chunks: &[Range<usize>],
+    results: Vec<Result<(), ChunkError>>,
+) -> Option<(usize, ChunkError)> {
+    chunks
+        .iter()
+        .zip(results)
+        .find_map(|(range, result)| result.err().map(|e| (range.start, e)))
+}
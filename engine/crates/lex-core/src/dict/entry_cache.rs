@@ -0,0 +1,192 @@
+//! Bounded cache of decoded dictionary entries.
+//!
+//! `TrieDictionary` stores entries as packed records plus a string pool, so
+//! every hit on a reading decodes its records and allocates each surface
+//! again. A handful of readings (particles, auxiliaries, common nouns) make
+//! up most hits on every keystroke; [`EntryCache`] keeps their decoded
+//! slices keyed by trie value ID and hands out shared references.
+//!
+//! Eviction is second-chance FIFO (CLOCK): entries enter at the back of a
+//! queue, a hit marks them referenced, and when the byte budget is exceeded
+//! the front entry is dropped unless referenced, in which case it is cleared
+//! and requeued. Hits take one short mutex section; the cache is meant to be
+//! shared by every session on a dictionary.
+
+use std::collections::{HashMap, VecDeque};
+use std::mem;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard};
+
+use super::DictEntry;
+
+/// Bookkeeping charged per cached value on top of its entries and surfaces:
+/// the map slot, queue slot, and `Arc` header.
+const SLOT_OVERHEAD: usize = 64;
+
+/// Hit/miss counters and occupancy of an [`EntryCache`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct EntryCacheStats {
+    pub hits: u64,
+    pub misses: u64,
+    /// Value IDs currently cached.
+    pub values: usize,
+    /// Bytes charged against the budget (see [`EntryCache::new`]).
+    pub bytes: usize,
+    pub capacity_bytes: usize,
+}
+
+impl EntryCacheStats {
+    /// Fraction of lookups served from the cache, or 0 before any lookup.
+    pub fn hit_rate(&self) -> f64 {
+        let total = self.hits + self.misses;
+        if total == 0 {
+            0.0
+        } else {
+            self.hits as f64 / total as f64
+        }
+    }
+}
+
+struct Slot {
+    entries: Arc<[DictEntry]>,
+    bytes: usize,
+    referenced: bool,
+}
+
+#[derive(Default)]
+struct CacheState {
+    slots: HashMap<u32, Slot>,
+    /// Eviction order; holds exactly the keys of `slots`.
+    queue: VecDeque<u32>,
+    bytes: usize,
+}
+
+/// Decoded entries keyed by trie value ID, bounded in bytes.
+///
+/// Attach with [`TrieDictionary::with_entry_cache`](super::TrieDictionary::with_entry_cache).
+/// Value IDs are only meaningful for one dictionary file, so a cache must
+/// not be shared between different dictionaries.
+pub struct EntryCache {
+    capacity_bytes: usize,
+    state: Mutex<CacheState>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+impl EntryCache {
+    /// An empty cache holding at most `capacity_bytes`, counting each
+    /// value's `DictEntry` structs, surface bytes, and a fixed per-value
+    /// overhead. Values larger than the whole budget are never cached.
+    pub fn new(capacity_bytes: usize) -> Self {
+        Self {
+            capacity_bytes,
+            state: Mutex::new(CacheState::default()),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+        }
+    }
+
+    /// Cached entries for `value_id`, or `decode`d and inserted on a miss.
+    pub(super) fn get_or_insert_with(
+        &self,
+        value_id: u32,
+        decode: impl FnOnce() -> Vec<DictEntry>,
+    ) -> Arc<[DictEntry]> {
+        if let Some(entries) = self.get(value_id) {
+            return entries;
+        }
+        self.misses.fetch_add(1, Ordering::Relaxed);
+        // Decode outside the lock; a racing miss on the same ID just
+        // replaces an identical slice.
+        let entries: Arc<[DictEntry]> = decode().into();
+        self.insert(value_id, Arc::clone(&entries), true);
+        entries
+    }
+
+    /// Counted lookup: a hit also marks the value referenced.
+    fn get(&self, value_id: u32) -> Option<Arc<[DictEntry]>> {
+        let mut state = self.lock();
+        let slot = state.slots.get_mut(&value_id)?;
+        slot.referenced = true;
+        let entries = Arc::clone(&slot.entries);
+        drop(state);
+        self.hits.fetch_add(1, Ordering::Relaxed);
+        Some(entries)
+    }
+
+    /// Insert for prewarming: uncounted, and refused (returning `false`)
+    /// instead of evicting once the budget is full, so the head of a
+    /// frequency list is never displaced by its tail.
+    pub(super) fn prewarm(&self, value_id: u32, entries: Vec<DictEntry>) -> bool {
+        self.insert(value_id, entries.into(), false)
+    }
+
+    fn insert(&self, value_id: u32, entries: Arc<[DictEntry]>, evict: bool) -> bool {
+        let bytes = charged_bytes(&entries);
+        if bytes > self.capacity_bytes {
+            return false;
+        }
+        let mut state = self.lock();
+        if state.slots.contains_key(&value_id) {
+            return true;
+        }
+        if !evict && state.bytes + bytes > self.capacity_bytes {
+            return false;
+        }
+        while state.bytes + bytes > self.capacity_bytes {
+            let Some(front) = state.queue.pop_front() else {
+                break;
+            };
+            let slot = state.slots.get_mut(&front).expect("queue mirrors slots");
+            if mem::take(&mut slot.referenced) {
+                state.queue.push_back(front);
+            } else {
+                let freed = slot.bytes;
+                state.slots.remove(&front);
+                state.bytes -= freed;
+            }
+        }
+        state.slots.insert(
+            value_id,
+            Slot {
+                entries,
+                bytes,
+                referenced: false,
+            },
+        );
+        state.queue.push_back(value_id);
+        state.bytes += bytes;
+        true
+    }
+
+    pub fn stats(&self) -> EntryCacheStats {
+        let state = self.lock();
+        EntryCacheStats {
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            values: state.slots.len(),
+            bytes: state.bytes,
+            capacity_bytes: self.capacity_bytes,
+        }
+    }
+
+    /// Zero the hit and miss counters, keeping the cached values.
+    pub fn reset_counters(&self) {
+        self.hits.store(0, Ordering::Relaxed);
+        self.misses.store(0, Ordering::Relaxed);
+    }
+
+    fn lock(&self) -> MutexGuard<'_, CacheState> {
+        // Every critical section leaves the state consistent before any
+        // call that could panic, so a poisoned lock is still usable.
+        self.state
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+    }
+}
+
+fn charged_bytes(entries: &[DictEntry]) -> usize {
+    SLOT_OVERHEAD
+        + mem::size_of_val(entries)
+        + entries.iter().map(|e| e.surface.len()).sum::<usize>()
+}
@@ -2,21 +2,29 @@
 //!
 //! `TrieDictionary` stores reading → entries mappings in a serialized trie.
 //! `ConnectionMatrix` stores POS bigram transition costs for Viterbi scoring.
+//! `EntryCache` optionally keeps the decoded entries of hot readings.
+//! Both compiled formats end in a per-section checksum table (`checksum`).
 
+mod checksum;
 mod composite;
 pub mod connection;
 mod connection_io;
+mod connection_text;
 mod entry;
+mod entry_cache;
 #[cfg(test)]
 mod tests;
 mod trie_dict;
 mod trie_dict_io;
 
+pub use checksum::Integrity;
 pub use composite::CompositeDictionary;
 pub use entry::DictEntry;
-pub use trie_dict::TrieDictionary;
+pub use entry_cache::{EntryCache, EntryCacheStats};
+pub use trie_dict::{DictLayout, TrieDictionary};
 
 use std::io;
+use std::sync::Arc;
 
 /// Unified error type for dictionary and connection-matrix binary I/O.
 ///
@@ -62,19 +70,42 @@ pub struct SearchResult {
     pub entries: Vec<DictEntry>,
 }
 
+/// A [`SearchResult`] whose entries may be shared with a cache.
+pub struct SharedSearchResult {
+    pub reading: String,
+    pub entries: Arc<[DictEntry]>,
+}
+
 pub trait Dictionary: Send + Sync {
     fn lookup(&self, reading: &str) -> Vec<DictEntry>;
     fn predict(&self, prefix: &str, max_results: usize) -> Vec<SearchResult>;
     fn common_prefix_search(&self, query: &str) -> Vec<SearchResult>;
 
+    /// `common_prefix_search` for read-only callers such as the lattice
+    /// builder.
+    ///
+    /// Same results in the same order. `TrieDictionary` with an
+    /// [`EntryCache`] returns cached slices without copying, and
+    /// `CompositeDictionary` passes them through; the default wraps
+    /// `common_prefix_search`.
+    fn common_prefix_search_shared(&self, query: &str) -> Vec<SharedSearchResult> {
+        self.common_prefix_search(query)
+            .into_iter()
+            .map(|r| SharedSearchResult {
+                reading: r.reading,
+                entries: r.entries.into(),
+            })
+            .collect()
+    }
+
     /// Maximum reading length (in characters) across all entries.
     ///
-    /// Used by `Lattice::extend` to bound the lookback window for
-    /// incremental extension. Implementors should override this whenever
-    /// a finite maximum is known. The default returns `usize::MAX` as a
-    /// conservative fallback; `extend` also tracks the longest reading
-    /// observed during construction, so the lookback is bounded even
-    /// when this method is not overridden.
+    /// Used by `Lattice::splice` to bound how far before an edit nodes
+    /// must be searched again; it must never be less than the longest
+    /// reading a prefix search can return. Implementors should override
+    /// this whenever a finite maximum is known. The default returns
+    /// `usize::MAX`, which makes every edit rebuild the lattice from the
+    /// start up to the edit.
     fn max_reading_len(&self) -> usize {
         usize::MAX
     }
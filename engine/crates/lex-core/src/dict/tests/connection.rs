@@ -1,7 +1,8 @@
 use std::fs;
 
+use crate::converter::testutil::Rng;
 use crate::dict::connection::ConnectionMatrix;
-use crate::dict::DictError;
+use crate::dict::{DictError, Integrity};
 
 fn sample_matrix() -> ConnectionMatrix {
     let text = "3 3\n0\n10\n20\n30\n40\n50\n60\n70\n80\n";
@@ -290,3 +291,318 @@ fn test_roles_file_roundtrip() {
 
     fs::remove_dir_all(&dir).ok();
 }
+
+#[test]
+fn test_verify_detects_single_byte_corruption() {
+    let bytes = sample_matrix().to_bytes();
+    assert_eq!(
+        ConnectionMatrix::verify_bytes(&bytes).unwrap(),
+        Integrity::Intact
+    );
+
+    // fw_min (byte 7), a role byte, and the first and last cost bytes.
+    let header_end = 11 + 3;
+    let costs_end = header_end + 9 * 2;
+    for (section, at) in [
+        ("header", 7),
+        ("header", header_end - 1),
+        ("costs", header_end),
+        ("costs", costs_end - 1),
+    ] {
+        let mut corrupt = bytes.clone();
+        corrupt[at] ^= 0x01;
+        assert_eq!(
+            ConnectionMatrix::verify_bytes(&corrupt).unwrap(),
+            Integrity::Corrupt(vec![section]),
+            "flipped byte {at}"
+        );
+    }
+
+    // A damaged trailer no longer frames the cost data: rejected at open.
+    let mut corrupt = bytes.clone();
+    *corrupt.last_mut().unwrap() ^= 0x01;
+    assert!(matches!(
+        ConnectionMatrix::from_bytes(&corrupt),
+        Err(DictError::Parse(_))
+    ));
+}
+
+#[test]
+fn test_verify_legacy_file_unchecked() {
+    let bytes = sample_matrix().to_bytes();
+    // Written before checksum tables: cost data runs to the end of the file.
+    let legacy = &bytes[..11 + 3 + 9 * 2];
+    assert_eq!(
+        ConnectionMatrix::verify_bytes(legacy).unwrap(),
+        Integrity::Unchecked
+    );
+    let m = ConnectionMatrix::from_bytes(legacy).unwrap();
+    assert_eq!(m.cost(2, 2), 80);
+    assert_eq!(m.verify(), Integrity::Unchecked);
+}
+
+#[test]
+fn test_mapped_out_of_range() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("test.conn");
+    sample_matrix().save(&path).unwrap();
+    let m = ConnectionMatrix::open(&path).unwrap();
+    // Both would index past the costs into the checksum trailer.
+    assert_eq!(m.cost(3, 0), 0);
+    assert_eq!(m.cost(2, 3), 0);
+    assert_eq!(m.cost(u16::MAX, u16::MAX), 0);
+}
+
+#[test]
+fn test_open_defers_verification() {
+    let bytes = sample_matrix().to_bytes();
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("corrupt.conn");
+    let mut corrupt = bytes.clone();
+    corrupt[11 + 3] ^= 0x01;
+    fs::write(&path, &corrupt).unwrap();
+
+    // Opening stays O(1): the damage surfaces only when verified.
+    let m = ConnectionMatrix::open(&path).unwrap();
+    assert_eq!(m.verify(), Integrity::Corrupt(vec!["costs"]));
+
+    fs::write(&path, &bytes).unwrap();
+    assert_eq!(
+        ConnectionMatrix::open(&path).unwrap().verify(),
+        Integrity::Intact
+    );
+}
+
+/// Parse `text` serially and chunked (several chunk sizes and thread
+/// counts), asserting identical serialized output or identical errors.
+fn assert_chunked_matches(text: &str) {
+    let serial = ConnectionMatrix::from_text(text).map(|m| m.to_bytes());
+    for chunk_size in [1, 3, 7, 64, 1 << 20] {
+        for threads in [1, 4] {
+            let chunked = ConnectionMatrix::from_text_chunked(text.as_bytes(), chunk_size, threads)
+                .map(|m| m.to_bytes());
+            match (&serial, &chunked) {
+                (Ok(a), Ok(b)) => assert!(a == b, "chunk_size {chunk_size}: output differs"),
+                (Err(a), Err(b)) => assert_eq!(
+                    a.to_string(),
+                    b.to_string(),
+                    "chunk_size {chunk_size}, threads {threads}"
+                ),
+                _ => panic!("chunk_size {chunk_size}: serial {serial:?} vs chunked {chunked:?}"),
+            }
+        }
+    }
+}
+
+fn mozc_text(num_ids: usize, line_end: &str) -> String {
+    let mut text = format!("{num_ids} {num_ids}{line_end}");
+    for i in 0..num_ids * num_ids {
+        text.push_str(&format!(
+            "{}{line_end}",
+            (i as i64 * 7919 % 65_536 - 32_768)
+        ));
+    }
+    text
+}
+
+fn triplet_text(num_ids: usize) -> String {
+    let mut text = format!("{num_ids} {num_ids}\n");
+    for right in 0..num_ids {
+        for left in 0..num_ids {
+            text.push_str(&format!(
+                "{right} {left} {}\n",
+                (right * 31 + left) as i16 - 40
+            ));
+        }
+    }
+    text
+}
+
+#[test]
+fn test_chunked_mozc_matches_serial() {
+    assert_chunked_matches(&mozc_text(13, "\n"));
+    assert_chunked_matches(&mozc_text(13, "\r\n"));
+    // Blank lines between costs and no trailing newline.
+    assert_chunked_matches("2 2\n\n0\n  10 \n\n20\n30");
+    // Metadata survives the chunked path.
+    let text = mozc_text(4, "\n");
+    let a = ConnectionMatrix::from_text_with_roles(&text, 1, 2, vec![0, 1, 2]).unwrap();
+    let b = ConnectionMatrix::from_text_chunked(text.as_bytes(), 5, 3)
+        .unwrap()
+        .with_roles(1, 2, vec![0, 1, 2])
+        .unwrap();
+    assert!(a.to_bytes() == b.to_bytes());
+}
+
+#[test]
+fn test_chunked_triplet_matches_serial() {
+    assert_chunked_matches(&triplet_text(11));
+    // Sparse, with a repeated cell: the later line must win.
+    assert_chunked_matches("3 3\n\n0 1 5\n2 2 -9\n0 1 7\n1 0 3\n0 1 11\n");
+}
+
+#[test]
+fn test_chunked_errors_match_serial() {
+    let mut bad_cost = mozc_text(5, "\n");
+    bad_cost = bad_cost.replacen("\n-", "\nx", 3);
+    assert_chunked_matches(&bad_cost);
+    assert_chunked_matches("2 2\n0\n10\n20\n");
+    assert_chunked_matches("2 2\n0\n10\n20\n30\n40\n");
+    // Wrong count and a malformed line: the malformed line is reported.
+    assert_chunked_matches("2 2\n0\n1x\n");
+    assert_chunked_matches("2 2\n0 0 1\n0 1\n1 1 1\n");
+    assert_chunked_matches("2 2\n0 0 1\n\n0 2 1\n");
+    assert_chunked_matches("");
+    assert_chunked_matches("2 3\n");
+    assert_chunked_matches("\n0\n");
+}
+
+#[test]
+fn test_error_reports_line_number() {
+    let text = "2 2\n0\n\n10\nbad\n30\n";
+    for result in [
+        ConnectionMatrix::from_text(text),
+        ConnectionMatrix::from_text_chunked(text.as_bytes(), 2, 4),
+    ] {
+        let err = result.err().expect("malformed line must fail").to_string();
+        assert!(err.contains("line 5: invalid cost 'bad'"), "{err}");
+    }
+}
+
+#[test]
+fn test_from_text_file_matches_serial() {
+    let text = triplet_text(9);
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("matrix.def");
+    fs::write(&path, &text).unwrap();
+    let a = ConnectionMatrix::from_text_with_roles(&text, 0, 3, vec![1; 9]).unwrap();
+    let b = ConnectionMatrix::from_text_file(&path, 0, 3, vec![1; 9]).unwrap();
+    assert!(a.to_bytes() == b.to_bytes());
+}
+
+/// Every `i16` shows up in some row, extremes included.
+fn wide_matrix() -> ConnectionMatrix {
+    let n = 16usize;
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    let costs: Vec<i16> = (0..n * n)
+        .map(|i| match i % 37 {
+            0 => i16::MIN,
+            1 => i16::MAX,
+            _ => {
+                // Row r spans about 2^(r % 16) around 3000.
+                let row = i / n;
+                let span = 1i64 << (row % 16);
+                (3000 + (rng.next() as i64).rem_euclid(span)).min(i16::MAX as i64) as i16
+            }
+        })
+        .collect();
+    ConnectionMatrix::new_owned(n as u16, 1, 2, vec![0, 1, 2, 3], costs)
+}
+
+#[test]
+fn test_quantize_narrow_rows_exact() {
+    // Rows span at most 20, well inside one byte: every code decodes exactly.
+    let m = sample_matrix();
+    let q = m.quantize();
+    assert!(!m.is_quantized());
+    assert!(q.is_quantized());
+    assert_eq!(q.max_quantization_error(), 0);
+    for left in 0..3 {
+        for right in 0..3 {
+            assert_eq!(q.cost(left, right), m.cost(left, right));
+        }
+    }
+}
+
+#[test]
+fn test_quantize_error_bound() {
+    let m = wide_matrix();
+    let q = m.quantize();
+    let bound = q.max_quantization_error();
+    // A full-range row needs a step of 65535 / 255 = 257.
+    assert_eq!(bound, 128);
+    let mut worst = 0;
+    for left in 0..m.num_ids() {
+        for right in 0..m.num_ids() {
+            let err = (i32::from(q.cost(left, right)) - i32::from(m.cost(left, right))).abs();
+            worst = worst.max(err);
+        }
+    }
+    assert!(worst <= i32::from(bound), "worst {worst} > bound {bound}");
+    // Extremes survive quantization.
+    assert_eq!(q.cost(0, 0), i16::MIN);
+    assert!(q.cost(0, 1) >= i16::MAX - 128);
+}
+
+#[test]
+fn test_quantized_roundtrip() {
+    let m = wide_matrix();
+    let q = m.quantize();
+    let bytes = q.to_bytes();
+    assert_eq!(bytes[4], 4);
+    // Half the cost grid of the V3 image.
+    assert_eq!(m.to_bytes().len() - bytes.len(), 16 * 16 - 16 * 4);
+    assert_eq!(
+        ConnectionMatrix::verify_bytes(&bytes).unwrap(),
+        Integrity::Intact
+    );
+
+    let owned = ConnectionMatrix::from_bytes(&bytes).unwrap();
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("quantized.conn");
+    q.save(&path).unwrap();
+    let mapped = ConnectionMatrix::open(&path).unwrap();
+    assert_eq!(mapped.verify(), Integrity::Intact);
+
+    for loaded in [&owned, &mapped] {
+        assert!(loaded.is_quantized());
+        assert_eq!(loaded.max_quantization_error(), q.max_quantization_error());
+        assert!(loaded.is_function_word(2));
+        assert_eq!(loaded.role(3), 3);
+        for left in 0..16 {
+            for right in 0..16 {
+                assert_eq!(loaded.cost(left, right), q.cost(left, right));
+            }
+        }
+        assert_eq!(loaded.to_bytes(), bytes);
+    }
+}
+
+#[test]
+fn test_quantized_out_of_range() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("quantized.conn");
+    sample_matrix().quantize().save(&path).unwrap();
+    let owned = sample_matrix().quantize();
+    let mapped = ConnectionMatrix::open(&path).unwrap();
+    for m in [&owned, &mapped] {
+        // (3, 0) would index the first byte past the codes.
+        assert_eq!(m.cost(3, 0), 0);
+        // (2, 3) is in range as an index but names no right ID.
+        assert_eq!(m.cost(2, 3), 0);
+        assert_eq!(m.cost(0, 3), 0);
+        assert_eq!(m.cost(u16::MAX, u16::MAX), 0);
+    }
+}
+
+#[test]
+fn test_quantized_verify_detects_row_table_corruption() {
+    let bytes = sample_matrix().quantize().to_bytes();
+    // Row scales sit between the roles and the codes, inside "header".
+    let rows_start = 11 + 3;
+    let codes_start = rows_start + 3 * 4;
+    for (section, at) in [("header", rows_start), ("costs", codes_start)] {
+        let mut corrupt = bytes.clone();
+        corrupt[at] ^= 0x01;
+        assert_eq!(
+            ConnectionMatrix::verify_bytes(&corrupt).unwrap(),
+            Integrity::Corrupt(vec![section]),
+            "flipped byte {at}"
+        );
+    }
+    // A V4 image cut inside its row table is rejected.
+    assert!(matches!(
+        ConnectionMatrix::from_bytes(&bytes[..rows_start + 5]),
+        Err(DictError::InvalidHeader)
+    ));
+}
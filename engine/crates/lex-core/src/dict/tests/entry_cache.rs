@@ -0,0 +1,270 @@
+use std::sync::Arc;
+use std::thread;
+
+use crate::converter::build_lattice;
+use crate::converter::testutil::test_dict;
+use crate::dict::{CompositeDictionary, DictEntry, Dictionary, EntryCache, TrieDictionary};
+
+type Row = (String, i16, u16, u16);
+
+fn rows(entries: &[DictEntry]) -> Vec<Row> {
+    entries
+        .iter()
+        .map(|e| (e.surface.clone(), e.cost, e.left_id, e.right_id))
+        .collect()
+}
+
+fn cached_dict(capacity_bytes: usize) -> TrieDictionary {
+    test_dict().with_entry_cache(Arc::new(EntryCache::new(capacity_bytes)))
+}
+
+fn stats(dict: &TrieDictionary) -> crate::dict::EntryCacheStats {
+    dict.entry_cache().unwrap().stats()
+}
+
+const QUERIES: &[&str] = &[
+    "きょうはいいてんきですね",
+    "わたしはがくせいです",
+    "きょう",
+    "き",
+    "てんき",
+    "ぬ",
+    "",
+];
+
+#[test]
+fn test_cached_results_match_uncached() {
+    let plain = test_dict();
+    let cached = cached_dict(1 << 20);
+    // Second round is served from the cache.
+    for round in 0..2 {
+        for &q in QUERIES {
+            assert_eq!(
+                rows(&cached.lookup(q)),
+                rows(&plain.lookup(q)),
+                "{q} {round}"
+            );
+            let prefix = |d: &TrieDictionary| -> Vec<(String, Vec<Row>)> {
+                d.common_prefix_search(q)
+                    .into_iter()
+                    .map(|r| (r.reading, rows(&r.entries)))
+                    .collect()
+            };
+            assert_eq!(prefix(&cached), prefix(&plain), "{q} {round}");
+            let shared: Vec<(String, Vec<Row>)> = cached
+                .common_prefix_search_shared(q)
+                .into_iter()
+                .map(|r| (r.reading, rows(&r.entries)))
+                .collect();
+            assert_eq!(shared, prefix(&plain), "{q} {round}");
+
+            let predict = |d: &TrieDictionary| -> Vec<(String, Vec<Row>)> {
+                d.predict(q, 50)
+                    .into_iter()
+                    .map(|r| (r.reading, rows(&r.entries)))
+                    .collect()
+            };
+            assert_eq!(predict(&cached), predict(&plain), "{q} {round}");
+
+            for (max, scan) in [(3, 1000), (20, 1000), (20, 2)] {
+                let ranked = |d: &TrieDictionary| -> Vec<(String, Row)> {
+                    d.predict_ranked(q, max, scan)
+                        .into_iter()
+                        .map(|(r, e)| (r, rows(&[e]).remove(0)))
+                        .collect()
+                };
+                assert_eq!(ranked(&cached), ranked(&plain), "{q} {max} {scan} {round}");
+            }
+        }
+    }
+    assert!(stats(&cached).hits > 0);
+}
+
+#[test]
+fn test_cached_lattice_matches_uncached() {
+    let plain = test_dict();
+    let cached = cached_dict(1 << 20);
+    for _ in 0..2 {
+        for &q in QUERIES {
+            let a = build_lattice(&plain, q);
+            let b = build_lattice(&cached, q);
+            assert_eq!(a.node_count(), b.node_count());
+            for i in 0..a.node_count() {
+                assert_eq!(
+                    (a.start(i), a.end(i), a.surface(i), a.cost(i), a.left_id(i)),
+                    (b.start(i), b.end(i), b.surface(i), b.cost(i), b.left_id(i)),
+                    "{q} node {i}"
+                );
+            }
+        }
+    }
+}
+
+#[test]
+fn test_composite_passes_cached_slices_through() {
+    let cache = Arc::new(EntryCache::new(1 << 20));
+    let trie: Arc<dyn Dictionary> = Arc::new(test_dict().with_entry_cache(Arc::clone(&cache)));
+    let user: Arc<dyn Dictionary> = Arc::new(TrieDictionary::from_entries(vec![(
+        "きょう".to_string(),
+        vec![DictEntry {
+            surface: "強".to_string(),
+            cost: 1000,
+            left_id: 1,
+            right_id: 1,
+        }],
+    )]));
+    let dict = CompositeDictionary::new(vec![Arc::clone(&trie), user]);
+
+    // Entries of equal cost may come out in either order.
+    let sorted = |entries: &[DictEntry]| {
+        assert!(entries.windows(2).all(|w| w[0].cost <= w[1].cost));
+        let mut rows = rows(entries);
+        rows.sort();
+        rows
+    };
+    for &q in QUERIES {
+        let owned: Vec<(String, Vec<Row>)> = dict
+            .common_prefix_search(q)
+            .into_iter()
+            .map(|r| (r.reading, sorted(&r.entries)))
+            .collect();
+        let shared: Vec<(String, Vec<Row>)> = dict
+            .common_prefix_search_shared(q)
+            .into_iter()
+            .map(|r| (r.reading, sorted(&r.entries)))
+            .collect();
+        assert_eq!(shared, owned, "{q}");
+    }
+
+    // A reading only the system layer has is the cached slice itself; one
+    // both layers have is merged into a new slice.
+    let entries_of = |d: &dyn Dictionary, reading: &str| -> Arc<[DictEntry]> {
+        d.common_prefix_search_shared(reading)
+            .into_iter()
+            .find(|r| r.reading == reading)
+            .unwrap()
+            .entries
+    };
+    assert!(Arc::ptr_eq(
+        &entries_of(trie.as_ref(), "てんき"),
+        &entries_of(&dict, "てんき")
+    ));
+    let kyou = entries_of(&dict, "きょう");
+    assert_eq!(kyou[0].surface, "強");
+    assert!(!Arc::ptr_eq(&kyou, &entries_of(trie.as_ref(), "きょう")));
+}
+
+#[test]
+fn test_hit_and_miss_counters() {
+    let dict = cached_dict(1 << 20);
+    assert_eq!(stats(&dict).hit_rate(), 0.0);
+
+    dict.lookup("きょう");
+    dict.lookup("きょう");
+    dict.lookup("きょう");
+    // Unknown readings never reach the cache.
+    dict.lookup("ぬぬぬ");
+    let s = stats(&dict);
+    assert_eq!((s.hits, s.misses, s.values), (2, 1, 1));
+    assert!((s.hit_rate() - 2.0 / 3.0).abs() < 1e-9);
+
+    dict.entry_cache().unwrap().reset_counters();
+    let s = stats(&dict);
+    assert_eq!((s.hits, s.misses, s.values), (0, 0, 1));
+    assert!(s.bytes > 0);
+}
+
+#[test]
+fn test_capacity_bounds_bytes() {
+    let budget = 600;
+    let dict = cached_dict(budget);
+    let readings: Vec<String> = dict.iter().map(|(r, _)| r).collect();
+    assert!(readings.len() > 10);
+    for r in &readings {
+        dict.lookup(r);
+        let s = stats(&dict);
+        assert!(s.bytes <= budget, "{} > {budget}", s.bytes);
+    }
+    let s = stats(&dict);
+    assert!(s.values < readings.len());
+    assert_eq!(s.misses as usize, readings.len());
+}
+
+#[test]
+fn test_second_chance_keeps_hot_value() {
+    let dict = cached_dict(600);
+    let readings: Vec<String> = dict.iter().map(|(r, _)| r).filter(|r| r != "は").collect();
+    dict.lookup("は");
+    // A hit between every cold insert keeps "は" referenced, so each pass
+    // of the clock hand spares it.
+    for r in &readings {
+        dict.lookup(r);
+        let before = stats(&dict).hits;
+        dict.lookup("は");
+        assert_eq!(stats(&dict).hits, before + 1, "evicted after {r}");
+    }
+}
+
+#[test]
+fn test_prewarm_fills_in_frequency_order() {
+    let dict = cached_dict(400);
+    let frequency = [
+        "は",
+        "の",
+        "です",
+        "ぬぬぬ",
+        "きょう",
+        "わたし",
+        "てんき",
+        "がくせい",
+    ];
+    let cached = dict.prewarm_entry_cache(frequency);
+    let s = stats(&dict);
+    assert!(
+        cached > 0 && cached < frequency.len() - 1,
+        "cached {cached}"
+    );
+    assert_eq!(s.values, cached);
+    assert_eq!((s.hits, s.misses), (0, 0));
+    assert!(s.bytes <= 400);
+
+    // The head of the list is served from the cache.
+    dict.lookup("は");
+    assert_eq!(stats(&dict).hits, 1);
+
+    // No cache, nothing to warm.
+    assert_eq!(test_dict().prewarm_entry_cache(frequency), 0);
+}
+
+#[test]
+fn test_oversized_value_is_not_cached() {
+    let dict = cached_dict(16);
+    assert_eq!(
+        rows(&dict.lookup("きょう")),
+        rows(&test_dict().lookup("きょう"))
+    );
+    dict.lookup("きょう");
+    let s = stats(&dict);
+    assert_eq!((s.hits, s.misses, s.values, s.bytes), (0, 2, 0, 0));
+}
+
+#[test]
+fn test_cache_shared_across_threads() {
+    let cache = Arc::new(EntryCache::new(1 << 20));
+    let dict = Arc::new(test_dict().with_entry_cache(Arc::clone(&cache)));
+    thread::scope(|s| {
+        for _ in 0..4 {
+            let dict = Arc::clone(&dict);
+            s.spawn(move || {
+                for _ in 0..50 {
+                    build_lattice(dict.as_ref(), "きょうはいいてんきですね");
+                }
+            });
+        }
+    });
+    let s = cache.stats();
+    // Racing misses on one ID may each decode it, but the cache ends up
+    // holding it once and everything after is a hit.
+    assert!(s.hits > s.misses * 10, "{s:?}");
+    assert!(s.values as u64 <= s.misses);
+}
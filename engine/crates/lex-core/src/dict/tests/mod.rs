@@ -1,2 +1,3 @@
 mod connection;
+mod entry_cache;
 mod trie_dict;
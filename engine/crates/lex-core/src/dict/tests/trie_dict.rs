@@ -1,4 +1,5 @@
-use crate::dict::{DictEntry, DictError, Dictionary, TrieDictionary};
+use crate::converter::testutil::test_dict;
+use crate::dict::{DictEntry, DictError, Dictionary, Integrity, TrieDictionary};
 
 fn sample_dict() -> TrieDictionary {
     let entries = vec![
@@ -281,3 +282,184 @@ fn test_open_mmap() {
     let p2 = dict2.predict("かん", 100);
     assert_eq!(p1.len(), p2.len());
 }
+
+#[test]
+fn test_layout_sections_and_pool_sharing() {
+    let mut entries: Vec<(String, Vec<DictEntry>)> = sample_dict().iter().collect();
+    // A second reading for 感じ shares its pool bytes.
+    entries.push((
+        "かんぢ".to_string(),
+        vec![DictEntry {
+            surface: "感じ".to_string(),
+            cost: 9000,
+            left_id: 0,
+            right_id: 0,
+        }],
+    ));
+    let dict = TrieDictionary::from_entries(entries);
+    let layout = dict.layout();
+    assert_eq!(layout.entries_bytes, 9 * 12);
+    assert_eq!(layout.index_bytes, 5 * 6);
+    assert_eq!(layout.distinct_surfaces, 8);
+    assert_eq!(layout.surface_bytes, layout.pool_bytes + "感じ".len());
+
+    let bytes = dict.to_bytes().unwrap();
+    assert_eq!(
+        // header + sections + checksum table (5 CRCs, count, magic)
+        24 + layout.trie_bytes + layout.pool_bytes + layout.entries_bytes + layout.index_bytes + 28,
+        bytes.len()
+    );
+
+    // The mmap-backed dictionary reports the same layout.
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("layout.dict");
+    dict.save(&path).unwrap();
+    assert_eq!(TrieDictionary::open(&path).unwrap().layout(), layout);
+}
+
+/// Section start offsets of a serialized dictionary, read from its header.
+fn section_starts(bytes: &[u8]) -> [(&'static str, usize); 5] {
+    let len = |at: usize| u32::from_ne_bytes(bytes[at..at + 4].try_into().unwrap()) as usize;
+    let trie = 24;
+    let pool = trie + len(8);
+    let entries = pool + len(12);
+    let index = entries + len(16);
+    [
+        // Byte 6 is the reading-length bound: flipping it leaves the
+        // layout intact.
+        ("header", 6),
+        ("trie", trie),
+        ("pool", pool),
+        ("entries", entries),
+        ("index", index),
+    ]
+}
+
+#[test]
+fn test_verify_detects_single_byte_corruption() {
+    let bytes = sample_dict().to_bytes().unwrap();
+    assert_eq!(
+        TrieDictionary::verify_bytes(&bytes).unwrap(),
+        Integrity::Intact
+    );
+
+    for (section, at) in section_starts(&bytes) {
+        let mut corrupt = bytes.clone();
+        corrupt[at] ^= 0x01;
+        assert_eq!(
+            TrieDictionary::verify_bytes(&corrupt).unwrap(),
+            Integrity::Corrupt(vec![section]),
+            "flipped byte {at}"
+        );
+    }
+
+    let mut corrupt = bytes.clone();
+    let crc_at = bytes.len() - 28;
+    corrupt[crc_at] ^= 0x01;
+    assert_eq!(
+        TrieDictionary::verify_bytes(&corrupt).unwrap(),
+        Integrity::Corrupt(vec!["header"])
+    );
+}
+
+#[test]
+fn test_max_reading_len_roundtrip() {
+    let dict = sample_dict();
+    let longest = dict.iter().map(|(r, _)| r.chars().count()).max().unwrap();
+    assert_eq!(dict.max_reading_len(), longest);
+
+    let bytes = dict.to_bytes().unwrap();
+    let loaded = TrieDictionary::from_bytes(&bytes).unwrap();
+    assert_eq!(loaded.max_reading_len(), longest);
+
+    // Files written before the bound was recorded leave the byte at 0.
+    let mut legacy = bytes[..bytes.len() - 28].to_vec();
+    legacy[5] = 0;
+    legacy[6] = 0;
+    let legacy = TrieDictionary::from_bytes(&legacy).unwrap();
+    assert_eq!(legacy.max_reading_len(), usize::MAX);
+    assert_eq!(legacy.lookup("かんじ").len(), dict.lookup("かんじ").len());
+}
+
+#[test]
+fn test_verify_table_damage_and_legacy_files() {
+    let bytes = sample_dict().to_bytes().unwrap();
+    let body_len = bytes.len() - 28;
+
+    // Truncated table on a flagged file.
+    assert_eq!(
+        TrieDictionary::verify_bytes(&bytes[..bytes.len() - 1]).unwrap(),
+        Integrity::Corrupt(vec!["checksums"])
+    );
+
+    // A file written before checksum tables: no flag, no trailer.
+    let mut legacy = bytes[..body_len].to_vec();
+    legacy[5] = 0;
+    assert_eq!(
+        TrieDictionary::verify_bytes(&legacy).unwrap(),
+        Integrity::Unchecked
+    );
+    assert_eq!(
+        TrieDictionary::from_bytes(&legacy).unwrap().verify(),
+        Integrity::Unchecked
+    );
+}
+
+#[test]
+fn test_open_defers_verification() {
+    let bytes = sample_dict().to_bytes().unwrap();
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("corrupt.dict");
+    let [_, _, (_, pool), ..] = section_starts(&bytes);
+    let mut corrupt = bytes.clone();
+    corrupt[pool] ^= 0x01;
+    std::fs::write(&path, &corrupt).unwrap();
+
+    // Opening stays O(1): the damage surfaces only when verified.
+    let dict = TrieDictionary::open(&path).unwrap();
+    assert_eq!(dict.verify(), Integrity::Corrupt(vec!["pool"]));
+
+    std::fs::write(&path, &bytes).unwrap();
+    assert_eq!(
+        TrieDictionary::open(&path).unwrap().verify(),
+        Integrity::Intact
+    );
+}
+
+type RankedRow = (String, String, i16, u16, u16);
+
+fn ranked_rows(ranked: Vec<(String, DictEntry)>) -> Vec<RankedRow> {
+    ranked
+        .into_iter()
+        .map(|(r, e)| (r, e.surface, e.cost, e.left_id, e.right_id))
+        .collect()
+}
+
+#[test]
+fn test_predict_ranked_matches_cloning_reference() {
+    // The ranking `predict_ranked` had before it borrowed entries: clone
+    // everything, sort, then dedup by surface.
+    let reference = |dict: &TrieDictionary, prefix: &str, max: usize, scan: usize| {
+        let mut flat: Vec<(String, DictEntry)> = Vec::new();
+        for sr in dict.predict(prefix, scan) {
+            for e in sr.entries {
+                flat.push((sr.reading.clone(), e));
+            }
+        }
+        flat.sort_by_key(|(_, e)| e.cost);
+        let mut seen = std::collections::HashSet::new();
+        flat.retain(|(_, e)| seen.insert(e.surface.clone()));
+        flat.truncate(max);
+        ranked_rows(flat)
+    };
+    let dict = test_dict();
+    for prefix in ["", "き", "きょう", "てんき", "ぬ"] {
+        for (max, scan) in [(3, 1000), (20, 1000), (20, 2)] {
+            assert_eq!(
+                ranked_rows(dict.predict_ranked(prefix, max, scan)),
+                reference(&dict, prefix, max, scan),
+                "{prefix} {max} {scan}"
+            );
+        }
+    }
+}
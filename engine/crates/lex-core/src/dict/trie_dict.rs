@@ -4,7 +4,8 @@ use std::sync::Arc;
 use lexime_trie::{DoubleArray, DoubleArrayBacked, StableBacking, TrieSearch};
 use memmap2::Mmap;
 
-use super::{DictEntry, DictError, Dictionary, SearchResult};
+use super::entry_cache::EntryCache;
+use super::{DictEntry, DictError, Dictionary, SearchResult, SharedSearchResult};
 
 /// Self-contained `AsRef<[u8]>` over a memory-mapped slice.
 ///
@@ -53,8 +54,16 @@ unsafe impl StableBacking for OwnedMmap {}
 
 pub(super) const MAGIC: &[u8; 4] = b"LXDX";
 pub(super) const VERSION: u8 = 4;
-// magic(4) + version(1) + reserved(3) + trie_len(4) + pool_len(4) + entries_len(4) + reading_count(4) = 24
+// magic(4) + version(1) + flags(1) + max_reading(1) + reserved(1) + trie_len(4) + pool_len(4) + entries_len(4) + reading_count(4) = 24
 pub(super) const HEADER_SIZE: usize = 24;
+/// Offset of the flags byte in the header.
+pub(super) const FLAGS_OFFSET: usize = 5;
+/// Offset of the longest reading in characters; 0 when unknown, in files
+/// written before it was recorded or whose longest reading does not fit a
+/// byte.
+pub(super) const MAX_READING_OFFSET: usize = 6;
+/// Flag: a checksum table follows the index section.
+pub(super) const FLAG_CHECKSUMS: u8 = 1;
 const ENTRY_SIZE: usize = 12; // str_offset(4) + str_len(2) + cost(2) + left_id(2) + right_id(2)
 pub(super) const SLOT_SIZE: usize = 6; // entry_offset(4) + count(2)
 
@@ -112,6 +121,16 @@ impl ValuesStore {
         }
     }
 
+    /// `(pool offset, length)` of every entry's surface, in entry order.
+    pub(super) fn surface_refs(&self) -> impl Iterator<Item = (u32, u16)> + '_ {
+        self.entries_data().chunks_exact(ENTRY_SIZE).map(|rec| {
+            (
+                u32::from_ne_bytes(rec[0..4].try_into().unwrap()),
+                u16::from_ne_bytes(rec[4..6].try_into().unwrap()),
+            )
+        })
+    }
+
     fn reading_count(&self) -> usize {
         self.reading_index().len() / SLOT_SIZE
     }
@@ -161,10 +180,28 @@ impl ValuesStore {
     }
 }
 
+/// Byte sizes of the LXDX sections and how much sharing the string pool
+/// achieves, as reported by [`TrieDictionary::layout`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct DictLayout {
+    pub trie_bytes: usize,
+    pub pool_bytes: usize,
+    pub entries_bytes: usize,
+    pub index_bytes: usize,
+    /// Surface bytes referenced by all entries; what the pool would hold
+    /// without deduplication.
+    pub surface_bytes: usize,
+    /// Number of distinct strings referenced from the pool.
+    pub distinct_surfaces: usize,
+}
+
 pub struct TrieDictionary {
     pub(super) trie: TrieStore,
     pub(super) values: ValuesStore,
     pub(super) _mmap: Option<Arc<Mmap>>,
+    pub(super) entry_cache: Option<Arc<EntryCache>>,
+    /// Longest reading in characters, `usize::MAX` when unknown.
+    pub(super) max_reading_chars: usize,
 }
 
 impl TrieDictionary {
@@ -175,6 +212,11 @@ impl TrieDictionary {
         }
         pairs.sort_by(|a, b| a.0.as_bytes().cmp(b.0.as_bytes()));
 
+        let max_reading_chars = pairs
+            .iter()
+            .map(|(r, _)| r.chars().count())
+            .max()
+            .unwrap_or(0);
         let keys: Vec<&[u8]> = pairs.iter().map(|(r, _)| r.as_bytes()).collect();
         let trie = DoubleArray::<u8>::build(&keys);
 
@@ -218,6 +260,59 @@ impl TrieDictionary {
                 reading_index,
             },
             _mmap: None,
+            entry_cache: None,
+            max_reading_chars,
+        }
+    }
+
+    /// Serve decoded entries through `cache` (see [`EntryCache`]).
+    ///
+    /// The cache is keyed by this file's value IDs; hand the same `Arc` to
+    /// every copy of this dictionary, never to a different one.
+    pub fn with_entry_cache(mut self, cache: Arc<EntryCache>) -> Self {
+        self.entry_cache = Some(cache);
+        self
+    }
+
+    pub fn entry_cache(&self) -> Option<&Arc<EntryCache>> {
+        self.entry_cache.as_ref()
+    }
+
+    /// Load the entries of `readings`, most frequent first, into the entry
+    /// cache until it is full. Unknown readings are skipped. Returns how many
+    /// readings were cached; 0 without a cache.
+    pub fn prewarm_entry_cache<'r>(&self, readings: impl IntoIterator<Item = &'r str>) -> usize {
+        let Some(cache) = &self.entry_cache else {
+            return 0;
+        };
+        let mut cached = 0;
+        for reading in readings {
+            let Some(id) = with_trie!(self, |t| t.exact_match(reading.as_bytes())) else {
+                continue;
+            };
+            if !cache.prewarm(id, self.values.get_entries(id as usize)) {
+                break;
+            }
+            cached += 1;
+        }
+        cached
+    }
+
+    /// Shared entries for a value ID, through the cache when there is one.
+    fn shared_entries(&self, value_id: u32) -> Arc<[DictEntry]> {
+        match &self.entry_cache {
+            Some(cache) => {
+                cache.get_or_insert_with(value_id, || self.values.get_entries(value_id as usize))
+            }
+            None => self.values.get_entries(value_id as usize).into(),
+        }
+    }
+
+    /// Owned entries for a value ID, copied out of the cache on a hit.
+    fn owned_entries(&self, value_id: u32) -> Vec<DictEntry> {
+        match &self.entry_cache {
+            Some(_) => self.shared_entries(value_id).to_vec(),
+            None => self.values.get_entries(value_id as usize),
         }
     }
 
@@ -250,11 +345,15 @@ impl Dictionary for TrieDictionary {
     fn lookup(&self, reading: &str) -> Vec<DictEntry> {
         with_trie!(self, |t| {
             t.exact_match(reading.as_bytes())
-                .map(|id| self.values.get_entries(id as usize))
+                .map(|id| self.owned_entries(id))
                 .unwrap_or_default()
         })
     }
 
+    fn max_reading_len(&self) -> usize {
+        self.max_reading_chars
+    }
+
     fn contains_reading(&self, reading: &str) -> bool {
         with_trie!(self, |t| t.exact_match(reading.as_bytes()).is_some())
     }
@@ -266,7 +365,7 @@ impl Dictionary for TrieDictionary {
                 .map(|m| SearchResult {
                     reading: String::from_utf8(m.key)
                         .unwrap_or_else(|e| String::from_utf8_lossy(e.as_bytes()).into_owned()),
-                    entries: self.values.get_entries(m.value_id as usize),
+                    entries: self.owned_entries(m.value_id),
                 })
                 .collect()
         })
@@ -278,26 +377,34 @@ impl Dictionary for TrieDictionary {
         max_results: usize,
         scan_limit: usize,
     ) -> Vec<(String, DictEntry)> {
-        let mut flat: Vec<(String, DictEntry)> = Vec::new();
+        // Rank borrowed entries and copy out only the survivors, instead of
+        // cloning every entry of up to `scan_limit` readings.
+        let mut readings: Vec<String> = Vec::new();
+        let mut lists: Vec<Arc<[DictEntry]>> = Vec::new();
         with_trie!(self, |t| {
             for m in t.predictive_search(prefix.as_bytes()).take(scan_limit) {
-                let reading = String::from_utf8(m.key)
-                    .unwrap_or_else(|e| String::from_utf8_lossy(e.as_bytes()).into_owned());
-                let entries = self.values.get_entries(m.value_id as usize);
-                flat.reserve(entries.len());
-                for e in entries {
-                    flat.push((reading.clone(), e));
-                }
+                readings.push(
+                    String::from_utf8(m.key)
+                        .unwrap_or_else(|e| String::from_utf8_lossy(e.as_bytes()).into_owned()),
+                );
+                lists.push(self.shared_entries(m.value_id));
             }
         });
 
+        let mut flat: Vec<(usize, &DictEntry)> = lists
+            .iter()
+            .enumerate()
+            .flat_map(|(i, entries)| entries.iter().map(move |e| (i, e)))
+            .collect();
         flat.sort_by_key(|(_, e)| e.cost);
 
         let mut seen = std::collections::HashSet::new();
-        flat.retain(|(_, e)| seen.insert(e.surface.clone()));
+        flat.retain(|(_, e)| seen.insert(e.surface.as_str()));
 
         flat.truncate(max_results);
-        flat
+        flat.into_iter()
+            .map(|(i, e)| (readings[i].clone(), e.clone()))
+            .collect()
     }
 
     fn common_prefix_search(&self, query: &str) -> Vec<SearchResult> {
@@ -308,7 +415,22 @@ impl Dictionary for TrieDictionary {
                     let reading = std::str::from_utf8(&query_bytes[..m.len]).ok()?;
                     Some(SearchResult {
                         reading: reading.to_string(),
-                        entries: self.values.get_entries(m.value_id as usize),
+                        entries: self.owned_entries(m.value_id),
+                    })
+                })
+                .collect()
+        })
+    }
+
+    fn common_prefix_search_shared(&self, query: &str) -> Vec<SharedSearchResult> {
+        let query_bytes = query.as_bytes();
+        with_trie!(self, |t| {
+            t.common_prefix_search(query_bytes)
+                .filter_map(|m| {
+                    let reading = std::str::from_utf8(&query_bytes[..m.len]).ok()?;
+                    Some(SharedSearchResult {
+                        reading: reading.to_string(),
+                        entries: self.shared_entries(m.value_id),
                     })
                 })
                 .collect()
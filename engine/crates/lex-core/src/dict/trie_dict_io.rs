@@ -1,15 +1,22 @@
+use std::collections::HashSet;
 use std::fs::{self, File};
+use std::ops::Range;
 use std::path::Path;
 use std::sync::Arc;
 
 use lexime_trie::{DoubleArray, DoubleArrayBacked};
 use memmap2::Mmap;
 
+use super::checksum::{self, Integrity};
 use super::trie_dict::{
-    OwnedMmap, TrieDictionary, TrieStore, ValuesStore, HEADER_SIZE, MAGIC, SLOT_SIZE, VERSION,
+    DictLayout, OwnedMmap, TrieDictionary, TrieStore, ValuesStore, FLAGS_OFFSET, FLAG_CHECKSUMS,
+    HEADER_SIZE, MAGIC, MAX_READING_OFFSET, SLOT_SIZE, VERSION,
 };
 use super::DictError;
 
+/// Sections covered by the checksum table, in file order.
+const SECTION_COUNT: usize = 5;
+
 /// Validated byte offsets for each LXDX section.
 ///
 /// Produced by [`SectionOffsets::parse`], which also performs the
@@ -23,6 +30,8 @@ struct SectionOffsets {
     entries_start: usize,
     index_start: usize,
     end: usize,
+    /// Longest reading in characters, `usize::MAX` when not recorded.
+    max_reading_chars: usize,
 }
 
 impl SectionOffsets {
@@ -68,14 +77,30 @@ impl SectionOffsets {
         if data.len() < end {
             return Err(DictError::InvalidHeader);
         }
+        let max_reading_chars = match data[MAX_READING_OFFSET] {
+            0 => usize::MAX,
+            n => usize::from(n),
+        };
         Ok(Self {
             trie_start,
             pool_start,
             entries_start,
             index_start,
             end,
+            max_reading_chars,
         })
     }
+
+    /// Name and byte range of every section, header included.
+    fn named(&self) -> [(&'static str, Range<usize>); SECTION_COUNT] {
+        [
+            ("header", 0..self.trie_start),
+            ("trie", self.trie_start..self.pool_start),
+            ("pool", self.pool_start..self.entries_start),
+            ("entries", self.entries_start..self.index_start),
+            ("index", self.index_start..self.end),
+        ]
+    }
 }
 
 impl TrieDictionary {
@@ -109,11 +134,17 @@ impl TrieDictionary {
             .try_into()
             .map_err(|_| DictError::Parse("reading count exceeds u32::MAX".to_string()))?;
 
-        let total = HEADER_SIZE + trie_data.len() + pool.len() + entries.len() + index.len();
+        let total = HEADER_SIZE
+            + trie_data.len()
+            + pool.len()
+            + entries.len()
+            + index.len()
+            + checksum::trailer_len(SECTION_COUNT);
         let mut buf = Vec::with_capacity(total);
         buf.extend_from_slice(MAGIC);
         buf.push(VERSION);
-        buf.extend_from_slice(&[0u8; 3]); // reserved
+        let max_reading = u8::try_from(self.max_reading_chars).unwrap_or(0);
+        buf.extend_from_slice(&[FLAG_CHECKSUMS, max_reading, 0]); // flags + max reading + reserved
         buf.extend_from_slice(&trie_len.to_ne_bytes());
         buf.extend_from_slice(&pool_len.to_ne_bytes());
         buf.extend_from_slice(&entries_len.to_ne_bytes());
@@ -123,6 +154,8 @@ impl TrieDictionary {
         buf.extend_from_slice(entries);
         buf.extend_from_slice(index);
 
+        let sections = SectionOffsets::parse(&buf)?.named().map(|(_, range)| range);
+        checksum::append(&mut buf, &sections);
         Ok(buf)
     }
 
@@ -138,6 +171,8 @@ impl TrieDictionary {
                 reading_index: data[sections.index_start..sections.end].to_vec(),
             },
             _mmap: None,
+            entry_cache: None,
+            max_reading_chars: sections.max_reading_chars,
         })
     }
 
@@ -189,9 +224,68 @@ impl TrieDictionary {
                 reading_index,
             },
             _mmap: Some(mmap),
+            entry_cache: None,
+            max_reading_chars: sections.max_reading_chars,
         })
     }
 
+    /// Section sizes and string-pool sharing, for layout diagnostics.
+    pub fn layout(&self) -> DictLayout {
+        let trie_bytes = match (&self.trie, &self._mmap) {
+            (TrieStore::Owned(da), _) => da.as_bytes().len(),
+            // `open` already validated the header, so this cannot fail.
+            (TrieStore::MmapRef(_), Some(mmap)) => {
+                SectionOffsets::parse(mmap).map_or(0, |s| s.pool_start - s.trie_start)
+            }
+            (TrieStore::MmapRef(_), None) => 0,
+        };
+        let mut distinct = HashSet::new();
+        let mut surface_bytes = 0;
+        for (offset, len) in self.values.surface_refs() {
+            surface_bytes += len as usize;
+            distinct.insert((offset, len));
+        }
+        DictLayout {
+            trie_bytes,
+            pool_bytes: self.values.string_pool().len(),
+            entries_bytes: self.values.entries_data().len(),
+            index_bytes: self.values.reading_index().len(),
+            surface_bytes,
+            distinct_surfaces: distinct.len(),
+        }
+    }
+
+    /// Compare every section with the checksum table written by `save`.
+    ///
+    /// Hashes the whole file, so run it off the startup path. Dictionaries
+    /// built in memory have nothing on disk to check and report `Unchecked`.
+    pub fn verify(&self) -> Integrity {
+        match &self._mmap {
+            // `open` already validated the header, so this cannot fail.
+            Some(mmap) => {
+                Self::verify_bytes(mmap).unwrap_or_else(|_| Integrity::Corrupt(vec!["header"]))
+            }
+            None => Integrity::Unchecked,
+        }
+    }
+
+    /// Compare every section of the LXDX image `data` with its checksum table.
+    pub fn verify_bytes(data: &[u8]) -> Result<Integrity, DictError> {
+        let sections = SectionOffsets::parse(data)?;
+        let trailer = &data[sections.end..];
+        let Some(table) = checksum::parse(trailer) else {
+            // A flagged file lost its table; unflagged trailing bytes are
+            // not something the writer ever produced either.
+            let flagged = data[FLAGS_OFFSET] & FLAG_CHECKSUMS != 0;
+            return Ok(if flagged || !trailer.is_empty() {
+                Integrity::Corrupt(vec!["checksums"])
+            } else {
+                Integrity::Unchecked
+            });
+        };
+        Ok(checksum::verify(data, &sections.named(), &table))
+    }
+
     pub fn save(&self, path: &Path) -> Result<(), DictError> {
         Ok(fs::write(path, self.to_bytes()?)?)
     }
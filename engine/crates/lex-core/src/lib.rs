@@ -6,7 +6,7 @@ pub mod converter;
 pub mod dict;
 #[cfg(feature = "neural")]
 pub mod neural;
-pub(crate) mod numeric;
+pub mod numeric;
 pub mod romaji;
 pub mod settings;
 pub mod snippets;
@@ -5,13 +5,20 @@
 //!
 //! GGUF tensor names follow the llama.cpp convention for GPT-2.
 
+use std::ops::Range;
 use std::path::Path;
 
 use candle_core::quantized::gguf_file;
 use candle_core::quantized::QMatMul;
-use candle_core::{Device, IndexOp, Module, Result, Tensor};
+
+use candle_core::{DType, Device, IndexOp, Module, Result, Tensor, D};
 use candle_nn::{Embedding, LayerNorm};
 
+use super::kv_cache::{Int8Kv, KvCache, KvCacheMode};
+
+/// Tokens of int8 K/V dequantized per attention block.
+const KV_BLOCK: usize = 128;
+
 // ---- Configuration ----
 
 struct Gpt2Config {
@@ -54,7 +61,8 @@ struct Attention {
     out_bias: Tensor,
     n_head: usize,
     head_dim: usize,
-    kv_cache: Option<(Tensor, Tensor)>,
+    kv_mode: KvCacheMode,
+    kv_cache: Option<KvCache>,
 }
 
 impl Attention {
@@ -72,28 +80,24 @@ impl Attention {
         let k = qkv.i((.., .., 1))?.transpose(1, 2)?.contiguous()?;
         let v = qkv.i((.., .., 2))?.transpose(1, 2)?.contiguous()?;
 
-        // KV-cache: concatenate along sequence dimension
-        let (k, v) = if let Some((prev_k, prev_v)) = &self.kv_cache {
-            let k = Tensor::cat(&[prev_k, &k], 2)?;
-            let v = Tensor::cat(&[prev_v, &v], 2)?;
-            (k, v)
-        } else {
-            (k, v)
-        };
-        self.kv_cache = Some((k.clone(), v.clone()));
-
-        let total_len = pos + seq_len;
-
-        // Scaled dot-product attention
+        // KV-cache: extend along sequence dimension
         let scale = (head_dim as f64).sqrt();
-        let attn_weights = q.matmul(&k.transpose(2, 3)?)? / scale;
+        let attn_out = match KvCache::append(&mut self.kv_cache, self.kv_mode, k, v)? {
+            KvCache::F32 { k, v } => {
+                let total_len = pos + seq_len;
+
+                // Scaled dot-product attention
+                let attn_weights = q.matmul(&k.transpose(2, 3)?)? / scale;
 
-        // Causal mask: only attend to positions <= current
-        let mask = create_causal_mask(seq_len, total_len, x.device())?;
-        let attn_weights = attn_weights?.broadcast_add(&mask)?;
+                // Causal mask: only attend to positions <= current
+                let mask = create_causal_mask(seq_len, pos, 0..total_len, x.device())?;
+                let attn_weights = attn_weights?.broadcast_add(&mask)?;
 
-        let attn_weights = candle_nn::ops::softmax_last_dim(&attn_weights)?;
-        let attn_out = attn_weights.matmul(&v)?;
+                let attn_weights = candle_nn::ops::softmax_last_dim(&attn_weights)?;
+                attn_weights.matmul(v)?
+            }
+            KvCache::Int8(cache) => attend_int8(&q, cache, pos, scale)?,
+        };
 
         // Reshape back: [batch, seq, n_embd]
         let attn_out = attn_out
@@ -109,12 +113,18 @@ impl Attention {
     }
 }
 
-fn create_causal_mask(seq_len: usize, total_len: usize, device: &Device) -> Result<Tensor> {
-    let offset = total_len - seq_len;
-    // For each query position i (0..seq_len), mask out key positions j where j > i + offset
+/// Causal mask of `seq_len` queries at positions `offset..` against the key
+/// positions `keys`: query i sees key j only when j <= i + offset.
+fn create_causal_mask(
+    seq_len: usize,
+    offset: usize,
+    keys: Range<usize>,
+    device: &Device,
+) -> Result<Tensor> {
+    let key_len = keys.len();
     let mask: Vec<f32> = (0..seq_len)
         .flat_map(|i| {
-            (0..total_len).map(move |j| {
+            keys.clone().map(move |j| {
                 if j <= i + offset {
                     0.0f32
                 } else {
@@ -123,7 +133,43 @@ fn create_causal_mask(seq_len: usize, total_len: usize, device: &Device) -> Resu
             })
         })
         .collect();
-    Tensor::from_vec(mask, (1, 1, seq_len, total_len), device)
+    Tensor::from_vec(mask, (1, 1, seq_len, key_len), device)
+}
+
+/// Scaled dot-product attention over int8 K/V, `KV_BLOCK` tokens at a time.
+///
+/// Blocks are merged with a running softmax (max, normalizer and weighted
+/// sum rescaled as the max grows), so only one block is ever held in f32.
+/// Block 0 holds key 0, which every query sees, so the running max is finite
+/// from the start and fully masked later blocks contribute exp(-inf) = 0.
+fn attend_int8(q: &Tensor, cache: &Int8Kv, pos: usize, scale: f64) -> Result<Tensor> {
+    let seq_len = q.dim(2)?;
+    let total_len = cache.len();
+    let device = q.device();
+    let mut state: Option<(Tensor, Tensor, Tensor)> = None;
+    for start in (0..total_len).step_by(KV_BLOCK) {
+        let keys = start..(start + KV_BLOCK).min(total_len);
+        let (k, v) = cache.dequantize(keys.clone(), device)?;
+        let mask = create_causal_mask(seq_len, pos, keys, device)?;
+        let scores = (q.matmul(&k.transpose(2, 3)?)? / scale)?.broadcast_add(&mask)?;
+        let block_max = scores.max_keepdim(D::Minus1)?;
+        state = Some(match state {
+            None => {
+                let p = scores.broadcast_sub(&block_max)?.exp()?;
+                (block_max, p.sum_keepdim(D::Minus1)?, p.matmul(&v)?)
+            }
+            Some((max, sum, acc)) => {
+                let new_max = max.maximum(&block_max)?;
+                let rescale = max.sub(&new_max)?.exp()?;
+                let p = scores.broadcast_sub(&new_max)?.exp()?;
+                let sum = sum.mul(&rescale)?.add(&p.sum_keepdim(D::Minus1)?)?;
+                let acc = acc.broadcast_mul(&rescale)?.add(&p.matmul(&v)?)?;
+                (new_max, sum, acc)
+            }
+        });
+    }
+    let (_, sum, acc) = state.expect("the token just appended is cached");
+    acc.broadcast_div(&sum)
 }
 
 // ---- MLP ----
@@ -178,6 +224,10 @@ impl Block {
 
 // ---- Full GPT-2 Model ----
 
+/// Opaque KV cache state captured by [`QuantizedGpt2::save_kv_cache`].
+#[derive(Clone)]
+pub struct KvSnapshot(Vec<Option<KvCache>>);
+
 pub struct QuantizedGpt2 {
     wte: Embedding,
     wpe: Embedding,
@@ -277,6 +327,7 @@ impl QuantizedGpt2 {
                 )?,
                 n_head: config.n_head,
                 head_dim: config.head_dim(),
+                kv_mode: KvCacheMode::default(),
                 kv_cache: None,
             };
 
@@ -408,20 +459,115 @@ impl QuantizedGpt2 {
 
     /// Save a snapshot of the current KV cache state.
     ///
-    /// `Tensor::clone()` is O(1) (Arc-based reference counting),
-    /// so this is cheap even for large caches.
-    pub fn save_kv_cache(&self) -> Vec<Option<(Tensor, Tensor)>> {
+    /// Both cache kinds are reference counted, so this is O(1) even for
+    /// large caches.
+    pub fn save_kv_cache(&self) -> KvSnapshot {
+        KvSnapshot(
+            self.blocks
+                .iter()
+                .map(|b| b.attn.kv_cache.clone())
+                .collect(),
+        )
+    }
+
+    /// Restore KV cache from a previously saved snapshot.
+    pub fn restore_kv_cache(&mut self, snapshot: &KvSnapshot) {
+        for (block, cache) in self.blocks.iter_mut().zip(snapshot.0.iter()) {
+            block.attn.kv_cache = cache.as_ref().map(KvCache::detached);
+        }
+    }
+
+    /// Select the KV cache storage precision. Clears the current cache.
+    pub fn set_kv_cache_mode(&mut self, mode: KvCacheMode) {
+        for block in &mut self.blocks {
+            block.attn.kv_mode = mode;
+            block.attn.kv_cache = None;
+        }
+    }
+
+    pub fn kv_cache_mode(&self) -> KvCacheMode {
+        self.blocks
+            .first()
+            .map_or(KvCacheMode::default(), |b| b.attn.kv_mode)
+    }
+
+    /// Resident bytes held by the KV cache across all layers.
+    pub fn kv_cache_bytes(&self) -> usize {
         self.blocks
             .iter()
-            .map(|b| b.attn.kv_cache.clone())
-            .collect()
+            .filter_map(|b| b.attn.kv_cache.as_ref())
+            .map(KvCache::bytes)
+            .sum()
     }
 
-    /// Restore KV cache from a previously saved snapshot.
-    pub fn restore_kv_cache(&mut self, snapshot: &[Option<(Tensor, Tensor)>]) {
-        for (block, cache) in self.blocks.iter_mut().zip(snapshot.iter()) {
-            block.attn.kv_cache = cache.clone();
+    /// Build a model with random weights, for tests and benchmarks that
+    /// need the real forward pass without a GGUF file.
+    #[doc(hidden)]
+    pub fn random(
+        n_embd: usize,
+        n_head: usize,
+        n_layer: usize,
+        vocab_size: usize,
+        n_positions: usize,
+        device: &Device,
+    ) -> Result<Self> {
+        let config = Gpt2Config {
+            n_embd,
+            n_head,
+            n_layer,
+            n_positions,
+            vocab_size,
+        };
+        let linear = |out: usize, inp: usize| {
+            Tensor::randn(0f32, 0.05, (out, inp), device).map(QMatMul::Tensor)
+        };
+        let layer_norm = || -> Result<LayerNorm> {
+            Ok(LayerNorm::new(
+                Tensor::ones(n_embd, DType::F32, device)?,
+                Tensor::zeros(n_embd, DType::F32, device)?,
+                1e-5,
+            ))
+        };
+        let zeros = |n: usize| Tensor::zeros(n, DType::F32, device);
+
+        let mut blocks = Vec::with_capacity(n_layer);
+        for _ in 0..n_layer {
+            blocks.push(Block {
+                ln_1: layer_norm()?,
+                attn: Attention {
+                    qkv: linear(3 * n_embd, n_embd)?,
+                    qkv_bias: zeros(3 * n_embd)?,
+                    out_proj: linear(n_embd, n_embd)?,
+                    out_bias: zeros(n_embd)?,
+                    n_head,
+                    head_dim: config.head_dim(),
+                    kv_mode: KvCacheMode::default(),
+                    kv_cache: None,
+                },
+                ln_2: layer_norm()?,
+                mlp: Mlp {
+                    fc: linear(4 * n_embd, n_embd)?,
+                    fc_bias: zeros(4 * n_embd)?,
+                    proj: linear(n_embd, 4 * n_embd)?,
+                    proj_bias: zeros(n_embd)?,
+                },
+            });
         }
+
+        Ok(Self {
+            wte: Embedding::new(
+                Tensor::randn(0f32, 1.0, (vocab_size, n_embd), device)?,
+                n_embd,
+            ),
+            wpe: Embedding::new(
+                Tensor::randn(0f32, 1.0, (n_positions, n_embd), device)?,
+                n_embd,
+            ),
+            blocks,
+            ln_f: layer_norm()?,
+            lm_head: None,
+            config,
+        })
     }
 
     /// Get model configuration summary.
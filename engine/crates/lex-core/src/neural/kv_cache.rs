@@ -0,0 +1,258 @@
+//! Per-layer attention KV cache for [`QuantizedGpt2`](super::QuantizedGpt2).
+//!
+//! The default cache keeps full-precision K/V tensors and grows them with
+//! `Tensor::cat`. The opt-in int8 cache stores each (token, head) row as
+//! symmetric int8 with its own f32 scale, cutting resident size to roughly a
+//! quarter; attention dequantizes them one block of tokens at a time, so no
+//! full-length f32 K/V is ever built.
+
+use std::ops::Range;
+use std::sync::Arc;
+
+use candle_core::{Device, Result, Tensor};
+
+/// Storage precision for the attention KV cache.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum KvCacheMode {
+    /// Full-precision f32 K/V tensors.
+    #[default]
+    F32,
+    /// Int8 K/V with one f32 scale per head per token.
+    Int8,
+}
+
+#[derive(Clone)]
+pub(super) enum KvCache {
+    F32 { k: Tensor, v: Tensor },
+    Int8(Arc<Int8Kv>),
+}
+
+impl KvCache {
+    /// Append this step's `k`/`v` (`[1, n_head, seq, head_dim]`) to `slot`
+    /// and return the cache to attend over.
+    pub(super) fn append(
+        slot: &mut Option<KvCache>,
+        mode: KvCacheMode,
+        k: Tensor,
+        v: Tensor,
+    ) -> Result<&KvCache> {
+        let cache = match mode {
+            KvCacheMode::F32 => match slot.take() {
+                Some(KvCache::F32 {
+                    k: prev_k,
+                    v: prev_v,
+                }) => KvCache::F32 {
+                    k: Tensor::cat(&[&prev_k, &k], 2)?,
+                    v: Tensor::cat(&[&prev_v, &v], 2)?,
+                },
+                _ => KvCache::F32 { k, v },
+            },
+            KvCacheMode::Int8 => {
+                let (_, n_head, _, head_dim) = k.dims4()?;
+                let mut cache = match slot.take() {
+                    Some(KvCache::Int8(cache)) => cache,
+                    _ => Arc::new(Int8Kv::new(n_head, head_dim)),
+                };
+                let kv = Arc::make_mut(&mut cache);
+                kv.k.append(&k)?;
+                kv.v.append(&v)?;
+                KvCache::Int8(cache)
+            }
+        };
+        Ok(&*slot.insert(cache))
+    }
+
+    /// Copy of this cache that no longer shares storage with `self`.
+    ///
+    /// F32 tensors are immutable, so sharing them is free. Int8 rows are
+    /// appended in place; copying them here keeps the copy-on-write cost out
+    /// of the next forward step.
+    pub(super) fn detached(&self) -> KvCache {
+        match self {
+            KvCache::F32 { k, v } => KvCache::F32 {
+                k: k.clone(),
+                v: v.clone(),
+            },
+            KvCache::Int8(cache) => KvCache::Int8(Arc::new(Int8Kv::clone(cache))),
+        }
+    }
+
+    /// Resident bytes held by this cache.
+    pub(super) fn bytes(&self) -> usize {
+        match self {
+            KvCache::F32 { k, v } => (k.elem_count() + v.elem_count()) * size_of::<f32>(),
+            KvCache::Int8(cache) => cache.k.bytes() + cache.v.bytes(),
+        }
+    }
+}
+
+#[derive(Clone)]
+pub(super) struct Int8Kv {
+    k: Int8Rows,
+    v: Int8Rows,
+}
+
+impl Int8Kv {
+    fn new(n_head: usize, head_dim: usize) -> Self {
+        Self {
+            k: Int8Rows::new(n_head, head_dim),
+            v: Int8Rows::new(n_head, head_dim),
+        }
+    }
+
+    /// Cached tokens.
+    pub(super) fn len(&self) -> usize {
+        self.k.len
+    }
+
+    /// K and V of `tokens`, dequantized to `[1, n_head, tokens.len(), head_dim]`.
+    pub(super) fn dequantize(
+        &self,
+        tokens: Range<usize>,
+        device: &Device,
+    ) -> Result<(Tensor, Tensor)> {
+        Ok((
+            self.k.dequantize(tokens.clone(), device)?,
+            self.v.dequantize(tokens, device)?,
+        ))
+    }
+}
+
+/// Int8 rows laid out `[token][head][head_dim]` so appends never move
+/// existing data, with one scale per `[token][head]` row.
+#[derive(Clone)]
+struct Int8Rows {
+    n_head: usize,
+    head_dim: usize,
+    len: usize,
+    data: Vec<i8>,
+    scales: Vec<f32>,
+}
+
+impl Int8Rows {
+    fn new(n_head: usize, head_dim: usize) -> Self {
+        Self {
+            n_head,
+            head_dim,
+            len: 0,
+            data: Vec::new(),
+            scales: Vec::new(),
+        }
+    }
+
+    /// Quantize and append `x` (`[1, n_head, seq, head_dim]`).
+    fn append(&mut self, x: &Tensor) -> Result<()> {
+        let heads = x.squeeze(0)?.to_vec3::<f32>()?;
+        let seq = heads.first().map_or(0, Vec::len);
+        for t in 0..seq {
+            for head in &heads {
+                let scale = quantize_row(&head[t], &mut self.data);
+                self.scales.push(scale);
+            }
+        }
+        self.len += seq;
+        Ok(())
+    }
+
+    /// Dequantize `tokens` into an f32 tensor of shape
+    /// `[1, n_head, tokens.len(), head_dim]`.
+    fn dequantize(&self, tokens: Range<usize>, device: &Device) -> Result<Tensor> {
+        let (n_head, head_dim, len) = (self.n_head, self.head_dim, tokens.len());
+        let mut out = vec![0f32; n_head * len * head_dim];
+        for (i, t) in tokens.enumerate() {
+            for h in 0..n_head {
+                let row = t * n_head + h;
+                let src = &self.data[row * head_dim..(row + 1) * head_dim];
+                let dst = &mut out[(h * len + i) * head_dim..][..head_dim];
+                dequantize_row(src, self.scales[row], dst);
+            }
+        }
+        Tensor::from_vec(out, (1, n_head, len, head_dim), device)
+    }
+
+    fn bytes(&self) -> usize {
+        self.data.len() + self.scales.len() * size_of::<f32>()
+    }
+}
+
+/// Symmetric per-row quantization: `q = round(x / scale)` with
+/// `scale = max|x| / 127`, so the error per element is at most `scale / 2`.
+fn quantize_row(row: &[f32], out: &mut Vec<i8>) -> f32 {
+    let max_abs = row.iter().fold(0f32, |m, &x| m.max(x.abs()));
+    if max_abs == 0.0 || !max_abs.is_finite() {
+        out.extend(std::iter::repeat_n(0i8, row.len()));
+        return 0.0;
+    }
+    let scale = max_abs / 127.0;
+    let inv = 1.0 / scale;
+    out.extend(
+        row.iter()
+            .map(|&x| (x * inv).round().clamp(-127.0, 127.0) as i8),
+    );
+    scale
+}
+
+fn dequantize_row(src: &[i8], scale: f32, dst: &mut [f32]) {
+    for (d, &q) in dst.iter_mut().zip(src) {
+        *d = f32::from(q) * scale;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_quantize_row_error_bound() {
+        let row: Vec<f32> = (0..64).map(|i| ((i as f32) * 0.37).sin() * 3.0).collect();
+        let mut q = Vec::new();
+        let scale = quantize_row(&row, &mut q);
+        let mut back = vec![0f32; row.len()];
+        dequantize_row(&q, scale, &mut back);
+        for (a, b) in row.iter().zip(&back) {
+            assert!((a - b).abs() <= scale / 2.0 + f32::EPSILON);
+        }
+    }
+
+    #[test]
+    fn test_quantize_row_zero() {
+        let mut q = Vec::new();
+        assert_eq!(quantize_row(&[0.0; 8], &mut q), 0.0);
+        assert_eq!(q, vec![0i8; 8]);
+    }
+
+    #[test]
+    fn test_int8_rows_round_trip_layout() {
+        let device = Device::Cpu;
+        let mut rows = Int8Rows::new(2, 3);
+        // [1, n_head=2, seq=2, head_dim=3]
+        let a = Tensor::from_vec(
+            vec![1f32, 2., 3., 4., 5., 6., -1., -2., -3., -4., -5., -6.],
+            (1, 2, 2, 3),
+            &device,
+        )
+        .unwrap();
+        rows.append(&a).unwrap();
+        let b = Tensor::from_vec(vec![7f32, 8., 9., -7., -8., -9.], (1, 2, 1, 3), &device).unwrap();
+        rows.append(&b).unwrap();
+
+        let out = rows.dequantize(0..3, &device).unwrap();
+        assert_eq!(out.dims(), &[1, 2, 3, 3]);
+        let vals: Vec<f32> = out.flatten_all().unwrap().to_vec1().unwrap();
+        let expected = [
+            1f32, 2., 3., 4., 5., 6., 7., 8., 9., -1., -2., -3., -4., -5., -6., -7., -8., -9.,
+        ];
+        for (a, b) in vals.iter().zip(expected) {
+            assert!((a - b).abs() < 0.05, "{a} vs {b}");
+        }
+        assert_eq!(rows.bytes(), 18 + 6 * 4);
+
+        let tail = rows.dequantize(1..3, &device).unwrap();
+        assert_eq!(tail.dims(), &[1, 2, 2, 3]);
+        let vals: Vec<f32> = tail.flatten_all().unwrap().to_vec1().unwrap();
+        let expected = [4f32, 5., 6., 7., 8., 9., -4., -5., -6., -7., -8., -9.];
+        for (a, b) in vals.iter().zip(expected) {
+            assert!((a - b).abs() < 0.05, "{a} vs {b}");
+        }
+    }
+}
@@ -9,6 +9,7 @@
 //! because inference latency is too high for interactive use.
 
 mod gpt2;
+mod kv_cache;
 mod scoring;
 pub mod speculative;
 #[cfg(test)]
@@ -19,8 +20,9 @@ use std::path::Path;
 
 use candle_core::{DType, Device, Tensor};
 
-pub use gpt2::QuantizedGpt2;
-pub use scoring::build_prompt;
+pub use gpt2::{KvSnapshot, QuantizedGpt2};
+pub use kv_cache::KvCacheMode;
+pub use scoring::{build_prompt, PathScore, PruneConfig, PrunedScores};
 pub use tokenizer::{hiragana_to_katakana, BpeTokenizer, CHAR_CONTEXT, CHAR_INPUT, CHAR_OUTPUT};
 
 /// Configuration for autoregressive text generation.
@@ -170,6 +172,15 @@ impl NeuralScorer {
         Ok(text)
     }
 
+    /// Select the KV cache precision used by scoring and generation.
+    pub fn set_kv_cache_mode(&mut self, mode: KvCacheMode) {
+        self.model.set_kv_cache_mode(mode);
+    }
+
+    pub fn kv_cache_mode(&self) -> KvCacheMode {
+        self.model.kv_cache_mode()
+    }
+
     /// Get model configuration summary.
     pub fn config_summary(&self) -> String {
         self.model.config_summary()
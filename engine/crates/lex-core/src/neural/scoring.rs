@@ -5,6 +5,62 @@ use crate::converter::ConvertedSegment;
 use super::tokenizer::{hiragana_to_katakana, BpeTokenizer, CHAR_CONTEXT, CHAR_INPUT, CHAR_OUTPUT};
 use super::NeuralScorer;
 
+/// Early-exit settings for [`NeuralScorer::score_paths_pruned`]. The
+/// default prunes nothing.
+#[derive(Debug, Clone, Default)]
+pub struct PruneConfig {
+    /// Only the best `top_k` paths need exact scores.
+    pub top_k: Option<usize>,
+    /// Paths scoring below this log-prob need no exact score.
+    pub min_log_prob: Option<f64>,
+    /// Path to score before all others, normally the Viterbi best. A strong
+    /// early score raises the top-k bar for everything after it.
+    pub score_first: Option<usize>,
+}
+
+impl PruneConfig {
+    /// Partial sums below this cannot place. `best` is sorted descending.
+    fn bar(&self, best: &[f64]) -> f64 {
+        let kth = self
+            .top_k
+            .and_then(|k| best.get(k.checked_sub(1)?))
+            .copied()
+            .unwrap_or(f64::NEG_INFINITY);
+        kth.max(self.min_log_prob.unwrap_or(f64::NEG_INFINITY))
+    }
+}
+
+/// Neural score of one path.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PathScore {
+    /// Index into the scored `paths`.
+    pub index: usize,
+    /// Total log-prob; for a pruned path, the partial sum where scoring
+    /// stopped (an upper bound on the total).
+    pub log_prob: f64,
+    /// Scoring stopped early because the path could not place.
+    pub pruned: bool,
+}
+
+impl PathScore {
+    fn exact(index: usize, log_prob: f64) -> Self {
+        Self {
+            index,
+            log_prob,
+            pruned: false,
+        }
+    }
+}
+
+/// Result of [`NeuralScorer::score_paths_pruned`].
+#[derive(Debug, Clone)]
+pub struct PrunedScores {
+    /// Unpruned paths by descending log-prob, then pruned paths.
+    pub scores: Vec<PathScore>,
+    /// Model forward passes run, shared prefix included.
+    pub forward_calls: usize,
+}
+
 impl NeuralScorer {
     /// Compute the log-probability of `output` given `context` and `kana`.
     ///
@@ -54,8 +110,35 @@ impl NeuralScorer {
         kana: &str,
         paths: &[Vec<ConvertedSegment>],
     ) -> anyhow::Result<Vec<(usize, f64)>> {
+        let scored = self.score_paths_pruned(context, kana, paths, &PruneConfig::default())?;
+        Ok(scored
+            .scores
+            .into_iter()
+            .map(|s| (s.index, s.log_prob))
+            .collect())
+    }
+
+    /// [`score_paths`](Self::score_paths) with exact early exit.
+    ///
+    /// Every output token adds a log-prob ≤ 0, so a candidate's partial sum
+    /// only falls. Once it drops below the bar — `config.min_log_prob`, or
+    /// the `top_k`-th best complete score so far — the candidate cannot
+    /// place and its remaining tokens are not forwarded. Such paths come
+    /// last, marked `pruned`. The unpruned paths are exact and sorted as
+    /// `score_paths` would sort them, so the top `top_k` are identical.
+    pub fn score_paths_pruned(
+        &mut self,
+        context: &str,
+        kana: &str,
+        paths: &[Vec<ConvertedSegment>],
+        config: &PruneConfig,
+    ) -> anyhow::Result<PrunedScores> {
+        let mut result = PrunedScores {
+            scores: Vec::with_capacity(paths.len()),
+            forward_calls: 0,
+        };
         if paths.is_empty() {
-            return Ok(Vec::new());
+            return Ok(result);
         }
 
         // Build and process the shared prefix: \uEE02{context}\uEE00{katakana}\uEE01
@@ -66,11 +149,10 @@ impl NeuralScorer {
         let prefix_tokens = self.tokenizer.encode(&prefix);
 
         if prefix_tokens.is_empty() {
-            return Ok(paths
-                .iter()
-                .enumerate()
-                .map(|(i, _)| (i, f64::NEG_INFINITY))
-                .collect());
+            result.scores = (0..paths.len())
+                .map(|index| PathScore::exact(index, f64::NEG_INFINITY))
+                .collect();
+            return Ok(result);
         }
 
         // Forward pass for the shared prefix (builds KV-cache)
@@ -83,6 +165,7 @@ impl NeuralScorer {
                 .map_err(|e| anyhow::anyhow!("prefix forward at position {i} failed: {e}"))?;
             prefix_logits = Some(logits);
         }
+        result.forward_calls += prefix_tokens.len();
         let prefix_logits =
             prefix_logits.ok_or_else(|| anyhow::anyhow!("empty prefix after encoding"))?;
 
@@ -90,43 +173,81 @@ impl NeuralScorer {
         let kv_snapshot = self.model.save_kv_cache();
         let prefix_len = prefix_tokens.len();
 
-        // Score each candidate by restoring the prefix cache
-        let mut scores: Vec<(usize, f64)> = Vec::with_capacity(paths.len());
+        // Complete scores so far, best first, for the top-k bar.
+        let mut best: Vec<f64> = Vec::new();
+        let order = config
+            .score_first
+            .filter(|&i| i < paths.len())
+            .into_iter()
+            .chain((0..paths.len()).filter(|&i| Some(i) != config.score_first));
 
-        for (i, path) in paths.iter().enumerate() {
-            let output: String = path.iter().map(|s| s.surface.as_str()).collect();
+        // Score each candidate by restoring the prefix cache
+        for i in order {
+            let output: String = paths[i].iter().map(|s| s.surface.as_str()).collect();
             let output = output.replace(' ', "\u{3000}");
             let output_with_eos = format!("{output}</s>");
             let output_tokens = self.tokenizer.encode(&output_with_eos);
 
             if output_tokens.is_empty() {
-                scores.push((i, f64::NEG_INFINITY));
+                result.scores.push(PathScore::exact(i, f64::NEG_INFINITY));
                 continue;
             }
 
-            // Restore KV-cache to the prefix state
-            self.model.restore_kv_cache(&kv_snapshot);
+            let bar = config.bar(&best);
 
             // First output token scored from prefix logits
             let mut log_prob = log_softmax_at(&prefix_logits, output_tokens[0], &self.device)?;
-
-            // Forward remaining output tokens one by one
-            for j in 0..output_tokens.len() - 1 {
-                let logits = self
-                    .model
-                    .forward(&[output_tokens[j]], prefix_len + j)
-                    .map_err(|e| {
-                        anyhow::anyhow!("output forward at position {} failed: {e}", prefix_len + j)
-                    })?;
-                log_prob += log_softmax_at(&logits, output_tokens[j + 1], &self.device)?;
+            let mut pruned = log_prob < bar;
+
+            if !pruned {
+                // Restore KV-cache to the prefix state
+                self.model.restore_kv_cache(&kv_snapshot);
+
+                // Forward remaining output tokens one by one
+                for j in 0..output_tokens.len() - 1 {
+                    let logits = self
+                        .model
+                        .forward(&[output_tokens[j]], prefix_len + j)
+                        .map_err(|e| {
+                            anyhow::anyhow!(
+                                "output forward at position {} failed: {e}",
+                                prefix_len + j
+                            )
+                        })?;
+                    result.forward_calls += 1;
+                    log_prob += log_softmax_at(&logits, output_tokens[j + 1], &self.device)?;
+                    if log_prob < bar {
+                        pruned = true;
+                        break;
+                    }
+                }
             }
 
-            scores.push((i, log_prob));
+            if let (false, Some(k)) = (pruned, config.top_k) {
+                let pos = best.partition_point(|&b| b >= log_prob);
+                best.insert(pos, log_prob);
+                best.truncate(k);
+            }
+            result.scores.push(PathScore {
+                index: i,
+                log_prob,
+                pruned,
+            });
         }
 
-        // Sort by log_prob descending (higher = better)
-        scores.sort_by(|a, b| b.1.partial_cmp(&a.1).unwrap_or(std::cmp::Ordering::Equal));
-        Ok(scores)
+        // Sort by log_prob descending (higher = better), ties in path
+        // order; pruned paths last.
+        result.scores.sort_by(|a, b| {
+            a.pruned
+                .cmp(&b.pruned)
+                .then_with(|| {
+                    b.log_prob
+                        .partial_cmp(&a.log_prob)
+                        .unwrap_or(std::cmp::Ordering::Equal)
+                })
+                .then_with(|| a.index.cmp(&b.index))
+        });
+        Ok(result)
     }
 
     /// Returns per-segment average log-prob per character.
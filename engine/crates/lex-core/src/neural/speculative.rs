@@ -11,7 +11,7 @@ use crate::converter::{build_lattice, convert_nbest_constrained, ConvertedSegmen
 use crate::dict::connection::ConnectionMatrix;
 use crate::dict::Dictionary;
 
-use super::NeuralScorer;
+use super::{KvCacheMode, NeuralScorer, PruneConfig};
 
 /// Configuration for speculative decoding.
 pub struct SpeculativeConfig {
@@ -24,6 +24,8 @@ pub struct SpeculativeConfig {
     pub min_segments: usize,
     /// Number of N-best candidates per constrained Viterbi pass.
     pub nbest_per_pass: usize,
+    /// KV cache precision used while verifying drafts.
+    pub kv_cache: KvCacheMode,
 }
 
 impl Default for SpeculativeConfig {
@@ -33,6 +35,7 @@ impl Default for SpeculativeConfig {
             max_iterations: 3,
             min_segments: 3,
             nbest_per_pass: 5,
+            kv_cache: KvCacheMode::F32,
         }
     }
 }
@@ -63,6 +66,9 @@ pub struct SpeculativeMetadata {
 }
 
 /// Run speculative decoding: draft with Viterbi, verify with GPT-2, refine.
+///
+/// Verification runs with `config.kv_cache`; the scorer's own KV cache mode
+/// is restored before returning.
 pub fn speculative_decode(
     scorer: &mut NeuralScorer,
     dict: &dyn Dictionary,
@@ -70,6 +76,21 @@ pub fn speculative_decode(
     context: &str,
     kana: &str,
     config: &SpeculativeConfig,
+) -> anyhow::Result<SpeculativeResult> {
+    let previous = scorer.kv_cache_mode();
+    scorer.set_kv_cache_mode(config.kv_cache);
+    let result = decode(scorer, dict, conn, context, kana, config);
+    scorer.set_kv_cache_mode(previous);
+    result
+}
+
+fn decode(
+    scorer: &mut NeuralScorer,
+    dict: &dyn Dictionary,
+    conn: Option<&ConnectionMatrix>,
+    context: &str,
+    kana: &str,
+    config: &SpeculativeConfig,
 ) -> anyhow::Result<SpeculativeResult> {
     let total_start = Instant::now();
     let mut viterbi_latency = Duration::ZERO;
@@ -77,11 +98,12 @@ pub fn speculative_decode(
 
     // 1. Initial Viterbi N-best
     let viterbi_start = Instant::now();
-    let cost_fn = crate::converter::cost::DefaultCostFunction::new(conn);
+    let settings = crate::settings::settings();
+    let cost_fn = crate::converter::cost::DefaultCostFunction::new(conn, &settings.cost);
     let lattice = build_lattice(dict, kana);
     let mut initial_paths =
         crate::converter::viterbi_nbest(&lattice, &cost_fn, config.nbest_per_pass * 3);
-    crate::converter::reranker::rerank(&mut initial_paths, conn, Some(dict));
+    crate::converter::reranker::rerank(&mut initial_paths, conn, Some(dict), &settings);
     initial_paths.truncate(config.nbest_per_pass);
     viterbi_latency += viterbi_start.elapsed();
 
@@ -107,10 +129,22 @@ pub fn speculative_decode(
         let neural_start = Instant::now();
         let paths_as_segments: Vec<Vec<ConvertedSegment>> =
             initial_paths.iter().map(scored_path_to_segments).collect();
-        let scores = scorer.score_paths(context, kana, &paths_as_segments)?;
+        // Only the winner is needed; the reranker may have moved the
+        // Viterbi best, which makes the strongest opening bar.
+        let viterbi_best = initial_paths
+            .iter()
+            .enumerate()
+            .min_by_key(|(_, p)| p.viterbi_cost)
+            .map(|(i, _)| i);
+        let prune = PruneConfig {
+            top_k: Some(1),
+            score_first: viterbi_best,
+            ..PruneConfig::default()
+        };
+        let scores = scorer.score_paths_pruned(context, kana, &paths_as_segments, &prune)?;
         neural_latency += neural_start.elapsed();
 
-        let best_idx = scores.first().map(|&(idx, _)| idx).unwrap_or(0);
+        let best_idx = scores.scores.first().map_or(0, |s| s.index);
         let best_segments = paths_as_segments[best_idx].clone();
 
         let neural_start2 = Instant::now();
@@ -180,10 +214,16 @@ pub fn speculative_decode(
                 let paths_as_segments: Vec<Vec<ConvertedSegment>> =
                     new_paths.iter().map(scored_path_to_segments).collect();
                 let neural_start = Instant::now();
-                let path_scores = scorer.score_paths(context, kana, &paths_as_segments)?;
+                let prune = PruneConfig {
+                    top_k: Some(1),
+                    score_first: Some(0),
+                    ..PruneConfig::default()
+                };
+                let path_scores =
+                    scorer.score_paths_pruned(context, kana, &paths_as_segments, &prune)?;
                 neural_latency += neural_start.elapsed();
 
-                let best_idx = path_scores.first().map(|&(idx, _)| idx).unwrap_or(0);
+                let best_idx = path_scores.scores.first().map_or(0, |s| s.index);
                 let new_best = paths_as_segments[best_idx].clone();
 
                 // Check convergence: same surface as before?
@@ -241,6 +281,7 @@ mod tests {
         assert_eq!(config.max_iterations, 3);
         assert_eq!(config.min_segments, 3);
         assert_eq!(config.nbest_per_pass, 5);
+        assert_eq!(config.kv_cache, KvCacheMode::F32);
     }
 
     #[test]
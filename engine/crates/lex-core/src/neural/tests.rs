@@ -150,3 +150,224 @@ fn test_generate_text_basic() {
     // Should generate some non-empty text
     assert!(!text.is_empty(), "generated text should not be empty");
 }
+
+// --- KV cache precision (synthetic model, no GGUF needed) ---
+
+/// Per-token log-probs of `tokens[1..]` under teacher forcing.
+fn token_logprobs(model: &mut QuantizedGpt2, tokens: &[u32]) -> Vec<f64> {
+    use candle_core::IndexOp;
+    model.reset_kv_cache();
+    (0..tokens.len() - 1)
+        .map(|i| {
+            let logits = model.forward(&[tokens[i]], i).unwrap();
+            let log_probs = candle_nn::ops::log_softmax(&logits, 0).unwrap();
+            log_probs
+                .i(tokens[i + 1] as usize)
+                .unwrap()
+                .to_scalar::<f32>()
+                .unwrap() as f64
+        })
+        .collect()
+}
+
+fn synthetic_tokens(len: usize, vocab: u32) -> Vec<u32> {
+    (0..len as u32).map(|i| (i * 7 + 3) % vocab).collect()
+}
+
+#[test]
+fn test_int8_kv_cache_logprob_drift() {
+    let device = candle_core::Device::Cpu;
+    let mut model = QuantizedGpt2::random(32, 4, 2, 64, 128, &device).unwrap();
+    let tokens = synthetic_tokens(48, 64);
+
+    let reference = token_logprobs(&mut model, &tokens);
+    let f32_bytes = model.kv_cache_bytes();
+
+    model.set_kv_cache_mode(KvCacheMode::Int8);
+    let quantized = token_logprobs(&mut model, &tokens);
+    let int8_bytes = model.kv_cache_bytes();
+
+    let max_drift = reference
+        .iter()
+        .zip(&quantized)
+        .map(|(a, b)| (a - b).abs())
+        .fold(0.0, f64::max);
+    let total_drift = (reference.iter().sum::<f64>() - quantized.iter().sum::<f64>()).abs();
+    assert!(max_drift < 0.05, "per-token drift {max_drift}");
+    assert!(total_drift < 0.5, "sequence drift {total_drift}");
+    // int8 data plus one f32 scale per 8-wide head row.
+    assert!(int8_bytes * 2 < f32_bytes, "{int8_bytes} vs {f32_bytes}");
+}
+
+#[test]
+fn test_int8_kv_cache_spans_attention_blocks() {
+    let device = candle_core::Device::Cpu;
+    let mut model = QuantizedGpt2::random(32, 4, 2, 64, 512, &device).unwrap();
+    let tokens = synthetic_tokens(300, 64);
+
+    // A 200-token prefill, then single steps, crossing several int8 blocks.
+    let logits = |model: &mut QuantizedGpt2| -> Vec<f32> {
+        model.reset_kv_cache();
+        let mut logits = model.forward(&tokens[..200], 0).unwrap().to_vec1().unwrap();
+        for (i, &t) in tokens.iter().enumerate().skip(200) {
+            logits.extend(model.forward(&[t], i).unwrap().to_vec1::<f32>().unwrap());
+        }
+        logits
+    };
+    let reference = logits(&mut model);
+    model.set_kv_cache_mode(KvCacheMode::Int8);
+    let quantized = logits(&mut model);
+
+    let max_diff = reference
+        .iter()
+        .zip(&quantized)
+        .map(|(a, b)| (a - b).abs())
+        .fold(0f32, f32::max);
+    assert!(max_diff < 0.05, "logit drift {max_diff}");
+}
+
+#[test]
+fn test_int8_kv_cache_snapshot_restore() {
+    let device = candle_core::Device::Cpu;
+    let mut model = QuantizedGpt2::random(32, 4, 2, 64, 128, &device).unwrap();
+    model.set_kv_cache_mode(KvCacheMode::Int8);
+    let tokens = synthetic_tokens(12, 64);
+
+    for (i, &t) in tokens[..8].iter().enumerate() {
+        model.forward(&[t], i).unwrap();
+    }
+    let snapshot = model.save_kv_cache();
+
+    // Two continuations from the same snapshot must not see each other's rows.
+    let mut runs = Vec::new();
+    for _ in 0..2 {
+        model.restore_kv_cache(&snapshot);
+        let mut last = None;
+        for (i, &t) in tokens[8..].iter().enumerate() {
+            last = Some(model.forward(&[t], 8 + i).unwrap());
+        }
+        let logits: Vec<f32> = last.unwrap().to_vec1().unwrap();
+        runs.push(logits);
+    }
+    assert_eq!(runs[0], runs[1]);
+}
+
+// --- early-exit path scoring (synthetic model) ---
+
+fn synthetic_scorer() -> NeuralScorer {
+    let device = candle_core::Device::Cpu;
+    let tokenizer = BpeTokenizer::byte_level();
+    let model = QuantizedGpt2::random(32, 4, 2, tokenizer.vocab_size(), 256, &device).unwrap();
+    NeuralScorer {
+        model,
+        tokenizer,
+        device,
+    }
+}
+
+#[test]
+fn test_speculative_decode_restores_kv_cache_mode() {
+    use super::speculative::{speculative_decode, SpeculativeConfig};
+
+    let mut scorer = synthetic_scorer();
+    let dict = crate::converter::testutil::test_dict();
+    let config = SpeculativeConfig {
+        kv_cache: KvCacheMode::Int8,
+        ..SpeculativeConfig::default()
+    };
+    speculative_decode(&mut scorer, &dict, None, "", "きょうはいいてんき", &config).unwrap();
+    assert_eq!(scorer.kv_cache_mode(), KvCacheMode::F32);
+}
+
+fn nbest_paths() -> Vec<Vec<ConvertedSegment>> {
+    [
+        "今日は",
+        "京は",
+        "教派",
+        "今日葉",
+        "きょうは",
+        "凶は",
+        "今日わ",
+        "強は",
+    ]
+    .iter()
+    .map(|s| vec![seg("きょうは", s)])
+    .collect()
+}
+
+#[test]
+fn test_pruned_scoring_keeps_top_k() {
+    let mut scorer = synthetic_scorer();
+    let paths = nbest_paths();
+    let full = scorer
+        .score_paths_pruned("", "きょうは", &paths, &PruneConfig::default())
+        .unwrap();
+    assert!(full.scores.iter().all(|s| !s.pruned));
+    let legacy = scorer.score_paths("", "きょうは", &paths).unwrap();
+    let as_pairs: Vec<(usize, f64)> = full.scores.iter().map(|s| (s.index, s.log_prob)).collect();
+    assert_eq!(legacy, as_pairs);
+
+    for k in 1..=3 {
+        for score_first in [None, Some(full.scores[0].index)] {
+            let config = PruneConfig {
+                top_k: Some(k),
+                score_first,
+                ..PruneConfig::default()
+            };
+            let pruned = scorer
+                .score_paths_pruned("", "きょうは", &paths, &config)
+                .unwrap();
+            assert_eq!(pruned.scores[..k], full.scores[..k], "k = {k}");
+            assert!(pruned.scores[..k].iter().all(|s| !s.pruned));
+            // Pruned totals are upper bounds, below the k-th exact score.
+            for s in pruned.scores.iter().filter(|s| s.pruned) {
+                assert!(s.log_prob < full.scores[k - 1].log_prob);
+            }
+            assert!(pruned.forward_calls <= full.forward_calls);
+        }
+    }
+
+    // Scoring the winner first must save forward passes for top-1.
+    let config = PruneConfig {
+        top_k: Some(1),
+        score_first: Some(full.scores[0].index),
+        ..PruneConfig::default()
+    };
+    let pruned = scorer
+        .score_paths_pruned("", "きょうは", &paths, &config)
+        .unwrap();
+    assert!(
+        pruned.forward_calls < full.forward_calls,
+        "{} vs {}",
+        pruned.forward_calls,
+        full.forward_calls
+    );
+}
+
+#[test]
+fn test_pruned_scoring_min_log_prob() {
+    let mut scorer = synthetic_scorer();
+    let paths = nbest_paths();
+    let full = scorer
+        .score_paths_pruned("", "きょうは", &paths, &PruneConfig::default())
+        .unwrap();
+    // Bar halfway down the exact ranking.
+    let bar = full.scores[paths.len() / 2].log_prob;
+    let config = PruneConfig {
+        min_log_prob: Some(bar),
+        ..PruneConfig::default()
+    };
+    let pruned = scorer
+        .score_paths_pruned("", "きょうは", &paths, &config)
+        .unwrap();
+    let above: Vec<_> = full.scores.iter().filter(|s| s.log_prob >= bar).collect();
+    assert_eq!(
+        pruned
+            .scores
+            .iter()
+            .filter(|s| !s.pruned)
+            .collect::<Vec<_>>(),
+        above
+    );
+    assert!(pruned.forward_calls < full.forward_calls);
+}
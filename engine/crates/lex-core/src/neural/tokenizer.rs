@@ -71,6 +71,30 @@ impl BpeTokenizer {
         })
     }
 
+    /// Tokenizer without merges: the special tokens (matching the Zenzai
+    /// IDs), then one token per byte. For tests with a synthetic model.
+    #[cfg(test)]
+    pub(super) fn byte_level() -> Self {
+        let (byte_to_char, char_to_byte) = build_byte_mapping();
+        let id_to_token: Vec<String> = SPECIAL_TOKENS
+            .iter()
+            .map(|t| t.to_string())
+            .chain(byte_to_char.iter().map(char::to_string))
+            .collect();
+        let token_to_id = id_to_token
+            .iter()
+            .enumerate()
+            .map(|(i, t)| (t.clone(), i as u32))
+            .collect();
+        Self {
+            token_to_id,
+            id_to_token,
+            merges: Vec::new(),
+            byte_to_char,
+            char_to_byte,
+        }
+    }
+
     /// Encode text into token IDs using GPT-2 byte-level BPE.
     pub fn encode(&self, text: &str) -> Vec<u32> {
         if text.is_empty() {
@@ -1,467 +0,0 @@
-//! Japanese kana-to-number conversion.
-//!
-//! Parses hiragana number words (いち, にじゅうさん, さんびゃくよんじゅうご, etc.)
-//! into numeric values and formats them as half-width or full-width digits.
-//! Supports rendaku (連濁) variants and values up to 兆 (10^12).
-
-/// Parse a hiragana number string into a numeric value.
-///
-/// Returns `None` if the input is not a valid Japanese number expression.
-pub fn parse_japanese_number(kana: &str) -> Option<u64> {
-    let first = kana.chars().next()?;
-    if !matches!(
-        first,
-        'い' | 'に'
-            | 'さ'
-            | 'し'
-            | 'よ'
-            | 'ご'
-            | 'ろ'
-            | 'な'
-            | 'は'
-            | 'き'
-            | 'く'
-            | 'ぜ'
-            | 'れ'
-            | 'じ'
-            | 'ひ'
-            | 'せ'
-            | 'ま'
-            | 'お'
-            | 'ち'
-    ) {
-        return None;
-    }
-
-    let mut rest = kana;
-    let mut result: u64 = 0;
-    let mut group = parse_group(&mut rest);
-
-    // Large units: ちょう(10^12), おく(10^8), まん(10^4)
-    for (unit_kana, unit_val) in &[
-        ("ちょう", 1_000_000_000_000u64),
-        ("おく", 100_000_000),
-        ("まん", 10_000),
-    ] {
-        if let Some(pos) = rest.find(unit_kana) {
-            // Everything before the unit should have been consumed into group
-            if pos != 0 {
-                return None;
-            }
-            // Require an explicit leading digit. Bare `まん` / `おく` /
-            // `ちょう` overwhelmingly mean something other than the bare
-            // numeric value (万年, 億劫, 兆候, 調査, ...) — accepting them
-            // as implicit-1 lets the number+counter rewriter generate
-            // spurious top-1 candidates like `ちょうさ → 一兆差` that
-            // outrank natural Viterbi top-1 like `調査`. Multiplier-only
-            // input remains a typing error if it ever reaches us.
-            if group == 0 {
-                return None;
-            }
-            rest = &rest[unit_kana.len()..];
-            result += group * unit_val;
-            group = parse_group(&mut rest);
-        }
-    }
-
-    result += group;
-
-    if !rest.is_empty() {
-        return None;
-    }
-    if result == 0 && kana != "ぜろ" && kana != "れい" {
-        return None;
-    }
-
-    Some(result)
-}
-
-/// Parse a group value (< 10000) from the front of `rest`, advancing the slice.
-fn parse_group(rest: &mut &str) -> u64 {
-    let mut value: u64 = 0;
-
-    // せん(1000)
-    value += parse_unit(rest, 1000);
-    // ひゃく(100)
-    value += parse_unit(rest, 100);
-    // じゅう(10)
-    value += parse_unit(rest, 10);
-    // Trailing digit
-    if let Some((d, len)) = consume_digit(rest) {
-        *rest = &rest[len..];
-        value += d;
-    }
-
-    value
-}
-
-/// Parse [digit] + unit from `rest`. Returns the contribution (digit * unit_val).
-fn parse_unit(rest: &mut &str, unit_val: u64) -> u64 {
-    // Try digit + unit
-    let saved = *rest;
-    if let Some((d, dlen)) = consume_digit_or_rendaku_prefix(rest, unit_val) {
-        let after_digit = &saved[dlen..];
-        if let Some(ulen) = consume_unit_kana(after_digit, unit_val) {
-            *rest = &after_digit[ulen..];
-            return d * unit_val;
-        }
-        // No unit followed — restore
-        // (don't restore if it was a rendaku prefix, those are only valid before units)
-    }
-
-    // Try bare unit (e.g. ひゃく = 100, じゅう = 10, せん = 1000)
-    *rest = saved;
-    if let Some(ulen) = consume_unit_kana(rest, unit_val) {
-        *rest = &rest[ulen..];
-        return unit_val;
-    }
-
-    0
-}
-
-/// Try to consume a digit (1-9) or a rendaku prefix from the front of `s`.
-/// Returns (digit_value, byte_length) if found.
-fn consume_digit_or_rendaku_prefix(s: &str, unit_val: u64) -> Option<(u64, usize)> {
-    // Rendaku prefixes (only valid before specific units)
-    match unit_val {
-        100 => {
-            // ろっぴゃく(600), はっぴゃく(800)
-            if s.starts_with("ろっ") {
-                return Some((6, "ろっ".len()));
-            }
-            if s.starts_with("はっ") {
-                return Some((8, "はっ".len()));
-            }
-        }
-        1000 if s.starts_with("はっ") => {
-            // はっせん(8000)
-            return Some((8, "はっ".len()));
-        }
-        10 => {
-            // じっ as prefix for じゅう (じっ = 10, used in じっかい etc., but also standalone)
-            // Not a digit prefix — handled as a unit variant
-        }
-        _ => {}
-    }
-
-    // Standard digits
-    consume_digit(s)
-}
-
-/// Try to consume a standard digit (0-9) from the front of `s`.
-fn consume_digit(s: &str) -> Option<(u64, usize)> {
-    let table: &[(&str, u64)] = &[
-        ("きゅう", 9),
-        ("しち", 7),
-        ("よん", 4),
-        ("はち", 8),
-        ("ろく", 6),
-        ("なな", 7),
-        ("いち", 1),
-        ("さん", 3),
-        ("ぜろ", 0),
-        ("れい", 0),
-        ("に", 2),
-        ("し", 4),
-        ("ご", 5),
-        ("く", 9),
-    ];
-    for &(kana, val) in table {
-        if s.starts_with(kana) {
-            return Some((val, kana.len()));
-        }
-    }
-    None
-}
-
-/// Try to consume a unit kana from the front of `s`. Returns byte length if matched.
-fn consume_unit_kana(s: &str, unit_val: u64) -> Option<usize> {
-    let variants: &[&str] = match unit_val {
-        10 => &["じゅう", "じゅっ", "じっ"],
-        100 => &["ひゃく", "びゃく", "ぴゃく"],
-        1000 => &["せん", "ぜん"],
-        _ => return None,
-    };
-    for &v in variants {
-        if s.starts_with(v) {
-            return Some(v.len());
-        }
-    }
-    None
-}
-
-/// Format a number as Japanese kanji numerals.
-///
-/// Uses traditional positional notation:
-/// - 十/百/千 omit the leading 一 (e.g. 10 → "十", not "一十")
-/// - 万/億/兆 keep the leading 一 (e.g. 10000 → "一万")
-/// - Zero is "〇"
-///
-/// Supports values up to 9999兆 (9,999,999,999,999,999).
-/// Values exceeding this range are returned as half-width Arabic digits.
-pub fn to_kanji(n: u64) -> String {
-    // Max supported: 9999兆9999億9999万9999
-    if n > 9_999_999_999_999_999 {
-        return to_halfwidth(n);
-    }
-    if n == 0 {
-        return "〇".to_string();
-    }
-
-    let mut result = String::new();
-
-    // 兆 (10^12)
-    let chou = n / 1_000_000_000_000;
-    let rem = n % 1_000_000_000_000;
-    if chou > 0 {
-        group_to_kanji(chou, &mut result);
-        result.push('兆');
-    }
-
-    // 億 (10^8)
-    let oku = rem / 100_000_000;
-    let rem = rem % 100_000_000;
-    if oku > 0 {
-        group_to_kanji(oku, &mut result);
-        result.push('億');
-    }
-
-    // 万 (10^4)
-    let man = rem / 10_000;
-    let rem = rem % 10_000;
-    if man > 0 {
-        group_to_kanji(man, &mut result);
-        result.push('万');
-    }
-
-    // Ones group (< 10000)
-    if rem > 0 {
-        group_to_kanji(rem, &mut result);
-    }
-
-    result
-}
-
-/// Format a group value (1–9999) as kanji, appending to `out`.
-/// Leading 一 is omitted before 十/百/千 (e.g. 10→"十", 100→"百", 1000→"千").
-///
-/// # Panics
-/// Panics if `n > 9999`.
-fn group_to_kanji(n: u64, out: &mut String) {
-    assert!(n <= 9999, "group_to_kanji: n={n} exceeds 9999");
-    const DIGITS: [char; 10] = ['〇', '一', '二', '三', '四', '五', '六', '七', '八', '九'];
-
-    let sen = n / 1000;
-    let rem = n % 1000;
-    if sen > 0 {
-        if sen > 1 {
-            out.push(DIGITS[sen as usize]);
-        }
-        out.push('千');
-    }
-
-    let hyaku = rem / 100;
-    let rem = rem % 100;
-    if hyaku > 0 {
-        if hyaku > 1 {
-            out.push(DIGITS[hyaku as usize]);
-        }
-        out.push('百');
-    }
-
-    let juu = rem / 10;
-    let rem = rem % 10;
-    if juu > 0 {
-        if juu > 1 {
-            out.push(DIGITS[juu as usize]);
-        }
-        out.push('十');
-    }
-
-    if rem > 0 {
-        out.push(DIGITS[rem as usize]);
-    }
-}
-
-/// Format a number as half-width Arabic digits.
-pub fn to_halfwidth(n: u64) -> String {
-    n.to_string()
-}
-
-/// Format a number as full-width Arabic digits.
-pub fn to_fullwidth(n: u64) -> String {
-    n.to_string()
-        .chars()
-        .map(|c| char::from_u32(c as u32 - '0' as u32 + '０' as u32).unwrap_or(c))
-        .collect()
-}
-
-#[cfg(test)]
-mod tests {
-    use super::*;
-
-    #[test]
-    fn test_simple_digits() {
-        assert_eq!(parse_japanese_number("ぜろ"), Some(0));
-        assert_eq!(parse_japanese_number("れい"), Some(0));
-        assert_eq!(parse_japanese_number("いち"), Some(1));
-        assert_eq!(parse_japanese_number("に"), Some(2));
-        assert_eq!(parse_japanese_number("さん"), Some(3));
-        assert_eq!(parse_japanese_number("し"), Some(4));
-        assert_eq!(parse_japanese_number("よん"), Some(4));
-        assert_eq!(parse_japanese_number("ご"), Some(5));
-        assert_eq!(parse_japanese_number("ろく"), Some(6));
-        assert_eq!(parse_japanese_number("しち"), Some(7));
-        assert_eq!(parse_japanese_number("なな"), Some(7));
-        assert_eq!(parse_japanese_number("はち"), Some(8));
-        assert_eq!(parse_japanese_number("きゅう"), Some(9));
-        assert_eq!(parse_japanese_number("く"), Some(9));
-    }
-
-    #[test]
-    fn test_tens() {
-        assert_eq!(parse_japanese_number("じゅう"), Some(10));
-        assert_eq!(parse_japanese_number("にじゅう"), Some(20));
-        assert_eq!(parse_japanese_number("にじゅうさん"), Some(23));
-        assert_eq!(parse_japanese_number("さんじゅう"), Some(30));
-        assert_eq!(parse_japanese_number("きゅうじゅうきゅう"), Some(99));
-    }
-
-    #[test]
-    fn test_hundreds() {
-        assert_eq!(parse_japanese_number("ひゃく"), Some(100));
-        assert_eq!(parse_japanese_number("にひゃく"), Some(200));
-        assert_eq!(parse_japanese_number("さんびゃく"), Some(300));
-        assert_eq!(parse_japanese_number("ろっぴゃく"), Some(600));
-        assert_eq!(parse_japanese_number("はっぴゃく"), Some(800));
-    }
-
-    #[test]
-    fn test_thousands() {
-        assert_eq!(parse_japanese_number("せん"), Some(1000));
-        assert_eq!(parse_japanese_number("さんぜん"), Some(3000));
-        assert_eq!(parse_japanese_number("はっせん"), Some(8000));
-    }
-
-    #[test]
-    fn test_compound() {
-        assert_eq!(parse_japanese_number("さんびゃくよんじゅうご"), Some(345));
-        assert_eq!(
-            parse_japanese_number("いっせんにひゃくさんじゅうよん"),
-            None // いっせん not supported (would need いっ rendaku prefix for せん)
-        );
-        assert_eq!(
-            parse_japanese_number("せんにひゃくさんじゅうよん"),
-            Some(1234)
-        );
-    }
-
-    #[test]
-    fn test_large_units() {
-        assert_eq!(parse_japanese_number("いちまん"), Some(10_000));
-        assert_eq!(parse_japanese_number("じゅうまん"), Some(100_000));
-        assert_eq!(parse_japanese_number("いちおく"), Some(100_000_000));
-        assert_eq!(parse_japanese_number("いっちょう"), None); // いっちょう not supported
-        assert_eq!(parse_japanese_number("いちちょう"), Some(1_000_000_000_000));
-    }
-
-    #[test]
-    fn test_bare_large_units_rejected() {
-        // Bare large multipliers must NOT parse — otherwise the number+counter
-        // rewriter generates spurious top-1 like `ちょうさ → 一兆差` that
-        // outranks `調査` (real user bug).
-        assert_eq!(parse_japanese_number("まん"), None);
-        assert_eq!(parse_japanese_number("おく"), None);
-        assert_eq!(parse_japanese_number("ちょう"), None);
-        // Compound forms with a real leading group must still work.
-        assert_eq!(parse_japanese_number("ひゃくまん"), Some(1_000_000));
-        assert_eq!(parse_japanese_number("じゅうおく"), Some(1_000_000_000));
-        assert_eq!(parse_japanese_number("にちょう"), Some(2_000_000_000_000));
-    }
-
-    #[test]
-    fn test_complex() {
-        // 12345 = いちまんにせんさんびゃくよんじゅうご
-        assert_eq!(
-            parse_japanese_number("いちまんにせんさんびゃくよんじゅうご"),
-            Some(12345)
-        );
-    }
-
-    #[test]
-    fn test_non_numeric() {
-        assert_eq!(parse_japanese_number("こんにちは"), None);
-        assert_eq!(parse_japanese_number("きょう"), None);
-        assert_eq!(parse_japanese_number("あ"), None);
-        assert_eq!(parse_japanese_number(""), None);
-    }
-
-    #[test]
-    fn test_kanji_zero() {
-        assert_eq!(to_kanji(0), "〇");
-    }
-
-    #[test]
-    fn test_kanji_single_digits() {
-        assert_eq!(to_kanji(1), "一");
-        assert_eq!(to_kanji(2), "二");
-        assert_eq!(to_kanji(9), "九");
-    }
-
-    #[test]
-    fn test_kanji_tens() {
-        assert_eq!(to_kanji(10), "十");
-        assert_eq!(to_kanji(11), "十一");
-        assert_eq!(to_kanji(20), "二十");
-        assert_eq!(to_kanji(23), "二十三");
-        assert_eq!(to_kanji(99), "九十九");
-    }
-
-    #[test]
-    fn test_kanji_hundreds() {
-        assert_eq!(to_kanji(100), "百");
-        assert_eq!(to_kanji(200), "二百");
-        assert_eq!(to_kanji(345), "三百四十五");
-        assert_eq!(to_kanji(999), "九百九十九");
-    }
-
-    #[test]
-    fn test_kanji_thousands() {
-        assert_eq!(to_kanji(1000), "千");
-        assert_eq!(to_kanji(3000), "三千");
-        assert_eq!(to_kanji(1234), "千二百三十四");
-    }
-
-    #[test]
-    fn test_kanji_large_units() {
-        // 万以上は一を省略しない
-        assert_eq!(to_kanji(10_000), "一万");
-        assert_eq!(to_kanji(12_345), "一万二千三百四十五");
-        assert_eq!(to_kanji(100_000_000), "一億");
-        assert_eq!(to_kanji(1_000_000_000_000), "一兆");
-        assert_eq!(to_kanji(20_000), "二万");
-        assert_eq!(to_kanji(100_000), "十万");
-        // Max supported value
-        assert_eq!(
-            to_kanji(9_999_999_999_999_999),
-            "九千九百九十九兆九千九百九十九億九千九百九十九万九千九百九十九"
-        );
-        // Over max → fallback to Arabic digits
-        assert_eq!(to_kanji(10_000_000_000_000_000), "10000000000000000");
-        assert_eq!(to_kanji(u64::MAX), u64::MAX.to_string());
-    }
-
-    #[test]
-    fn test_halfwidth() {
-        assert_eq!(to_halfwidth(0), "0");
-        assert_eq!(to_halfwidth(123), "123");
-        assert_eq!(to_halfwidth(10000), "10000");
-    }
-
-    #[test]
-    fn test_fullwidth() {
-        assert_eq!(to_fullwidth(0), "０");
-        assert_eq!(to_fullwidth(123), "１２３");
-        assert_eq!(to_fullwidth(10000), "１００００");
-    }
-}
@@ -0,0 +1,404 @@
+//! Japanese kana-to-number conversion.
+//!
+//! Parses hiragana number words (いち, にじゅうさん, さんびゃくよんじゅうご, etc.)
+//! into numeric values and formats them as half-width or full-width digits.
+//! Supports rendaku (連濁) variants and values up to 兆 (10^12).
+//!
+//! Parsing is a single left-to-right pass: a table lexer splits the kana
+//! into number words ([`Token`]) and a small state machine ([`State`])
+//! folds them into a value, noting every prefix that forms a complete
+//! number along the way.
+
+#[cfg(test)]
+mod tests;
+
+/// A number word. Variants share a token (じゅう / じゅっ / じっ are all
+/// `Small(TEN)`).
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+enum Token {
+    /// 0–9.
+    Digit(u8),
+    /// Geminated digit (ろっ, はっ): only valid directly before one of the
+    /// small units in `units`.
+    Geminate { digit: u8, units: u8 },
+    /// じゅう / ひゃく / せん and their rendaku forms.
+    Small(SmallUnit),
+    /// まん / おく / ちょう.
+    Large(LargeUnit),
+}
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+struct SmallUnit {
+    /// Bit for `Geminate::units`; also orders units (larger bit = larger unit).
+    bit: u8,
+    value: u64,
+    /// びゃく / ぴゃく: never the first word of a number.
+    voiced: bool,
+}
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+struct LargeUnit {
+    rank: u8,
+    value: u64,
+}
+
+const TEN: SmallUnit = SmallUnit {
+    bit: 1,
+    value: 10,
+    voiced: false,
+};
+const HUNDRED: SmallUnit = SmallUnit {
+    bit: 2,
+    value: 100,
+    voiced: false,
+};
+const HUNDRED_VOICED: SmallUnit = SmallUnit {
+    voiced: true,
+    ..HUNDRED
+};
+const THOUSAND: SmallUnit = SmallUnit {
+    bit: 4,
+    value: 1000,
+    voiced: false,
+};
+const MAN: LargeUnit = LargeUnit {
+    rank: 1,
+    value: 10_000,
+};
+const OKU: LargeUnit = LargeUnit {
+    rank: 2,
+    value: 100_000_000,
+};
+const CHOU: LargeUnit = LargeUnit {
+    rank: 3,
+    value: 1_000_000_000_000,
+};
+
+/// Number words keyed by their first kana, longest first.
+///
+/// Only `し` / `しち` share a prefix. A bare leading `いっ` (いっせん,
+/// いっちょう) is deliberately absent.
+fn words(first: char) -> &'static [(&'static str, Token)] {
+    use Token::*;
+    match first {
+        'い' => &[("いち", Digit(1))],
+        'に' => &[("に", Digit(2))],
+        'さ' => &[("さん", Digit(3))],
+        'し' => &[("しち", Digit(7)), ("し", Digit(4))],
+        'よ' => &[("よん", Digit(4))],
+        'ご' => &[("ご", Digit(5))],
+        'ろ' => &[
+            ("ろく", Digit(6)),
+            (
+                "ろっ",
+                Geminate {
+                    digit: 6,
+                    units: HUNDRED.bit,
+                },
+            ),
+        ],
+        'な' => &[("なな", Digit(7))],
+        'は' => &[
+            ("はち", Digit(8)),
+            (
+                "はっ",
+                Geminate {
+                    digit: 8,
+                    units: HUNDRED.bit | THOUSAND.bit,
+                },
+            ),
+        ],
+        'き' => &[("きゅう", Digit(9))],
+        'く' => &[("く", Digit(9))],
+        'ぜ' => &[("ぜろ", Digit(0)), ("ぜん", Small(THOUSAND))],
+        'れ' => &[("れい", Digit(0))],
+        'じ' => &[
+            ("じゅう", Small(TEN)),
+            ("じゅっ", Small(TEN)),
+            ("じっ", Small(TEN)),
+        ],
+        'ひ' => &[("ひゃく", Small(HUNDRED))],
+        'び' => &[("びゃく", Small(HUNDRED_VOICED))],
+        'ぴ' => &[("ぴゃく", Small(HUNDRED_VOICED))],
+        'せ' => &[("せん", Small(THOUSAND))],
+        'ま' => &[("まん", Large(MAN))],
+        'お' => &[("おく", Large(OKU))],
+        'ち' => &[("ちょう", Large(CHOU))],
+        _ => &[],
+    }
+}
+
+/// Parser state after some number of words.
+#[derive(Clone, Copy, Debug, Default)]
+struct State {
+    /// Sum of the completed 万 / 億 / 兆 groups.
+    total: u64,
+    /// Completed small units of the current group.
+    group: u64,
+    /// Digit waiting to learn whether it multiplies a unit or is the ones
+    /// place, with the small units it may multiply (`ANY_UNIT` for a plain
+    /// digit, which alone can also stand as the ones place).
+    pending: Option<(u8, u8)>,
+    /// Small units still allowed in this group: those below the last one.
+    small_allowed: u8,
+    /// Rank of the last large unit (4 = none yet).
+    large_rank: u8,
+    /// No word consumed yet.
+    at_start: bool,
+}
+
+const ALL_SMALL: u8 = TEN.bit | HUNDRED.bit | THOUSAND.bit;
+/// `pending` units mask for a plain digit.
+const ANY_UNIT: u8 = ALL_SMALL;
+
+impl State {
+    fn new() -> Self {
+        Self {
+            small_allowed: ALL_SMALL,
+            large_rank: 4,
+            at_start: true,
+            ..Self::default()
+        }
+    }
+
+    fn step(self, token: Token) -> Option<Self> {
+        let mut next = Self {
+            at_start: false,
+            ..self
+        };
+        match token {
+            Token::Digit(d) | Token::Geminate { digit: d, .. } => {
+                if self.pending.is_some() {
+                    return None;
+                }
+                let units = match token {
+                    Token::Geminate { units, .. } => units,
+                    _ => ANY_UNIT,
+                };
+                next.pending = Some((d, units));
+            }
+            Token::Small(unit) => {
+                if self.small_allowed & unit.bit == 0 || (unit.voiced && self.at_start) {
+                    return None;
+                }
+                let multiplier = match self.pending {
+                    Some((d, units)) if units & unit.bit != 0 => u64::from(d),
+                    Some(_) => return None,
+                    None => 1,
+                };
+                next.group += multiplier * unit.value;
+                next.pending = None;
+                next.small_allowed = unit.bit - 1;
+            }
+            Token::Large(unit) => {
+                if unit.rank >= self.large_rank {
+                    return None;
+                }
+                // Require an explicit leading number. Bare `まん` / `おく` /
+                // `ちょう` overwhelmingly mean something other than the bare
+                // numeric value (万年, 億劫, 兆候, 調査, ...) — accepting them
+                // as implicit-1 lets the number+counter rewriter generate
+                // spurious top-1 candidates like `ちょうさ → 一兆差` that
+                // outrank natural Viterbi top-1 like `調査`.
+                let group = self.group_value()?;
+                if group == 0 {
+                    return None;
+                }
+                next.total += group * unit.value;
+                next.group = 0;
+                next.pending = None;
+                next.small_allowed = ALL_SMALL;
+                next.large_rank = unit.rank;
+            }
+        }
+        Some(next)
+    }
+
+    /// Current group including a trailing ones digit; `None` while a
+    /// geminate digit is still waiting for its unit.
+    fn group_value(&self) -> Option<u64> {
+        match self.pending {
+            Some((d, ANY_UNIT)) => Some(self.group + u64::from(d)),
+            Some(_) => None,
+            None => Some(self.group),
+        }
+    }
+
+    /// Value if the words so far form a complete number.
+    fn value(&self) -> Option<u64> {
+        Some(self.total + self.group_value()?)
+    }
+}
+
+/// Scan `kana` once, calling `accept(end, value)` for every prefix
+/// `kana[..end]` that is a complete number, in increasing `end` order.
+fn scan(kana: &str, mut accept: impl FnMut(usize, u64)) {
+    let mut state = State::new();
+    let mut pos = 0;
+    while let Some(first) = kana[pos..].chars().next() {
+        let rest = &kana[pos..];
+        let mut matches = words(first)
+            .iter()
+            .filter(|(word, _)| rest.starts_with(word));
+        let Some(&(word, token)) = matches.next() else {
+            return;
+        };
+        // A shorter word matched at the same spot (し inside しち) ends a
+        // different prefix; it can complete a number but is never extended.
+        for &(short, short_token) in matches {
+            if let Some(value) = state.step(short_token).and_then(|s| s.value()) {
+                report(kana, pos + short.len(), value, &mut accept);
+            }
+        }
+        let Some(next) = state.step(token) else {
+            return;
+        };
+        state = next;
+        pos += word.len();
+        if let Some(value) = state.value() {
+            report(kana, pos, value, &mut accept);
+        }
+    }
+}
+
+fn report(kana: &str, end: usize, value: u64, accept: &mut impl FnMut(usize, u64)) {
+    // Zero only as the bare digit: ぜろじゅう and friends are not numbers.
+    if value != 0 || matches!(&kana[..end], "ぜろ" | "れい") {
+        accept(end, value);
+    }
+}
+
+/// Parse a hiragana number string into a numeric value.
+///
+/// Returns `None` if the input is not a valid Japanese number expression.
+pub fn parse_japanese_number(kana: &str) -> Option<u64> {
+    let mut result = None;
+    scan(kana, |end, value| {
+        if end == kana.len() {
+            result = Some(value);
+        }
+    });
+    result
+}
+
+/// Longest prefix of `kana` that is a number: `(value, byte length)`.
+pub fn parse_number_prefix(kana: &str) -> Option<(u64, usize)> {
+    number_prefixes(kana)
+        .last()
+        .map(|&(end, value)| (value, end))
+}
+
+/// Every prefix of `kana` that is a number, as `(byte length, value)` in
+/// increasing length, from one scan. `kana[..end]` parses to `value` with
+/// [`parse_japanese_number`] exactly when `(end, value)` is listed.
+pub fn number_prefixes(kana: &str) -> Vec<(usize, u64)> {
+    let mut out = Vec::new();
+    scan(kana, |end, value| out.push((end, value)));
+    out
+}
+
+/// Format a number as Japanese kanji numerals.
+///
+/// Uses traditional positional notation:
+/// - 十/百/千 omit the leading 一 (e.g. 10 → "十", not "一十")
+/// - 万/億/兆 keep the leading 一 (e.g. 10000 → "一万")
+/// - Zero is "〇"
+///
+/// Supports values up to 9999兆 (9,999,999,999,999,999).
+/// Values exceeding this range are returned as half-width Arabic digits.
+pub fn to_kanji(n: u64) -> String {
+    // Max supported: 9999兆9999億9999万9999
+    if n > 9_999_999_999_999_999 {
+        return to_halfwidth(n);
+    }
+    if n == 0 {
+        return "〇".to_string();
+    }
+
+    let mut result = String::new();
+
+    // 兆 (10^12)
+    let chou = n / 1_000_000_000_000;
+    let rem = n % 1_000_000_000_000;
+    if chou > 0 {
+        group_to_kanji(chou, &mut result);
+        result.push('兆');
+    }
+
+    // 億 (10^8)
+    let oku = rem / 100_000_000;
+    let rem = rem % 100_000_000;
+    if oku > 0 {
+        group_to_kanji(oku, &mut result);
+        result.push('億');
+    }
+
+    // 万 (10^4)
+    let man = rem / 10_000;
+    let rem = rem % 10_000;
+    if man > 0 {
+        group_to_kanji(man, &mut result);
+        result.push('万');
+    }
+
+    // Ones group (< 10000)
+    if rem > 0 {
+        group_to_kanji(rem, &mut result);
+    }
+
+    result
+}
+
+/// Format a group value (1–9999) as kanji, appending to `out`.
+/// Leading 一 is omitted before 十/百/千 (e.g. 10→"十", 100→"百", 1000→"千").
+///
+/// # Panics
+/// Panics if `n > 9999`.
+fn group_to_kanji(n: u64, out: &mut String) {
+    assert!(n <= 9999, "group_to_kanji: n={n} exceeds 9999");
+    const DIGITS: [char; 10] = ['〇', '一', '二', '三', '四', '五', '六', '七', '八', '九'];
+
+    let sen = n / 1000;
+    let rem = n % 1000;
+    if sen > 0 {
+        if sen > 1 {
+            out.push(DIGITS[sen as usize]);
+        }
+        out.push('千');
+    }
+
+    let hyaku = rem / 100;
+    let rem = rem % 100;
+    if hyaku > 0 {
+        if hyaku > 1 {
+            out.push(DIGITS[hyaku as usize]);
+        }
+        out.push('百');
+    }
+
+    let juu = rem / 10;
+    let rem = rem % 10;
+    if juu > 0 {
+        if juu > 1 {
+            out.push(DIGITS[juu as usize]);
+        }
+        out.push('十');
+    }
+
+    if rem > 0 {
+        out.push(DIGITS[rem as usize]);
+    }
+}
+
+/// Format a number as half-width Arabic digits.
+pub fn to_halfwidth(n: u64) -> String {
+    n.to_string()
+}
+
+/// Format a number as full-width Arabic digits.
+pub fn to_fullwidth(n: u64) -> String {
+    n.to_string()
+        .chars()
+        .map(|c| char::from_u32(c as u32 - '0' as u32 + '０' as u32).unwrap_or(c))
+        .collect()
+}
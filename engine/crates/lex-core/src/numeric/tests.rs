@@ -0,0 +1,512 @@
+use super::*;
+use crate::converter::testutil::Rng;
+
+#[test]
+fn test_simple_digits() {
+    assert_eq!(parse_japanese_number("ぜろ"), Some(0));
+    assert_eq!(parse_japanese_number("れい"), Some(0));
+    assert_eq!(parse_japanese_number("いち"), Some(1));
+    assert_eq!(parse_japanese_number("に"), Some(2));
+    assert_eq!(parse_japanese_number("さん"), Some(3));
+    assert_eq!(parse_japanese_number("し"), Some(4));
+    assert_eq!(parse_japanese_number("よん"), Some(4));
+    assert_eq!(parse_japanese_number("ご"), Some(5));
+    assert_eq!(parse_japanese_number("ろく"), Some(6));
+    assert_eq!(parse_japanese_number("しち"), Some(7));
+    assert_eq!(parse_japanese_number("なな"), Some(7));
+    assert_eq!(parse_japanese_number("はち"), Some(8));
+    assert_eq!(parse_japanese_number("きゅう"), Some(9));
+    assert_eq!(parse_japanese_number("く"), Some(9));
+}
+
+#[test]
+fn test_tens() {
+    assert_eq!(parse_japanese_number("じゅう"), Some(10));
+    assert_eq!(parse_japanese_number("にじゅう"), Some(20));
+    assert_eq!(parse_japanese_number("にじゅうさん"), Some(23));
+    assert_eq!(parse_japanese_number("さんじゅう"), Some(30));
+    assert_eq!(parse_japanese_number("きゅうじゅうきゅう"), Some(99));
+}
+
+#[test]
+fn test_hundreds() {
+    assert_eq!(parse_japanese_number("ひゃく"), Some(100));
+    assert_eq!(parse_japanese_number("にひゃく"), Some(200));
+    assert_eq!(parse_japanese_number("さんびゃく"), Some(300));
+    assert_eq!(parse_japanese_number("ろっぴゃく"), Some(600));
+    assert_eq!(parse_japanese_number("はっぴゃく"), Some(800));
+}
+
+#[test]
+fn test_thousands() {
+    assert_eq!(parse_japanese_number("せん"), Some(1000));
+    assert_eq!(parse_japanese_number("さんぜん"), Some(3000));
+    assert_eq!(parse_japanese_number("はっせん"), Some(8000));
+}
+
+#[test]
+fn test_compound() {
+    assert_eq!(parse_japanese_number("さんびゃくよんじゅうご"), Some(345));
+    assert_eq!(
+        parse_japanese_number("いっせんにひゃくさんじゅうよん"),
+        None // いっせん not supported (would need いっ rendaku prefix for せん)
+    );
+    assert_eq!(
+        parse_japanese_number("せんにひゃくさんじゅうよん"),
+        Some(1234)
+    );
+}
+
+#[test]
+fn test_large_units() {
+    assert_eq!(parse_japanese_number("いちまん"), Some(10_000));
+    assert_eq!(parse_japanese_number("じゅうまん"), Some(100_000));
+    assert_eq!(parse_japanese_number("いちおく"), Some(100_000_000));
+    assert_eq!(parse_japanese_number("いっちょう"), None); // いっちょう not supported
+    assert_eq!(parse_japanese_number("いちちょう"), Some(1_000_000_000_000));
+}
+
+#[test]
+fn test_bare_large_units_rejected() {
+    // Bare large multipliers must NOT parse — otherwise the number+counter
+    // rewriter generates spurious top-1 like `ちょうさ → 一兆差` that
+    // outranks `調査` (real user bug).
+    assert_eq!(parse_japanese_number("まん"), None);
+    assert_eq!(parse_japanese_number("おく"), None);
+    assert_eq!(parse_japanese_number("ちょう"), None);
+    // Compound forms with a real leading group must still work.
+    assert_eq!(parse_japanese_number("ひゃくまん"), Some(1_000_000));
+    assert_eq!(parse_japanese_number("じゅうおく"), Some(1_000_000_000));
+    assert_eq!(parse_japanese_number("にちょう"), Some(2_000_000_000_000));
+}
+
+#[test]
+fn test_complex() {
+    // 12345 = いちまんにせんさんびゃくよんじゅうご
+    assert_eq!(
+        parse_japanese_number("いちまんにせんさんびゃくよんじゅうご"),
+        Some(12345)
+    );
+}
+
+#[test]
+fn test_non_numeric() {
+    assert_eq!(parse_japanese_number("こんにちは"), None);
+    assert_eq!(parse_japanese_number("きょう"), None);
+    assert_eq!(parse_japanese_number("あ"), None);
+    assert_eq!(parse_japanese_number(""), None);
+}
+
+#[test]
+fn test_kanji_zero() {
+    assert_eq!(to_kanji(0), "〇");
+}
+
+#[test]
+fn test_kanji_single_digits() {
+    assert_eq!(to_kanji(1), "一");
+    assert_eq!(to_kanji(2), "二");
+    assert_eq!(to_kanji(9), "九");
+}
+
+#[test]
+fn test_kanji_tens() {
+    assert_eq!(to_kanji(10), "十");
+    assert_eq!(to_kanji(11), "十一");
+    assert_eq!(to_kanji(20), "二十");
+    assert_eq!(to_kanji(23), "二十三");
+    assert_eq!(to_kanji(99), "九十九");
+}
+
+#[test]
+fn test_kanji_hundreds() {
+    assert_eq!(to_kanji(100), "百");
+    assert_eq!(to_kanji(200), "二百");
+    assert_eq!(to_kanji(345), "三百四十五");
+    assert_eq!(to_kanji(999), "九百九十九");
+}
+
+#[test]
+fn test_kanji_thousands() {
+    assert_eq!(to_kanji(1000), "千");
+    assert_eq!(to_kanji(3000), "三千");
+    assert_eq!(to_kanji(1234), "千二百三十四");
+}
+
+#[test]
+fn test_kanji_large_units() {
+    // 万以上は一を省略しない
+    assert_eq!(to_kanji(10_000), "一万");
+    assert_eq!(to_kanji(12_345), "一万二千三百四十五");
+    assert_eq!(to_kanji(100_000_000), "一億");
+    assert_eq!(to_kanji(1_000_000_000_000), "一兆");
+    assert_eq!(to_kanji(20_000), "二万");
+    assert_eq!(to_kanji(100_000), "十万");
+    // Max supported value
+    assert_eq!(
+        to_kanji(9_999_999_999_999_999),
+        "九千九百九十九兆九千九百九十九億九千九百九十九万九千九百九十九"
+    );
+    // Over max → fallback to Arabic digits
+    assert_eq!(to_kanji(10_000_000_000_000_000), "10000000000000000");
+    assert_eq!(to_kanji(u64::MAX), u64::MAX.to_string());
+}
+
+#[test]
+fn test_halfwidth() {
+    assert_eq!(to_halfwidth(0), "0");
+    assert_eq!(to_halfwidth(123), "123");
+    assert_eq!(to_halfwidth(10000), "10000");
+}
+
+#[test]
+fn test_fullwidth() {
+    assert_eq!(to_fullwidth(0), "０");
+    assert_eq!(to_fullwidth(123), "１２３");
+    assert_eq!(to_fullwidth(10000), "１００００");
+}
+
+/// The previous multi-pass parser, kept verbatim as the oracle for the
+/// single-pass automaton.
+mod reference {
+    pub fn parse_japanese_number(kana: &str) -> Option<u64> {
+        let first = kana.chars().next()?;
+        if !matches!(
+            first,
+            'い' | 'に'
+                | 'さ'
+                | 'し'
+                | 'よ'
+                | 'ご'
+                | 'ろ'
+                | 'な'
+                | 'は'
+                | 'き'
+                | 'く'
+                | 'ぜ'
+                | 'れ'
+                | 'じ'
+                | 'ひ'
+                | 'せ'
+                | 'ま'
+                | 'お'
+                | 'ち'
+        ) {
+            return None;
+        }
+
+        let mut rest = kana;
+        let mut result: u64 = 0;
+        let mut group = parse_group(&mut rest);
+
+        for (unit_kana, unit_val) in &[
+            ("ちょう", 1_000_000_000_000u64),
+            ("おく", 100_000_000),
+            ("まん", 10_000),
+        ] {
+            if let Some(pos) = rest.find(unit_kana) {
+                if pos != 0 {
+                    return None;
+                }
+                if group == 0 {
+                    return None;
+                }
+                rest = &rest[unit_kana.len()..];
+                result += group * unit_val;
+                group = parse_group(&mut rest);
+            }
+        }
+
+        result += group;
+
+        if !rest.is_empty() {
+            return None;
+        }
+        if result == 0 && kana != "ぜろ" && kana != "れい" {
+            return None;
+        }
+
+        Some(result)
+    }
+
+    fn parse_group(rest: &mut &str) -> u64 {
+        let mut value: u64 = 0;
+        value += parse_unit(rest, 1000);
+        value += parse_unit(rest, 100);
+        value += parse_unit(rest, 10);
+        if let Some((d, len)) = consume_digit(rest) {
+            *rest = &rest[len..];
+            value += d;
+        }
+        value
+    }
+
+    fn parse_unit(rest: &mut &str, unit_val: u64) -> u64 {
+        let saved = *rest;
+        if let Some((d, dlen)) = consume_digit_or_rendaku_prefix(rest, unit_val) {
+            let after_digit = &saved[dlen..];
+            if let Some(ulen) = consume_unit_kana(after_digit, unit_val) {
+                *rest = &after_digit[ulen..];
+                return d * unit_val;
+            }
+        }
+        *rest = saved;
+        if let Some(ulen) = consume_unit_kana(rest, unit_val) {
+            *rest = &rest[ulen..];
+            return unit_val;
+        }
+        0
+    }
+
+    fn consume_digit_or_rendaku_prefix(s: &str, unit_val: u64) -> Option<(u64, usize)> {
+        match unit_val {
+            100 => {
+                if s.starts_with("ろっ") {
+                    return Some((6, "ろっ".len()));
+                }
+                if s.starts_with("はっ") {
+                    return Some((8, "はっ".len()));
+                }
+            }
+            1000 if s.starts_with("はっ") => {
+                return Some((8, "はっ".len()));
+            }
+            _ => {}
+        }
+        consume_digit(s)
+    }
+
+    fn consume_digit(s: &str) -> Option<(u64, usize)> {
+        let table: &[(&str, u64)] = &[
+            ("きゅう", 9),
+            ("しち", 7),
+            ("よん", 4),
+            ("はち", 8),
+            ("ろく", 6),
+            ("なな", 7),
+            ("いち", 1),
+            ("さん", 3),
+            ("ぜろ", 0),
+            ("れい", 0),
+            ("に", 2),
+            ("し", 4),
+            ("ご", 5),
+            ("く", 9),
+        ];
+        for &(kana, val) in table {
+            if s.starts_with(kana) {
+                return Some((val, kana.len()));
+            }
+        }
+        None
+    }
+
+    fn consume_unit_kana(s: &str, unit_val: u64) -> Option<usize> {
+        let variants: &[&str] = match unit_val {
+            10 => &["じゅう", "じゅっ", "じっ"],
+            100 => &["ひゃく", "びゃく", "ぴゃく"],
+            1000 => &["せん", "ぜん"],
+            _ => return None,
+        };
+        for &v in variants {
+            if s.starts_with(v) {
+                return Some(v.len());
+            }
+        }
+        None
+    }
+}
+
+/// Reading of a group (1–9999). With `rng`, spelling variants are chosen
+/// at random (し for 4, く for 9, じっ for 10, ...).
+fn group_kana(n: u64, rng: &mut Option<Rng>, out: &mut String) {
+    const DIGITS: [&[&str]; 10] = [
+        &["ぜろ"],
+        &["いち"],
+        &["に"],
+        &["さん"],
+        &["よん", "し"],
+        &["ご"],
+        &["ろく"],
+        &["なな", "しち"],
+        &["はち"],
+        &["きゅう", "く"],
+    ];
+    let mut pick = |options: &[&'static str]| match rng {
+        Some(rng) => options[rng.below(options.len())],
+        None => options[0],
+    };
+    let (sen, hyaku, juu, ichi) = (n / 1000, n / 100 % 10, n / 10 % 10, n % 10);
+    match sen {
+        0 => {}
+        1 => out.push_str("せん"),
+        3 => out.push_str("さんぜん"),
+        8 => out.push_str("はっせん"),
+        d => {
+            out.push_str(pick(DIGITS[d as usize]));
+            out.push_str("せん");
+        }
+    }
+    match hyaku {
+        0 => {}
+        1 => out.push_str("ひゃく"),
+        3 => out.push_str("さんびゃく"),
+        6 => out.push_str("ろっぴゃく"),
+        8 => out.push_str("はっぴゃく"),
+        d => {
+            out.push_str(pick(DIGITS[d as usize]));
+            out.push_str("ひゃく");
+        }
+    }
+    if juu > 0 {
+        if juu > 1 {
+            out.push_str(pick(DIGITS[juu as usize]));
+        }
+        out.push_str(pick(&["じゅう", "じゅっ", "じっ"]));
+    }
+    if ichi > 0 {
+        out.push_str(pick(DIGITS[ichi as usize]));
+    }
+}
+
+/// Reading of `n` (≥ 1), with 万 / 億 / 兆 groups.
+fn to_kana(n: u64, mut rng: Option<Rng>) -> String {
+    let mut out = String::new();
+    for (unit, value) in [
+        ("ちょう", 1_000_000_000_000),
+        ("おく", 100_000_000),
+        ("まん", 10_000),
+    ] {
+        let group = n / value % 10_000;
+        if group > 0 {
+            group_kana(group, &mut rng, &mut out);
+            out.push_str(unit);
+        }
+    }
+    group_kana(n % 10_000, &mut rng, &mut out);
+    out
+}
+
+#[test]
+fn test_round_trip_exhaustive_below_one_million() {
+    assert_eq!(parse_japanese_number("ぜろ"), Some(0));
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+    for n in 1..1_000_000 {
+        let kana = to_kana(n, None);
+        assert_eq!(parse_japanese_number(&kana), Some(n), "{kana}");
+        assert_eq!(reference::parse_japanese_number(&kana), Some(n), "{kana}");
+
+        // Spelling variants on a sample: the reference parser is slow.
+        if n % 8 != 0 {
+            continue;
+        }
+        let variant = to_kana(n, Some(Rng(rng.next() | 1)));
+        assert_eq!(
+            parse_japanese_number(&variant),
+            reference::parse_japanese_number(&variant),
+            "{variant}"
+        );
+    }
+}
+
+#[test]
+fn test_round_trip_large_values() {
+    let values = [
+        10_000,
+        100_000_000,
+        100_010_001,
+        1_000_000_000_000,
+        1_000_000_000_001,
+        2_000_300_040_005,
+        8_888_888_888_888,
+        123_456_789_012_345,
+        9_999_999_999_999_999,
+    ];
+    for n in values {
+        let kana = to_kana(n, None);
+        assert_eq!(parse_japanese_number(&kana), Some(n), "{kana}");
+        assert_eq!(reference::parse_japanese_number(&kana), Some(n), "{kana}");
+    }
+}
+
+/// Random strings of number words (and a few non-number kana) must parse
+/// the same as before, and every prefix must agree with `number_prefixes`.
+#[test]
+fn test_matches_reference_on_random_word_sequences() {
+    const WORDS: &[&str] = &[
+        "いち",
+        "に",
+        "さん",
+        "し",
+        "しち",
+        "よん",
+        "ご",
+        "ろく",
+        "ろっ",
+        "なな",
+        "はち",
+        "はっ",
+        "きゅう",
+        "く",
+        "ぜろ",
+        "れい",
+        "じゅう",
+        "じゅっ",
+        "じっ",
+        "ひゃく",
+        "びゃく",
+        "ぴゃく",
+        "せん",
+        "ぜん",
+        "まん",
+        "おく",
+        "ちょう",
+        "い",
+        "ち",
+        "ょう",
+        "えん",
+        "ほん",
+    ];
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+    for _ in 0..50_000 {
+        let len = 1 + rng.next() % 7;
+        let kana: String = (0..len).map(|_| WORDS[rng.below(WORDS.len())]).collect();
+        let prefixes = number_prefixes(&kana);
+        for (end, _) in kana.char_indices().skip(1).chain([(kana.len(), ' ')]) {
+            let listed = prefixes.iter().find(|&&(e, _)| e == end).map(|&(_, v)| v);
+            assert_eq!(
+                listed,
+                reference::parse_japanese_number(&kana[..end]),
+                "{}",
+                &kana[..end]
+            );
+        }
+    }
+}
+
+#[test]
+fn test_number_prefix() {
+    assert_eq!(
+        parse_number_prefix("さんぜんえん"),
+        Some((3000, "さんぜん".len()))
+    );
+    assert_eq!(
+        parse_number_prefix("にじゅうにん"),
+        Some((22, "にじゅうに".len()))
+    );
+    assert_eq!(parse_number_prefix("ごほん"), Some((5, "ご".len())));
+    // し inside しち still ends a number.
+    assert_eq!(
+        number_prefixes("しちょう"),
+        vec![("し".len(), 4), ("しち".len(), 7)]
+    );
+    assert_eq!(parse_number_prefix("えん"), None);
+    assert_eq!(
+        number_prefixes("にじゅうにん"),
+        vec![
+            ("に".len(), 2),
+            ("にじゅう".len(), 20),
+            ("にじゅうに".len(), 22),
+        ]
+    );
+}
@@ -1,15 +1,21 @@
-//! Global settings loaded from TOML, following the same OnceLock pattern as romaji config.
+//! Global settings loaded from TOML.
 //!
 //! - `init_custom(toml_content)` sets a custom TOML before first `settings()` call
-//! - `settings()` returns `&'static Settings` (lazy-init singleton)
+//! - `settings()` returns the current `Arc<Settings>` snapshot (lazy-init)
+//! - `reload(toml_content)` swaps in a new snapshot at runtime
 //! - Default values are embedded via `include_str!("default_settings.toml")`
+//!
+//! A conversion captures one snapshot up front and passes it down (see
+//! `PostprocessContext`), so a concurrent `reload` never mixes old and new
+//! weights within a single result.
 
 use std::collections::HashMap;
-use std::sync::OnceLock;
+use std::sync::{Arc, OnceLock, RwLock};
 
 use serde::Deserialize;
 
 use crate::snippets::SnippetVariable;
+use crate::user_history::DecayTable;
 
 pub const DEFAULT_SETTINGS_TOML: &str = include_str!("default_settings.toml");
 
@@ -23,18 +29,58 @@ pub fn init_custom(toml_content: String) -> Result<(), SettingsError> {
         .map_err(|_| SettingsError::AlreadyInitialized)
 }
 
-/// Get or initialize the global settings singleton.
-pub fn settings() -> &'static Settings {
-    static INSTANCE: OnceLock<Settings> = OnceLock::new();
+/// Current settings snapshot.
+///
+/// Cheap (one read lock and a refcount bump), but hot loops should capture
+/// the snapshot once and pass it down rather than calling this per item.
+pub fn settings() -> Arc<Settings> {
+    current().load()
+}
+
+/// Validate `toml_content` and make it the current settings.
+///
+/// Snapshots already handed out stay valid and unchanged; only later
+/// `settings()` calls observe the new values. On error the current
+/// settings are left untouched.
+pub fn reload(toml_content: &str) -> Result<(), SettingsError> {
+    let parsed = parse_settings_toml(toml_content)?;
+    current().replace(parsed);
+    Ok(())
+}
+
+fn current() -> &'static SettingsCell {
+    static INSTANCE: OnceLock<SettingsCell> = OnceLock::new();
     INSTANCE.get_or_init(|| {
         let toml_str = CUSTOM_TOML
             .get()
             .map(|s| s.as_str())
             .unwrap_or(DEFAULT_SETTINGS_TOML);
-        parse_settings_toml(toml_str).expect("settings TOML must be valid")
+        SettingsCell::new(parse_settings_toml(toml_str).expect("settings TOML must be valid"))
     })
 }
 
+/// Atomically swappable settings snapshot.
+pub(crate) struct SettingsCell {
+    current: RwLock<Arc<Settings>>,
+}
+
+impl SettingsCell {
+    pub(crate) fn new(settings: Settings) -> Self {
+        Self {
+            current: RwLock::new(Arc::new(settings)),
+        }
+    }
+
+    pub(crate) fn load(&self) -> Arc<Settings> {
+        Arc::clone(&self.current.read().expect("settings lock poisoned"))
+    }
+
+    pub(crate) fn replace(&self, settings: Settings) {
+        let next = Arc::new(settings);
+        *self.current.write().expect("settings lock poisoned") = next;
+    }
+}
+
 /// Returns the embedded default settings TOML content.
 pub fn default_toml() -> &'static str {
     DEFAULT_SETTINGS_TOML
@@ -57,6 +103,10 @@ pub struct Settings {
     pub history: HistorySettings,
     pub candidates: CandidateSettings,
     #[serde(default)]
+    pub limits: LimitSettings,
+    #[serde(default)]
+    pub dictionary: DictionarySettings,
+    #[serde(default)]
     pub snippets: SnippetSettings,
     #[serde(default)]
     keymap: HashMap<String, Vec<String>>,
@@ -139,6 +189,9 @@ pub struct HistorySettings {
     pub half_life_hours: f64,
     pub max_unigrams: usize,
     pub max_bigrams: usize,
+    /// `half_life_hours` as a fixed-point table; built by `parse_settings_toml`.
+    #[serde(skip)]
+    pub decay: DecayTable,
 }
 
 #[derive(Debug, Clone, Deserialize)]
@@ -147,6 +200,68 @@ pub struct CandidateSettings {
     pub max_results: usize,
 }
 
+/// Default cap on dictionary nodes per lattice start position.
+pub const DEFAULT_MAX_NODES_PER_POSITION: usize = 512;
+/// Default Viterbi work budget, in top-K relaxations per search.
+pub const DEFAULT_VITERBI_WORK_BUDGET: usize = 256_000_000;
+
+/// Worst-case latency guards. Typical input stays well below both, even
+/// against a dictionary denser than the shipped one (see the converter's
+/// limits tests); they only bind on pathological readings (long runs of
+/// one kana, readings where every prefix is a word), which then convert
+/// with fewer candidates instead of stalling.
+#[derive(Debug, Clone, Deserialize)]
+pub struct LimitSettings {
+    /// Dictionary nodes kept per lattice start position, cheapest first.
+    #[serde(default = "default_max_nodes_per_position")]
+    pub max_nodes_per_position: usize,
+    /// Relaxations (lattice edges × paths kept per node) one Viterbi
+    /// search may spend; past it, fewer paths are kept per node.
+    #[serde(default = "default_viterbi_work_budget")]
+    pub viterbi_work_budget: usize,
+}
+
+impl Default for LimitSettings {
+    fn default() -> Self {
+        Self {
+            max_nodes_per_position: DEFAULT_MAX_NODES_PER_POSITION,
+            viterbi_work_budget: DEFAULT_VITERBI_WORK_BUDGET,
+        }
+    }
+}
+
+fn default_max_nodes_per_position() -> usize {
+    DEFAULT_MAX_NODES_PER_POSITION
+}
+
+fn default_viterbi_work_budget() -> usize {
+    DEFAULT_VITERBI_WORK_BUDGET
+}
+
+/// Default byte budget of the shared dictionary entry cache.
+pub const DEFAULT_ENTRY_CACHE_BYTES: usize = 4 << 20;
+
+#[derive(Debug, Clone, Deserialize)]
+pub struct DictionarySettings {
+    /// Bytes of decoded entries the system dictionary keeps for hot
+    /// readings (see [`crate::dict::EntryCache`]); 0 disables the cache.
+    /// Read when the dictionary is opened.
+    #[serde(default = "default_entry_cache_bytes")]
+    pub entry_cache_bytes: usize,
+}
+
+impl Default for DictionarySettings {
+    fn default() -> Self {
+        Self {
+            entry_cache_bytes: DEFAULT_ENTRY_CACHE_BYTES,
+        }
+    }
+}
+
+fn default_entry_cache_bytes() -> usize {
+    DEFAULT_ENTRY_CACHE_BYTES
+}
+
 fn default_snippet_trigger() -> String {
     "ctrl+shift+/".to_string()
 }
@@ -220,6 +335,7 @@ pub fn parse_settings_toml(toml_str: &str) -> Result<Settings, SettingsError> {
         toml::from_str(toml_str).map_err(|e| SettingsError::Parse(e.to_string()))?;
     validate(&s)?;
     s.keymap_parsed = parse_keymap(&s.keymap)?;
+    s.history.decay = DecayTable::new(s.history.half_life_hours);
     Ok(s)
 }
 
@@ -292,6 +408,9 @@ fn validate(s: &Settings) -> Result<(), SettingsError> {
     check_positive_usize!(candidates.nbest);
     check_positive_usize!(candidates.max_results);
 
+    check_positive_usize!(limits.max_nodes_per_position);
+    check_positive_usize!(limits.viterbi_work_budget);
+
     // i16 range check for unknown_word_cost is enforced by the type itself
 
     // Validate snippet trigger (empty string intentionally disables)
@@ -330,6 +449,9 @@ mod tests {
         assert_eq!(s.history.max_bigrams, 10000);
         assert_eq!(s.candidates.nbest, 20);
         assert_eq!(s.candidates.max_results, 20);
+        assert_eq!(s.limits.max_nodes_per_position, 512);
+        assert_eq!(s.limits.viterbi_work_budget, 256_000_000);
+        assert_eq!(s.dictionary.entry_cache_bytes, 4 << 20);
         // Snippet defaults
         assert_eq!(s.snippets.trigger, "ctrl+shift+/");
         let trigger = s.snippet_trigger().unwrap();
@@ -375,6 +497,9 @@ max_results = 30
         let s = parse_settings_toml(toml).unwrap();
         assert_eq!(s.cost.segment_penalty, 1000);
         assert_eq!(s.candidates.nbest, 10);
+        // Sections left out fall back to the defaults.
+        assert_eq!(s.limits.max_nodes_per_position, 512);
+        assert_eq!(s.dictionary.entry_cache_bytes, DEFAULT_ENTRY_CACHE_BYTES);
     }
 
     #[test]
@@ -468,6 +593,14 @@ max_results = 20
         assert!(err.to_string().contains("candidates.nbest"));
     }
 
+    #[test]
+    fn error_zero_work_budget() {
+        let toml = DEFAULT_SETTINGS_TOML
+            .replace("viterbi_work_budget = 256000000", "viterbi_work_budget = 0");
+        let err = parse_settings_toml(&toml).unwrap_err();
+        assert!(err.to_string().contains("limits.viterbi_work_budget"));
+    }
+
     #[test]
     fn keymap_omitted_is_empty() {
         let toml = r#"
@@ -611,4 +744,22 @@ unknown_word_cost = 10000
         let err = parse_settings_toml(toml).unwrap_err();
         assert!(matches!(err, SettingsError::Parse(_)));
     }
+
+    #[test]
+    fn settings_cell_replace_keeps_old_snapshots() {
+        let cell = SettingsCell::new(parse_settings_toml(DEFAULT_SETTINGS_TOML).unwrap());
+        let old = cell.load();
+        let mut next = (*old).clone();
+        next.candidates.nbest = old.candidates.nbest + 1;
+        cell.replace(next);
+        assert_eq!(cell.load().candidates.nbest, old.candidates.nbest + 1);
+        assert_eq!(old.candidates.nbest, 20, "held snapshot is unchanged");
+    }
+
+    #[test]
+    fn reload_invalid_toml_keeps_current() {
+        let before = settings();
+        assert!(reload("[cost]\nsegment_penalty = -1").is_err());
+        assert!(Arc::ptr_eq(&before, &settings()));
+    }
 }
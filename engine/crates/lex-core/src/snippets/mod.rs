@@ -4,4 +4,4 @@ mod variables;
 
 pub use config::{parse_snippets_toml, validate_snippet_entries, SnippetConfigError};
 pub use store::SnippetStore;
-pub use variables::{SnippetVariable, VariableResolver};
+pub use variables::{ExpansionContext, SnippetVariable, Template, VariableResolver};
@@ -1,28 +1,67 @@
 use std::collections::HashMap;
+use std::ops::Range;
 
-use super::variables::VariableResolver;
+use super::variables::{ExpansionContext, Template, VariableResolver};
 
 pub struct SnippetStore {
-    entries: HashMap<String, String>,
+    /// Entries sorted by key, bodies pre-compiled into templates.
+    entries: Vec<(String, Template)>,
     resolver: VariableResolver,
 }
 
 impl SnippetStore {
     pub fn new(entries: HashMap<String, String>, resolver: VariableResolver) -> Self {
+        let mut entries: Vec<(String, Template)> = entries
+            .into_iter()
+            .map(|(key, body)| {
+                let template = resolver.compile(&body);
+                (key, template)
+            })
+            .collect();
+        entries.sort_by(|a, b| a.0.cmp(&b.0));
         Self { entries, resolver }
     }
 
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Indices of the entries whose key starts with `prefix`. Keys are kept
+    /// sorted, so the matches are always one contiguous run.
+    pub fn prefix_range(&self, prefix: &str) -> Range<usize> {
+        let start = self
+            .entries
+            .partition_point(|(key, _)| key.as_str() < prefix);
+        let len = self.entries[start..].partition_point(|(key, _)| key.starts_with(prefix));
+        start..start + len
+    }
+
+    /// Key of the entry at `index` (see [`prefix_range`](Self::prefix_range)).
+    pub fn key(&self, index: usize) -> &str {
+        &self.entries[index].0
+    }
+
+    /// Start a rendering pass; see [`VariableResolver::context`].
+    pub fn context(&self) -> ExpansionContext {
+        self.resolver.context()
+    }
+
+    /// Body of the entry at `index` with variables expanded.
+    pub fn expand(&self, index: usize, ctx: &ExpansionContext) -> String {
+        self.resolver.render(&self.entries[index].1, ctx)
+    }
+
     /// Return all entries matching the given prefix, with variables expanded.
     /// Results are sorted by key for stable ordering.
     pub fn prefix_search(&self, prefix: &str) -> Vec<(String, String)> {
-        let mut results: Vec<(String, String)> = self
-            .entries
-            .iter()
-            .filter(|(key, _)| key.starts_with(prefix))
-            .map(|(key, body)| (key.clone(), self.resolver.expand(body)))
-            .collect();
-        results.sort_by(|a, b| a.0.cmp(&b.0));
-        results
+        let ctx = self.context();
+        self.prefix_range(prefix)
+            .map(|i| (self.entries[i].0.clone(), self.expand(i, &ctx)))
+            .collect()
     }
 
     /// Return all entries with variables expanded (empty prefix).
@@ -112,4 +151,23 @@ mod tests {
         assert_eq!(results.len(), 1);
         assert_eq!(results[0].1, "Name: Taro");
     }
+
+    #[test]
+    fn test_prefix_range_is_contiguous() {
+        let mut entries = HashMap::new();
+        for key in ["a", "g", "ga", "gb", "gh", "h", "hg"] {
+            entries.insert(key.to_string(), key.to_uppercase());
+        }
+        let store = SnippetStore::new(entries, VariableResolver::new(HashMap::new()));
+
+        let range = store.prefix_range("g");
+        let keys: Vec<&str> = range.clone().map(|i| store.key(i)).collect();
+        assert_eq!(keys, ["g", "ga", "gb", "gh"]);
+        let ctx = store.context();
+        assert_eq!(store.expand(range.start + 2, &ctx), "GB");
+
+        assert_eq!(store.prefix_range("").len(), 7);
+        assert!(store.prefix_range("z").is_empty());
+        assert!(store.prefix_range("gz").is_empty());
+    }
 }
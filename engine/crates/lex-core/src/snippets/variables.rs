@@ -1,3 +1,4 @@
+use std::cell::OnceCell;
 use std::collections::HashMap;
 
 use serde::Deserialize;
@@ -14,6 +15,31 @@ pub enum SnippetVariable {
 
 pub struct VariableResolver {
     vars: HashMap<String, SnippetVariable>,
+    /// Date formats referenced by compiled templates, indexed by slot.
+    date_slots: Vec<String>,
+    date_slot_by_name: HashMap<String, usize>,
+}
+
+/// A snippet body parsed once into literal spans and date slots.
+///
+/// Static and unknown variables are folded into the literal spans at compile
+/// time, so rendering only has to splice in the time-dependent values.
+#[derive(Debug, Clone)]
+pub struct Template {
+    segments: Vec<Segment>,
+}
+
+#[derive(Debug, Clone)]
+enum Segment {
+    Literal(String),
+    Date(usize),
+}
+
+/// Per-request rendering state: the clock is read once, and each date slot is
+/// formatted at most once no matter how many templates reference it.
+pub struct ExpansionContext {
+    now: OffsetDateTime,
+    dates: Vec<OnceCell<String>>,
 }
 
 struct EraEntry {
@@ -114,20 +140,55 @@ impl VariableResolver {
         let mut vars = builtin_defaults();
         // User-defined variables override builtins
         vars.extend(user_vars);
-        Self { vars }
+
+        let mut date_names: Vec<&String> = vars
+            .iter()
+            .filter(|(_, v)| matches!(v, SnippetVariable::Date { .. }))
+            .map(|(name, _)| name)
+            .collect();
+        date_names.sort();
+        let mut date_slots = Vec::with_capacity(date_names.len());
+        let mut date_slot_by_name = HashMap::with_capacity(date_names.len());
+        for name in date_names {
+            if let Some(SnippetVariable::Date { format }) = vars.get(name) {
+                date_slot_by_name.insert(name.clone(), date_slots.len());
+                date_slots.push(format.clone());
+            }
+        }
+
+        Self {
+            vars,
+            date_slots,
+            date_slot_by_name,
+        }
     }
 
     pub fn known_names(&self) -> Vec<String> {
         self.vars.keys().cloned().collect()
     }
 
+    /// Expand all variables in `template` against the current time.
     pub fn expand(&self, template: &str) -> String {
-        let mut result = String::with_capacity(template.len());
+        self.render(&self.compile(template), &self.context())
+    }
+
+    /// Start a rendering pass. Time-based variables rendered through the
+    /// returned context all observe the same instant.
+    pub fn context(&self) -> ExpansionContext {
+        ExpansionContext {
+            now: now(),
+            dates: vec![OnceCell::new(); self.date_slots.len()],
+        }
+    }
+
+    /// Parse `template` into literal spans and variable slots.
+    pub fn compile(&self, template: &str) -> Template {
+        let mut out = TemplateBuilder::default();
         let mut chars = template.chars().peekable();
 
         while let Some(ch) = chars.next() {
             if ch != '$' {
-                result.push(ch);
+                out.push_char(ch);
                 continue;
             }
 
@@ -136,7 +197,7 @@ impl VariableResolver {
                 Some('$') => {
                     // $$ → literal $
                     chars.next();
-                    result.push('$');
+                    out.push_char('$');
                 }
                 Some('{') => {
                     // ${name}
@@ -151,12 +212,12 @@ impl VariableResolver {
                         name.push(c);
                     }
                     if found_closing {
-                        result.push_str(&self.resolve_var(&name));
+                        self.push_var(&mut out, &name);
                     } else {
                         // Malformed ${... → preserve as literal
-                        result.push('$');
-                        result.push('{');
-                        result.push_str(&name);
+                        out.push_char('$');
+                        out.push_char('{');
+                        out.push_str(&name);
                     }
                 }
                 Some(c) if c.is_ascii_alphanumeric() || *c == '_' => {
@@ -170,30 +231,86 @@ impl VariableResolver {
                             break;
                         }
                     }
-                    result.push_str(&self.resolve_var(&name));
+                    self.push_var(&mut out, &name);
                 }
                 _ => {
                     // Lone $ at end or before non-identifier char
-                    result.push('$');
+                    out.push_char('$');
                 }
             }
         }
 
+        out.finish()
+    }
+
+    /// Render a compiled template.
+    pub fn render(&self, template: &Template, ctx: &ExpansionContext) -> String {
+        let mut result = String::new();
+        for segment in &template.segments {
+            match segment {
+                Segment::Literal(text) => result.push_str(text),
+                Segment::Date(slot) => {
+                    let value = ctx.dates[*slot]
+                        .get_or_init(|| format_date_at(&self.date_slots[*slot], &ctx.now));
+                    result.push_str(value);
+                }
+            }
+        }
         result
     }
 
-    fn resolve_var(&self, name: &str) -> String {
+    fn push_var(&self, out: &mut TemplateBuilder, name: &str) {
         match self.vars.get(name) {
-            Some(SnippetVariable::Date { format }) => format_date(format),
-            Some(SnippetVariable::Static { value }) => value.clone(),
-            None => format!("${{{name}}}"),
+            Some(SnippetVariable::Date { .. }) => out.push_date(self.date_slot_by_name[name]),
+            Some(SnippetVariable::Static { value }) => out.push_str(value),
+            None => out.push_str(&format!("${{{name}}}")),
+        }
+    }
+}
+
+/// Accumulates adjacent literal text into a single span.
+#[derive(Default)]
+struct TemplateBuilder {
+    segments: Vec<Segment>,
+    literal: String,
+}
+
+impl TemplateBuilder {
+    fn push_char(&mut self, ch: char) {
+        self.literal.push(ch);
+    }
+
+    fn push_str(&mut self, s: &str) {
+        self.literal.push_str(s);
+    }
+
+    fn push_date(&mut self, slot: usize) {
+        self.flush();
+        self.segments.push(Segment::Date(slot));
+    }
+
+    fn flush(&mut self) {
+        if !self.literal.is_empty() {
+            self.segments
+                .push(Segment::Literal(std::mem::take(&mut self.literal)));
+        }
+    }
+
+    fn finish(mut self) -> Template {
+        self.flush();
+        self.segments.shrink_to_fit();
+        Template {
+            segments: self.segments,
         }
     }
 }
 
-fn format_date(fmt: &str) -> String {
-    let now = OffsetDateTime::now_local().unwrap_or_else(|_| OffsetDateTime::now_utc());
-    let (era_name, era_year) = current_era(&now);
+fn now() -> OffsetDateTime {
+    OffsetDateTime::now_local().unwrap_or_else(|_| OffsetDateTime::now_utc())
+}
+
+fn format_date_at(fmt: &str, now: &OffsetDateTime) -> String {
+    let (era_name, era_year) = current_era(now);
 
     let mut result = String::with_capacity(fmt.len());
     let mut chars = fmt.chars().peekable();
@@ -372,7 +489,7 @@ mod tests {
         // Verify that %G (era name) and %gy (era year) are both supported and don't duplicate
         let now = time::OffsetDateTime::now_utc();
         if now.year() >= 2019 {
-            let result = format_date("%G%gy年");
+            let result = format_date_at("%G%gy年", &now);
             assert!(result.starts_with("令和"));
             // Should NOT contain "%G" or "令和令和"
             assert!(!result.contains("令和令和"));
@@ -399,4 +516,34 @@ mod tests {
         assert_eq!(resolver.expand("$ "), "$ ");
         assert_eq!(resolver.expand("$"), "$");
     }
+
+    #[test]
+    fn test_compile_folds_static_variables() {
+        let mut user = HashMap::new();
+        user.insert(
+            "name".to_string(),
+            SnippetVariable::Static {
+                value: "Taro".to_string(),
+            },
+        );
+        let resolver = VariableResolver::new(user);
+        let template = resolver.compile("Hi $name, $$5 ${missing}");
+        assert_eq!(template.segments.len(), 1);
+        assert_eq!(
+            resolver.render(&template, &resolver.context()),
+            "Hi Taro, $5 ${missing}"
+        );
+    }
+
+    #[test]
+    fn test_context_shares_date_across_templates() {
+        let resolver = VariableResolver::new(HashMap::new());
+        let a = resolver.compile("[$datetime]");
+        let b = resolver.compile("$date $time");
+        let ctx = resolver.context();
+        let ra = resolver.render(&a, &ctx);
+        let rb = resolver.render(&b, &ctx);
+        // Both renders observe the same instant.
+        assert_eq!(&ra[1..ra.len() - 1], rb.as_str());
+    }
 }
@@ -1,24 +1,34 @@
 //! User dictionary with runtime word registration.
 //!
-//! HashMap-based dictionary that implements `Dictionary` trait for integration
-//! with `CompositeDictionary`. Uses `RwLock` for interior mutability so that
-//! `register`/`unregister` can be called while sessions hold a read reference.
+//! Two layers implement the `Dictionary` trait for integration with
+//! `CompositeDictionary`:
+//!
+//! - a **base** of bulk-imported words (`import_tsv`), compiled into an LXDX
+//!   trie and stored next to the user dictionary file (see [`base_path`]);
+//! - a small mutable **delta** of single-word `register`/`unregister` edits,
+//!   persisted as LXUW. Unregistering a base word records a tombstone in the
+//!   delta instead of rewriting the trie.
+//!
+//! Both layers sit behind one `RwLock` so edits can be made while sessions
+//! hold a read reference.
 
 #[cfg(test)]
 mod tests;
 
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 use std::fs;
 use std::io;
-use std::path::Path;
-use std::sync::RwLock;
+use std::path::{Path, PathBuf};
+use std::sync::{RwLock, RwLockReadGuard, RwLockWriteGuard};
 
 use serde::{Deserialize, Serialize};
 
-use crate::dict::{DictEntry, Dictionary, SearchResult};
+use crate::dict::{DictEntry, DictError, Dictionary, SearchResult, TrieDictionary};
 
 const MAGIC: &[u8; 4] = b"LXUW";
-const VERSION: u8 = 1;
+/// v1: registered words only. v2: adds tombstones for base words.
+const VERSION: u8 = 2;
+const VERSION_V1: u8 = 1;
 
 /// POS ID for 名詞,一般 (from id.def).
 const USER_POS_ID: u16 = 1852;
@@ -34,21 +44,217 @@ fn make_entry(surface: &str) -> DictEntry {
     }
 }
 
+/// Path of the compiled base layer belonging to the user dictionary at `path`.
+pub fn base_path(path: &Path) -> PathBuf {
+    path.with_extension("lxdx")
+}
+
+/// Cost and POS applied to imported rows that do not carry their own.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ImportDefaults {
+    pub cost: i16,
+    pub pos_id: u16,
+}
+
+impl Default for ImportDefaults {
+    fn default() -> Self {
+        Self {
+            cost: USER_COST,
+            pos_id: USER_POS_ID,
+        }
+    }
+}
+
+/// Parse a glossary TSV: `reading<TAB>surface[<TAB>cost[<TAB>pos_id]]`.
+///
+/// Blank lines and lines starting with `#` are skipped. Errors carry the
+/// 1-based line number.
+pub fn parse_tsv(
+    text: &str,
+    defaults: ImportDefaults,
+) -> Result<Vec<(String, DictEntry)>, io::Error> {
+    let invalid = |line: usize, msg: String| {
+        io::Error::new(io::ErrorKind::InvalidData, format!("line {line}: {msg}"))
+    };
+    let mut rows = Vec::new();
+    for (i, line) in text.lines().enumerate() {
+        let line_no = i + 1;
+        let line = line.trim_end_matches('\r');
+        if line.trim().is_empty() || line.starts_with('#') {
+            continue;
+        }
+        let cols: Vec<&str> = line.split('\t').collect();
+        if cols.len() < 2 || cols.len() > 4 {
+            return Err(invalid(
+                line_no,
+                format!("expected 2-4 columns, got {}", cols.len()),
+            ));
+        }
+        let (reading, surface) = (cols[0].trim(), cols[1].trim());
+        if reading.is_empty() || surface.is_empty() {
+            return Err(invalid(line_no, "empty reading or surface".to_string()));
+        }
+        if surface.len() > u16::MAX as usize {
+            return Err(invalid(line_no, "surface too long".to_string()));
+        }
+        let cost = match cols.get(2).map(|c| c.trim()) {
+            Some(c) if !c.is_empty() => c
+                .parse::<i16>()
+                .map_err(|e| invalid(line_no, format!("bad cost {c:?}: {e}")))?,
+            _ => defaults.cost,
+        };
+        let pos_id = match cols.get(3).map(|c| c.trim()) {
+            Some(c) if !c.is_empty() => c
+                .parse::<u16>()
+                .map_err(|e| invalid(line_no, format!("bad pos_id {c:?}: {e}")))?,
+            _ => defaults.pos_id,
+        };
+        rows.push((
+            reading.to_string(),
+            DictEntry {
+                surface: surface.to_string(),
+                cost,
+                left_id: pos_id,
+                right_id: pos_id,
+            },
+        ));
+    }
+    Ok(rows)
+}
+
+fn dict_error_to_io(e: DictError) -> io::Error {
+    match e {
+        DictError::Io(e) => e,
+        e => io::Error::new(io::ErrorKind::InvalidData, e),
+    }
+}
+
+/// Temporary file for [`write_atomic`]: the full file name plus `.tmp`, so
+/// the delta and its base (same stem) never share one.
+fn tmp_path(path: &Path) -> PathBuf {
+    let mut name = path.as_os_str().to_owned();
+    name.push(".tmp");
+    PathBuf::from(name)
+}
+
+/// Atomic write: write to .tmp then rename. A rename also leaves any
+/// existing mmap of the old base file intact.
+fn write_atomic(path: &Path, bytes: &[u8]) -> Result<(), io::Error> {
+    let tmp = tmp_path(path);
+    if let Some(parent) = path.parent() {
+        fs::create_dir_all(parent)?;
+    }
+    fs::write(&tmp, bytes)?;
+    fs::rename(&tmp, path)
+}
+
+#[derive(Default)]
+struct Layers {
+    /// Bulk-imported words; replaced wholesale by `import_tsv`.
+    base: Option<TrieDictionary>,
+    /// `base` changed since it was loaded or last saved.
+    base_dirty: bool,
+    /// Single-word registrations, disjoint from `base`.
+    added: HashMap<String, Vec<DictEntry>>,
+    /// Base words hidden by `unregister`: reading → surfaces.
+    removed: HashMap<String, HashSet<String>>,
+}
+
+impl Layers {
+    /// The delta as LXUW bytes.
+    fn delta_bytes(&self) -> Result<Vec<u8>, io::Error> {
+        let words: Vec<UserWordRecord> = self
+            .added
+            .iter()
+            .flat_map(|(reading, entries)| {
+                entries.iter().map(move |e| UserWordRecord {
+                    reading: reading.clone(),
+                    surface: e.surface.clone(),
+                })
+            })
+            .collect();
+        let removed: Vec<UserWordRecord> = self
+            .removed
+            .iter()
+            .flat_map(|(reading, surfaces)| {
+                surfaces.iter().map(move |s| UserWordRecord {
+                    reading: reading.clone(),
+                    surface: s.clone(),
+                })
+            })
+            .collect();
+
+        let body =
+            bincode::serialize(&UserDictData { words, removed }).map_err(io::Error::other)?;
+        let mut buf = Vec::with_capacity(5 + body.len());
+        buf.extend_from_slice(MAGIC);
+        buf.push(VERSION);
+        buf.extend_from_slice(&body);
+        Ok(buf)
+    }
+
+    fn is_removed(&self, reading: &str, surface: &str) -> bool {
+        self.removed
+            .get(reading)
+            .is_some_and(|surfaces| surfaces.contains(surface))
+    }
+
+    fn base_contains(&self, reading: &str, surface: &str) -> bool {
+        self.base
+            .as_ref()
+            .is_some_and(|b| b.lookup(reading).iter().any(|e| e.surface == surface))
+    }
+
+    /// Visible entries for `reading`: the delta first, then base entries
+    /// that are neither tombstoned nor shadowed by a delta surface.
+    fn merge(&self, reading: &str, base_entries: Vec<DictEntry>) -> Vec<DictEntry> {
+        let mut entries = self.added.get(reading).cloned().unwrap_or_default();
+        let delta_len = entries.len();
+        for e in base_entries {
+            if !self.is_removed(reading, &e.surface)
+                && !entries[..delta_len].iter().any(|d| d.surface == e.surface)
+            {
+                entries.push(e);
+            }
+        }
+        entries
+    }
+}
+
 pub struct UserDictionary {
-    entries: RwLock<HashMap<String, Vec<DictEntry>>>,
+    layers: RwLock<Layers>,
 }
 
 impl UserDictionary {
     pub fn new() -> Self {
         Self {
-            entries: RwLock::new(HashMap::new()),
+            layers: RwLock::new(Layers::default()),
         }
     }
 
+    fn read(&self) -> RwLockReadGuard<'_, Layers> {
+        self.layers.read().expect("user_dict lock poisoned")
+    }
+
+    fn write(&self) -> RwLockWriteGuard<'_, Layers> {
+        self.layers.write().expect("user_dict lock poisoned")
+    }
+
     /// Register a word. Returns `true` if newly added, `false` if already exists.
     pub fn register(&self, reading: &str, surface: &str) -> bool {
-        let mut map = self.entries.write().expect("user_dict lock poisoned");
-        let entries = map.entry(reading.to_string()).or_default();
+        let mut layers = self.write();
+        if layers.base_contains(reading, surface) {
+            // Re-registering a hidden base word just lifts its tombstone.
+            let Some(surfaces) = layers.removed.get_mut(reading) else {
+                return false;
+            };
+            let restored = surfaces.remove(surface);
+            if surfaces.is_empty() {
+                layers.removed.remove(reading);
+            }
+            return restored;
+        }
+        let entries = layers.added.entry(reading.to_string()).or_default();
         if entries.iter().any(|e| e.surface == surface) {
             return false;
         }
@@ -58,54 +264,121 @@ impl UserDictionary {
 
     /// Unregister a word. Returns `true` if removed, `false` if not found.
     pub fn unregister(&self, reading: &str, surface: &str) -> bool {
-        let mut map = self.entries.write().expect("user_dict lock poisoned");
-        let Some(entries) = map.get_mut(reading) else {
-            return false;
+        let mut layers = self.write();
+        if let Some(entries) = layers.added.get_mut(reading) {
+            let before = entries.len();
+            entries.retain(|e| e.surface != surface);
+            let removed = entries.len() < before;
+            if entries.is_empty() {
+                layers.added.remove(reading);
+            }
+            if removed {
+                return true;
+            }
+        }
+        if layers.base_contains(reading, surface) {
+            return layers
+                .removed
+                .entry(reading.to_string())
+                .or_default()
+                .insert(surface.to_string());
+        }
+        false
+    }
+
+    /// Compile TSV rows (see [`parse_tsv`]) into the base layer, merging
+    /// with any existing base. Rows already in the base are updated in
+    /// place. Imported words leave the delta and lose their tombstones.
+    /// Returns the number of words that were not visible before.
+    pub fn import_tsv(&self, text: &str, defaults: ImportDefaults) -> Result<usize, io::Error> {
+        let rows = parse_tsv(text, defaults)?;
+        let mut layers = self.write();
+
+        let mut readings: Vec<(String, Vec<DictEntry>)> = match &layers.base {
+            Some(base) => base.iter().collect(),
+            None => Vec::new(),
         };
-        let before = entries.len();
-        entries.retain(|e| e.surface != surface);
-        let removed = entries.len() < before;
-        if entries.is_empty() {
-            map.remove(reading);
+        let mut index: HashMap<String, usize> = readings
+            .iter()
+            .enumerate()
+            .map(|(i, (r, _))| (r.clone(), i))
+            .collect();
+
+        let mut imported = 0;
+        for (reading, entry) in rows {
+            let visible = layers
+                .added
+                .get(&reading)
+                .is_some_and(|v| v.iter().any(|e| e.surface == entry.surface));
+            if let Some(entries) = layers.added.get_mut(&reading) {
+                entries.retain(|e| e.surface != entry.surface);
+                if entries.is_empty() {
+                    layers.added.remove(&reading);
+                }
+            }
+            let was_removed = layers
+                .removed
+                .get_mut(&reading)
+                .is_some_and(|s| s.remove(&entry.surface));
+            if layers.removed.get(&reading).is_some_and(|s| s.is_empty()) {
+                layers.removed.remove(&reading);
+            }
+
+            let i = *index.entry(reading.clone()).or_insert_with(|| {
+                readings.push((reading, Vec::new()));
+                readings.len() - 1
+            });
+            let entries = &mut readings[i].1;
+            match entries.iter_mut().find(|e| e.surface == entry.surface) {
+                Some(existing) => {
+                    *existing = entry;
+                    if was_removed {
+                        imported += 1;
+                    }
+                }
+                None => {
+                    entries.push(entry);
+                    if !visible {
+                        imported += 1;
+                    }
+                }
+            }
         }
-        removed
+
+        layers.base = Some(TrieDictionary::from_entries(readings));
+        layers.base_dirty = true;
+        Ok(imported)
     }
 
     /// List all entries as (reading, surface) pairs, sorted by reading.
     pub fn list(&self) -> Vec<(String, String)> {
-        let map = self.entries.read().expect("user_dict lock poisoned");
+        let layers = self.read();
         let mut result: Vec<(String, String)> = Vec::new();
-        for (reading, entries) in map.iter() {
+        for (reading, entries) in layers.added.iter() {
             for e in entries {
                 result.push((reading.clone(), e.surface.clone()));
             }
         }
+        if let Some(base) = &layers.base {
+            for (reading, entries) in base.iter() {
+                for e in entries {
+                    if !layers.is_removed(&reading, &e.surface) {
+                        result.push((reading.clone(), e.surface));
+                    }
+                }
+            }
+        }
         result.sort();
         result
     }
 
-    /// Serialize to bytes (LXUW format).
+    /// Serialize the delta layer to bytes (LXUW format). The base layer is
+    /// stored separately; see [`save`](Self::save).
     pub fn to_bytes(&self) -> Result<Vec<u8>, io::Error> {
-        let map = self.entries.read().expect("user_dict lock poisoned");
-        let records: Vec<UserWordRecord> = map
-            .iter()
-            .flat_map(|(reading, entries)| {
-                entries.iter().map(move |e| UserWordRecord {
-                    reading: reading.clone(),
-                    surface: e.surface.clone(),
-                })
-            })
-            .collect();
-
-        let body = bincode::serialize(&records).map_err(io::Error::other)?;
-        let mut buf = Vec::with_capacity(5 + body.len());
-        buf.extend_from_slice(MAGIC);
-        buf.push(VERSION);
-        buf.extend_from_slice(&body);
-        Ok(buf)
+        self.read().delta_bytes()
     }
 
-    /// Deserialize from bytes (LXUW format).
+    /// Deserialize the delta layer from bytes (LXUW format).
     pub fn from_bytes(bytes: &[u8]) -> Result<Self, io::Error> {
         if bytes.len() < 5 {
             return Err(io::Error::new(io::ErrorKind::InvalidData, "too short"));
@@ -113,45 +386,71 @@ impl UserDictionary {
         if &bytes[0..4] != MAGIC {
             return Err(io::Error::new(io::ErrorKind::InvalidData, "bad magic"));
         }
-        if bytes[4] != VERSION {
-            return Err(io::Error::new(
-                io::ErrorKind::InvalidData,
-                "unsupported version",
-            ));
+        let data = match bytes[4] {
+            VERSION => bincode::deserialize::<UserDictData>(&bytes[5..]),
+            VERSION_V1 => {
+                bincode::deserialize::<Vec<UserWordRecord>>(&bytes[5..]).map(|words| UserDictData {
+                    words,
+                    removed: Vec::new(),
+                })
+            }
+            _ => {
+                return Err(io::Error::new(
+                    io::ErrorKind::InvalidData,
+                    "unsupported version",
+                ))
+            }
         }
-        let records: Vec<UserWordRecord> = bincode::deserialize(&bytes[5..])
-            .map_err(|e| io::Error::new(io::ErrorKind::InvalidData, e))?;
+        .map_err(|e| io::Error::new(io::ErrorKind::InvalidData, e))?;
 
-        let mut map: HashMap<String, Vec<DictEntry>> = HashMap::new();
-        for rec in records {
-            map.entry(rec.reading)
+        let mut layers = Layers::default();
+        for rec in data.words {
+            layers
+                .added
+                .entry(rec.reading)
                 .or_default()
                 .push(make_entry(&rec.surface));
         }
+        for rec in data.removed {
+            layers
+                .removed
+                .entry(rec.reading)
+                .or_default()
+                .insert(rec.surface);
+        }
         Ok(Self {
-            entries: RwLock::new(map),
+            layers: RwLock::new(layers),
         })
     }
 
-    /// Atomic write: write to .tmp then rename.
+    /// Atomic write of the delta to `path`, plus the base layer to
+    /// [`base_path`] when an import changed it. Both are serialized under
+    /// the write lock, so concurrent saves never persist stale layers.
     pub fn save(&self, path: &Path) -> Result<(), io::Error> {
-        let bytes = self.to_bytes()?;
-        let tmp = path.with_extension("tmp");
-        if let Some(parent) = path.parent() {
-            fs::create_dir_all(parent)?;
+        let mut layers = self.write();
+        if layers.base_dirty {
+            if let Some(base) = &layers.base {
+                let base_bytes = base.to_bytes().map_err(dict_error_to_io)?;
+                write_atomic(&base_path(path), &base_bytes)?;
+            }
+            layers.base_dirty = false;
         }
-        fs::write(&tmp, &bytes)?;
-        fs::rename(&tmp, path)?;
-        Ok(())
+        write_atomic(path, &layers.delta_bytes()?)
     }
 
     /// Open from file, returning empty UserDictionary if file doesn't exist.
+    /// The base layer at [`base_path`] is memory-mapped when present.
     pub fn open(path: &Path) -> Result<Self, io::Error> {
-        match fs::read(path) {
-            Ok(bytes) => Self::from_bytes(&bytes),
-            Err(e) if e.kind() == io::ErrorKind::NotFound => Ok(Self::new()),
-            Err(e) => Err(e),
+        let dict = match fs::read(path) {
+            Ok(bytes) => Self::from_bytes(&bytes)?,
+            Err(e) if e.kind() == io::ErrorKind::NotFound => Self::new(),
+            Err(e) => return Err(e),
+        };
+        let base = base_path(path);
+        if base.exists() {
+            dict.write().base = Some(TrieDictionary::open(&base).map_err(dict_error_to_io)?);
         }
+        Ok(dict)
     }
 }
 
@@ -163,19 +462,37 @@ impl Default for UserDictionary {
 
 impl Dictionary for UserDictionary {
     fn lookup(&self, reading: &str) -> Vec<DictEntry> {
-        let map = self.entries.read().expect("user_dict lock poisoned");
-        map.get(reading).cloned().unwrap_or_default()
+        let layers = self.read();
+        let base = layers
+            .base
+            .as_ref()
+            .map(|b| b.lookup(reading))
+            .unwrap_or_default();
+        layers.merge(reading, base)
     }
 
     fn predict(&self, prefix: &str, max_results: usize) -> Vec<SearchResult> {
-        let map = self.entries.read().expect("user_dict lock poisoned");
-        let mut results: Vec<SearchResult> = map
-            .iter()
-            .filter(|(k, _)| k.starts_with(prefix))
-            .map(|(k, v)| SearchResult {
-                reading: k.clone(),
-                entries: v.clone(),
+        let layers = self.read();
+        let mut by_reading: HashMap<String, Vec<DictEntry>> = HashMap::new();
+        if let Some(base) = &layers.base {
+            // Tombstones can empty whole readings; over-fetch to compensate.
+            let limit = max_results.saturating_add(layers.removed.len());
+            for sr in base.predict(prefix, limit) {
+                by_reading.insert(sr.reading, sr.entries);
+            }
+        }
+        for reading in layers.added.keys() {
+            if reading.starts_with(prefix) {
+                by_reading.entry(reading.clone()).or_default();
+            }
+        }
+        let mut results: Vec<SearchResult> = by_reading
+            .into_iter()
+            .map(|(reading, base)| {
+                let entries = layers.merge(&reading, base);
+                SearchResult { reading, entries }
             })
+            .filter(|sr| !sr.entries.is_empty())
             .collect();
         results.sort_by(|a, b| a.reading.cmp(&b.reading));
         results.truncate(max_results);
@@ -183,24 +500,49 @@ impl Dictionary for UserDictionary {
     }
 
     fn common_prefix_search(&self, query: &str) -> Vec<SearchResult> {
-        let map = self.entries.read().expect("user_dict lock poisoned");
+        let layers = self.read();
+        let mut base: HashMap<String, Vec<DictEntry>> = layers
+            .base
+            .as_ref()
+            .map(|b| {
+                b.common_prefix_search(query)
+                    .into_iter()
+                    .map(|sr| (sr.reading, sr.entries))
+                    .collect()
+            })
+            .unwrap_or_default();
         let mut results = Vec::new();
-        // Check all prefixes of query against the HashMap
+        // Check all prefixes of query against both layers
         for end in 1..=query.len() {
             // Only split at char boundaries
             if !query.is_char_boundary(end) {
                 continue;
             }
             let prefix = &query[..end];
-            if let Some(entries) = map.get(prefix) {
+            let base_entries = base.remove(prefix).unwrap_or_default();
+            if base_entries.is_empty() && !layers.added.contains_key(prefix) {
+                continue;
+            }
+            let entries = layers.merge(prefix, base_entries);
+            if !entries.is_empty() {
                 results.push(SearchResult {
                     reading: prefix.to_string(),
-                    entries: entries.clone(),
+                    entries,
                 });
             }
         }
         results
     }
+
+    fn max_reading_len(&self) -> usize {
+        let layers = self.read();
+        let base = layers.base.as_ref().map_or(0, |b| b.max_reading_len());
+        layers
+            .added
+            .keys()
+            .map(|r| r.chars().count())
+            .fold(base, usize::max)
+    }
 }
 
 /// Flat serialization record — only (reading, surface) pairs are persisted.
@@ -210,3 +552,10 @@ struct UserWordRecord {
     reading: String,
     surface: String,
 }
+
+/// LXUW v2 body: registered words plus tombstones for hidden base words.
+#[derive(Serialize, Deserialize)]
+struct UserDictData {
+    words: Vec<UserWordRecord>,
+    removed: Vec<UserWordRecord>,
+}
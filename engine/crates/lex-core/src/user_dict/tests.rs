@@ -159,3 +159,226 @@ fn from_bytes_too_short() {
     let bytes = b"LX";
     assert!(UserDictionary::from_bytes(bytes).is_err());
 }
+
+// --- Bulk import (base layer) ---
+
+const GLOSSARY: &str = "\
+# corporate glossary
+しゅうじ\t週次
+しゅうじ\t修辞
+きょう\t今日
+きょうと\t京都\t-100
+き\t木\t\t1851
+
+かき\t柿
+";
+
+fn surfaces(entries: &[DictEntry]) -> Vec<String> {
+    let mut s: Vec<String> = entries.iter().map(|e| e.surface.clone()).collect();
+    s.sort();
+    s
+}
+
+fn search_summary(results: Vec<SearchResult>) -> Vec<(String, Vec<String>)> {
+    let mut summary: Vec<(String, Vec<String>)> = results
+        .into_iter()
+        .map(|sr| (sr.reading, surfaces(&sr.entries)))
+        .collect();
+    summary.sort();
+    summary
+}
+
+#[test]
+fn parse_tsv_columns_and_defaults() {
+    let rows = parse_tsv(GLOSSARY, ImportDefaults::default()).unwrap();
+    assert_eq!(rows.len(), 6);
+    assert_eq!(rows[0].0, "しゅうじ");
+    assert_eq!(rows[0].1.cost, USER_COST);
+    assert_eq!(rows[0].1.left_id, USER_POS_ID);
+    assert_eq!(rows[3].1.cost, -100);
+    assert_eq!(rows[4].1.cost, USER_COST);
+    assert_eq!(rows[4].1.left_id, 1851);
+    assert_eq!(rows[4].1.right_id, 1851);
+}
+
+#[test]
+fn parse_tsv_reports_line_numbers() {
+    let err = parse_tsv("かき\t柿\nbroken\n", ImportDefaults::default()).unwrap_err();
+    assert!(err.to_string().contains("line 2"), "{err}");
+    let err = parse_tsv("かき\t柿\tcheap\n", ImportDefaults::default()).unwrap_err();
+    assert!(err.to_string().contains("line 1"), "{err}");
+}
+
+#[test]
+fn import_uses_layer_defaults() {
+    let dict = UserDictionary::new();
+    let defaults = ImportDefaults {
+        cost: 500,
+        pos_id: 1900,
+    };
+    assert_eq!(dict.import_tsv("かき\t柿\n", defaults).unwrap(), 1);
+    let entries = dict.lookup("かき");
+    assert_eq!(entries[0].cost, 500);
+    assert_eq!(entries[0].left_id, 1900);
+}
+
+#[test]
+fn import_file_roundtrip() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("user_dict.lxuw");
+
+    let dict = UserDictionary::new();
+    assert_eq!(
+        dict.import_tsv(GLOSSARY, ImportDefaults::default())
+            .unwrap(),
+        6
+    );
+    // Importing the same rows again adds nothing new.
+    assert_eq!(
+        dict.import_tsv(GLOSSARY, ImportDefaults::default())
+            .unwrap(),
+        0
+    );
+    dict.register("みかん", "蜜柑");
+    dict.save(&path).unwrap();
+    assert!(base_path(&path).exists());
+
+    let loaded = UserDictionary::open(&path).unwrap();
+    assert_eq!(loaded.list(), dict.list());
+    assert_eq!(loaded.list().len(), 7);
+    let kyouto = loaded.lookup("きょうと");
+    assert_eq!(kyouto[0].surface, "京都");
+    assert_eq!(kyouto[0].cost, -100);
+}
+
+#[test]
+fn save_writes_base_and_delta_through_separate_temp_files() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("user_dict.lxuw");
+    assert_ne!(tmp_path(&path), tmp_path(&base_path(&path)));
+
+    let dict = UserDictionary::new();
+    dict.import_tsv(GLOSSARY, ImportDefaults::default())
+        .unwrap();
+    dict.register("みかん", "蜜柑");
+    dict.save(&path).unwrap();
+
+    let mut names: Vec<_> = fs::read_dir(dir.path())
+        .unwrap()
+        .map(|e| e.unwrap().file_name().into_string().unwrap())
+        .collect();
+    names.sort();
+    assert_eq!(names, ["user_dict.lxdx", "user_dict.lxuw"]);
+}
+
+#[test]
+fn import_matches_registered_lookup() {
+    let rows = parse_tsv(GLOSSARY, ImportDefaults::default()).unwrap();
+    let registered = UserDictionary::new();
+    let imported = UserDictionary::new();
+    for (reading, entry) in &rows {
+        registered.register(reading, &entry.surface);
+    }
+    // Parity needs identical costs, so drop the per-row overrides.
+    let plain: String = rows
+        .iter()
+        .map(|(r, e)| format!("{r}\t{}\n", e.surface))
+        .collect();
+    imported
+        .import_tsv(&plain, ImportDefaults::default())
+        .unwrap();
+
+    assert_eq!(registered.list(), imported.list());
+    for reading in ["しゅうじ", "きょう", "きょうと", "き", "かき", "なし"] {
+        let (a, b) = (registered.lookup(reading), imported.lookup(reading));
+        assert_eq!(surfaces(&a), surfaces(&b), "lookup {reading}");
+        assert!(a.iter().chain(&b).all(|e| e.cost == USER_COST));
+    }
+    for prefix in ["", "き", "きょう", "しゅ", "ん"] {
+        assert_eq!(
+            search_summary(registered.predict(prefix, 100)),
+            search_summary(imported.predict(prefix, 100)),
+            "predict {prefix}"
+        );
+    }
+    for query in ["きょうは", "きょうとふ", "しゅうじつ", "かきごおり", "ん"] {
+        assert_eq!(
+            search_summary(registered.common_prefix_search(query)),
+            search_summary(imported.common_prefix_search(query)),
+            "common_prefix_search {query}"
+        );
+    }
+}
+
+#[test]
+fn delta_shadows_base() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("user_dict.lxuw");
+    let dict = UserDictionary::new();
+    dict.import_tsv(GLOSSARY, ImportDefaults::default())
+        .unwrap();
+
+    // Base words count as registered.
+    assert!(!dict.register("しゅうじ", "週次"));
+
+    // Unregistering a base word hides it everywhere.
+    assert!(dict.unregister("しゅうじ", "週次"));
+    assert!(!dict.unregister("しゅうじ", "週次"));
+    assert_eq!(surfaces(&dict.lookup("しゅうじ")), vec!["修辞"]);
+    assert!(!dict.list().contains(&("しゅうじ".into(), "週次".into())));
+    let cps = dict.common_prefix_search("しゅうじつ");
+    assert_eq!(surfaces(&cps[0].entries), vec!["修辞"]);
+
+    // Hiding every surface of a reading drops it from search results.
+    assert!(dict.unregister("かき", "柿"));
+    assert!(dict.predict("か", 10).is_empty());
+    assert!(dict.common_prefix_search("かき").is_empty());
+
+    // A new delta word for a base reading comes first.
+    assert!(dict.register("きょう", "強"));
+    let kyou = dict.lookup("きょう");
+    assert_eq!(kyou[0].surface, "強");
+    assert_eq!(surfaces(&kyou), vec!["今日", "強"]);
+
+    // Tombstones persist with the delta.
+    dict.save(&path).unwrap();
+    let loaded = UserDictionary::open(&path).unwrap();
+    assert_eq!(surfaces(&loaded.lookup("しゅうじ")), vec!["修辞"]);
+    assert_eq!(loaded.list(), dict.list());
+
+    // Re-registering lifts the tombstone.
+    assert!(loaded.register("しゅうじ", "週次"));
+    assert_eq!(surfaces(&loaded.lookup("しゅうじ")), vec!["修辞", "週次"]);
+}
+
+#[test]
+fn import_absorbs_delta_and_tombstones() {
+    let dict = UserDictionary::new();
+    dict.register("かき", "柿");
+    dict.import_tsv("しゅうじ\t週次\n", ImportDefaults::default())
+        .unwrap();
+    dict.unregister("しゅうじ", "週次");
+
+    // 柿 moves from the delta to the base; 週次 becomes visible again.
+    let imported = dict
+        .import_tsv("かき\t柿\nしゅうじ\t週次\n", ImportDefaults::default())
+        .unwrap();
+    assert_eq!(imported, 1);
+    assert_eq!(dict.list().len(), 2);
+    let layers = dict.read();
+    assert!(layers.added.is_empty());
+    assert!(layers.removed.is_empty());
+}
+
+#[test]
+fn from_bytes_reads_v1() {
+    let records = vec![UserWordRecord {
+        reading: "かき".to_string(),
+        surface: "柿".to_string(),
+    }];
+    let mut bytes = MAGIC.to_vec();
+    bytes.push(VERSION_V1);
+    bytes.extend(bincode::serialize(&records).unwrap());
+    let dict = UserDictionary::from_bytes(&bytes).unwrap();
+    assert_eq!(dict.list(), vec![("かき".to_string(), "柿".to_string())]);
+}
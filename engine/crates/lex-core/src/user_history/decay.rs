@@ -0,0 +1,78 @@
+//! Fixed-point time decay for history scores.
+//!
+//! An entry last used `t` seconds ago is weighted by `H / (H + t)`, where `H`
+//! is the half-life. [`DecayTable`] evaluates that in Q32 integer arithmetic:
+//! a table of factors at whole-hour elapsed times, linearly interpolated
+//! within the hour, with an exact integer division past the table's end.
+//! Results are identical on every platform and need no float conversion.
+
+/// Fixed-point 1.0: decay factors are Q32 fractions.
+pub(crate) const DECAY_ONE: u64 = 1 << 32;
+
+/// Width of one table bucket.
+const BUCKET_SECS: u64 = 3600;
+
+/// The table spans this many half-lives; older entries take the division.
+const TABLE_HALF_LIVES: u64 = 16;
+
+/// Cap on table length (32 KiB) for very long half-lives.
+const MAX_BUCKETS: u64 = 4096;
+
+/// Shortest half-life that gets a table. Interpolating over a one-hour bucket
+/// is off by at most `(bucket / half_life)² / 4`, i.e. under 6.2e-5 from here
+/// up — less than one point on the default `max_boost`. Shorter half-lives
+/// curve too sharply within an hour and always take the division.
+const MIN_TABLE_HALF_LIFE_SECS: u64 = 64 * BUCKET_SECS;
+
+/// `history.half_life_hours` compiled into a lookup table.
+///
+/// Built once per settings load (see `parse_settings_toml`), so scoring
+/// touches neither the settings lock nor floating point.
+#[derive(Debug, Clone, Default)]
+pub struct DecayTable {
+    half_life_secs: u64,
+    /// `factors[h]`: Q32 decay after exactly `h` hours. Non-increasing.
+    factors: Vec<u64>,
+}
+
+impl DecayTable {
+    pub fn new(half_life_hours: f64) -> Self {
+        let half_life_secs = ((half_life_hours * 3600.0).round() as u64).max(1);
+        let factors = if half_life_secs >= MIN_TABLE_HALF_LIFE_SECS {
+            let buckets = (half_life_secs * TABLE_HALF_LIVES / BUCKET_SECS).min(MAX_BUCKETS);
+            (0..=buckets)
+                .map(|h| exact_factor(half_life_secs, h * BUCKET_SECS))
+                .collect()
+        } else {
+            Vec::new()
+        };
+        Self {
+            half_life_secs,
+            factors,
+        }
+    }
+
+    /// Q32 decay factor for an entry last used at `last_used`. Timestamps in
+    /// the future count as zero elapsed.
+    #[inline]
+    pub fn factor(&self, last_used: u64, now: u64) -> u64 {
+        let elapsed = now.saturating_sub(last_used);
+        let bucket = (elapsed / BUCKET_SECS) as usize;
+        match self.factors.get(bucket..bucket + 2) {
+            Some(&[a, b]) => a - (a - b) * (elapsed % BUCKET_SECS) / BUCKET_SECS,
+            _ => exact_factor(self.half_life_secs, elapsed),
+        }
+    }
+
+    /// Scale a non-negative `raw` score by the decay factor, rounding down.
+    #[inline]
+    pub fn apply(&self, raw: i64, last_used: u64, now: u64) -> i64 {
+        ((i128::from(raw) * i128::from(self.factor(last_used, now))) >> 32) as i64
+    }
+}
+
+/// `DECAY_ONE * H / (H + t)`, rounded down.
+fn exact_factor(half_life_secs: u64, elapsed: u64) -> u64 {
+    let h = u128::from(half_life_secs.max(1));
+    (u128::from(DECAY_ONE) * h / (h + u128::from(elapsed))) as u64
+}
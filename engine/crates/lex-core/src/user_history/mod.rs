@@ -3,6 +3,7 @@
 //! Records confirmed conversions and uses frequency × recency scoring to
 //! promote learned candidates in subsequent sessions.
 
+mod decay;
 mod persistence;
 #[cfg(test)]
 mod tests;
@@ -14,17 +15,28 @@ use std::time::{SystemTime, UNIX_EPOCH};
 use serde::{Deserialize, Serialize};
 
 use crate::dict::DictEntry;
-use crate::settings::settings;
+use crate::settings::{settings, HistorySettings};
+
+pub use decay::DecayTable;
 
 pub(super) const MAGIC: &[u8; 4] = b"LXUD";
 pub(super) const VERSION: u8 = 1;
 
+/// Successors kept per previous surface in the top-k successor index.
+pub const SUCCESSOR_TOP_K: usize = 8;
+
+type BigramKey = (String, String);
+
 #[derive(Clone)]
 pub struct UserHistory {
     /// reading → (surface → HistoryEntry)
     pub(super) unigrams: HashMap<String, HashMap<String, HistoryEntry>>,
     /// prev_surface → ((next_reading, next_surface) → HistoryEntry)
-    pub(super) bigrams: HashMap<String, HashMap<(String, String), HistoryEntry>>,
+    pub(super) bigrams: HashMap<String, HashMap<BigramKey, HistoryEntry>>,
+    /// prev_surface → up to `SUCCESSOR_TOP_K` bigram keys, best first.
+    /// Derived from `bigrams`; kept current by `record_at` so lookups never
+    /// scan or sort the full successor set.
+    pub(super) successors: HashMap<String, Vec<BigramKey>>,
 }
 
 #[derive(Clone)]
@@ -35,10 +47,9 @@ pub struct HistoryEntry {
 
 impl HistoryEntry {
     /// Compute boost score with time decay.
-    fn boost(&self, now: u64) -> i64 {
-        let s = settings();
-        let raw = (self.frequency as i64 * s.history.boost_per_use).min(s.history.max_boost);
-        (raw as f64 * decay(self.last_used, now)) as i64
+    fn boost(&self, hs: &HistorySettings, now: u64) -> i64 {
+        let raw = (self.frequency as i64 * hs.boost_per_use).min(hs.max_boost);
+        hs.decay.apply(raw, self.last_used, now)
     }
 }
 
@@ -73,34 +84,30 @@ pub fn now_epoch() -> u64 {
         .as_secs()
 }
 
-fn decay(last_used: u64, now: u64) -> f64 {
-    let hours = (now.saturating_sub(last_used)) as f64 / 3600.0;
-    1.0 / (1.0 + hours / settings().history.half_life_hours)
-}
-
 /// Evict lowest-score entries from a nested HashMap when exceeding capacity.
+/// Returns true if anything was evicted.
 fn evict_map<K: Clone + Eq + std::hash::Hash>(
     map: &mut HashMap<String, HashMap<K, HistoryEntry>>,
     max: usize,
+    decay: &DecayTable,
     now: u64,
-) {
+) -> bool {
     let count: usize = map.values().map(|inner| inner.len()).sum();
     if count <= max {
-        return;
+        return false;
     }
-    let mut all: Vec<(String, K, f64)> = Vec::with_capacity(count);
+    let mut all: Vec<(String, K, u64)> = Vec::with_capacity(count);
     for (outer_key, inner) in map.iter() {
         for (inner_key, entry) in inner {
-            let score = entry.frequency as f64 * decay(entry.last_used, now);
+            // u32 frequency × Q32 factor (≤ 2^32) cannot overflow.
+            let score = u64::from(entry.frequency) * decay.factor(entry.last_used, now);
             all.push((outer_key.clone(), inner_key.clone(), score));
         }
     }
     let to_remove = count - max;
     // Partial sort: partition so the lowest-score `to_remove` entries are in all[..to_remove].
     // O(n) average vs O(n log n) for a full sort.
-    all.select_nth_unstable_by(to_remove - 1, |a, b| {
-        a.2.partial_cmp(&b.2).unwrap_or(std::cmp::Ordering::Equal)
-    });
+    all.select_nth_unstable_by_key(to_remove - 1, |e| e.2);
     for (outer_key, inner_key, _) in all[..to_remove].iter() {
         if let Some(inner) = map.get_mut(outer_key) {
             inner.remove(inner_key);
@@ -109,6 +116,40 @@ fn evict_map<K: Clone + Eq + std::hash::Hash>(
             }
         }
     }
+    true
+}
+
+/// Order `top` by current boost (best first) and cap it at `SUCCESSOR_TOP_K`.
+fn rank_successors(
+    top: &mut Vec<BigramKey>,
+    inner: &HashMap<BigramKey, HistoryEntry>,
+    hs: &HistorySettings,
+    now: u64,
+) {
+    top.sort_by_cached_key(|key| {
+        std::cmp::Reverse(inner.get(key).map_or(i64::MIN, |e| e.boost(hs, now)))
+    });
+    top.truncate(SUCCESSOR_TOP_K);
+}
+
+/// Select the top-k successor keys of one previous surface from scratch.
+fn top_successor_keys(
+    inner: &HashMap<BigramKey, HistoryEntry>,
+    hs: &HistorySettings,
+    now: u64,
+) -> Vec<BigramKey> {
+    let mut scored: Vec<(i64, &BigramKey)> = inner
+        .iter()
+        .map(|(key, e)| (e.boost(hs, now), key))
+        .collect();
+    if scored.len() > SUCCESSOR_TOP_K {
+        scored.select_nth_unstable_by_key(SUCCESSOR_TOP_K - 1, |(boost, _)| {
+            std::cmp::Reverse(*boost)
+        });
+        scored.truncate(SUCCESSOR_TOP_K);
+    }
+    scored.sort_by_key(|(boost, _)| std::cmp::Reverse(*boost));
+    scored.into_iter().map(|(_, key)| key.clone()).collect()
 }
 
 impl Default for UserHistory {
@@ -122,6 +163,7 @@ impl UserHistory {
         Self {
             unigrams: HashMap::new(),
             bigrams: HashMap::new(),
+            successors: HashMap::new(),
         }
     }
 
@@ -132,6 +174,7 @@ impl UserHistory {
 
     /// Record with an explicit timestamp (for WAL replay).
     pub fn record_at(&mut self, segments: &[(String, String)], now: u64) {
+        let s = settings();
         for (reading, surface) in segments {
             let entry = self
                 .unigrams
@@ -152,29 +195,43 @@ impl UserHistory {
             let (next_reading, next_surface) = &pair[1];
 
             let key = (next_reading.clone(), next_surface.clone());
-            let entry = self
-                .bigrams
-                .entry(prev_surface.clone())
-                .or_default()
-                .entry(key)
-                .or_insert(HistoryEntry {
-                    frequency: 0,
-                    last_used: now,
-                });
+            let inner = self.bigrams.entry(prev_surface.clone()).or_default();
+            let entry = inner.entry(key.clone()).or_insert(HistoryEntry {
+                frequency: 0,
+                last_used: now,
+            });
             entry.frequency += 1;
             entry.last_used = now;
+
+            let top = self.successors.entry(prev_surface.clone()).or_default();
+            if !top.contains(&key) {
+                top.push(key);
+            }
+            rank_successors(top, inner, &s.history, now);
         }
 
-        self.evict();
+        self.evict(&s.history);
     }
 
     /// Compute unigram boost for a (reading, surface) pair.
     /// `now` should be obtained from [`now_epoch()`] once per batch operation.
     pub fn unigram_boost(&self, reading: &str, surface: &str, now: u64) -> i64 {
+        self.unigram_boost_with(&settings().history, reading, surface, now)
+    }
+
+    /// [`unigram_boost`](Self::unigram_boost) against a captured settings
+    /// snapshot, for callers scoring many entries in one pass.
+    pub fn unigram_boost_with(
+        &self,
+        hs: &HistorySettings,
+        reading: &str,
+        surface: &str,
+        now: u64,
+    ) -> i64 {
         self.unigrams
             .get(reading)
             .and_then(|inner| inner.get(surface))
-            .map_or(0, |entry| entry.boost(now))
+            .map_or(0, |entry| entry.boost(hs, now))
     }
 
     /// Compute bigram boost for (prev_surface → next_reading, next_surface).
@@ -185,12 +242,30 @@ impl UserHistory {
         next_reading: &str,
         next_surface: &str,
         now: u64,
+    ) -> i64 {
+        self.bigram_boost_with(
+            &settings().history,
+            prev_surface,
+            next_reading,
+            next_surface,
+            now,
+        )
+    }
+
+    /// [`bigram_boost`](Self::bigram_boost) against a captured settings snapshot.
+    pub fn bigram_boost_with(
+        &self,
+        hs: &HistorySettings,
+        prev_surface: &str,
+        next_reading: &str,
+        next_surface: &str,
+        now: u64,
     ) -> i64 {
         let key = (next_reading.to_string(), next_surface.to_string());
         self.bigrams
             .get(prev_surface)
             .and_then(|inner| inner.get(&key))
-            .map_or(0, |entry| entry.boost(now))
+            .map_or(0, |entry| entry.boost(hs, now))
     }
 
     /// Return successor words for a given previous surface, sorted by boost descending.
@@ -200,37 +275,94 @@ impl UserHistory {
         let Some(inner) = self.bigrams.get(prev_surface) else {
             return Vec::new();
         };
+        let s = settings();
         let mut results: Vec<(String, String, i64)> = inner
             .iter()
-            .map(|((reading, surface), entry)| (reading.clone(), surface.clone(), entry.boost(now)))
+            .map(|((reading, surface), entry)| {
+                (
+                    reading.clone(),
+                    surface.clone(),
+                    entry.boost(&s.history, now),
+                )
+            })
             .filter(|(_, _, boost)| *boost > 0)
             .collect();
         results.sort_by_key(|b| std::cmp::Reverse(b.2));
         results
     }
 
+    /// Return the best successors of `prev_surface` from the top-k index,
+    /// sorted by boost descending. Only returns entries with positive boost.
+    ///
+    /// Unlike [`bigram_successors`](Self::bigram_successors) this touches at
+    /// most `SUCCESSOR_TOP_K` entries. Membership is refreshed whenever a
+    /// bigram for `prev_surface` is recorded, so a long-idle list can differ
+    /// from a full re-sort once decay reorders entries near the cutoff.
+    pub fn top_successors(&self, prev_surface: &str, now: u64) -> Vec<(String, String, i64)> {
+        let (Some(top), Some(inner)) = (
+            self.successors.get(prev_surface),
+            self.bigrams.get(prev_surface),
+        ) else {
+            return Vec::new();
+        };
+        let s = settings();
+        let mut results: Vec<(String, String, i64)> = top
+            .iter()
+            .filter_map(|key| {
+                let boost = inner.get(key)?.boost(&s.history, now);
+                (boost > 0).then(|| (key.0.clone(), key.1.clone(), boost))
+            })
+            .collect();
+        results.sort_by_key(|b| std::cmp::Reverse(b.2));
+        results
+    }
+
     /// Return surfaces the user has previously confirmed for this reading,
     /// sorted by boost descending. Only returns entries with positive boost.
     pub fn learned_surfaces(&self, reading: &str, now: u64) -> Vec<(String, i64)> {
         let Some(inner) = self.unigrams.get(reading) else {
             return Vec::new();
         };
+        let s = settings();
         let mut results: Vec<(String, i64)> = inner
             .iter()
-            .map(|(surface, entry)| (surface.clone(), entry.boost(now)))
+            .map(|(surface, entry)| (surface.clone(), entry.boost(&s.history, now)))
             .filter(|(_, boost)| *boost > 0)
             .collect();
         results.sort_by_key(|b| std::cmp::Reverse(b.1));
         results
     }
 
+    /// Readings with confirmed conversions, most used first (summing the
+    /// frequency of every surface). Ties break by reading so the order is
+    /// stable; used to prewarm the dictionary entry cache.
+    pub fn frequent_readings(&self) -> Vec<&str> {
+        let mut readings: Vec<(u64, &str)> = self
+            .unigrams
+            .iter()
+            .map(|(reading, inner)| {
+                let uses = inner.values().map(|e| e.frequency as u64).sum();
+                (uses, reading.as_str())
+            })
+            .collect();
+        readings.sort_by(|a, b| b.0.cmp(&a.0).then(a.1.cmp(b.1)));
+        readings.into_iter().map(|(_, reading)| reading).collect()
+    }
+
     /// Reorder dictionary candidates so learned entries appear first.
     pub fn reorder_candidates(&self, reading: &str, entries: &[DictEntry]) -> Vec<DictEntry> {
         let now = now_epoch();
+        let s = settings();
         let mut with_boost: Vec<(i64, usize, &DictEntry)> = entries
             .iter()
             .enumerate()
-            .map(|(i, e)| (self.unigram_boost(reading, &e.surface, now), i, e))
+            .map(|(i, e)| {
+                (
+                    self.unigram_boost_with(&s.history, reading, &e.surface, now),
+                    i,
+                    e,
+                )
+            })
             .collect();
 
         // Boosted entries first (descending boost), then original order (ascending cost via index)
@@ -246,6 +378,8 @@ impl UserHistory {
     /// Returns true if any entries were actually removed.
     pub fn remove_entries(&mut self, segments: &[(String, String)]) -> bool {
         let mut removed = false;
+        let now = now_epoch();
+        let s = settings();
         for (reading, surface) in segments {
             if let Some(inner) = self.unigrams.get_mut(reading) {
                 if inner.remove(surface).is_some() {
@@ -266,6 +400,11 @@ impl UserHistory {
                 }
                 if inner.is_empty() {
                     self.bigrams.remove(prev_surface);
+                    self.successors.remove(prev_surface);
+                } else if let Some(top) = self.successors.get_mut(prev_surface) {
+                    if top.contains(&key) {
+                        *top = top_successor_keys(inner, &s.history, now);
+                    }
                 }
             }
         }
@@ -273,10 +412,35 @@ impl UserHistory {
     }
 
     /// Evict lowest-score entries when exceeding capacity.
-    fn evict(&mut self) {
-        let s = settings();
+    fn evict(&mut self, hs: &HistorySettings) {
         let now = now_epoch();
-        evict_map(&mut self.unigrams, s.history.max_unigrams, now);
-        evict_map(&mut self.bigrams, s.history.max_bigrams, now);
+        evict_map(&mut self.unigrams, hs.max_unigrams, &hs.decay, now);
+        if evict_map(&mut self.bigrams, hs.max_bigrams, &hs.decay, now) {
+            self.reconcile_successors(hs, now);
+        }
+    }
+
+    /// Re-select any top-k list that lost members to eviction.
+    fn reconcile_successors(&mut self, hs: &HistorySettings, now: u64) {
+        let bigrams = &self.bigrams;
+        self.successors.retain(|prev, top| {
+            let Some(inner) = bigrams.get(prev) else {
+                return false;
+            };
+            if top.iter().any(|key| !inner.contains_key(key)) {
+                *top = top_successor_keys(inner, hs, now);
+            }
+            true
+        });
+    }
+
+    /// Rebuild the whole successor index from `bigrams` (after loading).
+    pub(super) fn rebuild_successors(&mut self, now: u64) {
+        let s = settings();
+        self.successors = self
+            .bigrams
+            .iter()
+            .map(|(prev, inner)| (prev.clone(), top_successor_keys(inner, &s.history, now)))
+            .collect();
     }
 }
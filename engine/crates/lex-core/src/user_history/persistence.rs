@@ -118,6 +118,12 @@ impl UserHistory {
             );
         }
 
-        Self { unigrams, bigrams }
+        let mut history = Self {
+            unigrams,
+            bigrams,
+            successors: std::collections::HashMap::new(),
+        };
+        history.rebuild_successors(super::now_epoch());
+        history
     }
 }
@@ -1,11 +1,27 @@
+use std::collections::HashSet;
 use std::fs;
 use std::path::Path;
 
+use crate::converter::testutil::Rng;
 use crate::settings::settings;
 
+use super::decay::DECAY_ONE;
 use super::wal::HistoryWal;
 use super::*;
 
+/// Decay factor as a float, read through the fixed-point table.
+fn decay(last_used: u64, now: u64, half_life_hours: f64) -> f64 {
+    DecayTable::new(half_life_hours).factor(last_used, now) as f64 / DECAY_ONE as f64
+}
+
+/// The closed form the table approximates.
+fn float_decay(last_used: u64, now: u64, half_life_hours: f64) -> f64 {
+    let hours = (now.saturating_sub(last_used)) as f64 / 3600.0;
+    1.0 / (1.0 + hours / half_life_hours)
+}
+
+const YEAR_SECS: u64 = 365 * 24 * 3600;
+
 #[test]
 fn test_record_unigram() {
     let mut h = UserHistory::new();
@@ -109,7 +125,7 @@ fn test_no_boost_for_unrecorded() {
 fn test_decay_recent() {
     // Just recorded → decay ≈ 1.0
     let now = now_epoch();
-    let d = decay(now, now);
+    let d = decay(now, now, 168.0);
     assert!(
         (d - 1.0).abs() < 0.01,
         "recent decay should be ~1.0, got {d}"
@@ -121,7 +137,7 @@ fn test_decay_one_week_old() {
     // 1 week (168 hours) ago → decay = 1/(1+1) = 0.5
     let now = now_epoch();
     let one_week_ago = now - 168 * 3600;
-    let d = decay(one_week_ago, now);
+    let d = decay(one_week_ago, now, 168.0);
     assert!(
         (d - 0.5).abs() < 0.01,
         "1-week decay should be ~0.5, got {d}"
@@ -133,7 +149,7 @@ fn test_decay_very_old() {
     // Very old entry → decay approaches 0
     let now = now_epoch();
     let very_old = now.saturating_sub(365 * 24 * 3600);
-    let d = decay(very_old, now);
+    let d = decay(very_old, now, 168.0);
     assert!(d < 0.02, "very old decay should be near 0, got {d}");
 }
 
@@ -142,7 +158,7 @@ fn test_decay_future_timestamp() {
     // Future timestamp → saturating_sub yields 0 hours → decay = 1.0
     let now = now_epoch();
     let future = now + 3600;
-    let d = decay(future, now);
+    let d = decay(future, now, 168.0);
     assert!(
         (d - 1.0).abs() < 0.001,
         "future decay should be 1.0, got {d}"
@@ -156,14 +172,14 @@ fn test_decay_known_timestamps() {
 
     // 0 hours elapsed → decay = 1/(1+0/168) = 1.0
     assert!(
-        (decay(now, now) - 1.0).abs() < 1e-9,
+        (decay(now, now, 168.0) - 1.0).abs() < 1e-9,
         "zero elapsed: expected 1.0"
     );
 
     // Exactly 1 half-life (168 h) elapsed → decay = 1/(1+1) = 0.5
     let one_hl = now - 168 * 3600;
     assert!(
-        (decay(one_hl, now) - 0.5).abs() < 1e-9,
+        (decay(one_hl, now, 168.0) - 0.5).abs() < 1e-9,
         "one half-life: expected 0.5"
     );
 
@@ -171,7 +187,7 @@ fn test_decay_known_timestamps() {
     let two_hl = now - 336 * 3600;
     let expected = 1.0 / 3.0;
     assert!(
-        (decay(two_hl, now) - expected).abs() < 1e-9,
+        (decay(two_hl, now, 168.0) - expected).abs() < 1e-9,
         "two half-lives: expected {expected}"
     );
 
@@ -179,14 +195,14 @@ fn test_decay_known_timestamps() {
     let day_ago = now - 24 * 3600;
     let expected_day = 168.0 / 192.0;
     assert!(
-        (decay(day_ago, now) - expected_day).abs() < 1e-9,
+        (decay(day_ago, now, 168.0) - expected_day).abs() < 1e-9,
         "24h elapsed: expected {expected_day}"
     );
 
     // Future timestamp (last_used > now) → saturating_sub gives 0 → decay = 1.0
     let future = now + 9999;
     assert!(
-        (decay(future, now) - 1.0).abs() < 1e-9,
+        (decay(future, now, 168.0) - 1.0).abs() < 1e-9,
         "future timestamp: expected 1.0"
     );
 }
@@ -243,6 +259,19 @@ fn test_learned_surfaces_empty() {
     assert!(h.learned_surfaces("ゆうかい", now_epoch()).is_empty());
 }
 
+#[test]
+fn test_frequent_readings() {
+    let mut h = UserHistory::new();
+    assert!(h.frequent_readings().is_empty());
+    h.record(&[("は".into(), "は".into())]);
+    h.record(&[("きょう".into(), "今日".into())]);
+    h.record(&[("きょう".into(), "京".into())]);
+    h.record(&[("あめ".into(), "雨".into())]);
+    h.record(&[("あめ".into(), "雨".into())]);
+    h.record(&[("あめ".into(), "飴".into())]);
+    assert_eq!(h.frequent_readings(), ["あめ", "きょう", "は"]);
+}
+
 #[test]
 fn test_bigram_successors() {
     let mut h = UserHistory::new();
@@ -273,6 +302,88 @@ fn test_bigram_successors_empty_history() {
     assert!(h.bigram_successors("今日").is_empty());
 }
 
+/// Record `count` distinct successors of "A", one use each, successor `i`
+/// an hour more recent than `i - 1` so every boost is distinct.
+fn history_with_successors(count: usize) -> UserHistory {
+    let mut h = UserHistory::new();
+    let base = now_epoch();
+    for i in 0..count {
+        let at = base - (count - i) as u64 * 3600;
+        h.record_at(
+            &[
+                ("あ".into(), "A".into()),
+                (format!("r{i}"), format!("S{i}")),
+            ],
+            at,
+        );
+    }
+    h
+}
+
+#[test]
+fn test_top_successors_matches_full_sort() {
+    let h = history_with_successors(SUCCESSOR_TOP_K + 4);
+    let now = now_epoch();
+    let top = h.top_successors("A", now);
+    let full = h.bigram_successors("A");
+    assert_eq!(top.len(), SUCCESSOR_TOP_K);
+    let surfaces = |v: &[(String, String, i64)]| v.iter().map(|s| s.1.clone()).collect::<Vec<_>>();
+    assert_eq!(surfaces(&top), surfaces(&full[..SUCCESSOR_TOP_K]));
+    assert!(h.top_successors("S0", now).is_empty());
+}
+
+#[test]
+fn test_top_successors_promotes_on_record() {
+    let mut h = history_with_successors(SUCCESSOR_TOP_K + 1);
+    // S0 starts outside the top-k; enough uses push it to the front.
+    let now = now_epoch();
+    assert!(!h.top_successors("A", now).iter().any(|s| s.1 == "S0"));
+    for _ in 0..20 {
+        h.record(&[("あ".into(), "A".into()), ("r0".into(), "S0".into())]);
+    }
+    assert_eq!(h.top_successors("A", now_epoch())[0].1, "S0");
+}
+
+#[test]
+fn test_top_successors_refill_after_removal() {
+    let mut h = history_with_successors(SUCCESSOR_TOP_K + 1);
+    let best = h.top_successors("A", now_epoch())[0].clone();
+    assert!(h.remove_entries(&[("あ".into(), "A".into()), (best.0, best.1.clone())]));
+
+    let top = h.top_successors("A", now_epoch());
+    assert_eq!(top.len(), SUCCESSOR_TOP_K, "list should be refilled");
+    assert!(top.iter().all(|s| s.1 != best.1));
+    assert!(top.iter().any(|s| s.1 == "S0"));
+}
+
+#[test]
+fn test_top_successors_rebuilt_on_load() {
+    let h = history_with_successors(SUCCESSOR_TOP_K + 2);
+    let loaded = UserHistory::from_bytes(&h.to_bytes().unwrap()).unwrap();
+    let now = now_epoch();
+    assert_eq!(loaded.top_successors("A", now), h.top_successors("A", now));
+}
+
+#[test]
+fn test_top_successors_survive_eviction() {
+    let max = settings().history.max_bigrams;
+    let mut h = UserHistory::new();
+    let now = 1_700_000_000;
+    for i in 0..max + 3 {
+        h.record_at(
+            &[
+                ("あ".into(), "A".into()),
+                (format!("r{i}"), format!("S{i}")),
+            ],
+            now,
+        );
+    }
+    let inner = &h.bigrams["A"];
+    let top = &h.successors["A"];
+    assert_eq!(top.len(), SUCCESSOR_TOP_K);
+    assert!(top.iter().all(|key| inner.contains_key(key)));
+}
+
 #[test]
 fn test_save_to_invalid_path() {
     let h = UserHistory::new();
@@ -502,3 +613,100 @@ fn test_remove_entries_preserves_other_entries() {
     // "京" should still exist
     assert!(h.unigram_boost("きょう", "京", now_epoch()) > 0);
 }
+
+#[test]
+fn test_fixed_point_decay_tracks_float() {
+    let now: u64 = 1_700_000_000;
+    let mut rng = Rng(0x9e37_79b9_7f4a_7c15);
+    // Table-backed (default, long, capped) and division-only half-lives.
+    for half_life in [168.0, 64.0, 720.0, 5000.0, 24.0, 1.0, 0.25] {
+        let table = DecayTable::new(half_life);
+        let mut elapsed: Vec<u64> = (0..20_000).map(|_| rng.next() % (3 * YEAR_SECS)).collect();
+        elapsed.extend((0..2000).map(|h| h * 3600));
+        elapsed.extend((0..2000).map(|h| h * 3600 + 1800));
+        for t in elapsed {
+            let last_used = now - t;
+            let exact = float_decay(last_used, now, half_life);
+            let fixed = table.factor(last_used, now) as f64 / DECAY_ONE as f64;
+            assert!(
+                (fixed - exact).abs() < 6.2e-5,
+                "half-life {half_life}h, {t}s: {fixed} vs {exact}"
+            );
+
+            // Below one point for boosts up to the default max_boost.
+            let raw = (rng.next() % 15_001) as i64;
+            let boost = table.apply(raw, last_used, now);
+            let float_boost = (raw as f64 * exact) as i64;
+            assert!(
+                (boost - float_boost).abs() <= 1,
+                "half-life {half_life}h, {t}s, raw {raw}: {boost} vs {float_boost}"
+            );
+        }
+    }
+}
+
+#[test]
+fn test_fixed_point_decay_is_monotonic() {
+    let now: u64 = 1_700_000_000;
+    let table = DecayTable::new(168.0);
+    let mut prev = DECAY_ONE;
+    for t in (0..(168 * 20 * 3600)).step_by(97) {
+        let f = table.factor(now - t, now);
+        assert!(f <= prev, "factor rose at {t}s");
+        prev = f;
+    }
+}
+
+#[test]
+fn test_eviction_order_matches_float() {
+    let now: u64 = 1_700_000_000;
+    let hs = &settings().history;
+    let mut rng = Rng(0x2545_f491_4f6c_dd1d);
+
+    let mut map: HashMap<String, HashMap<String, HistoryEntry>> = HashMap::new();
+    let mut total = 0;
+    while total < 30_000 {
+        let reading = format!("r{}", rng.next() % 8000);
+        let surface = format!("s{}", rng.next() % 4);
+        let entry = HistoryEntry {
+            frequency: 1 + (rng.next() % 40) as u32,
+            last_used: now - rng.next() % (2 * YEAR_SECS),
+        };
+        if map
+            .entry(reading)
+            .or_default()
+            .insert(surface, entry)
+            .is_none()
+        {
+            total += 1;
+        }
+    }
+
+    // Reference: rank every entry by the float formula.
+    let score =
+        |e: &HistoryEntry| e.frequency as f64 * float_decay(e.last_used, now, hs.half_life_hours);
+    let mut ranked: Vec<(f64, String, String)> = map
+        .iter()
+        .flat_map(|(r, inner)| {
+            inner
+                .iter()
+                .map(move |(s, e)| (score(e), r.clone(), s.clone()))
+        })
+        .collect();
+    ranked.sort_by(|a, b| a.0.total_cmp(&b.0));
+
+    for max in [29_999, 20_000, 10_000, 1000] {
+        let mut evicted_map = map.clone();
+        assert!(evict_map(&mut evicted_map, max, &hs.decay, now));
+        let kept: HashSet<(&str, &str)> = evicted_map
+            .iter()
+            .flat_map(|(r, inner)| inner.keys().map(move |s| (r.as_str(), s.as_str())))
+            .collect();
+        let expected: HashSet<(&str, &str)> = ranked[total - max..]
+            .iter()
+            .map(|(_, r, s)| (r.as_str(), s.as_str()))
+            .collect();
+        assert_eq!(kept.len(), max);
+        assert!(kept == expected, "survivors differ at max = {max}");
+    }
+}
@@ -1,7 +1,6 @@
 use lex_core::candidates::CandidateResponse;
 use lex_core::converter::{ConversionContext, ConvertedSegment};
 
-use super::response::{build_marked_text, build_marked_text_and_candidates};
 use super::types::{AsyncCandidateRequest, KeyResponse, SessionState, MAX_CANDIDATES};
 use super::InputSession;
 
@@ -54,7 +53,7 @@ impl InputSession {
                 conn: self.conn.as_deref(),
                 history: h_guard.as_deref(),
             };
-            let segments = ctx.convert_from_lattice(&lattice);
+            let segments = ctx.convert_from_lattice_with_memo(&lattice, self.lattice_cache.memo());
             drop(h_guard);
 
             let surface: String = segments.iter().map(|s| s.surface.as_str()).collect();
@@ -63,7 +62,7 @@ impl InputSession {
             c.candidates.paths = vec![segments];
             c.candidates.selected = 0;
 
-            let mut resp = build_marked_text(self.comp());
+            let mut resp = self.build_marked_text();
             resp.async_request = Some(AsyncCandidateRequest {
                 reading,
                 candidate_dispatch: self.config.conversion_mode.candidate_dispatch(),
@@ -73,8 +72,7 @@ impl InputSession {
         } else {
             self.comp().candidates.clear();
         }
-        let resp = build_marked_text(self.comp());
-        resp
+        self.build_marked_text()
     }
 
     /// Receive asynchronously generated candidates and update session state.
@@ -97,12 +95,13 @@ impl InputSession {
         c.candidates.selected = 0;
         c.stability.track(&c.candidates.paths);
 
-        // Try auto-commit with fresh candidates
-        if let Some(auto_resp) = self.try_auto_commit() {
-            return Some(auto_resp);
-        }
-
-        // No auto-commit: update marked text to Viterbi #1 and show candidates
-        Some(build_marked_text_and_candidates(self.comp()))
+        // Try auto-commit with fresh candidates; otherwise update marked text
+        // to Viterbi #1 and show candidates
+        let resp = match self.try_auto_commit() {
+            Some(auto_resp) => auto_resp,
+            None => self.build_marked_text_and_candidates(),
+        };
+        self.response_buffers.track(&resp);
+        Some(resp)
     }
 }
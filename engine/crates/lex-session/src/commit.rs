@@ -69,6 +69,10 @@ impl InputSession {
             return;
         }
         let segments = self.comp().find_matching_path(&surface);
+        self.last_committed_surface = Some(match segments.as_ref().and_then(|s| s.last()) {
+            Some((_, last)) => last.clone(),
+            None => surface.clone(),
+        });
         self.history_records.push(LearningRecord::Committed {
             reading,
             surface,
@@ -79,5 +83,6 @@ impl InputSession {
     pub(super) fn reset_state(&mut self) {
         self.state = SessionState::Idle;
         self.lattice_cache.invalidate();
+        self.response_buffers.forget_shown();
     }
 }
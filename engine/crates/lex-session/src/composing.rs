@@ -1,6 +1,5 @@
 use lex_core::romaji::{convert_romaji, RomajiTrie, TrieLookupResult};
 
-use super::response::{build_marked_text, build_marked_text_and_candidates};
 use super::types::{
     is_romaji_input, Composition, KeyResponse, SessionState, MAX_COMPOSED_KANA_LENGTH,
 };
@@ -10,9 +9,13 @@ impl InputSession {
     pub(super) fn handle_composing_text(&mut self, text: &str) -> KeyResponse {
         // z-sequences: composing 中、pending + text が trie にマッチする場合
         if !self.comp().pending.is_empty() {
-            let candidate = format!("{}{}", self.comp().pending, text);
-            let trie = RomajiTrie::global();
-            match trie.lookup(&candidate) {
+            // Probe pending + text in place rather than formatting a new string.
+            let c = self.comp();
+            let len = c.pending.len();
+            c.pending.push_str(text);
+            let lookup = RomajiTrie::global().lookup(&c.pending);
+            c.pending.truncate(len);
+            match lookup {
                 TrieLookupResult::Exact(_)
                 | TrieLookupResult::ExactAndPrefix(_)
                 | TrieLookupResult::Prefix => {
@@ -32,20 +35,27 @@ impl InputSession {
                 self.make_deferred_candidates_response()
             } else {
                 self.update_candidates();
-                build_marked_text_and_candidates(self.comp())
+                self.build_marked_text_and_candidates()
             };
         }
 
         if is_romaji_input(text) {
+            let lowered;
+            let text = if text.chars().any(char::is_uppercase) {
+                lowered = text.to_lowercase();
+                lowered.as_str()
+            } else {
+                text
+            };
             // If user has selected a non-default candidate, commit it first
             let c = self.comp();
             if c.candidates.selected > 0 && c.candidates.selected < c.candidates.surfaces.len() {
                 let commit_resp = self.commit_current_state();
                 self.state = SessionState::Composing(Box::new(Composition::new()));
-                let append_resp = self.append_and_convert(&text.to_lowercase());
+                let append_resp = self.append_and_convert(text);
                 return commit_resp.with_display_from(append_resp);
             }
-            return self.append_and_convert(&text.to_lowercase());
+            return self.append_and_convert(text);
         }
 
         // Direct trie match for non-romaji chars (punctuation auto-commit)
@@ -74,7 +84,7 @@ impl InputSession {
             self.make_deferred_candidates_response()
         } else {
             self.update_candidates();
-            let resp = build_marked_text_and_candidates(self.comp());
+            let resp = self.build_marked_text_and_candidates();
             self.maybe_auto_commit(resp)
         }
     }
@@ -92,7 +102,7 @@ impl InputSession {
                 if self.comp().pending.is_empty() {
                     self.update_candidates();
                 }
-                let resp = build_marked_text_and_candidates(self.comp());
+                let resp = self.build_marked_text_and_candidates();
                 self.maybe_auto_commit(resp)
             };
             return resp.with_display_from(sub_resp);
@@ -107,14 +117,14 @@ impl InputSession {
                 self.make_deferred_candidates_response()
             } else {
                 // Pending romaji: show kana + pending, no candidates needed yet
-                build_marked_text(self.comp())
+                self.build_marked_text()
             }
         } else {
             // Sync mode: generate candidates immediately when romaji resolves
             if self.comp().pending.is_empty() {
                 self.update_candidates();
             }
-            let resp = build_marked_text_and_candidates(self.comp());
+            let resp = self.build_marked_text_and_candidates();
             self.maybe_auto_commit(resp)
         }
     }
@@ -2,7 +2,6 @@ use tracing::debug_span;
 
 use lex_core::romaji::{RomajiTrie, TrieLookupResult};
 
-use super::response::{build_candidate_selection, build_marked_text_and_candidates};
 use super::types::{
     is_romaji_input, Composition, KeyEvent, KeyResponse, LearningRecord, SessionState,
 };
@@ -31,7 +30,7 @@ impl InputSession {
                     c.candidates.surfaces.len(),
                 );
             }
-            build_candidate_selection(self.comp())
+            self.build_candidate_selection()
         } else {
             KeyResponse::consumed()
         }
@@ -40,7 +39,13 @@ impl InputSession {
     /// Process a key event. Returns a KeyResponse describing what the caller should do.
     pub fn handle_key(&mut self, event: KeyEvent) -> KeyResponse {
         let _span = debug_span!("handle_key", ?event).entered();
+        self.last_committed_surface = None;
+        let resp = self.dispatch_key(event);
+        self.response_buffers.track(&resp);
+        resp
+    }
 
+    fn dispatch_key(&mut self, event: KeyEvent) -> KeyResponse {
         // Snippet trigger: enter snippet mode (commit composing first if needed)
         if matches!(event, KeyEvent::SnippetTrigger) {
             return self.enter_snippet_mode();
@@ -180,7 +185,7 @@ impl InputSession {
                 self.make_deferred_candidates_response()
             } else {
                 self.update_candidates();
-                build_marked_text_and_candidates(self.comp())
+                self.build_marked_text_and_candidates()
             };
         }
 
@@ -212,7 +217,7 @@ impl InputSession {
         let Some(surface) = c.candidates.surfaces.get(selected).cloned() else {
             // Repair out-of-bounds selection
             c.candidates.selected = c.candidates.surfaces.len().saturating_sub(1);
-            return build_candidate_selection(self.comp());
+            return self.build_candidate_selection();
         };
         let reading = c.kana.clone();
 
@@ -251,29 +256,28 @@ impl InputSession {
             c.candidates.selected = c.candidates.surfaces.len() - 1;
         }
 
-        build_candidate_selection(self.comp())
+        self.build_candidate_selection()
     }
 
     pub(super) fn handle_backspace(&mut self) -> KeyResponse {
-        let kana_shortened = {
+        {
             let c = self.comp();
             if !c.pending.is_empty() {
                 c.pending.pop();
-                false
             } else if !c.kana.is_empty() {
+                // The lattice cache splices off the popped character.
                 c.kana.pop();
-                true
             } else if !c.prefix.is_empty() {
                 c.prefix.pop();
-                false
-            } else {
-                false
             }
-        };
-        if kana_shortened {
-            self.lattice_cache.invalidate();
         }
+        self.respond_to_edit()
+    }
 
+    /// Response after the composition was shortened or edited in place:
+    /// reset when nothing is left, otherwise redisplay and regenerate
+    /// candidates as after a keystroke.
+    pub(super) fn respond_to_edit(&mut self) -> KeyResponse {
         let c = self.comp();
         let all_empty = c.kana.is_empty() && c.pending.is_empty() && c.prefix.is_empty();
 
@@ -294,7 +298,7 @@ impl InputSession {
             self.make_deferred_candidates_response()
         } else {
             self.update_candidates();
-            let resp = build_marked_text_and_candidates(self.comp());
+            let resp = self.build_marked_text_and_candidates();
             self.maybe_auto_commit(resp)
         }
     }
@@ -1,56 +1,89 @@
 //! Incremental lattice cache used by `InputSession`.
 //!
-//! The cache keeps a single `Arc<Lattice>` keyed by the current reading so
-//! consecutive keystrokes can extend the existing lattice instead of rebuilding
-//! from scratch. When the reading no longer matches (backspace, auto-commit,
-//! prefix mismatch) the cache falls back to a fresh build.
+//! The cache keeps a single `Arc<Lattice>` keyed by the current reading, plus
+//! the Viterbi tables of its last 1-best conversion. Appends extend the cached
+//! lattice in place when no one else holds it; backspace and edits in the
+//! middle splice it. Either way the tables are carried over, so only the part
+//! of the lattice and of the Viterbi passes around the changed characters is
+//! recomputed. After `invalidate` (auto-commit, commit, hibernate) or a
+//! settings reload the next call builds afresh.
 
 use std::sync::Arc;
 
-use lex_core::converter::{build_lattice, Lattice};
+use lex_core::converter::{build_lattice_with, Lattice, ViterbiMemo};
 use lex_core::dict::Dictionary;
+use lex_core::settings::settings;
 
 pub(crate) struct LatticeCache {
     lattice: Option<Arc<Lattice>>,
+    /// Viterbi tables for `lattice`, kept in step by `get_or_build`.
+    memo: ViterbiMemo,
 }
 
 impl LatticeCache {
     pub(crate) fn new() -> Self {
-        Self { lattice: None }
+        Self {
+            lattice: None,
+            memo: ViterbiMemo::new(),
+        }
     }
 
-    /// Drop any cached lattice (called on backspace, auto-commit, etc.).
+    /// Drop any cached lattice and Viterbi tables (called on auto-commit,
+    /// commit, etc.).
     pub(crate) fn invalidate(&mut self) {
         self.lattice = None;
+        self.memo = ViterbiMemo::new();
+    }
+
+    /// Heap bytes held by the cached lattice and tables, or 0 when empty.
+    pub(crate) fn heap_bytes(&self) -> usize {
+        self.lattice.as_ref().map_or(0, |l| l.heap_bytes()) + self.memo.heap_bytes()
+    }
+
+    /// Viterbi tables for the lattice last returned by `get_or_build`.
+    pub(crate) fn memo(&mut self) -> &mut ViterbiMemo {
+        &mut self.memo
     }
 
-    /// Return a lattice for `reading`, extending the cached one when possible.
+    /// Return a lattice for `reading`, splicing the cached one when possible.
     ///
-    /// Reuses the cached lattice unchanged when `reading` matches, extends it
-    /// when `reading` is a pure suffix append, and rebuilds otherwise.
+    /// Reuses the cached lattice unchanged when `reading` matches, extends
+    /// it on an append (in place unless an async request still holds it) and
+    /// splices it otherwise; builds from scratch only when nothing is cached
+    /// or the cached lattice predates the current settings.
     pub(crate) fn get_or_build(&mut self, reading: &str, dict: &dyn Dictionary) -> Arc<Lattice> {
-        if let Some(arc) = self.lattice.take() {
-            if reading == arc.input {
-                self.lattice = Some(Arc::clone(&arc));
-                return arc;
-            }
-            if reading.starts_with(&arc.input) {
+        let current = settings();
+        let cached = self
+            .lattice
+            .take()
+            .filter(|l| Arc::ptr_eq(l.settings(), &current));
+        let lattice = match cached {
+            Some(arc) if reading == arc.input => arc,
+            Some(arc) if reading.starts_with(&arc.input) => {
                 let mut owned = Arc::try_unwrap(arc).unwrap_or_else(|shared| (*shared).clone());
-                owned.extend(dict, reading);
-                let arc = Arc::new(owned);
-                self.lattice = Some(Arc::clone(&arc));
-                return arc;
+                let edit = owned.extend(dict, reading);
+                self.memo.apply_edit(&owned, &edit);
+                Arc::new(owned)
             }
-        }
-        let arc = Arc::new(build_lattice(dict, reading));
-        self.lattice = Some(Arc::clone(&arc));
-        arc
+            Some(arc) => {
+                let (next, edit) = arc.splice(dict, reading);
+                self.memo.apply_edit(&next, &edit);
+                Arc::new(next)
+            }
+            None => {
+                self.memo.clear();
+                Arc::new(build_lattice_with(dict, reading, current))
+            }
+        };
+        self.lattice = Some(Arc::clone(&lattice));
+        lattice
     }
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use lex_core::converter::build_lattice;
     use lex_core::dict::{DictEntry, TrieDictionary};
 
     fn test_dict() -> TrieDictionary {
@@ -111,9 +144,42 @@ mod tests {
         let dict = test_dict();
         let mut cache = LatticeCache::new();
         let before = cache.get_or_build("きょう", &dict);
+        let old: Vec<_> = (0..before.node_count())
+            .map(|i| {
+                (
+                    before.start(i),
+                    before.end(i),
+                    before.surface(i).to_string(),
+                )
+            })
+            .collect();
         drop(before);
         let extended = cache.get_or_build("きょうは", &dict);
         assert_eq!(extended.input, "きょうは");
+        // Extended in place: the old nodes keep their indices.
+        for (i, node) in old.iter().enumerate() {
+            assert_eq!(
+                (extended.start(i), extended.end(i), extended.surface(i)),
+                (node.0, node.1, node.2.as_str())
+            );
+        }
+        assert!(extended.node_count() > old.len());
+    }
+
+    #[test]
+    fn mid_edit_matches_fresh_build() {
+        let dict = test_dict();
+        let mut cache = LatticeCache::new();
+        cache.get_or_build("きょうはてんき", &dict);
+        let edited = cache.get_or_build("きょうてんき", &dict);
+        let fresh = build_lattice(&dict, "きょうてんき");
+        assert_eq!(edited.node_count(), fresh.node_count());
+        for i in 0..fresh.node_count() {
+            assert_eq!(
+                (edited.start(i), edited.end(i), edited.surface(i)),
+                (fresh.start(i), fresh.end(i), fresh.surface(i))
+            );
+        }
     }
 
     #[test]
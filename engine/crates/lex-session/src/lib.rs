@@ -17,6 +17,7 @@ mod snippet_handler;
 #[cfg(test)]
 mod tests;
 
+use std::ops::Range;
 use std::sync::{Arc, RwLock};
 
 use lex_core::dict::connection::ConnectionMatrix;
@@ -30,6 +31,7 @@ pub use types::{
 };
 
 use lattice_cache::LatticeCache;
+use response::ResponseBuffers;
 use types::{Composition, SessionConfig, SessionState};
 
 /// Stateful IME session encapsulating all input processing logic.
@@ -45,6 +47,9 @@ pub struct InputSession {
     /// Incremental Viterbi-input cache, independent of the UI `Composition`.
     pub(crate) lattice_cache: LatticeCache,
 
+    /// The candidate panel last sent out.
+    response_buffers: ResponseBuffers,
+
     // History recording buffer
     history_records: Vec<LearningRecord>,
 
@@ -55,6 +60,10 @@ pub struct InputSession {
     committed_context: String,
 
     snippet_store: Option<Arc<SnippetStore>>,
+
+    /// Last word of the conversion committed by the latest key event;
+    /// cleared when the next key arrives.
+    last_committed_surface: Option<String>,
 }
 
 impl InputSession {
@@ -73,10 +82,12 @@ impl InputSession {
                 conversion_mode: ConversionMode::Standard,
             },
             lattice_cache: LatticeCache::new(),
+            response_buffers: ResponseBuffers::new(),
             history_records: Vec::new(),
             abc_passthrough: false,
             committed_context: String::new(),
             snippet_store: None,
+            last_committed_surface: None,
         }
     }
 
@@ -125,14 +136,52 @@ impl InputSession {
 
     /// Commit the current composition (called by commitComposition).
     pub fn commit(&mut self) -> KeyResponse {
-        if matches!(self.state, SessionState::Snippet(_)) {
+        self.last_committed_surface = None;
+        let resp = if matches!(self.state, SessionState::Snippet(_)) {
             // Snippet mode: cancel and go back to idle
             self.reset_state();
-            return KeyResponse::consumed()
+            KeyResponse::consumed()
                 .with_marked(String::new())
-                .with_hide_candidates();
+                .with_hide_candidates()
+        } else {
+            self.commit_current_state()
+        };
+        self.response_buffers.track(&resp);
+        resp
+    }
+
+    /// Replace the characters `range` (char positions) of the composed kana
+    /// with `text`, for edits away from the end of the composition such as
+    /// inserting or deleting after moving the cursor.
+    ///
+    /// Pending romaji is resolved first. Candidates are regenerated as after
+    /// a keystroke; the cached lattice and Viterbi tables are only recomputed
+    /// around the edit. Not consumed when not composing or when `range` is
+    /// out of bounds.
+    pub fn edit_kana(&mut self, range: Range<usize>, text: &str) -> KeyResponse {
+        if !matches!(self.state, SessionState::Composing(_)) {
+            return KeyResponse::not_consumed();
         }
-        self.commit_current_state()
+        let c = self.comp();
+        if range.start > range.end || range.end > c.flushed_char_count() {
+            return KeyResponse::not_consumed();
+        }
+        c.drain_pending(true);
+        self.last_committed_surface = None;
+        let c = self.comp();
+        let byte =
+            |kana: &str, pos: usize| kana.char_indices().nth(pos).map_or(kana.len(), |(i, _)| i);
+        let bytes = byte(&c.kana, range.start)..byte(&c.kana, range.end);
+        c.kana.replace_range(bytes, text);
+        let resp = self.respond_to_edit();
+        self.response_buffers.track(&resp);
+        resp
+    }
+
+    /// Tell the session the frontend hid its candidate panel outside of a
+    /// response, so the next list goes out as `Show` instead of `Keep`.
+    pub fn candidate_panel_hidden(&mut self) {
+        self.response_buffers.forget_shown();
     }
 
     /// Take recorded history entries, clearing the internal buffer.
@@ -141,6 +190,29 @@ impl InputSession {
         std::mem::take(&mut self.history_records)
     }
 
+    /// Surface of the word just committed, until the next key event.
+    /// This is the bigram context for zero-query next-phrase suggestions.
+    pub fn last_committed_surface(&self) -> Option<&str> {
+        self.last_committed_surface.as_deref()
+    }
+
+    /// Release per-session caches while the session sits idle.
+    ///
+    /// Drops the cached lattice and trims spare buffer capacity. Visible
+    /// state (composition, candidates, conversion context) is kept, so the
+    /// next key event behaves exactly as it would have without hibernation;
+    /// the lattice is simply rebuilt on demand.
+    pub fn hibernate(&mut self) {
+        self.lattice_cache.invalidate();
+        self.history_records.shrink_to_fit();
+        self.committed_context.shrink_to_fit();
+    }
+
+    /// Heap bytes currently held by caches that `hibernate` releases.
+    pub fn cache_bytes(&self) -> usize {
+        self.lattice_cache.heap_bytes()
+    }
+
     /// Get the accumulated committed text (conversion context).
     pub fn committed_context(&self) -> String {
         self.committed_context.clone()
@@ -1,30 +1,108 @@
-use super::types::{CandidateAction, Composition, KeyResponse};
+//! Response construction.
+//!
+//! The candidate list last sent to the frontend is remembered so an
+//! unchanged panel goes out as `CandidateAction::Keep` instead of a fresh
+//! copy. A key that only extends pending romaji then allocates once: its
+//! marked text, which is handed on to the frontend.
 
-/// Build a response showing only marked text (no candidates).
-pub(super) fn build_marked_text(comp: &Composition) -> KeyResponse {
-    KeyResponse::consumed().with_marked(comp.display_kana())
+use super::types::{
+    CandidateAction, CandidateState, Composition, KeyResponse, MarkedText, SessionState,
+};
+use super::InputSession;
+
+pub(crate) struct ResponseBuffers {
+    /// Candidate panel as the frontend currently shows it, or `None` when it
+    /// is hidden or may have moved (after a commit).
+    shown: Option<ShownCandidates>,
+}
+
+struct ShownCandidates {
+    surfaces: Vec<String>,
+    selected: u32,
 }
 
-/// Build a response showing marked text and candidate panel.
-pub(super) fn build_marked_text_and_candidates(comp: &Composition) -> KeyResponse {
-    let mut resp = KeyResponse::consumed().with_marked(comp.display_kana());
+impl ResponseBuffers {
+    pub(crate) fn new() -> Self {
+        Self { shown: None }
+    }
 
-    if !comp.candidates.is_empty() {
-        resp.candidates = CandidateAction::Show {
-            surfaces: comp.candidates.surfaces.clone(),
-            selected: comp.candidates.selected as u32,
-        };
+    /// `Show` for the current candidates, or `Keep` when the panel already
+    /// displays exactly this list and selection.
+    fn candidates(&self, state: &CandidateState) -> CandidateAction {
+        let selected = state.selected as u32;
+        match &self.shown {
+            Some(shown) if shown.selected == selected && shown.surfaces == state.surfaces => {
+                CandidateAction::Keep
+            }
+            _ => CandidateAction::Show {
+                surfaces: state.surfaces.clone(),
+                selected,
+            },
+        }
     }
 
-    resp
+    /// Forget the shown panel so the next candidate list is sent in full.
+    pub(crate) fn forget_shown(&mut self) {
+        self.shown = None;
+    }
+
+    /// Record what `resp` does to the frontend panel before it leaves the session.
+    pub(crate) fn track(&mut self, resp: &KeyResponse) {
+        match &resp.candidates {
+            CandidateAction::Show { surfaces, selected } => {
+                let shown = self.shown.get_or_insert_with(|| ShownCandidates {
+                    surfaces: Vec::new(),
+                    selected: 0,
+                });
+                shown.surfaces.clone_from(surfaces);
+                shown.selected = *selected;
+            }
+            CandidateAction::Hide => self.shown = None,
+            // The frontend repositions the panel on its next show after a commit.
+            CandidateAction::Keep if resp.commit.is_some() => self.shown = None,
+            CandidateAction::Keep => {}
+        }
+    }
 }
 
-/// Build a response for candidate selection.
-pub(super) fn build_candidate_selection(comp: &Composition) -> KeyResponse {
-    let mut resp = KeyResponse::consumed().with_marked(comp.display());
-    resp.candidates = CandidateAction::Show {
-        surfaces: comp.candidates.surfaces.clone(),
-        selected: comp.candidates.selected as u32,
-    };
-    resp
+impl InputSession {
+    fn composing(&self) -> &Composition {
+        match &self.state {
+            SessionState::Composing(c) => c,
+            _ => unreachable!("response built in non-Composing state"),
+        }
+    }
+
+    /// Build a response showing only marked text (no candidates).
+    pub(super) fn build_marked_text(&mut self) -> KeyResponse {
+        let mut resp = KeyResponse::consumed();
+        resp.marked = Some(MarkedText {
+            text: self.composing().display_kana(),
+        });
+        resp
+    }
+
+    /// Build a response showing marked text and candidate panel.
+    pub(super) fn build_marked_text_and_candidates(&mut self) -> KeyResponse {
+        let comp = self.composing();
+        let mut resp = KeyResponse::consumed();
+        resp.marked = Some(MarkedText {
+            text: comp.display_kana(),
+        });
+        if !comp.candidates.is_empty() {
+            resp.candidates = self.response_buffers.candidates(&comp.candidates);
+        }
+        resp
+    }
+
+    /// Build a response for candidate selection.
+    pub(super) fn build_candidate_selection(&mut self) -> KeyResponse {
+        let comp = self.composing();
+        let mut resp = KeyResponse::consumed();
+        resp.marked = Some(MarkedText {
+            text: comp.display(),
+        });
+        resp.candidates = self.response_buffers.candidates(&comp.candidates);
+        resp
+    }
 }
@@ -1,5 +1,6 @@
 use super::types::{
     cyclic_index, CandidateAction, KeyEvent, KeyResponse, MarkedText, SessionState, SnippetState,
+    CANDIDATE_PAGE_SIZE,
 };
 use super::InputSession;
 
@@ -30,14 +31,9 @@ impl InputSession {
             KeyResponse::consumed()
         };
 
-        let matches = store.all_entries();
-        let surfaces = snippet_surfaces(&matches);
-
-        self.state = SessionState::Snippet(SnippetState {
-            filter: String::new(),
-            matches,
-            selected: 0,
-        });
+        let snippet = SnippetState::new(store);
+        let surfaces = snippet_surfaces(&snippet);
+        self.state = SessionState::Snippet(snippet);
 
         base_resp.marked = Some(MarkedText {
             text: String::new(),
@@ -87,26 +83,23 @@ impl InputSession {
     }
 
     fn snippet_filter_append(&mut self, text: &str) -> KeyResponse {
-        let store = match &self.snippet_store {
-            Some(s) => s.clone(),
-            None => return self.snippet_cancel_passthrough(),
-        };
+        if self.snippet_store.is_none() {
+            return self.snippet_cancel_passthrough();
+        }
 
         let SessionState::Snippet(ref mut s) = self.state else {
             unreachable!();
         };
         s.filter.push_str(text);
-        s.matches = store.prefix_search(&s.filter);
-        s.selected = 0;
+        s.refilter();
 
         build_snippet_response(s)
     }
 
     fn snippet_filter_pop(&mut self) -> KeyResponse {
-        let store = match &self.snippet_store {
-            Some(s) => s.clone(),
-            None => return self.snippet_cancel_passthrough(),
-        };
+        if self.snippet_store.is_none() {
+            return self.snippet_cancel_passthrough();
+        }
 
         let SessionState::Snippet(ref mut s) = self.state else {
             unreachable!();
@@ -118,8 +111,7 @@ impl InputSession {
         }
 
         s.filter.pop();
-        s.matches = store.prefix_search(&s.filter);
-        s.selected = 0;
+        s.refilter();
 
         build_snippet_response(s)
     }
@@ -137,7 +129,7 @@ impl InputSession {
             return self.snippet_cancel();
         }
 
-        let (_key, body) = s.matches[s.selected].clone();
+        let body = s.expand(s.selected);
 
         self.committed_context.push_str(&body);
         self.reset_state();
@@ -163,7 +155,7 @@ impl InputSession {
             return KeyResponse::consumed();
         }
 
-        s.selected = cyclic_index(s.selected, delta, s.matches.len());
+        s.selected = cyclic_index(s.selected, delta, s.match_count());
 
         build_snippet_response(s)
     }
@@ -189,7 +181,7 @@ impl InputSession {
 
 fn build_snippet_response(s: &SnippetState) -> KeyResponse {
     let mut resp = KeyResponse::consumed().with_marked(s.filter.clone());
-    let surfaces = snippet_surfaces(&s.matches);
+    let surfaces = snippet_surfaces(s);
 
     if surfaces.is_empty() {
         resp.candidates = CandidateAction::Hide;
@@ -203,9 +195,21 @@ fn build_snippet_response(s: &SnippetState) -> KeyResponse {
 }
 
 /// Format snippet matches as "key\tbody" for the candidate panel.
-fn snippet_surfaces(matches: &[(String, String)]) -> Vec<String> {
-    matches
-        .iter()
-        .map(|(key, body)| format!("{}\t{}", key, body))
+///
+/// Only the page containing the selection is ever drawn, so bodies are
+/// expanded for that page alone; the other rows carry just the key, which
+/// keeps the row count (and paging) intact for the frontend.
+fn snippet_surfaces(s: &SnippetState) -> Vec<String> {
+    let page_start = s.selected / CANDIDATE_PAGE_SIZE * CANDIDATE_PAGE_SIZE;
+    let page = page_start..page_start + CANDIDATE_PAGE_SIZE;
+    (0..s.match_count())
+        .map(|i| {
+            let key = s.store.key(s.matches.start + i);
+            if page.contains(&i) {
+                format!("{}\t{}", key, s.expand(i))
+            } else {
+                key.to_string()
+            }
+        })
         .collect()
 }
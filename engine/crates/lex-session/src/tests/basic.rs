@@ -1,7 +1,9 @@
 use std::sync::{Arc, RwLock};
 
 use super::*;
-use crate::types::{cyclic_index, is_romaji_input, CandidateAction, KeyEvent, LearningRecord};
+use crate::types::{
+    cyclic_index, is_romaji_input, CandidateAction, ConversionMode, KeyEvent, LearningRecord,
+};
 use lex_core::user_history::UserHistory;
 
 // --- Basic romaji input ---
@@ -84,6 +86,94 @@ fn test_backspace_partial() {
     assert!(session.is_composing());
 }
 
+// --- Mid-composition edit ---
+
+/// A session that never auto-commits, so long readings stay composing.
+fn editing_session(defer: bool) -> InputSession {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    session.set_conversion_mode(ConversionMode::Predictive);
+    session.set_defer_candidates(defer);
+    session
+}
+
+fn surfaces_after_typing(romaji: &str, defer: bool) -> Vec<String> {
+    let mut session = editing_session(defer);
+    type_string(&mut session, romaji);
+    session.comp().candidates.surfaces.clone()
+}
+
+#[test]
+fn test_edit_kana_matches_typing_result() {
+    for defer in [false, true] {
+        let mut session = editing_session(defer);
+        type_string(&mut session, "kyouhaiitenki");
+        assert_eq!(session.comp().kana, "きょうはいいてんき");
+
+        // Delete "いい" from the middle.
+        let resp = session.edit_kana(4..6, "");
+        assert!(resp.consumed);
+        assert!(resp.marked.is_some());
+        assert_eq!(session.comp().kana, "きょうはてんき");
+        assert_eq!(
+            session.comp().candidates.surfaces,
+            surfaces_after_typing("kyouhatenki", defer),
+            "defer {defer}"
+        );
+
+        // Insert it back, then replace the head.
+        session.edit_kana(4..4, "いい");
+        assert_eq!(
+            session.comp().candidates.surfaces,
+            surfaces_after_typing("kyouhaiitenki", defer),
+            "defer {defer}"
+        );
+        session.edit_kana(0..3, "わたし");
+        assert_eq!(session.comp().kana, "わたしはいいてんき");
+        assert_eq!(
+            session.comp().candidates.surfaces,
+            surfaces_after_typing("watashihaiitenki", defer),
+            "defer {defer}"
+        );
+    }
+}
+
+#[test]
+fn test_edit_kana_flushes_pending_and_empties() {
+    let dict = make_test_dict();
+    let mut session = InputSession::new(dict.clone(), None, None);
+    type_string(&mut session, "kyoun"); // "きょう" + pending "n"
+    session.edit_kana(0..0, "は");
+    assert_eq!(session.comp().kana, "はきょうん");
+    assert!(session.comp().pending.is_empty());
+
+    // Deleting everything ends the composition like backspace does.
+    let resp = session.edit_kana(0..5, "");
+    assert!(resp.consumed);
+    assert!(!session.is_composing());
+}
+
+#[test]
+fn test_edit_kana_rejects_bad_range_and_idle() {
+    let dict = make_test_dict();
+    let mut session = InputSession::new(dict.clone(), None, None);
+    assert!(!session.edit_kana(0..0, "は").consumed);
+
+    type_string(&mut session, "kyou");
+    assert!(!session.edit_kana(2..4, "").consumed);
+    let reversed = std::ops::Range { start: 2, end: 1 };
+    assert!(!session.edit_kana(reversed, "").consumed);
+    assert_eq!(session.comp().kana, "きょう");
+
+    // A rejected edit leaves pending romaji alone; the range counts it
+    // as flushed ("きょうん").
+    type_string(&mut session, "n");
+    assert!(!session.edit_kana(0..5, "").consumed);
+    assert_eq!(session.comp().kana, "きょう");
+    assert_eq!(session.comp().pending, "n");
+    assert!(session.edit_kana(3..4, "").consumed);
+    assert_eq!(session.comp().kana, "きょう");
+}
+
 // --- Escape ---
 
 #[test]
@@ -402,6 +492,22 @@ fn test_history_recorded_on_commit() {
     assert!(!records.is_empty());
 }
 
+#[test]
+fn test_last_committed_surface_until_next_key() {
+    let dict = make_test_dict();
+    let history = UserHistory::new();
+    let mut session = InputSession::new(dict.clone(), None, Some(Arc::new(RwLock::new(history))));
+
+    assert_eq!(session.last_committed_surface(), None);
+    type_string(&mut session, "kyou");
+    assert_eq!(session.last_committed_surface(), None);
+    session.handle_key(KeyEvent::Enter);
+    assert_eq!(session.last_committed_surface(), Some("今日"));
+
+    type_string(&mut session, "k");
+    assert_eq!(session.last_committed_surface(), None);
+}
+
 #[test]
 fn test_history_not_recorded_on_escape() {
     let dict = make_test_dict();
@@ -0,0 +1,75 @@
+use super::*;
+use crate::types::CandidateAction;
+
+/// Observable parts of a response, for comparing two sessions key by key.
+fn summarize(resp: &KeyResponse) -> String {
+    let candidates = match &resp.candidates {
+        CandidateAction::Keep => "keep".to_string(),
+        CandidateAction::Hide => "hide".to_string(),
+        CandidateAction::Show { surfaces, selected } => {
+            format!("show {selected} {}", surfaces.join("|"))
+        }
+    };
+    format!(
+        "consumed={} commit={:?} marked={:?} candidates={} async={:?}",
+        resp.consumed,
+        resp.commit,
+        resp.marked.as_ref().map(|m| m.text.as_str()),
+        candidates,
+        resp.async_request.as_ref().map(|r| r.reading.as_str()),
+    )
+}
+
+fn deferred_session() -> InputSession {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    session.set_defer_candidates(true);
+    session
+}
+
+fn run(session: &mut InputSession, keys: &[KeyEvent]) -> Vec<String> {
+    keys.iter()
+        .map(|k| summarize(&session.handle_key(k.clone())))
+        .collect()
+}
+
+#[test]
+fn test_hibernate_preserves_key_handling() {
+    let prefix: Vec<KeyEvent> = "kyouha"
+        .chars()
+        .map(|c| KeyEvent::text(&c.to_string()))
+        .collect();
+    let suffix: Vec<KeyEvent> = "iitenki"
+        .chars()
+        .map(|c| KeyEvent::text(&c.to_string()))
+        .chain([KeyEvent::Backspace, KeyEvent::Space, KeyEvent::Enter])
+        .collect();
+
+    let mut awake = deferred_session();
+    let mut hibernated = deferred_session();
+    assert_eq!(run(&mut awake, &prefix), run(&mut hibernated, &prefix));
+
+    hibernated.hibernate();
+    assert_eq!(run(&mut awake, &suffix), run(&mut hibernated, &suffix));
+    assert_eq!(awake.committed_context(), hibernated.committed_context());
+}
+
+#[test]
+fn test_hibernate_frees_lattice_cache() {
+    let mut session = deferred_session();
+    assert_eq!(session.cache_bytes(), 0);
+
+    type_string(&mut session, "kyouhaiitenki");
+    let before = session.cache_bytes();
+    assert!(before > 0, "deferred composition should cache a lattice");
+
+    session.hibernate();
+    assert_eq!(session.cache_bytes(), 0);
+    assert!(
+        session.is_composing(),
+        "hibernation must keep the composition"
+    );
+
+    // The next key rebuilds the cache transparently.
+    type_string(&mut session, "ne");
+    assert!(session.cache_bytes() > 0);
+}
@@ -1,7 +1,9 @@
 mod basic;
 mod candidates;
 mod corpus;
+mod hibernate;
 mod proptest_fsm;
+mod response_buffers;
 mod simulator;
 mod snippets;
 
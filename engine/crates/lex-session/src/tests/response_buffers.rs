@@ -0,0 +1,126 @@
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+
+use super::*;
+use crate::types::CandidateAction;
+
+/// Counts heap allocations per thread, so tests running in parallel do not
+/// disturb each other's numbers.
+struct CountingAlloc;
+
+thread_local! {
+    static ALLOCATIONS: Cell<usize> = const { Cell::new(0) };
+}
+
+fn count_allocation() {
+    let _ = ALLOCATIONS.try_with(|n| n.set(n.get() + 1));
+}
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        count_allocation();
+        System.alloc(layout)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        count_allocation();
+        System.realloc(ptr, layout, new_size)
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+fn allocations_during<T>(f: impl FnOnce() -> T) -> (T, usize) {
+    let before = ALLOCATIONS.with(Cell::get);
+    let out = f();
+    (out, ALLOCATIONS.with(Cell::get) - before)
+}
+
+/// Type "kyouky", then alternate Backspace and "y" so every measured key only
+/// extends pending romaji ("k" → "ky"). Such a key allocates exactly once:
+/// the marked text, which the response hands on to the frontend. The API
+/// layer adds its event list on top when it converts the response.
+fn assert_pending_keys_allocate_marked_text_only(mut session: InputSession) {
+    type_string(&mut session, "kyouky");
+    for round in 0..3 {
+        session.handle_key(KeyEvent::Backspace);
+        assert_eq!(session.comp().pending, "k");
+
+        let key = KeyEvent::text("y");
+        let (resp, allocs) = allocations_during(|| session.handle_key(key));
+        assert_eq!(allocs, 1, "round {round}: pending-only key allocations");
+        assert_eq!(session.comp().pending, "ky");
+        assert_eq!(
+            resp.marked.as_ref().map(|m| m.text.as_str()),
+            Some("きょうky")
+        );
+        assert!(matches!(resp.candidates, CandidateAction::Keep));
+    }
+}
+
+#[test]
+fn test_pending_romaji_allocates_marked_text_only_sync() {
+    let session = InputSession::new(make_test_dict(), None, None);
+    assert_pending_keys_allocate_marked_text_only(session);
+}
+
+#[test]
+fn test_pending_romaji_allocates_marked_text_only_deferred() {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    session.set_defer_candidates(true);
+    assert_pending_keys_allocate_marked_text_only(session);
+}
+
+#[test]
+fn test_unchanged_candidates_sent_once() {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    let responses = type_string(&mut session, "kyou");
+    assert!(matches!(
+        responses.last().unwrap().candidates,
+        CandidateAction::Show { .. }
+    ));
+
+    // Pending romaji leaves the list alone: nothing to resend.
+    let resp = session.handle_key(KeyEvent::text("k"));
+    assert!(matches!(resp.candidates, CandidateAction::Keep));
+
+    // A new selection is a change.
+    let resp = session.handle_key(KeyEvent::Space);
+    assert!(matches!(
+        resp.candidates,
+        CandidateAction::Show { selected: 1, .. }
+    ));
+}
+
+#[test]
+fn test_candidates_resent_after_hide() {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    type_string(&mut session, "kyou");
+    let resp = session.handle_key(KeyEvent::Enter);
+    assert!(matches!(resp.candidates, CandidateAction::Hide));
+
+    // Same reading again: the panel was hidden, so the list must be sent.
+    let responses = type_string(&mut session, "kyou");
+    assert!(matches!(
+        responses.last().unwrap().candidates,
+        CandidateAction::Show { .. }
+    ));
+}
+
+#[test]
+fn test_candidates_resent_after_frontend_hides_panel() {
+    let mut session = InputSession::new(make_test_dict(), None, None);
+    type_string(&mut session, "kyou");
+    let resp = session.handle_key(KeyEvent::text("k"));
+    assert!(matches!(resp.candidates, CandidateAction::Keep));
+
+    // The frontend dropped the panel (e.g. on deactivation).
+    session.candidate_panel_hidden();
+    let resp = session.handle_key(KeyEvent::Backspace);
+    assert!(matches!(resp.candidates, CandidateAction::Show { .. }));
+}
@@ -227,3 +227,45 @@ fn test_snippet_no_match_shows_no_candidates() {
     assert!(!session.is_composing());
     assert!(resp.commit.is_none());
 }
+
+#[test]
+fn test_snippet_expands_only_selected_page() {
+    let mut entries = HashMap::new();
+    for i in 0..20 {
+        entries.insert(format!("k{i:02}"), format!("body {i}"));
+    }
+    let store = SnippetStore::new(entries, VariableResolver::new(HashMap::new()));
+    let dict = make_test_dict();
+    let mut session = InputSession::new(dict, None, None);
+    session.set_snippet_store(Some(Arc::new(store)));
+
+    let resp = session.handle_key(KeyEvent::SnippetTrigger);
+    match resp.candidates {
+        CandidateAction::Show { surfaces, .. } => {
+            assert_eq!(surfaces.len(), 20);
+            assert_eq!(surfaces[0], "k00\tbody 0");
+            assert_eq!(surfaces[8], "k08\tbody 8");
+            assert_eq!(surfaces[9], "k09");
+        }
+        _ => panic!("expected Show candidates"),
+    }
+
+    // Moving onto the second page expands that page instead.
+    for _ in 0..9 {
+        session.handle_key(KeyEvent::ArrowDown);
+    }
+    let resp = session.handle_key(KeyEvent::ArrowDown);
+    match resp.candidates {
+        CandidateAction::Show { surfaces, selected } => {
+            assert_eq!(selected, 10);
+            assert_eq!(surfaces[0], "k00");
+            assert_eq!(surfaces[9], "k09\tbody 9");
+            assert_eq!(surfaces[17], "k17\tbody 17");
+            assert_eq!(surfaces[18], "k18");
+        }
+        _ => panic!("expected Show candidates"),
+    }
+
+    let resp = session.handle_key(KeyEvent::Enter);
+    assert_eq!(resp.commit, Some("body 10".to_string()));
+}
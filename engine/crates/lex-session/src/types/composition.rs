@@ -1,9 +1,14 @@
+use std::ops::Range;
+use std::sync::Arc;
+
 use lex_core::candidates::{
     generate_candidates, generate_prediction_candidates, CandidateResponse,
 };
 use lex_core::converter::ConvertedSegment;
 use lex_core::dict::connection::ConnectionMatrix;
 use lex_core::dict::Dictionary;
+use lex_core::romaji::{RomajiTrie, TrieLookupResult};
+use lex_core::snippets::{ExpansionContext, SnippetStore};
 use lex_core::user_history::UserHistory;
 
 /// Pluggable conversion mode: determines how candidates are generated
@@ -54,8 +59,45 @@ pub(crate) enum SessionState {
 
 pub(crate) struct SnippetState {
     pub(crate) filter: String,
-    pub(crate) matches: Vec<(String, String)>,
+    /// Store the matches index into; pinned so a concurrent
+    /// `set_snippet_store` cannot invalidate them.
+    pub(crate) store: Arc<SnippetStore>,
+    /// Matching entries as an index range into `store`.
+    pub(crate) matches: Range<usize>,
     pub(crate) selected: usize,
+    /// Expansion context for the current filter; keeps time-based
+    /// variables stable between what is shown and what is committed.
+    pub(crate) expansion: ExpansionContext,
+}
+
+impl SnippetState {
+    pub(crate) fn new(store: Arc<SnippetStore>) -> Self {
+        let matches = store.prefix_range("");
+        let expansion = store.context();
+        Self {
+            filter: String::new(),
+            store,
+            matches,
+            selected: 0,
+            expansion,
+        }
+    }
+
+    /// Re-run the prefix search after the filter changed.
+    pub(crate) fn refilter(&mut self) {
+        self.matches = self.store.prefix_range(&self.filter);
+        self.expansion = self.store.context();
+        self.selected = 0;
+    }
+
+    pub(crate) fn match_count(&self) -> usize {
+        self.matches.len()
+    }
+
+    /// Expanded body of the `i`-th match.
+    pub(crate) fn expand(&self, i: usize) -> String {
+        self.store.expand(self.matches.start + i, &self.expansion)
+    }
 }
 
 pub(crate) struct Composition {
@@ -82,31 +124,50 @@ impl Composition {
     /// When pending romaji is present, appends it to the candidate surface so the user
     /// sees e.g. "違和感なk" rather than reverting to raw kana "いわかんなk".
     pub(crate) fn display(&self) -> String {
-        let segment = if let Some(surface) = self.candidates.surfaces.get(self.candidates.selected)
-        {
-            if self.pending.is_empty() {
-                surface.clone()
-            } else {
-                format!("{}{}", surface, self.pending)
-            }
-        } else {
-            format!("{}{}", self.kana, self.pending)
-        };
-        format!("{}{}", self.prefix.text, segment)
+        let body = self
+            .candidates
+            .surfaces
+            .get(self.candidates.selected)
+            .unwrap_or(&self.kana);
+        concat_sized(&[&self.prefix.text, body, &self.pending])
     }
 
     /// Display string without candidates (always kana + pending).
     pub(crate) fn display_kana(&self) -> String {
-        format!("{}{}{}", self.prefix.text, self.kana, self.pending)
+        concat_sized(&[&self.prefix.text, &self.kana, &self.pending])
     }
 
     /// Convert pending romaji to kana. If `force`, flush incomplete sequences.
     pub(crate) fn drain_pending(&mut self, force: bool) {
+        // Fast path: pending is still a strict prefix of some sequence, so a
+        // non-forced conversion would change nothing. Skipping it keeps keys
+        // that only extend pending romaji down to their marked-text allocation.
+        if !force
+            && !self.kana.bytes().any(|b| b.is_ascii_lowercase())
+            && matches!(
+                RomajiTrie::global().lookup(&self.pending),
+                TrieLookupResult::Prefix
+            )
+        {
+            return;
+        }
         let result = lex_core::romaji::convert_romaji(&self.kana, &self.pending, force);
         self.kana = result.composed_kana;
         self.pending = result.pending_romaji;
     }
 
+    /// Character count of `kana` once pending romaji is flushed, leaving the
+    /// composition as it is.
+    pub(crate) fn flushed_char_count(&self) -> usize {
+        if self.pending.is_empty() {
+            return self.kana.chars().count();
+        }
+        lex_core::romaji::convert_romaji(&self.kana, &self.pending, true)
+            .composed_kana
+            .chars()
+            .count()
+    }
+
     /// Flush all pending romaji (force incomplete sequences).
     pub(crate) fn flush(&mut self) {
         self.drain_pending(true);
@@ -221,3 +282,12 @@ impl FrozenPrefix {
         self.text.pop()
     }
 }
+
+/// `parts` joined into a string allocated once at its final size.
+fn concat_sized(parts: &[&str]) -> String {
+    let mut out = String::with_capacity(parts.iter().map(|p| p.len()).sum());
+    for part in parts {
+        out.push_str(part);
+    }
+    out
+}
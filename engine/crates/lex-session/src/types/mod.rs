@@ -70,6 +70,9 @@ impl KeyEvent {
 
 pub(super) const MAX_COMPOSED_KANA_LENGTH: usize = 100;
 pub(super) const MAX_CANDIDATES: usize = 20;
+/// Rows the frontend shows per candidate page (`CandidateManager.maxDisplay`).
+/// Snippet bodies are only expanded for the page holding the selection.
+pub(super) const CANDIDATE_PAGE_SIZE: usize = 9;
 
 /// Marked (composing) text.
 pub struct MarkedText {
@@ -80,7 +83,8 @@ pub struct MarkedText {
 /// Replaces the old `show_candidates` / `hide_candidates` bool pair,
 /// making the invalid combination (both true) unrepresentable.
 pub enum CandidateAction {
-    /// Leave the panel as-is (e.g. deferred mode keeping stale candidates visible).
+    /// Leave the panel as-is (e.g. deferred mode keeping stale candidates visible,
+    /// or the panel already shows exactly these candidates).
     Keep,
     /// Show or update the candidate panel with these surfaces.
     Show {
@@ -1,9 +1,14 @@
-use std::sync::Arc;
+use std::sync::{Arc, RwLock};
+
+use crate::dict::connection::ConnectionMatrix;
+use crate::dict::Dictionary;
+use crate::executor;
+use crate::user_history::UserHistory;
 
 use super::session::LexSessionEvents;
 use super::{
-    LexConnection, LexDictionary, LexError, LexSession, LexUserDictionary, LexUserHistory,
-    LexUserWord,
+    LexConnection, LexDictionary, LexError, LexSegment, LexSession, LexUserDictionary,
+    LexUserHistory, LexUserWord,
 };
 
 #[derive(uniffi::Object)]
@@ -80,4 +85,143 @@ impl LexEngine {
             None => Ok(()),
         }
     }
+
+    /// 1-best conversion of `reading`, run on the shared conversion pool.
+    ///
+    /// Requests start in submission order but run concurrently on up to four
+    /// pool threads, so they may complete in any order. The pool's queue is
+    /// unbounded; dropping the returned future before the job starts cancels
+    /// the conversion.
+    async fn convert(&self, reading: String) -> Result<Vec<LexSegment>, LexError> {
+        let (dict, conn, history) = self.resources();
+        let task = executor::shared().spawn(move || {
+            let h_guard = history.as_ref().and_then(|h| h.read().ok());
+            let segments = match h_guard.as_deref() {
+                Some(h) => {
+                    crate::converter::convert_with_history(&*dict, conn.as_deref(), h, &reading)
+                }
+                None => crate::converter::convert(&*dict, conn.as_deref(), &reading),
+            };
+            segments
+                .into_iter()
+                .map(|s| LexSegment {
+                    reading: s.reading,
+                    surface: s.surface,
+                })
+                .collect()
+        });
+        task.await.ok_or_else(|| LexError::Internal {
+            msg: "conversion panicked".to_string(),
+        })
+    }
+
+    /// Prediction candidates for `reading` (bigram-chained completions),
+    /// run on the shared conversion pool. Ordering and cancellation as for
+    /// `convert`.
+    async fn predict(&self, reading: String, max_results: u32) -> Result<Vec<String>, LexError> {
+        let (dict, conn, history) = self.resources();
+        let max_results = max_results as usize;
+        let task = executor::shared().spawn(move || {
+            let h_guard = history.as_ref().and_then(|h| h.read().ok());
+            crate::candidates::generate_prediction_candidates(
+                &*dict,
+                conn.as_deref(),
+                h_guard.as_deref(),
+                &reading,
+                max_results,
+            )
+            .surfaces
+        });
+        task.await.ok_or_else(|| LexError::Internal {
+            msg: "prediction panicked".to_string(),
+        })
+    }
+}
+
+/// Owned resources captured by pool jobs.
+type JobResources = (
+    Arc<dyn Dictionary>,
+    Option<Arc<ConnectionMatrix>>,
+    Option<Arc<RwLock<UserHistory>>>,
+);
+
+impl LexEngine {
+    fn resources(&self) -> JobResources {
+        (
+            Arc::clone(&self.dict.inner),
+            self.conn.as_ref().map(|c| Arc::clone(&c.inner)),
+            self.history.as_ref().map(|h| Arc::clone(&h.inner)),
+        )
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::dict::{DictEntry, TrieDictionary};
+    use crate::executor::block_on;
+
+    fn test_engine() -> Arc<LexEngine> {
+        let entry = |surface: &str, cost: i16, id: u16| DictEntry {
+            surface: surface.to_string(),
+            cost,
+            left_id: id,
+            right_id: id,
+        };
+        let dict = TrieDictionary::from_entries(vec![
+            (
+                "きょう".to_string(),
+                vec![entry("今日", 3000, 100), entry("京", 5000, 101)],
+            ),
+            ("は".to_string(), vec![entry("は", 2000, 200)]),
+            ("いい".to_string(), vec![entry("良い", 3500, 300)]),
+            ("てんき".to_string(), vec![entry("天気", 4000, 400)]),
+        ]);
+        let dict = Arc::new(LexDictionary {
+            inner: Arc::new(dict),
+        });
+        LexEngine::new(dict, None, None, None)
+    }
+
+    #[test]
+    fn test_convert_matches_sync_path() {
+        let engine = test_engine();
+        let segments = block_on(engine.convert("きょうはいいてんき".to_string())).unwrap();
+        let expected: Vec<LexSegment> =
+            crate::converter::convert(&*engine.dict.inner, None, "きょうはいいてんき")
+                .into_iter()
+                .map(|s| LexSegment {
+                    reading: s.reading,
+                    surface: s.surface,
+                })
+                .collect();
+        assert!(!segments.is_empty());
+        assert_eq!(segments, expected);
+    }
+
+    #[test]
+    fn test_predict_returns_candidates() {
+        let engine = test_engine();
+        let surfaces = block_on(engine.predict("きょう".to_string(), 5)).unwrap();
+        assert!(surfaces.iter().any(|s| s == "今日"));
+        assert!(surfaces.len() <= 5);
+    }
+
+    #[test]
+    fn test_concurrent_requests_resolve_independently() {
+        let engine = test_engine();
+        let readings = ["きょう", "てんき", "いい", "きょうは"];
+        let futures: Vec<_> = readings
+            .iter()
+            .map(|r| engine.convert(r.to_string()))
+            .collect();
+        // Dropping one request must not disturb the others.
+        let mut futures = futures.into_iter();
+        drop(futures.next());
+        for (reading, fut) in readings[1..].iter().zip(futures) {
+            let segments = block_on(fut).unwrap();
+            let joined: String = segments.iter().map(|s| s.reading.as_str()).collect();
+            assert_eq!(joined, *reading);
+        }
+    }
 }
@@ -42,6 +42,8 @@ impl From<LexKeyEvent> for KeyEvent {
     }
 }
 
+/// Move a session response into FFI events. Strings and candidate lists are
+/// moved, not copied; the FFI lowering makes the only copy.
 pub(super) fn convert_to_events(resp: KeyResponse) -> LexKeyResponse {
     let mut events = Vec::new();
 
@@ -61,6 +63,9 @@ pub(super) fn convert_to_events(resp: KeyResponse) -> LexKeyResponse {
             events.push(LexEvent::ShowCandidates { surfaces, selected });
         }
         CandidateAction::Hide => events.push(LexEvent::HideCandidates),
+        // The session sends `Keep` only while the frontend still shows this
+        // exact list; the frontend reports a hidden panel through
+        // `LexSession::candidate_panel_hidden`.
         CandidateAction::Keep => {}
     }
 
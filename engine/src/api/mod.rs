@@ -11,12 +11,15 @@ mod types;
 mod user_dict;
 
 pub use engine::LexEngine;
-pub use resources::{LexConnection, LexDictionary, LexUserHistory};
+pub use resources::{
+    LexConnection, LexDictionary, LexIntegrityIssue, LexResourcePaths, LexResourceTiming,
+    LexResources, LexUserHistory,
+};
 pub use session::{LexSession, LexSessionEvents};
 pub use snippet_store::LexSnippetStore;
 pub use types::{
     LexConversionMode, LexDictEntry, LexError, LexEvent, LexKeyEvent, LexKeyResponse,
-    LexRomajiConvert, LexRomajiLookup, LexSnippetEntry, LexTriggerKey, LexUserWord,
+    LexRomajiConvert, LexRomajiLookup, LexSegment, LexSnippetEntry, LexTriggerKey, LexUserWord,
 };
 pub use user_dict::LexUserDictionary;
 
@@ -72,6 +75,16 @@ fn settings_load_config(path: String) -> Result<(), LexError> {
     Ok(())
 }
 
+/// Replace the active settings with `toml` without restarting.
+///
+/// Conversions already running finish with the settings they started
+/// with; later ones use the new values. Invalid TOML leaves the current
+/// settings in place.
+#[uniffi::export]
+fn settings_apply_config(toml: String) -> Result<(), LexError> {
+    crate::settings::reload(&toml).map_err(|e| LexError::InvalidData { msg: e.to_string() })
+}
+
 #[uniffi::export]
 fn romaji_default_config() -> String {
     crate::romaji::default_toml().to_string()
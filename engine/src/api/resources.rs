@@ -1,11 +1,15 @@
 use std::path::Path;
 use std::sync::atomic::{AtomicBool, Ordering};
-use std::sync::{Arc, Mutex, RwLock};
+use std::sync::{Arc, Condvar, Mutex, RwLock};
+use std::thread;
+use std::time::{Duration, Instant};
 
-use tracing::warn;
+use tracing::{info, warn};
 
 use crate::dict::connection::ConnectionMatrix;
-use crate::dict::{CompositeDictionary, Dictionary, TrieDictionary};
+use crate::dict::{CompositeDictionary, Dictionary, EntryCache, Integrity, TrieDictionary};
+use crate::settings::settings;
+use crate::user_dict::UserDictionary;
 use crate::user_history::wal::HistoryWal;
 use crate::user_history::UserHistory;
 
@@ -20,7 +24,7 @@ pub struct LexDictionary {
 impl LexDictionary {
     #[uniffi::constructor]
     fn open(path: String) -> Result<Arc<Self>, LexError> {
-        let dict = TrieDictionary::open(Path::new(&path))?;
+        let dict = with_entry_cache(TrieDictionary::open(Path::new(&path))?);
         Ok(Arc::new(Self {
             inner: Arc::new(dict),
         }))
@@ -31,7 +35,7 @@ impl LexDictionary {
         path: String,
         user_dict: Option<Arc<LexUserDictionary>>,
     ) -> Result<Arc<Self>, LexError> {
-        let trie = TrieDictionary::open(Path::new(&path))?;
+        let trie = with_entry_cache(TrieDictionary::open(Path::new(&path))?);
 
         let inner: Arc<dyn Dictionary> = match user_dict {
             Some(ud) => {
@@ -88,11 +92,7 @@ impl LexUserHistory {
     fn open(path: String) -> Result<Arc<Self>, LexError> {
         let cp = Path::new(&path);
         let (history, wal) = crate::user_history::wal::open_with_wal(cp)?;
-        Ok(Arc::new(Self {
-            inner: Arc::new(RwLock::new(history)),
-            wal: Mutex::new(wal),
-            compacting: AtomicBool::new(false),
-        }))
+        Ok(Self::from_parts(history, wal))
     }
 
     /// Clear all learning history (in-memory + WAL + checkpoint files).
@@ -102,6 +102,14 @@ impl LexUserHistory {
 }
 
 impl LexUserHistory {
+    fn from_parts(history: UserHistory, wal: HistoryWal) -> Arc<Self> {
+        Arc::new(Self {
+            inner: Arc::new(RwLock::new(history)),
+            wal: Mutex::new(wal),
+            compacting: AtomicBool::new(false),
+        })
+    }
+
     pub(super) fn clear_impl(&self) -> Result<(), LexError> {
         {
             let mut h = self.inner.write().map_err(|e| LexError::Io {
@@ -201,6 +209,345 @@ impl LexUserHistory {
     }
 }
 
+// ---------------------------------------------------------------------------
+// Startup loading
+// ---------------------------------------------------------------------------
+
+/// File locations for [`LexResources::load`]. Optional resources are skipped
+/// when their path is `None`.
+#[derive(uniffi::Record)]
+pub struct LexResourcePaths {
+    pub dict_path: String,
+    pub conn_path: Option<String>,
+    pub user_dict_path: Option<String>,
+    pub history_path: Option<String>,
+}
+
+/// Wall-clock time spent opening one resource.
+#[derive(Clone, Debug, uniffi::Record)]
+pub struct LexResourceTiming {
+    pub resource: String,
+    pub millis: f64,
+    /// Set when the resource failed to load and was left out.
+    pub error: Option<String>,
+}
+
+/// Every engine resource opened in one call.
+///
+/// The independent files are opened concurrently, so cold start costs the
+/// slowest resource rather than the sum. Failure semantics match opening
+/// them one by one: a missing or corrupt system dictionary is an error,
+/// while the connection matrix, user dictionary and history degrade to
+/// `None` (recorded in [`timings`](Self::timings)).
+///
+/// After loading, the system dictionary and connection matrix are checked
+/// against their checksum tables on a background thread; see
+/// [`integrity`](Self::integrity).
+#[derive(uniffi::Object)]
+pub struct LexResources {
+    dictionary: Arc<LexDictionary>,
+    /// System layer of `dictionary`, kept concrete for verification.
+    trie: Arc<TrieDictionary>,
+    connection: Option<Arc<LexConnection>>,
+    user_dictionary: Option<Arc<LexUserDictionary>>,
+    history: Option<Arc<LexUserHistory>>,
+    timings: Vec<LexResourceTiming>,
+    integrity: IntegrityReport,
+}
+
+#[uniffi::export]
+impl LexResources {
+    #[uniffi::constructor]
+    fn load(paths: LexResourcePaths) -> Result<Arc<Self>, LexError> {
+        let resources = Arc::new(load_resources(&paths, true)?);
+        resources.spawn_integrity_check();
+        Ok(resources)
+    }
+
+    /// System dictionary, layered with the user dictionary when one loaded.
+    fn dictionary(&self) -> Arc<LexDictionary> {
+        Arc::clone(&self.dictionary)
+    }
+
+    fn connection(&self) -> Option<Arc<LexConnection>> {
+        self.connection.clone()
+    }
+
+    fn user_dictionary(&self) -> Option<Arc<LexUserDictionary>> {
+        self.user_dictionary.clone()
+    }
+
+    fn history(&self) -> Option<Arc<LexUserHistory>> {
+        self.history.clone()
+    }
+
+    /// Per-resource load times, in load-call order.
+    fn timings(&self) -> Vec<LexResourceTiming> {
+        self.timings.clone()
+    }
+
+    /// Integrity problems found by the background check, or `None` while it
+    /// is still running. An empty list means every checksum matched.
+    fn integrity(&self) -> Option<Vec<LexIntegrityIssue>> {
+        self.integrity.get()
+    }
+
+    /// Block until the background integrity check finishes. Call from a
+    /// background queue, never from the input path.
+    fn wait_for_integrity(&self) -> Vec<LexIntegrityIssue> {
+        self.integrity.wait()
+    }
+}
+
+struct Timed<T> {
+    value: T,
+    elapsed: Duration,
+}
+
+fn timed<T>(f: impl FnOnce() -> T) -> Timed<T> {
+    let start = Instant::now();
+    let value = f();
+    Timed {
+        value,
+        elapsed: start.elapsed(),
+    }
+}
+
+type Loaded<T> = Option<Timed<Result<T, LexError>>>;
+
+fn open_optional<T>(
+    path: Option<&str>,
+    open: impl FnOnce(&Path) -> Result<T, LexError>,
+) -> Loaded<T> {
+    path.map(|p| timed(|| open(Path::new(p))))
+}
+
+fn join<T>(handle: thread::ScopedJoinHandle<'_, T>) -> T {
+    handle
+        .join()
+        .unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+}
+
+/// Open every resource in `paths`, concurrently when `parallel` is set.
+fn load_resources(paths: &LexResourcePaths, parallel: bool) -> Result<LexResources, LexError> {
+    let open_dict =
+        || timed(|| TrieDictionary::open(Path::new(&paths.dict_path)).map_err(LexError::from));
+    let open_conn = || {
+        open_optional(paths.conn_path.as_deref(), |p| {
+            Ok(ConnectionMatrix::open(p)?)
+        })
+    };
+    let open_user_dict = || {
+        open_optional(paths.user_dict_path.as_deref(), |p| {
+            Ok(UserDictionary::open(p)?)
+        })
+    };
+    let open_history = || {
+        open_optional(paths.history_path.as_deref(), |p| {
+            Ok(crate::user_history::wal::open_with_wal(p)?)
+        })
+    };
+
+    let (dict, conn, user_dict, history) = if parallel {
+        thread::scope(|s| {
+            let conn = s.spawn(open_conn);
+            let user_dict = s.spawn(open_user_dict);
+            let history = s.spawn(open_history);
+            // The dictionary is usually the largest file; open it here
+            // rather than idling on the joins.
+            let dict = open_dict();
+            (dict, join(conn), join(user_dict), join(history))
+        })
+    } else {
+        (open_dict(), open_conn(), open_user_dict(), open_history())
+    };
+
+    let mut timings = Vec::with_capacity(4);
+    let mut record = |resource: &str, elapsed: Duration, error: Option<&LexError>| {
+        let millis = elapsed.as_secs_f64() * 1000.0;
+        match error {
+            Some(e) => warn!("{resource} failed to load after {millis:.1}ms: {e}"),
+            None => info!("{resource} loaded in {millis:.1}ms"),
+        }
+        timings.push(LexResourceTiming {
+            resource: resource.to_string(),
+            millis,
+            error: error.map(|e| e.to_string()),
+        });
+    };
+
+    record("dictionary", dict.elapsed, dict.value.as_ref().err());
+    let trie = with_entry_cache(dict.value?);
+    let connection = settle(conn, "connection", &mut record)
+        .map(|c| Arc::new(LexConnection { inner: Arc::new(c) }));
+    let user_dictionary = settle(user_dict, "user_dictionary", &mut record).map(|ud| {
+        Arc::new(LexUserDictionary {
+            inner: Arc::new(ud),
+        })
+    });
+    let history = settle(history, "history", &mut record).map(|(history, wal)| {
+        let warmed = trie.prewarm_entry_cache(history.frequent_readings());
+        info!("entry cache prewarmed with {warmed} readings from history");
+        LexUserHistory::from_parts(history, wal)
+    });
+
+    let trie = Arc::new(trie);
+
+    Ok(LexResources {
+        dictionary: layered(&trie, user_dictionary.as_ref()),
+        trie,
+        connection,
+        user_dictionary,
+        history,
+        timings,
+        integrity: IntegrityReport::default(),
+    })
+}
+
+/// `trie` serving lookups through an entry cache of
+/// `[dictionary] entry_cache_bytes`, shared by every session on it.
+fn with_entry_cache(trie: TrieDictionary) -> TrieDictionary {
+    match settings().dictionary.entry_cache_bytes {
+        0 => trie,
+        bytes => trie.with_entry_cache(Arc::new(EntryCache::new(bytes))),
+    }
+}
+
+/// `trie` as an engine dictionary, with the user dictionary layered on top.
+fn layered(
+    trie: &Arc<TrieDictionary>,
+    user_dictionary: Option<&Arc<LexUserDictionary>>,
+) -> Arc<LexDictionary> {
+    let trie_layer: Arc<dyn Dictionary> = Arc::clone(trie) as _;
+    let inner: Arc<dyn Dictionary> = match user_dictionary {
+        Some(ud) => {
+            let user_layer: Arc<dyn Dictionary> = Arc::clone(&ud.inner) as _;
+            Arc::new(CompositeDictionary::new(vec![trie_layer, user_layer]))
+        }
+        None => trie_layer,
+    };
+    Arc::new(LexDictionary { inner })
+}
+
+/// Record the timing for an optional resource and drop it on failure.
+fn settle<T>(
+    loaded: Loaded<T>,
+    resource: &str,
+    record: &mut impl FnMut(&str, Duration, Option<&LexError>),
+) -> Option<T> {
+    let Timed { value, elapsed } = loaded?;
+    record(resource, elapsed, value.as_ref().err());
+    value.ok()
+}
+
+// ---------------------------------------------------------------------------
+// Background integrity check
+// ---------------------------------------------------------------------------
+
+/// A compiled resource whose contents no longer match its checksum table.
+#[derive(Clone, Debug, uniffi::Record)]
+pub struct LexIntegrityIssue {
+    /// `"dictionary"` or `"connection"`, as in [`LexResourceTiming`].
+    pub resource: String,
+    /// Corrupt sections (e.g. `"pool"`, `"costs"`, `"checksums"`).
+    pub sections: Vec<String>,
+}
+
+/// Result slot filled in once by the verifier thread.
+#[derive(Default)]
+struct IntegrityReport {
+    issues: Mutex<Option<Vec<LexIntegrityIssue>>>,
+    done: Condvar,
+}
+
+impl IntegrityReport {
+    fn get(&self) -> Option<Vec<LexIntegrityIssue>> {
+        self.issues
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .clone()
+    }
+
+    fn wait(&self) -> Vec<LexIntegrityIssue> {
+        let guard = self
+            .issues
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        let guard = self
+            .done
+            .wait_while(guard, |issues| issues.is_none())
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        guard.clone().unwrap_or_default()
+    }
+
+    fn finish(&self, issues: Vec<LexIntegrityIssue>) {
+        *self
+            .issues
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner()) = Some(issues);
+        self.done.notify_all();
+    }
+}
+
+impl LexResources {
+    /// Verify the system dictionary and connection matrix off the startup
+    /// path. Hashing yields between 1 MiB chunks, so the thread stays out of
+    /// the way of conversion on a busy machine.
+    fn spawn_integrity_check(self: &Arc<Self>) {
+        let this = Arc::downgrade(self);
+        let trie = Arc::clone(&self.trie);
+        let conn = self.connection.as_ref().map(|c| Arc::clone(&c.inner));
+        let spawned = thread::Builder::new()
+            .name("lex-integrity".into())
+            .spawn(move || {
+                let issues = check_integrity(&trie, conn.as_deref());
+                if let Some(resources) = this.upgrade() {
+                    resources.integrity.finish(issues);
+                }
+            });
+        if let Err(e) = spawned {
+            warn!("integrity check not started: {e}");
+            self.integrity.finish(Vec::new());
+        }
+    }
+}
+
+/// Verify `trie` and `conn`. A corrupt resource stays loaded; the issue is
+/// only reported.
+fn check_integrity(
+    trie: &TrieDictionary,
+    conn: Option<&ConnectionMatrix>,
+) -> Vec<LexIntegrityIssue> {
+    let start = Instant::now();
+    let mut issues = Vec::new();
+
+    if let Integrity::Corrupt(sections) = trie.verify() {
+        issues.push(integrity_issue("dictionary", sections));
+    }
+    if let Some(Integrity::Corrupt(sections)) = conn.map(ConnectionMatrix::verify) {
+        issues.push(integrity_issue("connection", sections));
+    }
+
+    if issues.is_empty() {
+        info!(
+            "integrity check passed in {:.1}ms",
+            start.elapsed().as_secs_f64() * 1000.0
+        );
+    }
+    issues
+}
+
+fn integrity_issue(resource: &str, sections: Vec<&'static str>) -> LexIntegrityIssue {
+    warn!(
+        "{resource} failed integrity check (sections: {})",
+        sections.join(", ")
+    );
+    LexIntegrityIssue {
+        resource: resource.to_string(),
+        sections: sections.into_iter().map(str::to_string).collect(),
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -248,4 +595,201 @@ mod tests {
             "reopened history should be empty"
         );
     }
+
+    /// Write a small dictionary, matrix, user dictionary and history (with
+    /// pending WAL entries) under `dir`.
+    fn write_fixtures(dir: &Path) -> LexResourcePaths {
+        use crate::dict::DictEntry;
+
+        let entry = |surface: &str, cost: i16| DictEntry {
+            surface: surface.to_string(),
+            cost,
+            left_id: 1,
+            right_id: 1,
+        };
+        let dict_path = dir.join("lexime.dict");
+        TrieDictionary::from_entries(vec![
+            (
+                "きょう".to_string(),
+                vec![entry("今日", 3000), entry("京", 5000)],
+            ),
+            ("てんき".to_string(), vec![entry("天気", 4000)]),
+        ])
+        .save(&dict_path)
+        .unwrap();
+
+        let conn_path = dir.join("lexime.conn");
+        ConnectionMatrix::from_text("2\n0\n10\n20\n30\n")
+            .unwrap()
+            .save(&conn_path)
+            .unwrap();
+
+        let user_dict_path = dir.join("user.dict");
+        let user_dict = UserDictionary::new();
+        user_dict.register("きょう", "強");
+        user_dict.save(&user_dict_path).unwrap();
+
+        let history_path = dir.join("history.lxud");
+        let mut history = UserHistory::new();
+        history.record_at(&[("きょう".to_string(), "京".to_string())], 1000);
+        history.save(&history_path).unwrap();
+        let mut wal = HistoryWal::new(&history_path);
+        wal.append(&[("てんき".to_string(), "天気".to_string())], 2000)
+            .unwrap();
+
+        let s = |p: std::path::PathBuf| Some(p.display().to_string());
+        LexResourcePaths {
+            dict_path: dict_path.display().to_string(),
+            conn_path: s(conn_path),
+            user_dict_path: s(user_dict_path),
+            history_path: s(history_path),
+        }
+    }
+
+    #[test]
+    fn test_parallel_load_matches_sequential() {
+        let dir = tempfile::tempdir().unwrap();
+        let paths = write_fixtures(dir.path());
+
+        let seq = load_resources(&paths, false).unwrap();
+        let par = load_resources(&paths, true).unwrap();
+
+        let surfaces = |r: &LexResources, reading: &str| -> Vec<String> {
+            let mut v: Vec<String> = r
+                .dictionary()
+                .inner
+                .lookup(reading)
+                .into_iter()
+                .map(|e| e.surface)
+                .collect();
+            v.sort();
+            v
+        };
+        for reading in ["きょう", "てんき", "なし"] {
+            assert_eq!(surfaces(&seq, reading), surfaces(&par, reading));
+        }
+        assert!(surfaces(&par, "きょう").contains(&"強".to_string()));
+
+        let (c1, c2) = (seq.connection().unwrap(), par.connection().unwrap());
+        for (l, r) in [(0, 0), (0, 1), (1, 0), (1, 1)] {
+            assert_eq!(c1.inner.cost(l, r), c2.inner.cost(l, r));
+        }
+
+        assert_eq!(
+            seq.user_dictionary.unwrap().inner.list(),
+            par.user_dictionary.unwrap().inner.list()
+        );
+
+        let (h1, h2) = (seq.history.unwrap(), par.history.unwrap());
+        for reading in ["きょう", "てんき"] {
+            let a = h1.inner.read().unwrap().learned_surfaces(reading, 3000);
+            let b = h2.inner.read().unwrap().learned_surfaces(reading, 3000);
+            assert!(!a.is_empty(), "WAL/checkpoint entry for {reading} missing");
+            assert_eq!(a, b);
+        }
+
+        let names: Vec<&str> = par.timings.iter().map(|t| t.resource.as_str()).collect();
+        assert_eq!(
+            names,
+            ["dictionary", "connection", "user_dictionary", "history"]
+        );
+        assert!(par.timings.iter().all(|t| t.error.is_none()));
+    }
+
+    #[test]
+    fn test_dictionary_lookups_go_through_prewarmed_cache() {
+        let dir = tempfile::tempdir().unwrap();
+        let paths = write_fixtures(dir.path());
+        let res = load_resources(&paths, false).unwrap();
+
+        let cache = res.trie.entry_cache().expect("entry cache attached");
+        // Both history readings are in the system dictionary.
+        let warmed = cache.stats();
+        assert_eq!((warmed.values, warmed.hits, warmed.misses), (2, 0, 0));
+
+        // Through the user dictionary layer as well.
+        res.dictionary().inner.lookup("きょう");
+        res.dictionary().inner.common_prefix_search_shared("てんき");
+        assert_eq!(cache.stats().hits, 2);
+    }
+
+    #[test]
+    fn test_load_error_semantics() {
+        let dir = tempfile::tempdir().unwrap();
+        let mut paths = write_fixtures(dir.path());
+
+        // Broken optional resources degrade to None and are reported.
+        paths.conn_path = Some(dir.path().join("missing.conn").display().to_string());
+        let res = load_resources(&paths, true).unwrap();
+        assert!(res.connection().is_none());
+        assert!(res.history.is_some());
+        let conn_timing = res
+            .timings
+            .iter()
+            .find(|t| t.resource == "connection")
+            .unwrap();
+        assert!(conn_timing.error.is_some());
+
+        // Skipped resources produce no timing entry.
+        paths.conn_path = None;
+        let res = load_resources(&paths, true).unwrap();
+        assert!(res.timings.iter().all(|t| t.resource != "connection"));
+
+        // A missing system dictionary is fatal.
+        paths.dict_path = dir.path().join("missing.dict").display().to_string();
+        assert!(matches!(
+            load_resources(&paths, true),
+            Err(LexError::Io { .. })
+        ));
+    }
+
+    fn flip_byte(path: &str, at: usize) {
+        let mut bytes = std::fs::read(path).unwrap();
+        bytes[at] ^= 0x01;
+        std::fs::write(path, bytes).unwrap();
+    }
+
+    fn check(paths: &LexResourcePaths) -> (Arc<LexResources>, Vec<LexIntegrityIssue>) {
+        let res = Arc::new(load_resources(paths, true).unwrap());
+        res.spawn_integrity_check();
+        let issues = res.wait_for_integrity();
+        (res, issues)
+    }
+
+    #[test]
+    fn test_integrity_check_passes_on_clean_files() {
+        let dir = tempfile::tempdir().unwrap();
+        let paths = write_fixtures(dir.path());
+        let (res, issues) = check(&paths);
+        assert!(issues.is_empty(), "{issues:?}");
+        assert_eq!(res.integrity().map(|i| i.len()), Some(0));
+    }
+
+    #[test]
+    fn test_integrity_check_reports_corruption() {
+        let dir = tempfile::tempdir().unwrap();
+        let paths = write_fixtures(dir.path());
+
+        // First byte of the string pool: 24-byte header + trie.
+        let header = std::fs::read(&paths.dict_path).unwrap();
+        let trie_len = u32::from_ne_bytes(header[8..12].try_into().unwrap()) as usize;
+        flip_byte(&paths.dict_path, 24 + trie_len);
+        // First cost: 11-byte fixed header + 2 role bytes.
+        flip_byte(paths.conn_path.as_deref().unwrap(), 13);
+
+        let (res, issues) = check(&paths);
+        let summary: Vec<(&str, Vec<String>)> = issues
+            .iter()
+            .map(|i| (i.resource.as_str(), i.sections.clone()))
+            .collect();
+        assert_eq!(
+            summary,
+            [
+                ("dictionary", vec!["pool".to_string()]),
+                ("connection", vec!["costs".to_string()]),
+            ]
+        );
+        // Corrupt resources stay loaded; the issue is only reported.
+        assert!(res.connection().is_some());
+    }
 }
@@ -46,6 +46,12 @@ impl CandidateSink for ListenerSink {
             tracing::error!("foreign LexSessionEvents.on_async_response panicked");
         }
     }
+
+    fn idle(&self) {
+        if let Some(session) = self.session.upgrade() {
+            session.hibernate();
+        }
+    }
 }
 
 /// IME session exposed to the Swift frontend via UniFFI.
@@ -114,19 +120,21 @@ impl LexSession {
             }
         }
 
+        let events = convert_to_events(resp);
         let records = session.take_history_records();
         drop(session);
         self.record_history(&records);
-        convert_to_events(resp)
+        events
     }
 
     fn commit(&self) -> LexKeyResponse {
         let mut session = self.session.lock().unwrap();
         let resp = session.commit();
+        let events = convert_to_events(resp);
         let records = session.take_history_records();
         drop(session);
         self.record_history(&records);
-        convert_to_events(resp)
+        events
     }
 
     fn is_composing(&self) -> bool {
@@ -159,6 +167,54 @@ impl LexSession {
             .set_snippet_store(store.map(|s| Arc::clone(&s.inner)));
     }
 
+    /// Zero-query next-phrase suggestions for the word just committed, to
+    /// show before any new key is typed. Empty once the next key arrives or
+    /// when the session has no history.
+    fn next_phrase_suggestions(&self, max_results: u32) -> Vec<String> {
+        let prev = {
+            let session = self.session.lock().unwrap();
+            match session.last_committed_surface() {
+                Some(surface) => surface.to_string(),
+                None => return Vec::new(),
+            }
+        };
+        let Some(ref h) = self.history else {
+            return Vec::new();
+        };
+        let Ok(hist) = h.inner.read() else {
+            return Vec::new();
+        };
+        crate::candidates::predictive::next_phrase_suggestions(&hist, &prev, max_results as usize)
+    }
+
+    /// The frontend hid the candidate panel on its own (deactivation, a
+    /// client switch), so the next candidate list must be sent in full
+    /// rather than as "unchanged".
+    fn candidate_panel_hidden(&self) {
+        self.session.lock().unwrap().candidate_panel_hidden();
+    }
+
+    /// Release per-session caches and park the worker thread. The next key
+    /// event rebuilds both transparently; composition state is untouched.
+    fn hibernate(&self) {
+        self.session.lock().unwrap().hibernate();
+        // Taken separately from the session lock: the worker may be inside
+        // `integrate_candidate_result`, which holds session then worker.
+        if let Some(worker) = self.worker.lock().unwrap().as_ref() {
+            worker.park();
+        }
+    }
+
+    /// Hibernate automatically once the worker has been idle for `seconds`
+    /// (0 disables). The timer lives on the worker thread, so a session
+    /// that is already parked costs nothing until the next key.
+    fn set_auto_hibernate(&self, seconds: u32) {
+        let timeout = (seconds > 0).then(|| std::time::Duration::from_secs(u64::from(seconds)));
+        if let Some(worker) = self.worker.lock().unwrap().as_ref() {
+            worker.set_idle_timeout(timeout);
+        }
+    }
+
     /// Stop the async worker thread eagerly. Called by the Swift side on
     /// IMKInputController teardown to guarantee the worker is joined before
     /// the last Arc to `LexSession` is dropped.
@@ -188,10 +244,11 @@ impl LexSession {
                 worker.submit_candidates(req.reading, req.candidate_dispatch, req.lattice);
             }
         }
+        let events = convert_to_events(resp);
         let records = session.take_history_records();
         drop(session);
         self.record_history(&records);
-        Some(convert_to_events(resp))
+        Some(events)
     }
 
     fn record_history(&self, records: &[LearningRecord]) {
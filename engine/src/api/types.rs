@@ -15,6 +15,12 @@ pub struct LexDictEntry {
     pub cost: i16,
 }
 
+#[derive(Debug, PartialEq, uniffi::Record)]
+pub struct LexSegment {
+    pub reading: String,
+    pub surface: String,
+}
+
 #[derive(uniffi::Record)]
 pub struct LexUserWord {
     pub reading: String,
@@ -1,6 +1,7 @@
 use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::{mpsc, Arc, Mutex, RwLock};
 use std::thread;
+use std::time::Duration;
 
 use crate::candidates::CandidateResponse;
 use crate::dict::connection::ConnectionMatrix;
@@ -30,6 +31,10 @@ pub(crate) struct CandidateResult {
 /// dispatched to another thread from inside the sink.
 pub(crate) trait CandidateSink: Send + Sync + 'static {
     fn deliver(&self, result: CandidateResult);
+
+    /// Called on the worker thread when no work arrived for the configured
+    /// idle timeout. The worker keeps running unless the sink parks it.
+    fn idle(&self) {}
 }
 
 // ---------------------------------------------------------------------------
@@ -45,12 +50,17 @@ pub(crate) struct AsyncWorker {
     sink: Arc<dyn CandidateSink>,
 
     candidate_gen: Arc<AtomicU64>,
+    /// Idle timeout in milliseconds before `CandidateSink::idle` fires;
+    /// 0 disables it. Read by the worker on every wait.
+    idle_timeout_ms: Arc<AtomicU64>,
     inner: Mutex<WorkerInner>,
 }
 
 struct WorkerInner {
     tx: Option<mpsc::Sender<CandidateWork>>,
     thread_handle: Option<thread::JoinHandle<()>>,
+    /// Threads let go by `park`, still to be joined by `Drop`.
+    parked: Vec<thread::JoinHandle<()>>,
 }
 
 impl AsyncWorker {
@@ -66,9 +76,11 @@ impl AsyncWorker {
             history,
             sink,
             candidate_gen: Arc::new(AtomicU64::new(0)),
+            idle_timeout_ms: Arc::new(AtomicU64::new(0)),
             inner: Mutex::new(WorkerInner {
                 tx: None,
                 thread_handle: None,
+                parked: Vec::new(),
             }),
         }
     }
@@ -91,14 +103,17 @@ impl AsyncWorker {
             let history = self.history.clone();
             let sink = Arc::clone(&self.sink);
             let gen_ref = Arc::clone(&self.candidate_gen);
+            let idle_ref = Arc::clone(&self.idle_timeout_ms);
             let handle = thread::Builder::new()
                 .name("lexime-candidates".into())
                 .spawn(move || {
-                    candidate_worker(rx, sink, gen_ref, dict, conn, history);
+                    candidate_worker(rx, sink, gen_ref, idle_ref, dict, conn, history);
                 })
                 .expect("failed to spawn candidate worker");
             inner.tx = Some(tx);
             inner.thread_handle = Some(handle);
+            // Reap parked threads that have already exited.
+            inner.parked.retain(|h| !h.is_finished());
         }
         if let Some(ref tx) = inner.tx {
             let _ = tx.send(CandidateWork {
@@ -113,14 +128,45 @@ impl AsyncWorker {
     pub fn invalidate_candidates(&self) {
         self.candidate_gen.fetch_add(1, Ordering::SeqCst);
     }
+
+    /// Fire `CandidateSink::idle` after `timeout` without work (`None` disables).
+    pub fn set_idle_timeout(&self, timeout: Option<Duration>) {
+        let ms = timeout.map_or(0, |t| (t.as_millis() as u64).max(1));
+        self.idle_timeout_ms.store(ms, Ordering::SeqCst);
+    }
+
+    /// Whether a worker thread is currently running.
+    pub fn is_running(&self) -> bool {
+        self.inner.lock().unwrap().tx.is_some()
+    }
+
+    /// Let the worker thread exit, releasing its stack. The next
+    /// `submit_candidates` lazily spawns a fresh one.
+    ///
+    /// This does not join: the caller may hold the session's worker lock,
+    /// which a thread mid-`deliver` can be waiting on. The handle is kept and
+    /// joined by `Drop`, so a parked thread never outlives the worker. Work
+    /// already queued is still delivered before the old thread exits.
+    pub fn park(&self) {
+        let mut inner = self.inner.lock().unwrap();
+        inner.tx.take();
+        if let Some(handle) = inner.thread_handle.take() {
+            inner.parked.push(handle);
+        }
+    }
 }
 
 impl Drop for AsyncWorker {
     fn drop(&mut self) {
         // Drop the sender first so the worker thread's recv() returns Err and exits.
-        let mut inner = self.inner.lock().unwrap();
-        inner.tx.take();
-        if let Some(handle) = inner.thread_handle.take() {
+        let handles: Vec<_> = {
+            let mut inner = self.inner.lock().unwrap();
+            inner.tx.take();
+            let mut handles = std::mem::take(&mut inner.parked);
+            handles.extend(inner.thread_handle.take());
+            handles
+        };
+        for handle in handles {
             // The last strong Arc<LexSession> can be dropped on the worker
             // thread itself: deliver() upgrades the Weak while Swift releases
             // its handle concurrently. Joining our own thread would deadlock
@@ -140,11 +186,12 @@ fn candidate_worker(
     rx: mpsc::Receiver<CandidateWork>,
     sink: Arc<dyn CandidateSink>,
     gen: Arc<AtomicU64>,
+    idle_timeout_ms: Arc<AtomicU64>,
     dict: Arc<dyn Dictionary>,
     conn: Option<Arc<ConnectionMatrix>>,
     history: Option<Arc<RwLock<UserHistory>>>,
 ) {
-    while let Ok(work) = rx.recv() {
+    while let Some(work) = next_work(&rx, &*sink, &idle_timeout_ms) {
         // Drain: if multiple work items queued, skip to latest
         let mut latest = work;
         while let Ok(newer) = rx.try_recv() {
@@ -225,6 +272,30 @@ fn candidate_worker(
     }
 }
 
+/// Block for the next work item, notifying the sink whenever the idle
+/// timeout elapses. Returns `None` once every sender has been dropped.
+fn next_work(
+    rx: &mpsc::Receiver<CandidateWork>,
+    sink: &dyn CandidateSink,
+    idle_timeout_ms: &AtomicU64,
+) -> Option<CandidateWork> {
+    loop {
+        let ms = idle_timeout_ms.load(Ordering::SeqCst);
+        if ms == 0 {
+            return rx.recv().ok();
+        }
+        match rx.recv_timeout(Duration::from_millis(ms)) {
+            Ok(work) => return Some(work),
+            Err(mpsc::RecvTimeoutError::Disconnected) => return None,
+            Err(mpsc::RecvTimeoutError::Timeout) => {
+                if std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| sink.idle())).is_err() {
+                    tracing::error!("candidate worker: CandidateSink::idle panicked");
+                }
+            }
+        }
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -284,7 +355,10 @@ mod tests {
         let worker = thread::spawn({
             let gen = Arc::clone(&gen);
             let history = Arc::clone(&history);
-            move || candidate_worker(rx, sink, gen, dict, None, Some(history))
+            move || {
+                let idle = Arc::new(AtomicU64::new(0));
+                candidate_worker(rx, sink, gen, idle, dict, None, Some(history))
+            }
         });
 
         let work_gen = gen.fetch_add(1, Ordering::SeqCst) + 1;
@@ -311,4 +385,101 @@ mod tests {
         drop(tx);
         worker.join().unwrap();
     }
+
+    /// An idle worker notifies its sink; parking from inside the callback
+    /// lets the thread exit, and the next submit spawns a fresh one.
+    #[test]
+    fn idle_worker_parks_and_respawns() {
+        struct IdleSink {
+            worker: Mutex<Option<std::sync::Weak<AsyncWorker>>>,
+            idle: mpsc::Sender<()>,
+            delivered: mpsc::Sender<String>,
+        }
+        impl CandidateSink for IdleSink {
+            fn deliver(&self, result: CandidateResult) {
+                let _ = self.delivered.send(result.reading);
+            }
+            fn idle(&self) {
+                let worker = self
+                    .worker
+                    .lock()
+                    .unwrap()
+                    .as_ref()
+                    .and_then(|w| w.upgrade());
+                if let Some(worker) = worker {
+                    worker.park();
+                }
+                let _ = self.idle.send(());
+            }
+        }
+
+        let (idle_tx, idle_rx) = mpsc::channel();
+        let (delivered_tx, delivered_rx) = mpsc::channel();
+        let sink = Arc::new(IdleSink {
+            worker: Mutex::new(None),
+            idle: idle_tx,
+            delivered: delivered_tx,
+        });
+        let dict: Arc<dyn crate::dict::Dictionary> =
+            Arc::new(crate::dict::TrieDictionary::from_entries(std::iter::empty()));
+        let worker = Arc::new(AsyncWorker::new(
+            dict,
+            None,
+            None,
+            Arc::clone(&sink) as Arc<dyn CandidateSink>,
+        ));
+        *sink.worker.lock().unwrap() = Some(Arc::downgrade(&worker));
+        worker.set_idle_timeout(Some(Duration::from_millis(20)));
+
+        let timeout = Duration::from_secs(2);
+        for reading in ["きょう", "てんき"] {
+            worker.submit_candidates(reading.to_string(), CandidateDispatch::Standard, None);
+            assert_eq!(delivered_rx.recv_timeout(timeout).unwrap(), reading);
+            idle_rx.recv_timeout(timeout).expect("idle never fired");
+            assert!(
+                !worker.is_running(),
+                "idle sink should have parked the worker"
+            );
+        }
+    }
+
+    /// A parked thread is still joined when the worker is dropped, so it
+    /// cannot run sink callbacks after `LexSession::shutdown` returns.
+    #[test]
+    fn drop_joins_parked_worker() {
+        struct SlowSink {
+            started: mpsc::Sender<()>,
+            finished: Arc<std::sync::atomic::AtomicBool>,
+        }
+        impl CandidateSink for SlowSink {
+            fn deliver(&self, _result: CandidateResult) {
+                let _ = self.started.send(());
+                thread::sleep(Duration::from_millis(100));
+                self.finished.store(true, Ordering::SeqCst);
+            }
+        }
+
+        let (started_tx, started_rx) = mpsc::channel();
+        let finished = Arc::new(std::sync::atomic::AtomicBool::new(false));
+        let dict: Arc<dyn crate::dict::Dictionary> =
+            Arc::new(crate::dict::TrieDictionary::from_entries(std::iter::empty()));
+        let worker = AsyncWorker::new(
+            dict,
+            None,
+            None,
+            Arc::new(SlowSink {
+                started: started_tx,
+                finished: Arc::clone(&finished),
+            }),
+        );
+
+        worker.submit_candidates("きょう".to_string(), CandidateDispatch::Standard, None);
+        started_rx
+            .recv_timeout(Duration::from_secs(2))
+            .expect("deliver never ran");
+        worker.park();
+        assert!(!worker.is_running());
+        drop(worker);
+        assert!(finished.load(Ordering::SeqCst));
+    }
 }
@@ -0,0 +1,268 @@
+//! Bounded thread pool backing the async `LexEngine` entry points.
+//!
+//! Unlike `AsyncWorker` (one thread per session, latest request wins), this
+//! pool is shared by every caller: jobs start in FIFO order on at most
+//! `max_threads` threads, each job is exposed as a `Future`, and dropping the
+//! future before its job starts cancels the job. A job that is already
+//! running finishes, but its result is discarded. With more than one thread,
+//! jobs run concurrently and may finish in any order.
+//!
+//! The queue itself is unbounded: `spawn` never blocks or rejects. Callers
+//! bound it by awaiting or dropping their tasks; a cancelled job stays
+//! queued until a worker pops and skips it.
+
+use std::collections::VecDeque;
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::{Arc, Condvar, Mutex, OnceLock};
+use std::task::{Context, Poll, Waker};
+use std::thread;
+
+type Job = Box<dyn FnOnce() + Send + 'static>;
+
+pub(crate) struct Executor {
+    shared: Arc<Shared>,
+}
+
+struct Shared {
+    queue: Mutex<Queue>,
+    available: Condvar,
+}
+
+struct Queue {
+    jobs: VecDeque<Job>,
+    threads: usize,
+    idle: usize,
+    max_threads: usize,
+    shutdown: bool,
+}
+
+/// Process-wide pool used by `LexEngine`. Threads are spawned lazily.
+pub(crate) fn shared() -> &'static Executor {
+    static POOL: OnceLock<Executor> = OnceLock::new();
+    POOL.get_or_init(|| {
+        let threads = thread::available_parallelism().map_or(2, |n| n.get());
+        Executor::new(threads.clamp(1, 4))
+    })
+}
+
+impl Executor {
+    pub fn new(max_threads: usize) -> Self {
+        Self {
+            shared: Arc::new(Shared {
+                queue: Mutex::new(Queue {
+                    jobs: VecDeque::new(),
+                    threads: 0,
+                    idle: 0,
+                    max_threads: max_threads.max(1),
+                    shutdown: false,
+                }),
+                available: Condvar::new(),
+            }),
+        }
+    }
+
+    /// Queue `f` and return a future resolving to its result.
+    ///
+    /// The future yields `None` if `f` panicked. Never blocks: the queue
+    /// grows without limit.
+    pub fn spawn<T, F>(&self, f: F) -> Task<T>
+    where
+        T: Send + 'static,
+        F: FnOnce() -> T + Send + 'static,
+    {
+        let state = Arc::new(Mutex::new(TaskState {
+            result: None,
+            waker: None,
+            finished: false,
+            cancelled: false,
+        }));
+        let job_state = Arc::clone(&state);
+        let job: Job = Box::new(move || {
+            if job_state.lock().unwrap().cancelled {
+                return;
+            }
+            let result = std::panic::catch_unwind(std::panic::AssertUnwindSafe(f)).ok();
+            let waker = {
+                let mut s = job_state.lock().unwrap();
+                if s.cancelled {
+                    return;
+                }
+                s.result = result;
+                s.finished = true;
+                s.waker.take()
+            };
+            if let Some(waker) = waker {
+                waker.wake();
+            }
+        });
+
+        let mut queue = self.shared.queue.lock().unwrap();
+        queue.jobs.push_back(job);
+        if queue.idle == 0 && queue.threads < queue.max_threads {
+            queue.threads += 1;
+            let shared = Arc::clone(&self.shared);
+            thread::Builder::new()
+                .name("lexime-convert".into())
+                .spawn(move || worker(shared))
+                .expect("failed to spawn conversion worker");
+        } else {
+            self.shared.available.notify_one();
+        }
+        Task { state }
+    }
+}
+
+impl Drop for Executor {
+    fn drop(&mut self) {
+        // Workers drain the remaining queue, then exit.
+        self.shared.queue.lock().unwrap().shutdown = true;
+        self.shared.available.notify_all();
+    }
+}
+
+fn worker(shared: Arc<Shared>) {
+    let mut queue = shared.queue.lock().unwrap();
+    loop {
+        if let Some(job) = queue.jobs.pop_front() {
+            drop(queue);
+            job();
+            queue = shared.queue.lock().unwrap();
+            continue;
+        }
+        if queue.shutdown {
+            queue.threads -= 1;
+            return;
+        }
+        queue.idle += 1;
+        queue = shared.available.wait(queue).unwrap();
+        queue.idle -= 1;
+    }
+}
+
+struct TaskState<T> {
+    result: Option<T>,
+    waker: Option<Waker>,
+    finished: bool,
+    cancelled: bool,
+}
+
+/// Handle to a job queued on an [`Executor`]. Dropping it cancels the job.
+pub(crate) struct Task<T> {
+    state: Arc<Mutex<TaskState<T>>>,
+}
+
+impl<T> Future for Task<T> {
+    type Output = Option<T>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<T>> {
+        let mut s = self.state.lock().unwrap();
+        if s.finished {
+            return Poll::Ready(s.result.take());
+        }
+        match &s.waker {
+            Some(w) if w.will_wake(cx.waker()) => {}
+            _ => s.waker = Some(cx.waker().clone()),
+        }
+        Poll::Pending
+    }
+}
+
+impl<T> Drop for Task<T> {
+    fn drop(&mut self) {
+        if let Ok(mut s) = self.state.lock() {
+            s.cancelled = true;
+            s.waker = None;
+        }
+    }
+}
+
+/// Minimal single-future executor for tests: polls on the current thread
+/// and parks between wake-ups.
+#[cfg(test)]
+pub(crate) fn block_on<F: Future>(fut: F) -> F::Output {
+    struct ThreadWaker(thread::Thread);
+    impl std::task::Wake for ThreadWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.unpark();
+        }
+    }
+
+    let mut fut = std::pin::pin!(fut);
+    let waker = Waker::from(Arc::new(ThreadWaker(thread::current())));
+    let mut cx = Context::from_waker(&waker);
+    loop {
+        if let Poll::Ready(out) = fut.as_mut().poll(&mut cx) {
+            return out;
+        }
+        thread::park();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicBool, Ordering};
+    use std::sync::mpsc;
+
+    #[test]
+    fn test_single_thread_runs_jobs_in_submission_order() {
+        let pool = Executor::new(1);
+        let order = Arc::new(Mutex::new(Vec::new()));
+        let tasks: Vec<Task<usize>> = (0..8)
+            .map(|i| {
+                let order = Arc::clone(&order);
+                pool.spawn(move || {
+                    order.lock().unwrap().push(i);
+                    i
+                })
+            })
+            .collect();
+        // Await in reverse; completion order is still FIFO.
+        for (i, task) in tasks.into_iter().enumerate().rev() {
+            assert_eq!(block_on(task), Some(i));
+        }
+        assert_eq!(*order.lock().unwrap(), (0..8).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_dropped_task_is_not_run() {
+        let pool = Executor::new(1);
+        let (gate_tx, gate_rx) = mpsc::channel::<()>();
+        let blocker = pool.spawn(move || gate_rx.recv().ok());
+
+        let ran = Arc::new(AtomicBool::new(false));
+        let cancelled = pool.spawn({
+            let ran = Arc::clone(&ran);
+            move || ran.store(true, Ordering::SeqCst)
+        });
+        drop(cancelled);
+
+        gate_tx.send(()).unwrap();
+        assert_eq!(block_on(blocker), Some(Some(())));
+        // A later job runs after the cancelled one would have.
+        assert_eq!(block_on(pool.spawn(|| 7)), Some(7));
+        assert!(!ran.load(Ordering::SeqCst));
+    }
+
+    #[test]
+    fn test_panicking_job_yields_none() {
+        let pool = Executor::new(1);
+        let task = pool.spawn(|| -> u32 { panic!("boom") });
+        assert_eq!(block_on(task), None);
+        // The worker survives the panic.
+        assert_eq!(block_on(pool.spawn(|| 1)), Some(1));
+    }
+
+    #[test]
+    fn test_pool_is_bounded() {
+        let pool = Executor::new(2);
+        let tasks: Vec<_> = (0..16)
+            .map(|_| pool.spawn(|| thread::current().id()))
+            .collect();
+        let mut ids: Vec<_> = tasks.into_iter().filter_map(block_on).collect();
+        ids.sort_by_key(|id| format!("{id:?}"));
+        ids.dedup();
+        assert!(ids.len() <= 2);
+    }
+}
@@ -12,6 +12,7 @@ pub use lex_session as session;
 
 pub mod api;
 pub(crate) mod async_worker;
+pub(crate) mod executor;
 pub mod trace_init;
 
 uniffi::setup_scaffolding!();